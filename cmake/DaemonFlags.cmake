@@ -261,7 +261,7 @@ if (USE_FLOAT_EXCEPTIONS)
 endif()
 
 if (NOT NACL AND BUILD_CLIENT)
-	option(USE_OPENMP "Use OpenMP to parallelize some tasks" OFF)
+	option(USE_OPENMP "Use OpenMP in the job system benchmark for comparison" OFF)
 endif()
 
 if (YOKAI_CXX_COMPILER_MSVC_COMPATIBILITY)
@@ -154,6 +154,7 @@ set(SERVERLIST
     ${ENGINE_DIR}/server/sv_bot.cpp
     ${ENGINE_DIR}/server/sv_ccmds.cpp
     ${ENGINE_DIR}/server/sv_client.cpp
+    ${ENGINE_DIR}/server/sv_http.cpp
     ${ENGINE_DIR}/server/sv_init.cpp
     ${ENGINE_DIR}/server/sv_main.cpp
     ${ENGINE_DIR}/server/sv_net_chan.cpp
@@ -169,6 +170,7 @@ set(ENGINELIST
     ${ENGINE_DIR}/framework/ApplicationInternals.h
     ${ENGINE_DIR}/framework/BaseCommands.cpp
     ${ENGINE_DIR}/framework/BaseCommands.h
+    ${ENGINE_DIR}/framework/Benchmark.h
     ${ENGINE_DIR}/framework/CommandBufferHost.cpp
     ${ENGINE_DIR}/framework/CommandBufferHost.h
     ${ENGINE_DIR}/framework/CommandSystem.cpp
@@ -183,10 +185,12 @@ set(ENGINELIST
     ${ENGINE_DIR}/framework/CrashDump.cpp
     ${ENGINE_DIR}/framework/CvarSystem.cpp
     ${ENGINE_DIR}/framework/CvarSystem.h
+    ${ENGINE_DIR}/framework/JobSystem.cpp
+    ${ENGINE_DIR}/framework/JobSystem.h
     ${ENGINE_DIR}/framework/LogSystem.cpp
     ${ENGINE_DIR}/framework/LogSystem.h
-    ${ENGINE_DIR}/framework/OmpSystem.cpp
-    ${ENGINE_DIR}/framework/OmpSystem.h
+    ${ENGINE_DIR}/framework/RadixSort.cpp
+    ${ENGINE_DIR}/framework/RadixSort.h
     ${ENGINE_DIR}/framework/Resource.cpp
     ${ENGINE_DIR}/framework/Resource.h
     ${ENGINE_DIR}/framework/System.cpp
@@ -206,11 +210,6 @@ set(ENGINELIST
     ${ENGINE_DIR}/RefAPI.h
 )
 
-set(OMPLIST
-    ${ENGINE_DIR}/framework/OmpSystem.cpp
-    ${ENGINE_DIR}/framework/OmpSystem.h
-)
-
 if (YOKAI_TARGET_SYSTEM_WINDOWS)
     set(ENGINELIST ${ENGINELIST}
         ${ENGINE_DIR}/sys/con_passive.cpp
@@ -224,6 +223,17 @@ endif()
 # Tests runnable for any engine variant
 set(ENGINETESTLIST ${COMMONTESTLIST}
     ${ENGINE_DIR}/framework/CommandSystemTest.cpp
+    ${ENGINE_DIR}/framework/CullBenchmark.cpp
+    ${ENGINE_DIR}/framework/JobBenchmark.cpp
+    ${ENGINE_DIR}/framework/JobSystemTest.cpp
+    ${ENGINE_DIR}/framework/RadixSortTest.cpp
+    ${ENGINE_DIR}/framework/ResourceTest.cpp
+    ${ENGINE_DIR}/framework/SortBenchmark.cpp
+)
+
+# Tests for the engine variants including the server
+set(SERVERTESTLIST ${ENGINETESTLIST}
+    ${ENGINE_DIR}/server/sv_http_test.cpp
 )
 
 set(QCOMMONLIST
@@ -274,8 +284,13 @@ set(CLIENTBASELIST
     ${ENGINE_DIR}/client/keys.h
 )
 
+# Tests for the engine variants including the client base
+set(CLIENTBASETESTLIST ${SERVERTESTLIST}
+    ${ENGINE_DIR}/client/cl_serverlist_test.cpp
+    ${ENGINE_DIR}/client/dl_main_test.cpp
+)
+
 set(CLIENTLIST
-    ${OMPLIST}
     ${ENGINE_DIR}/audio/ALObjects.cpp
     ${ENGINE_DIR}/audio/ALObjects.h
     ${ENGINE_DIR}/audio/Audio.cpp
@@ -305,11 +320,10 @@ if (YOKAI_TARGET_SYSTEM_MACOS)
     set(CLIENTLIST ${CLIENTLIST} ${ENGINE_DIR}/sys/DisableAccentMenu.m)
 endif()
 
-set(CLIENTTESTLIST ${ENGINETESTLIST}
+set(CLIENTTESTLIST ${CLIENTBASETESTLIST}
 )
 
 set(TTYCLIENTLIST
-    ${OMPLIST}
     ${ENGINE_DIR}/null/NullAudio.cpp
     ${ENGINE_DIR}/null/NullKeyboard.cpp
     ${ENGINE_DIR}/null/null_input.cpp
@@ -317,14 +331,12 @@ set(TTYCLIENTLIST
 )
 
 set(DEDSERVERLIST
-    ${OMPLIST}
     ${ENGINE_DIR}/null/NullKeyboard.cpp
     ${ENGINE_DIR}/null/null_client.cpp
     ${ENGINE_DIR}/null/null_input.cpp
 )
 
 set(DUMMYAPPLIST
-    ${OMPLIST}
     ${COMMON_DIR}/Util.h
 )
 
@@ -134,6 +134,11 @@ namespace FS {
 static Cvar::Cvar<bool> fs_legacypaks("fs_legacypaks", "also load pk3s, ignoring version", Cvar::NONE, false);
 static Cvar::Cvar<int> fs_maxSymlinkDepth("fs_maxSymlinkDepth", "max depth of symlinks in zip paks (0 means disabled)", Cvar::NONE, 1);
 static Cvar::Cvar<std::string> fs_pakprefixes("fs_pakprefixes", "prefixes to look for paks to load", 0, "");
+static Cvar::Cvar<bool> fs_pakIndexCache("fs_pakIndexCache", "cache the file lists of paks in the homepath to speed up loading", Cvar::NONE, true);
+static Cvar::Range<Cvar::Cvar<int>> fs_workerThreads("fs_workerThreads", "threads used to find and load paks in the background, 0 to do it on the main thread", Cvar::NONE, 4, 0, 32);
+// Tells VMs that FS_INITIALIZE_SHARED is supported, older engines only have FS_INITIALIZE
+static Cvar::Cvar<bool> fs_sharedFileTable("fs_sharedFileTable", "whether VMs can get the list of loaded files in shared memory", Cvar::ROM, true);
+static Cvar::Range<Cvar::Cvar<int>> fs_readThreads("fs_readThreads", "threads used to read prefetched files in the background, 0 to read them on the main thread", Cvar::NONE, 2, 0, 32);
 
 bool UseLegacyPaks()
 {
@@ -1058,6 +1063,83 @@ private:
 } // GCC bug workaround
 #endif // defined(BUILD_ENGINE)
 
+#if defined(BUILD_ENGINE)
+// Pool of threads used to run filesystem work in the background. The tasks
+// must not touch the global filesystem state, their results are merged by the
+// thread which submitted them.
+class WorkerPool {
+public:
+	explicit WorkerPool(Cvar::Range<Cvar::Cvar<int>>& numThreadsCvar)
+		: numThreadsCvar(numThreadsCvar) {}
+
+	~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+		condition.notify_all();
+		for (std::thread& thread: threads)
+			thread.join();
+	}
+
+	// Run a function on a worker thread and get a future for its result. The
+	// function is run immediately on the calling thread if the thread count
+	// cvar is 0.
+	template<typename Func> std::future<typename std::result_of<Func()>::type> Submit(Func func)
+	{
+		using Result = typename std::result_of<Func()>::type;
+		auto task = std::make_shared<std::packaged_task<Result()>>(std::move(func));
+		std::future<Result> future = task->get_future();
+
+		int numThreads = numThreadsCvar.Get();
+		if (numThreads == 0) {
+			(*task)();
+			return future;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			while (static_cast<int>(threads.size()) < numThreads)
+				threads.emplace_back(&WorkerPool::Run, this);
+			tasks.emplace_back([task] { (*task)(); });
+		}
+		condition.notify_one();
+		return future;
+	}
+
+private:
+	void Run()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			condition.wait(lock, [this] { return quit || !tasks.empty(); });
+			if (quit)
+				return;
+			std::function<void()> task = std::move(tasks.front());
+			tasks.pop_front();
+			lock.unlock();
+			task();
+			lock.lock();
+		}
+	}
+
+	Cvar::Range<Cvar::Cvar<int>>& numThreadsCvar;
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<std::function<void()>> tasks;
+	std::vector<std::thread> threads;
+	bool quit = false;
+};
+
+// Pool used to find and scan paks
+static WorkerPool workerPool(fs_workerThreads);
+
+// Pool used to read prefetched files, kept separate so that prefetching can't
+// delay pak loading
+static WorkerPool readPool(fs_readThreads);
+#endif // defined(BUILD_ENGINE)
+
 namespace PakPath {
 
 // List of loaded pak files
@@ -1091,8 +1173,164 @@ static std::unordered_set<std::pair<std::string, std::string>, stdStringPairHash
 
 // Map of filenames to pak files. The size_t is an offset into loadedPaks and
 // the offset_t is the position within the zip archive (unused for PAK_DIR).
+// VMs only fill it when the engine sends it instead of the shared file table.
 static std::unordered_map<std::string, std::pair<uint32_t, offset_t>, Str::IHash, Str::IEqual> fileMap;
 
+// Entry of the case-insensitive sorted index of all loaded files
+struct FileIndexEntry {
+	Str::StringRef name;
+	uint32_t pakIndex;
+	offset_t offset;
+};
+
+// Sorted index of the loaded files, used to list the contents of a directory
+// without scanning every loaded file. In the engine the names refer to the
+// keys of fileMap, which are never moved or modified. In VMs the index is the
+// only lookup structure and the names refer to the file table shared by the
+// engine, or to the keys of fileMap with older engines.
+static std::vector<FileIndexEntry> fileIndex;
+
+static bool FileIndexLess(const FileIndexEntry& a, const FileIndexEntry& b)
+{
+	return Str::ILess()(a.name, b.name);
+}
+
+// Layout of the file table given to VMs in shared memory: a header, followed
+// by numFiles entries sorted by name, followed by namesSize bytes of names.
+// Each name is followed by a NUL terminator which is not included in its
+// length.
+struct FileTableHeader {
+	uint32_t numFiles;
+	uint32_t namesSize;
+};
+struct FileTableEntry {
+	uint32_t nameOffset;
+	uint32_t nameLength;
+	uint32_t pakIndex;
+	uint32_t padding;
+	offset_t offset;
+};
+
+#ifdef BUILD_VM
+// Shared memory holding the names referenced by fileIndex
+static IPC::SharedMemory fileTable;
+
+static void ReadFileTable(IPC::SharedMemory table)
+{
+	fileIndex.clear();
+	fileMap.clear();
+	fileTable = std::move(table);
+
+	const char* base = static_cast<const char*>(fileTable.GetBase());
+	size_t size = fileTable.GetSize();
+	FileTableHeader header;
+	if (size < sizeof(header))
+		Sys::Drop("FS: Invalid file table");
+	memcpy(&header, base, sizeof(header));
+	size_t namesPos = sizeof(header) + size_t(header.numFiles) * sizeof(FileTableEntry);
+	if (header.numFiles > (size - sizeof(header)) / sizeof(FileTableEntry) || header.namesSize > size - namesPos)
+		Sys::Drop("FS: Invalid file table");
+
+	fileIndex.reserve(header.numFiles);
+	for (uint32_t i = 0; i < header.numFiles; i++) {
+		FileTableEntry entry;
+		memcpy(&entry, base + sizeof(header) + i * sizeof(FileTableEntry), sizeof(entry));
+		if (entry.nameOffset > header.namesSize || entry.nameLength >= header.namesSize - entry.nameOffset || entry.pakIndex >= loadedPaks.size())
+			Sys::Drop("FS: Invalid file table");
+		const char* name = base + namesPos + entry.nameOffset;
+		if (name[entry.nameLength] != '\0')
+			Sys::Drop("FS: Invalid file table");
+		fileIndex.push_back({name, entry.pakIndex, entry.offset});
+	}
+}
+
+// Index the file map sent by engines that don't share the file table
+static void IndexFileMap()
+{
+	fileIndex.clear();
+	fileTable = IPC::SharedMemory();
+	fileIndex.reserve(fileMap.size());
+	for (const auto& entry: fileMap)
+		fileIndex.push_back({entry.first, entry.second.first, entry.second.second});
+	std::sort(fileIndex.begin(), fileIndex.end(), FileIndexLess);
+}
+
+// Binary search in the sorted index
+static Util::optional<FileIndexEntry> FindFile(Str::StringRef path)
+{
+	FileIndexEntry key = {path, 0, 0};
+	auto it = std::lower_bound(fileIndex.begin(), fileIndex.end(), key, FileIndexLess);
+	if (it == fileIndex.end() || !Str::IsIEqual(it->name, path))
+		return {};
+	return *it;
+}
+#else
+// Serialized file table, built on demand and discarded whenever the set of
+// loaded files changes
+static std::string fileTableData;
+
+// Add a file to fileMap unless a file with the same name was already loaded.
+// The new entry is added at the end of fileIndex and must be sorted into place
+// with SortFileIndex.
+static void AddFile(Str::StringRef filename, uint32_t pakIndex, offset_t offset)
+{
+	auto result = fileMap.emplace(filename, std::pair<uint32_t, offset_t>(pakIndex, offset));
+	if (result.second)
+		fileIndex.push_back({result.first->first, pakIndex, offset});
+}
+
+// Sort the entries added since the index had the given size into the index
+static void SortFileIndex(size_t sortedSize)
+{
+	auto middle = fileIndex.begin() + sortedSize;
+	std::sort(middle, fileIndex.end(), FileIndexLess);
+	std::inplace_merge(fileIndex.begin(), middle, fileIndex.end(), FileIndexLess);
+	fileTableData.clear();
+}
+
+// Create a shared memory copy of the file table to send to a VM. A new one is
+// needed for every VM since the handle is closed once the reply is sent.
+static IPC::SharedMemory CreateFileTable()
+{
+	if (fileTableData.empty()) {
+		FileTableHeader header = {};
+		header.numFiles = fileIndex.size();
+		std::vector<FileTableEntry> entries;
+		entries.reserve(fileIndex.size());
+		std::string names;
+		for (const FileIndexEntry& file: fileIndex) {
+			FileTableEntry entry = {};
+			entry.nameOffset = names.size();
+			entry.nameLength = file.name.size();
+			entry.pakIndex = file.pakIndex;
+			entry.offset = file.offset;
+			entries.push_back(entry);
+			names.append(file.name.data(), file.name.size());
+			names.push_back('\0');
+		}
+		header.namesSize = names.size();
+
+		fileTableData.reserve(sizeof(header) + entries.size() * sizeof(FileTableEntry) + names.size());
+		fileTableData.append(reinterpret_cast<const char*>(&header), sizeof(header));
+		fileTableData.append(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(FileTableEntry));
+		fileTableData.append(names);
+	}
+
+	IPC::SharedMemory table = IPC::SharedMemory::Create(fileTableData.size());
+	memcpy(table.GetBase(), fileTableData.data(), fileTableData.size());
+	return table;
+}
+
+// Hash lookup in fileMap
+static Util::optional<FileIndexEntry> FindFile(Str::StringRef path)
+{
+	auto it = fileMap.find(path);
+	if (it == fileMap.end())
+		return {};
+	return FileIndexEntry{it->first, it->second.first, it->second.second};
+}
+#endif
+
 #ifndef BUILD_VM
 /* Parse the deleted file list file of a package.
 
@@ -1159,14 +1397,376 @@ static void ParseDeleted(const PakInfo& parent, Str::StringRef deletedData)
 	}
 }
 
-static void InternalLoadPak(
-	const PakInfo& pak, Util::optional<uint32_t> expectedChecksum, Str::StringRef pathPrefix,
-	bool loadDeps, std::error_code& err);
+// Owned file descriptor of a pak, which is closed unless it is released
+class PakFd {
+public:
+	PakFd()
+		: fd(-1) {}
+	explicit PakFd(int fd)
+		: fd(fd) {}
+
+	// Noncopyable but movable
+	PakFd(const PakFd&) = delete;
+	PakFd& operator=(const PakFd&) = delete;
+	PakFd(PakFd&& other)
+		: fd(other.fd)
+	{
+		other.fd = -1;
+	}
+	PakFd& operator=(PakFd&& other)
+	{
+		std::swap(fd, other.fd);
+		return *this;
+	}
+
+	~PakFd()
+	{
+		if (fd != -1)
+			close(fd);
+	}
+
+	int Get() const
+	{
+		return fd;
+	}
+
+	int Release()
+	{
+		int out = fd;
+		fd = -1;
+		return out;
+	}
+
+private:
+	int fd;
+};
+
+// Contents of a pak as read by ScanPak. This is everything needed to add the
+// pak to the namespace, gathered without touching any global state so that it
+// can be done on a worker thread.
+struct PakScan {
+	struct Entry {
+		std::string filename;
+		offset_t offset;
+	};
+
+	std::error_code err;
+	PakFd fd;
+	std::vector<Entry> files;
+	std::vector<std::string> invalidFilenames;
+	Util::optional<uint32_t> realChecksum;
+	std::chrono::system_clock::time_point timestamp;
+	bool hasDeleted = false;
+	std::string deletedData;
+	bool hasDeps = false;
+	std::string depsData;
+
+	// Whether the file list was read from the index cache
+	bool indexCached = false;
+
+	// Time spent reading the pak, in milliseconds
+	int scanTime = 0;
+};
+
+// Read a metadata file, such as the dependency list, from a pak
+static std::string ReadPakMetadata(const PakInfo& pak, ZipArchive& zipFile, offset_t offset, Str::StringRef filename, std::error_code& err)
+{
+	if (pak.type == pakType_t::PAK_DIR) {
+		File file = RawPath::OpenRead(Path::Build(pak.path, filename), err);
+		if (err)
+			return "";
+		return file.ReadAll(err);
+	} else if (pak.type == pakType_t::PAK_ZIP) {
+		zipFile.OpenFile(offset, err);
+		if (err)
+			return "";
+		offset_t length = zipFile.FileLength(err);
+		if (err)
+			return "";
+		std::string data;
+		data.resize(length);
+		auto read = zipFile.ReadFile(&data[0], length, err);
+		data.resize(read);
+		return data;
+	}
+
+	ASSERT_UNREACHABLE();
+}
+
+// The central directory of every zip pak is cached in the homepath so that it
+// doesn't need to be parsed again as long as the pak is unchanged. The cache
+// stores the raw entries, before filtering, so that the same cache can be
+// used whatever path prefix the pak is loaded with.
+static const uint32_t PAK_INDEX_MAGIC = 0x58444950; // "PIDX"
+static const uint32_t PAK_INDEX_VERSION = 1;
+
+// Cache file layout: a header, the pak path, numEntries entries and then the
+// concatenated entry names.
+struct PakIndexHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t pakSize;
+	int64_t pakTime;
+	uint32_t pathLength;
+	uint32_t numEntries;
+	uint32_t namesSize;
+	// CRC32 of everything following the header
+	uint32_t checksum;
+};
+struct PakIndexEntry {
+	offset_t offset;
+	uint32_t crc;
+	uint32_t nameLength;
+};
+
+struct ZipEntry {
+	std::string filename;
+	offset_t offset;
+	uint32_t crc;
+};
+
+static std::string PakIndexCachePath(const PakInfo& pak)
+{
+	uint32_t pathHash = crc32(0, reinterpret_cast<const Bytef*>(pak.path.data()), pak.path.size());
+	return Str::Format("pakindex/%08x.idx", pathHash);
+}
+
+// Read the cached index of a pak, returns false if there is no valid cache for
+// this version of the pak
+static bool ReadPakIndexCache(Str::StringRef cachePath, const PakInfo& pak, uint64_t pakSize, int64_t pakTime, std::vector<ZipEntry>& entries)
+{
+	std::error_code err;
+	File file = HomePath::OpenRead(cachePath, err);
+	if (err)
+		return false;
+	std::string data = file.ReadAll(err);
+	if (err || data.size() < sizeof(PakIndexHeader))
+		return false;
+
+	PakIndexHeader header;
+	memcpy(&header, data.data(), sizeof(header));
+	if (header.magic != PAK_INDEX_MAGIC || header.version != PAK_INDEX_VERSION || header.pakSize != pakSize || header.pakTime != pakTime)
+		return false;
+	size_t pos = sizeof(header);
+	if (header.checksum != crc32(0, reinterpret_cast<const Bytef*>(data.data() + pos), data.size() - pos))
+		return false;
+	if (header.pathLength != pak.path.size() || header.pathLength > data.size() - pos || data.compare(pos, header.pathLength, pak.path) != 0)
+		return false;
+	pos += header.pathLength;
+	if (header.numEntries > (data.size() - pos) / sizeof(PakIndexEntry))
+		return false;
+	size_t namePos = pos + header.numEntries * sizeof(PakIndexEntry);
+	if (header.namesSize != data.size() - namePos)
+		return false;
+
+	entries.clear();
+	entries.reserve(header.numEntries);
+	for (uint32_t i = 0; i < header.numEntries; i++) {
+		PakIndexEntry entry;
+		memcpy(&entry, data.data() + pos + i * sizeof(PakIndexEntry), sizeof(entry));
+		if (entry.nameLength > data.size() - namePos)
+			return false;
+		entries.push_back({data.substr(namePos, entry.nameLength), entry.offset, entry.crc});
+		namePos += entry.nameLength;
+	}
+	return true;
+}
+
+// Write the index of a pak to the cache. Errors are ignored since the cache is
+// only an optimization.
+static void WritePakIndexCache(Str::StringRef cachePath, const PakInfo& pak, uint64_t pakSize, int64_t pakTime, const std::vector<ZipEntry>& entries)
+{
+	PakIndexHeader header = {};
+	header.magic = PAK_INDEX_MAGIC;
+	header.version = PAK_INDEX_VERSION;
+	header.pakSize = pakSize;
+	header.pakTime = pakTime;
+	header.pathLength = pak.path.size();
+	header.numEntries = entries.size();
+
+	std::string data(sizeof(header), '\0');
+	data.append(pak.path);
+	for (const ZipEntry& zipEntry: entries) {
+		PakIndexEntry entry = {};
+		entry.offset = zipEntry.offset;
+		entry.crc = zipEntry.crc;
+		entry.nameLength = zipEntry.filename.size();
+		data.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+	}
+	size_t namePos = data.size();
+	for (const ZipEntry& zipEntry: entries)
+		data.append(zipEntry.filename);
+	header.namesSize = data.size() - namePos;
+	header.checksum = crc32(0, reinterpret_cast<const Bytef*>(data.data() + sizeof(header)), data.size() - sizeof(header));
+	memcpy(&data[0], &header, sizeof(header));
+
+	// The same pak may be scanned by several threads or processes at once
+	std::error_code err;
+	HomePath::WriteFileAtomic(cachePath, data, err);
+}
+
+// Read the file list of a pak and compute its checksum. This is the expensive
+// part of loading a pak and is safe to call from any thread.
+static PakScan ScanPak(const PakInfo& pak, Str::StringRef pathPrefix, bool loadDeps, bool useIndexCache)
+{
+	auto startTime = Sys::SteadyClock::now();
+	PakScan scan;
+	std::error_code& err = scan.err;
+	offset_t deletedOffset = 0;
+	offset_t depsOffset = 0;
+	ZipArchive zipFile;
+	bool isLegacy = pak.version.empty();
+
+	if (pak.type == pakType_t::PAK_DIR) {
+		auto dirRange = RawPath::ListFilesRecursive(pak.path, err);
+		if (err)
+			return scan;
+		for (auto it = dirRange.begin(); it != dirRange.end();) {
+			if (!isLegacy && *it == PAK_DELETED_FILE) {
+				scan.hasDeleted = true;
+			}
+			else if (!isLegacy && *it == PAK_DEPS_FILE) {
+				scan.hasDeps = true;
+			}
+			else if (!Str::IsSuffix("/", *it) && Str::IsPrefix(pathPrefix, *it)) {
+				scan.files.push_back({*it, 0});
+			}
+			it.increment(err);
+			if (err)
+				return scan;
+		}
+	} else if (pak.type == pakType_t::PAK_ZIP) {
+		// Open file
+		scan.fd = PakFd(my_open(pak.path, openMode_t::MODE_READ));
+		if (scan.fd.Get() == -1) {
+			SetErrorCodeSystem(err);
+			return scan;
+		}
+
+		// The size and modification time identify this version of the pak in the index cache
+		my_stat_t st;
+		if (my_fstat(scan.fd.Get(), &st) != 0) {
+			SetErrorCodeSystem(err);
+			return scan;
+		}
+
+		// Get the file list from the index cache, or from the central directory of the zip
+		std::vector<ZipEntry> entries;
+		std::string cachePath = PakIndexCachePath(pak);
+		scan.indexCached = useIndexCache && ReadPakIndexCache(cachePath, pak, st.st_size, st.st_mtime, entries);
+		if (!scan.indexCached) {
+			zipFile = ZipArchive::Open(scan.fd.Get(), err);
+			if (err)
+				return scan;
+			zipFile.ForEachFile([&entries](Str::StringRef filename, offset_t offset, uint32_t crc) {
+				entries.push_back({filename, offset, crc});
+			}, err);
+			if (err)
+				return scan;
+			if (useIndexCache)
+				WritePakIndexCache(cachePath, pak, st.st_size, st.st_mtime, entries);
+		}
+
+		// Filter the file list and calculate the checksum of the package (checksum of all file checksums)
+		scan.realChecksum = crc32(0, Z_NULL, 0);
+		for (ZipEntry& entry: entries) {
+			const std::string& filename = entry.filename;
+			if (!Str::IsPrefix(pathPrefix, filename)
+				&& filename != PAK_DELETED_FILE
+				&& filename != PAK_DEPS_FILE)
+				continue;
+			if (Str::IsSuffix("/", filename))
+				continue;
+			if (!Path::IsValid(filename, false)) {
+				scan.invalidFilenames.push_back(filename);
+				continue;
+			}
+
+			// Legacy paks don't have version neither checksum
+			if (!isLegacy) {
+				scan.realChecksum = crc32(*scan.realChecksum, reinterpret_cast<const Bytef*>(&entry.crc), sizeof(entry.crc));
+			}
+
+			if (!isLegacy && filename == PAK_DELETED_FILE) {
+				scan.hasDeleted = true;
+				deletedOffset = entry.offset;
+				continue;
+			}
+			else if (!isLegacy && filename == PAK_DEPS_FILE) {
+				scan.hasDeps = true;
+				depsOffset = entry.offset;
+				continue;
+			}
+
+			scan.files.push_back({std::move(entry.filename), entry.offset});
+		}
+
+		// The zip archive still needs to be opened to read the metadata files
+		// if the file list came from the cache
+		if (scan.indexCached && (scan.hasDeleted || (loadDeps && scan.hasDeps))) {
+			zipFile = ZipArchive::Open(scan.fd.Get(), err);
+			if (err)
+				return scan;
+		}
+
+		// Get the timestamp of the pak, but only for dpk files.
+		// Directories (aka a dpkdir) don't need timestamp.
+		// Fixes Windows bug where calling _wstat64i with trailing slash causes "file not found" error.
+		// For future stat calls on directories, trim the trailing slash (if exists)
+		scan.timestamp = FS::RawPath::FileTimestamp(pak.path, err);
+		if (err)
+			return scan;
+	} else {
+		ASSERT_UNREACHABLE();
+	}
+
+	// Read the deleted file list and the dependencies, which legacy paks (pk3) don't have
+	if (scan.hasDeleted) {
+		scan.deletedData = ReadPakMetadata(pak, zipFile, deletedOffset, PAK_DELETED_FILE, err);
+		if (err)
+			return scan;
+	}
+	if (loadDeps && scan.hasDeps) {
+		scan.depsData = ReadPakMetadata(pak, zipFile, depsOffset, PAK_DEPS_FILE, err);
+		if (err)
+			return scan;
+	}
+
+	scan.scanTime = std::chrono::duration_cast<std::chrono::milliseconds>(Sys::SteadyClock::now() - startTime).count();
+	return scan;
+}
+
+// Check if this pak has already been loaded to avoid recursive dependencies
+static bool IsPakLoaded(const PakInfo& pak, Str::StringRef pathPrefix)
+{
+	for (auto& x: loadedPaks) {
+		// If the prefix is a superset of our current prefix, then it already
+		// includes all the files we care about.
+		if (x.path == pak.path && Str::IsPrefix(x.pathPrefix, pathPrefix))
+			return true;
+	}
+	return false;
+}
+
+// Start reading a pak on a worker thread
+static std::future<PakScan> StartPakScan(const PakInfo& pak, Str::StringRef pathPrefix, bool loadDeps)
+{
+	std::string prefix = pathPrefix;
+	bool useIndexCache = fs_pakIndexCache.Get();
+	return workerPool.Submit([pak, prefix, loadDeps, useIndexCache] {
+		return ScanPak(pak, prefix, loadDeps, useIndexCache);
+	});
+}
+
+static void LoadScannedPak(
+	const PakInfo& pak, std::future<PakScan> pendingScan, Util::optional<uint32_t> expectedChecksum,
+	Str::StringRef pathPrefix, bool loadDeps, std::error_code& err);
 
 // Parse the dependencies file of a package
 // Each line of the dependencies file is a name followed by an optional version
 static void ParseDeps(const PakInfo& parent, Str::StringRef depsData, Str::StringRef prefix, std::error_code& err)
 {
+	std::vector<const PakInfo*> deps;
 	auto lineStart = depsData.begin();
 	int line = 0;
 	while (lineStart != depsData.end()) {
@@ -1199,9 +1799,7 @@ static void ParseDeps(const PakInfo& parent, Str::StringRef depsData, Str::Strin
 				SetErrorCodeFilesystem(err, filesystem_error::missing_dependency);
 				return;
 			}
-			InternalLoadPak(*pak, Util::nullopt, prefix, true, err);
-			if (err)
-				return;
+			deps.push_back(pak);
 			lineStart = lineEnd == depsData.end() ? lineEnd : lineEnd + 1;
 			continue;
 		}
@@ -1223,9 +1821,7 @@ static void ParseDeps(const PakInfo& parent, Str::StringRef depsData, Str::Strin
 				SetErrorCodeFilesystem(err, filesystem_error::missing_dependency);
 				return;
 			}
-			InternalLoadPak(*pak, Util::nullopt, prefix, true, err);
-			if (err)
-				return;
+			deps.push_back(pak);
 			lineStart = lineEnd == depsData.end() ? lineEnd : lineEnd + 1;
 			continue;
 		}
@@ -1234,6 +1830,24 @@ static void ParseDeps(const PakInfo& parent, Str::StringRef depsData, Str::Strin
 		fsLogs.Warn("Invalid dependency specification on line %d in %s", line, Path::Build(parent.path, PAK_DEPS_FILE));
 		lineStart = lineEnd == depsData.end() ? lineEnd : lineEnd + 1;
 	}
+
+	// Read all the dependencies in parallel, but add them in the order they
+	// are listed so that the priority of their files is deterministic.
+	std::vector<std::future<PakScan>> scans;
+	for (const PakInfo* pak: deps) {
+		if (IsPakLoaded(*pak, prefix))
+			scans.emplace_back();
+		else
+			scans.push_back(StartPakScan(*pak, prefix, true));
+	}
+	for (size_t i = 0; i < deps.size(); i++) {
+		// The pak may also have been loaded as a dependency of a previous one
+		if (IsPakLoaded(*deps[i], prefix))
+			continue;
+		LoadScannedPak(*deps[i], std::move(scans[i]), Util::nullopt, prefix, true, err);
+		if (err)
+			return;
+	}
 }
 
 /* The code is expected to be only reliable for ignoring deleted files
@@ -1259,26 +1873,14 @@ static bool FileIsDeleted(const PakInfo& pak, Str::StringRef filename)
 	return deletedFileSet.find(std::pair<std::string, std::string>(pak.name, filename)) != deletedFileSet.end();
 }
 
-static void InternalLoadPak(
-	const PakInfo& pak, Util::optional<uint32_t> expectedChecksum, Str::StringRef pathPrefix,
-	bool loadDeps, std::error_code& err)
+// Add a pak read by ScanPak to the namespace, then load its dependencies
+static void LoadScannedPak(
+	const PakInfo& pak, std::future<PakScan> pendingScan, Util::optional<uint32_t> expectedChecksum,
+	Str::StringRef pathPrefix, bool loadDeps, std::error_code& err)
 {
-	Util::optional<uint32_t> realChecksum;
-	bool hasDeleted = false;
-	offset_t deletedOffset = 0;
-	bool hasDeps = false;
-	offset_t depsOffset = 0;
-	ZipArchive zipFile;
+	auto startTime = Sys::SteadyClock::now();
 	bool isLegacy = pak.version.empty();
 
-	// Check if this pak has already been loaded to avoid recursive dependencies
-	for (auto& x: loadedPaks) {
-		// If the prefix is a superset of our current prefix, then it already
-		// includes all the files we care about.
-		if (x.path == pak.path && Str::IsPrefix(x.pathPrefix, pathPrefix))
-			return;
-	}
-
 	if (pak.type == pakType_t::PAK_ZIP) {
 		if (!isLegacy) {
 			fsLogs.WithoutSuppression().Notice("Loading pak '%s'...", pak.path.c_str());
@@ -1295,6 +1897,27 @@ static void InternalLoadPak(
 		ASSERT_UNREACHABLE();
 	}
 
+	PakScan scan = pendingScan.get();
+	for (const std::string& filename: scan.invalidFilenames)
+		fsLogs.Warn("Invalid filename '%s' in pak '%s'", filename, pak.path);
+	if (scan.err) {
+		SetErrorCode(err, scan.err.value(), scan.err.category());
+		return;
+	}
+
+	// Legacy paks don't have version neither checksum
+	if (!isLegacy) {
+		// If an explicit checksum was requested, verify that the pak we loaded is the one we are expecting
+		if (expectedChecksum && scan.realChecksum != *expectedChecksum) {
+			SetErrorCodeFilesystem(err, filesystem_error::wrong_pak_checksum, pak.path);
+			return;
+		}
+
+		// Print a warning if the checksum doesn't match the one in the filename
+		if (pak.checksum && *pak.checksum != scan.realChecksum)
+			fsLogs.Warn("Pak checksum doesn't match filename: %s", pak.path);
+	}
+
 	loadedPaks.emplace_back();
 	auto &loadedPak = loadedPaks.back();
 	loadedPak.name = pak.name;
@@ -1302,175 +1925,47 @@ static void InternalLoadPak(
 	loadedPak.checksum = pak.checksum;
 	loadedPak.type = pak.type;
 	loadedPak.path = pak.path;
+	// Save the real checksum in the list of loaded paks (empty for directories, not used for legacy paks)
+	loadedPak.realChecksum = scan.realChecksum;
+	loadedPak.timestamp = scan.timestamp;
+	loadedPak.fd = scan.fd.Release();
+	loadedPak.pathPrefix = pathPrefix;
 
 	// Update the list of files, but don't overwrite existing files, so the sort order is preserved
-	if (pak.type == pakType_t::PAK_DIR) {
-		loadedPak.fd = -1;
-		auto dirRange = RawPath::ListFilesRecursive(pak.path, err);
-		if (err)
-			return;
-		for (auto it = dirRange.begin(); it != dirRange.end();) {
-			if (!isLegacy && *it == PAK_DELETED_FILE) {
-				hasDeleted = true;
-			}
-			else if (!isLegacy && *it == PAK_DEPS_FILE) {
-				hasDeps = true;
-			}
-			else if (!Str::IsSuffix("/", *it) && Str::IsPrefix(pathPrefix, *it)) {
-				if (FileIsDeleted(pak, *it)) {
-					Log::Debug("Ignoring deleted file %s from %s", *it, pak.path);
-				}
-				else {
-					fileMap.emplace(*it, std::pair<uint32_t, offset_t>(loadedPaks.size() - 1, 0));
-				}
-			}
-			it.increment(err);
-			if (err)
-				return;
+	uint32_t pakIndex = loadedPaks.size() - 1;
+	size_t indexSize = fileIndex.size();
+	for (const PakScan::Entry& entry: scan.files) {
+		if (FileIsDeleted(pak, entry.filename)) {
+			Log::Debug("Ignoring deleted file %s from %s", entry.filename, pak.path);
 		}
-	} else if (pak.type == pakType_t::PAK_ZIP) {
-		// Open file
-		loadedPak.fd = my_open(pak.path, openMode_t::MODE_READ);
-		if (loadedPak.fd == -1) {
-			SetErrorCodeSystem(err);
-			return;
+		else {
+			AddFile(entry.filename, pakIndex, entry.offset);
 		}
-
-		// Open zip
-		zipFile = ZipArchive::Open(loadedPak.fd, err);
-		if (err)
-			return;
-
-		// Get the file list and calculate the checksum of the package (checksum of all file checksums)
-		realChecksum = crc32(0, Z_NULL, 0);
-		zipFile.ForEachFile([&pak, &realChecksum, &pathPrefix, &hasDeps, &hasDeleted, &depsOffset, &deletedOffset, &isLegacy](Str::StringRef filename, offset_t offset, uint32_t crc) {
-			// Note that 'return' is effectively 'continue' since we are in a lambda
-			if (!Str::IsPrefix(pathPrefix, filename)
-				&& filename != PAK_DELETED_FILE
-				&& filename != PAK_DEPS_FILE)
-				return;
-			if (Str::IsSuffix("/", filename))
-				return;
-			if (!Path::IsValid(filename, false)) {
-				fsLogs.Warn("Invalid filename '%s' in pak '%s'", filename, pak.path);
-				return;
-			}
-
-			// Legacy paks don't have version neither checksum
-			if (!isLegacy) {
-				realChecksum = crc32(*realChecksum, reinterpret_cast<const Bytef*>(&crc), sizeof(crc));
-			}
-
-			if (!isLegacy && filename == PAK_DELETED_FILE) {
-				hasDeleted = true;
-				deletedOffset = offset;
-				return;
-			}
-			else if (!isLegacy && filename == PAK_DEPS_FILE) {
-				hasDeps = true;
-				depsOffset = offset;
-				return;
-			}
-
-			if (FileIsDeleted(pak, filename)) {
-				Log::Debug("Ignoring deleted file %s from %s", filename, pak.path);
-			}
-			else {
-				fileMap.emplace(filename, std::pair<uint32_t, offset_t>(loadedPaks.size() - 1, offset));
-			}
-		}, err);
-		if (err)
-			return;
-	} else {
-		ASSERT_UNREACHABLE();
 	}
+	SortFileIndex(indexSize);
 
-	// Save the real checksum in the list of loaded paks (empty for directories, not used for legacy paks)
-	loadedPak.realChecksum = realChecksum;
+	fsLogs.Verbose("Loaded %d files from '%s' in %d ms (%d ms reading the %s)", scan.files.size(), pak.path,
+		std::chrono::duration_cast<std::chrono::milliseconds>(Sys::SteadyClock::now() - startTime).count(), scan.scanTime,
+		scan.indexCached ? "cached index" : "pak");
 
-	// Get the timestamp of the pak, but only for dpk files. 
-	// Directories (aka a dpkdir) don't need timestamp.
-	// Fixes Windows bug where calling _wstat64i with trailing slash causes "file not found" error.
-	// For future stat calls on directories, trim the trailing slash (if exists)
-	if (pak.type == pakType_t::PAK_ZIP) {
-		loadedPak.timestamp = FS::RawPath::FileTimestamp(pak.path, err);
-		if (err)
-			return;
-	}
-
-	loadedPak.pathPrefix = pathPrefix;
-
-	// Legacy paks don't have version neither checksum
+	// Load deleted file list and dependencies (non-legacy paks (pk3) only)
 	if (!isLegacy) {
-		// If an explicit checksum was requested, verify that the pak we loaded is the one we are expecting
-		if (expectedChecksum && realChecksum != *expectedChecksum) {
-			SetErrorCodeFilesystem(err, filesystem_error::wrong_pak_checksum, pak.path);
-			return;
-		}
+		if (scan.hasDeleted)
+			ParseDeleted(pak, scan.deletedData);
 
-		// Print a warning if the checksum doesn't match the one in the filename
-		if (pak.checksum && *pak.checksum != realChecksum)
-			fsLogs.Warn("Pak checksum doesn't match filename: %s", pak.path);
+		if (loadDeps && scan.hasDeps)
+			ParseDeps(pak, scan.depsData, pathPrefix, err);
 	}
+}
 
-	// Load deleted file list
-	// Do not look for deleted file list if it's a legacy pak (pk3)
-	if (!isLegacy) {
-		if (hasDeleted) {
-			std::string deletedData;
-			if (pak.type == pakType_t::PAK_DIR) {
-				File depsFile = RawPath::OpenRead(Path::Build(pak.path, PAK_DELETED_FILE), err);
-				if (err)
-					return;
-				deletedData = depsFile.ReadAll(err);
-				if (err)
-					return;
-			} else if (pak.type == pakType_t::PAK_ZIP) {
-				zipFile.OpenFile(deletedOffset, err);
-				if (err)
-					return;
-				offset_t length = zipFile.FileLength(err);
-				if (err)
-					return;
-				deletedData.resize(length);
-				auto read = zipFile.ReadFile(&deletedData[0], length, err);
-				deletedData.resize(read);
-				if (err)
-					return;
-			} else {
-				ASSERT_UNREACHABLE();
-			}
-			ParseDeleted(pak, deletedData);
-		}
+static void InternalLoadPak(
+	const PakInfo& pak, Util::optional<uint32_t> expectedChecksum, Str::StringRef pathPrefix,
+	bool loadDeps, std::error_code& err)
+{
+	if (IsPakLoaded(pak, pathPrefix))
+		return;
 
-		// Load dependencies (non-legacy paks (pk3) only)
-		if (loadDeps && hasDeps) {
-			std::string depsData;
-			if (pak.type == pakType_t::PAK_DIR) {
-				File depsFile = RawPath::OpenRead(Path::Build(pak.path, PAK_DEPS_FILE), err);
-				if (err)
-					return;
-				depsData = depsFile.ReadAll(err);
-				if (err)
-					return;
-			} else if (pak.type == pakType_t::PAK_ZIP) {
-				zipFile.OpenFile(depsOffset, err);
-				if (err)
-					return;
-				offset_t length = zipFile.FileLength(err);
-				if (err)
-					return;
-				depsData.resize(length);
-				auto read = zipFile.ReadFile(&depsData[0], length, err);
-				depsData.resize(read);
-				if (err)
-					return;
-			} else {
-				ASSERT_UNREACHABLE();
-			}
-			ParseDeps(pak, depsData, pathPrefix, err);
-		}
-	}
+	LoadScannedPak(pak, StartPakScan(pak, pathPrefix, loadDeps), expectedChecksum, pathPrefix, loadDeps, err);
 }
 
 void LoadPak(const PakInfo& pak, std::error_code& err)
@@ -1497,6 +1992,8 @@ void ClearPaks()
 {
 	fsLogs.Verbose("^5Unloading all paks");
 	deletedFileSet.clear();
+	fileIndex.clear();
+	fileTableData.clear();
 	fileMap.clear();
 	for (LoadedPakInfo& x: loadedPaks) {
 		if (x.fd != -1)
@@ -1552,18 +2049,13 @@ std::string ReadFile(Str::StringRef path, std::error_code& err) {
 #endif
 
 #ifdef BUILD_ENGINE
-std::string ReadFile(Str::StringRef path, std::error_code& err)
+// Read a file given its location in a pak. This doesn't touch the global
+// filesystem state so it is safe to call from any thread.
+static std::string ReadPakFile(pakType_t type, Str::StringRef pakPath, int fd, Str::StringRef name, offset_t offset, std::error_code& err)
 {
-	auto it = fileMap.find(path);
-	if (it == fileMap.end()) {
-		SetErrorCodeFilesystem(err, filesystem_error::no_such_file, path);
-		return "";
-	}
-
-	const LoadedPakInfo& pak = loadedPaks[it->second.first];
-	if (pak.type == pakType_t::PAK_DIR) {
+	if (type == pakType_t::PAK_DIR) {
 		// Open file
-		File file = RawPath::OpenRead(Path::Build(pak.path, it->first), err);
+		File file = RawPath::OpenRead(Path::Build(pakPath, name), err);
 		if (err)
 			return "";
 
@@ -1577,14 +2069,14 @@ std::string ReadFile(Str::StringRef path, std::error_code& err)
 		out.resize(length);
 		file.Read(&out[0], length, err);
 		return out;
-	} else if (pak.type == pakType_t::PAK_ZIP) {
+	} else if (type == pakType_t::PAK_ZIP) {
 		// Open zip
-		ZipArchive zipFile = ZipArchive::Open(pak.fd, err);
+		ZipArchive zipFile = ZipArchive::Open(fd, err);
 		if (err)
 			return "";
 
 		// Open file in zip
-		offset_t length = zipFile.OpenFileWithSymlinkResolution(it->first, it->second.second, err);
+		offset_t length = zipFile.OpenFileWithSymlinkResolution(name, offset, err);
 		if (err)
 			return "";
 
@@ -1606,6 +2098,51 @@ std::string ReadFile(Str::StringRef path, std::error_code& err)
 	ASSERT_UNREACHABLE();
 }
 
+
+std::string ReadFile(Str::StringRef path, std::error_code& err)
+{
+	auto it = fileMap.find(path);
+	if (it == fileMap.end()) {
+		SetErrorCodeFilesystem(err, filesystem_error::no_such_file, path);
+		return "";
+	}
+
+	const LoadedPakInfo& pak = loadedPaks[it->second.first];
+	return ReadPakFile(pak.type, pak.path, pak.fd, it->first, it->second.second, err);
+}
+
+std::future<std::string> PrefetchFile(Str::StringRef path)
+{
+	auto it = fileMap.find(path);
+	if (it == fileMap.end()) {
+		std::promise<std::string> result;
+		result.set_exception(std::make_exception_ptr(filesystem_exception(filesystem_error::no_such_file, path)));
+		return result.get_future();
+	}
+
+	// Copy the location of the file so that the read doesn't depend on the
+	// global state. The fd is duplicated since ClearPaks may close the pak
+	// before the read is done.
+	const LoadedPakInfo& pak = loadedPaks[it->second.first];
+	pakType_t type = pak.type;
+	std::string pakPath = pak.path;
+	std::string name = it->first;
+	offset_t offset = it->second.second;
+	auto fd = std::make_shared<PakFd>(pak.fd == -1 ? -1 : dup(pak.fd));
+	return readPool.Submit([type, pakPath, fd, name, offset] {
+		return ReadPakFile(type, pakPath, fd->Get(), name, offset, throws());
+	});
+}
+
+std::vector<std::future<std::string>> PrefetchFiles(const std::vector<std::string>& paths)
+{
+	std::vector<std::future<std::string>> results;
+	results.reserve(paths.size());
+	for (const std::string& path: paths)
+		results.push_back(PrefetchFile(path));
+	return results;
+}
+
 // Note: Does not handle symlinks.
 void CopyFile(Str::StringRef path, const File& dest, std::error_code& err)
 {
@@ -1663,31 +2200,31 @@ void CopyFile(Str::StringRef path, const File& dest, std::error_code& err)
 
 bool FileExists(Str::StringRef path)
 {
-	return fileMap.find(path) != fileMap.end();
+	return !!FindFile(path);
 }
 
 const LoadedPakInfo* LocateFile(Str::StringRef path)
 {
-	auto it = fileMap.find(path);
-	if (it == fileMap.end())
+	auto file = FindFile(path);
+	if (!file)
 		return nullptr;
 	else
-		return &loadedPaks[it->second.first];
+		return &loadedPaks[file->pakIndex];
 }
 
 std::chrono::system_clock::time_point FileTimestamp(Str::StringRef path, std::error_code& err)
 {
-	auto it = fileMap.find(path);
-	if (it == fileMap.end()) {
+	auto file = FindFile(path);
+	if (!file) {
 		SetErrorCodeFilesystem(err, filesystem_error::no_such_file, path);
 		return {};
 	}
 
-	const LoadedPakInfo& pak = loadedPaks[it->second.first];
+	const LoadedPakInfo& pak = loadedPaks[file->pakIndex];
 	if (pak.type == pakType_t::PAK_DIR) {
 #ifdef BUILD_VM
 		Util::optional<uint64_t> result;
-		VM::SendMsg<VM::FSPakPathTimestampMsg>(it->second.first, it->first, result);
+		VM::SendMsg<VM::FSPakPathTimestampMsg>(file->pakIndex, file->name, result);
 		if (result) {
 			ClearErrorCode(err);
 			return std::chrono::system_clock::from_time_t(*result);
@@ -1696,7 +2233,7 @@ std::chrono::system_clock::time_point FileTimestamp(Str::StringRef path, std::er
 			return {};
 		}
 #else
-		return RawPath::FileTimestamp(Path::Build(pak.path, it->first), err);
+		return RawPath::FileTimestamp(Path::Build(pak.path, file->name), err);
 #endif
 	} else if (pak.type == pakType_t::PAK_ZIP) {
 		return pak.timestamp;
@@ -1707,19 +2244,23 @@ std::chrono::system_clock::time_point FileTimestamp(Str::StringRef path, std::er
 
 bool DirectoryRange::InternalAdvance()
 {
-	for (; iter != iter_end; ++iter) {
-		// Filter out any paths not in the specified directory
-		if (!Str::IsPrefix(prefix, iter->first))
-			continue;
+	while (pos != endPos) {
+		Str::StringRef path = fileIndex[pos].name;
 
-		// Don't look down subdirectories when not doing a recursive search
+		// Skip over the contents of subdirectories when not doing a recursive
+		// search. All the paths in a subdirectory "a/b/" sort before "a/b0".
 		if (!recursive) {
-			auto p = std::find(iter->first.begin() + prefix.size(), iter->first.end(), '/');
-			if (p != iter->first.end())
+			size_t slash = path.find('/', prefix.size());
+			if (slash != Str::StringRef::npos) {
+				std::string subdirEnd(path.data(), slash);
+				subdirEnd.push_back('/' + 1);
+				FileIndexEntry key = {subdirEnd, 0, 0};
+				pos = std::lower_bound(fileIndex.begin() + pos, fileIndex.begin() + endPos, key, FileIndexLess) - fileIndex.begin();
 				continue;
+			}
 		}
 
-		current = iter->first.substr(prefix.size());
+		current = path.substr(prefix.size());
 		return true;
 	}
 
@@ -1728,34 +2269,41 @@ bool DirectoryRange::InternalAdvance()
 
 bool DirectoryRange::Advance(std::error_code& err)
 {
-	++iter;
+	++pos;
 	ClearErrorCode(err);
 	return InternalAdvance();
 }
 
+// Select the range of the index containing the paths in the given directory
+void DirectoryRange::Init(Str::StringRef path, bool recursive_)
+{
+	recursive = recursive_;
+	prefix = path;
+	if (prefix.empty()) {
+		pos = 0;
+		endPos = fileIndex.size();
+	} else {
+		if (prefix.back() != '/')
+			prefix.push_back('/');
+		std::string prefixEnd = prefix;
+		prefixEnd.back() = '/' + 1;
+		pos = std::lower_bound(fileIndex.begin(), fileIndex.end(), FileIndexEntry{prefix, 0, 0}, FileIndexLess) - fileIndex.begin();
+		endPos = std::lower_bound(fileIndex.begin(), fileIndex.end(), FileIndexEntry{prefixEnd, 0, 0}, FileIndexLess) - fileIndex.begin();
+	}
+	InternalAdvance();
+}
+
 DirectoryRange ListFiles(Str::StringRef path)
 {
 	DirectoryRange state;
-	state.recursive = false;
-	state.prefix = path;
-	if (!state.prefix.empty() && state.prefix.back() != '/')
-		state.prefix.push_back('/');
-	state.iter = fileMap.begin();
-	state.iter_end = fileMap.end();
-	state.InternalAdvance();
+	state.Init(path, false);
 	return state;
 }
 
 DirectoryRange ListFilesRecursive(Str::StringRef path)
 {
 	DirectoryRange state;
-	state.recursive = true;
-	state.prefix = path;
-	if (!state.prefix.empty() && state.prefix.back() != '/')
-		state.prefix.push_back('/');
-	state.iter = fileMap.begin();
-	state.iter_end = fileMap.end();
-	state.InternalAdvance();
+	state.Init(path, true);
 	return state;
 }
 
@@ -2207,6 +2755,36 @@ void DeleteFile(Str::StringRef path, std::error_code& err)
 #endif
 }
 
+#ifndef BUILD_VM
+void WriteFileAtomic(Str::StringRef path, Str::StringRef data, std::error_code& err)
+{
+	// The process id and a sequence number keep the temporary name unique
+	// among all the threads and processes sharing the home path.
+	static std::atomic<unsigned> tempSequence{0};
+#ifdef _WIN32
+	unsigned long pid = GetCurrentProcessId();
+#else
+	unsigned long pid = getpid();
+#endif
+	std::string tempPath = Str::Format("%s.%d-%d.tmp", path, pid, tempSequence++);
+
+	std::error_code ec;
+	File file = OpenWrite(tempPath, ec);
+	if (!ec)
+		file.Write(data.data(), data.size(), ec);
+	if (!ec)
+		file.Close(ec);
+	if (!ec)
+		MoveFile(path, tempPath, ec);
+	if (ec) {
+		std::error_code ignored;
+		DeleteFile(tempPath, ignored);
+		SetErrorCode(err, ec.value(), ec.category());
+	} else
+		ClearErrorCode(err);
+}
+#endif
+
 DirectoryRange ListFiles(Str::StringRef path, std::error_code& err)
 {
 #ifdef BUILD_VM
@@ -2399,7 +2977,16 @@ void Initialize()
 			close(x.fd);
 	}
 
-	VM::SendMsg<VM::FSInitializeMsg>(homePath, libPath, availablePaks, PakPath::loadedPaks, PakPath::fileMap);
+	bool sharedFileTable = false;
+	Cvar::ParseCvarValue(Cvar::GetValue("fs_sharedFileTable"), sharedFileTable);
+	if (sharedFileTable) {
+		IPC::SharedMemory fileTable;
+		VM::SendMsg<VM::FSInitializeSharedMsg>(homePath, libPath, availablePaks, PakPath::loadedPaks, fileTable);
+		PakPath::ReadFileTable(std::move(fileTable));
+	} else {
+		VM::SendMsg<VM::FSInitializeMsg>(homePath, libPath, availablePaks, PakPath::loadedPaks, PakPath::fileMap);
+		PakPath::IndexFileMap();
+	}
 }
 #else
 // Get an absolute path from a relative one. This may fail if the path does not
@@ -2534,25 +3121,30 @@ static void AddPak(pakType_t type, Str::StringRef filename, Str::StringRef baseP
 	availablePaks.push_back({std::move(name), std::move(version), checksum, type, std::move(fullPath)});
 }
 
-// Find all paks in the given path
-static void FindPaksInPath(Str::StringRef basePath, Str::StringRef subPath)
+// A file found while searching for paks, along with the type of pak it is
+struct FoundPakFile {
+	std::string filename;
+	Util::optional<pakType_t> type;
+};
+
+// Find all paks in the given path. This is safe to call from any thread.
+static void FindPaksInPath(Str::StringRef basePath, Str::StringRef subPath, bool useLegacyPaks, std::vector<FoundPakFile>& found)
 {
 	std::string fullPath = Path::Build(basePath, subPath);
-	bool useLegacyPaks = UseLegacyPaks();
 	try {
 		for (auto& filename: RawPath::ListFiles(fullPath)) {
 			if (Str::IsSuffix(PAK_ZIP_EXT, filename)) {
-				AddPak(pakType_t::PAK_ZIP, Path::Build(subPath, filename), basePath);
+				found.push_back({Path::Build(subPath, filename), pakType_t::PAK_ZIP});
 			} else if (Str::IsSuffix(PAK_DIR_EXT, filename)) {
-				AddPak(pakType_t::PAK_DIR, Path::Build(subPath, filename), basePath);
+				found.push_back({Path::Build(subPath, filename), pakType_t::PAK_DIR});
 			} else if (useLegacyPaks && Str::IsSuffix(LEGACY_PAK_ZIP_EXT, filename)) {
-				AddPak(pakType_t::PAK_ZIP, Path::Build(subPath, filename), basePath);
+				found.push_back({Path::Build(subPath, filename), pakType_t::PAK_ZIP});
 			} else if (useLegacyPaks && Str::IsSuffix(LEGACY_PAK_DIR_EXT, filename)) {
-				AddPak(pakType_t::PAK_DIR, Path::Build(subPath, filename), basePath);
+				found.push_back({Path::Build(subPath, filename), pakType_t::PAK_DIR});
 			} else if (Str::IsSuffix("/", filename)) {
-				FindPaksInPath(basePath, Path::Build(subPath, filename));
+				FindPaksInPath(basePath, Path::Build(subPath, filename), useLegacyPaks, found);
 			} else {
-				fsLogs.Verbose("Ignoring file: %s", filename);
+				found.push_back({filename, Util::nullopt});
 			}
 		}
 	} catch (std::system_error&) {
@@ -2624,9 +3216,27 @@ static int VersionCmp(Str::StringRef aStr, Str::StringRef bStr)
 #ifndef BUILD_VM
 void RefreshPaks()
 {
+	// Search all the pak paths in parallel, but add the paks in the order of
+	// the search paths.
+	bool useLegacyPaks = UseLegacyPaks();
+	std::vector<std::future<std::vector<FoundPakFile>>> searches;
+	for (const std::string& path: pakPaths) {
+		searches.push_back(workerPool.Submit([path, useLegacyPaks] {
+			std::vector<FoundPakFile> found;
+			FindPaksInPath(path, "", useLegacyPaks, found);
+			return found;
+		}));
+	}
+
 	availablePaks.clear();
-	for (auto& path: pakPaths)
-		FindPaksInPath(path, "");
+	for (size_t i = 0; i < pakPaths.size(); i++) {
+		for (const FoundPakFile& file: searches[i].get()) {
+			if (file.type)
+				AddPak(*file.type, file.filename, pakPaths[i]);
+			else
+				fsLogs.Verbose("Ignoring file: %s", file.filename);
+		}
+	}
 
 	// Sort the pak list for easy binary searching:
 	// First sort by name, then by version.
@@ -2899,6 +3509,16 @@ void HandleFileSystemSyscall(int minor, Util::Reader& reader, IPC::Channel& chan
 		});
 		break;
 
+	case VM::FS_INITIALIZE_SHARED:
+		IPC::HandleMsg<VM::FSInitializeSharedMsg>(channel, std::move(reader), [](std::string& homePath, std::string& libPath, std::vector<FS::PakInfo>& availablePaks, std::vector<FS::LoadedPakInfo>& loadedPaks, IPC::SharedMemory& fileTable) {
+			homePath = GetHomePath();
+			libPath = GetLibPath();
+			availablePaks = GetAvailablePaks();
+			loadedPaks = PakPath::loadedPaks;
+			fileTable = PakPath::CreateFileTable();
+		});
+		break;
+
 	case VM::FS_HOMEPATH_FILEEXISTS:
 		IPC::HandleMsg<VM::FSHomePathFileExistsMsg>(channel, std::move(reader), [](std::string path, bool& out) {
 			out = HomePath::FileExists(Path::Build("game", path));
@@ -34,6 +34,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Command.h"
 
 #ifdef BUILD_ENGINE
+#include <future>
 #include "IPC/Channel.h"
 #endif
 
@@ -340,6 +341,15 @@ namespace PakPath {
 	// Read an entire file into a string
 	std::string ReadFile(Str::StringRef path, std::error_code& err = throws());
 
+#ifdef BUILD_ENGINE
+	// Start reading files on the I/O threads, for example the files a map is
+	// about to need, so that they are read and decompressed while the caller
+	// does other work. The futures hold the file contents in the same order as
+	// the paths, get() throws the errors that ReadFile would report.
+	std::future<std::string> PrefetchFile(Str::StringRef path);
+	std::vector<std::future<std::string>> PrefetchFiles(const std::vector<std::string>& paths);
+#endif
+
 	// Copy an entire file to another file
 	void CopyFile(Str::StringRef path, const File& dest, std::error_code& err = throws());
 
@@ -355,6 +365,7 @@ namespace PakPath {
 
 	// List all files in the given subdirectory, optionally recursing into subdirectories
 	// Note that unlike RawPath/HomePath, directories are *not* returned by ListFiles
+	// Files are returned in case-insensitive sorted order.
 	class DirectoryRange;
 	DirectoryRange ListFiles(Str::StringRef path);
 	DirectoryRange ListFilesRecursive(Str::StringRef path);
@@ -376,18 +387,19 @@ namespace PakPath {
 		}
 		bool empty() const
 		{
-			return iter == iter_end;
+			return pos == endPos;
 		}
 
 	private:
 		friend class DirectoryIterator<DirectoryRange>;
 		friend DirectoryRange ListFiles(Str::StringRef path);
 		friend DirectoryRange ListFilesRecursive(Str::StringRef path);
+		void Init(Str::StringRef path, bool recursive_);
 		bool Advance(std::error_code& err);
 		bool InternalAdvance();
 		std::string current;
 		std::string prefix;
-		std::unordered_map<std::string, std::pair<uint32_t, offset_t>>::iterator iter, iter_end;
+		size_t pos, endPos;
 		bool recursive;
 	};
 
@@ -496,6 +508,12 @@ namespace HomePath {
 	void MoveFile(Str::StringRef dest, Str::StringRef src, std::error_code& err = throws());
 	void DeleteFile(Str::StringRef path, std::error_code& err = throws());
 
+#ifndef BUILD_VM
+	// Write a whole file through a uniquely named temporary file which is then
+	// renamed over the destination, so that a partial file is never seen
+	void WriteFileAtomic(Str::StringRef path, Str::StringRef data, std::error_code& err = throws());
+#endif
+
 	// List all files in the given subdirectory, optionally recursing into subdirectories
 	// Directory names are returned with a trailing slash to differentiate them from files
 #ifdef BUILD_VM
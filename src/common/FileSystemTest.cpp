@@ -62,5 +62,59 @@ namespace {
         ASSERT_EQ(contents, "test2");
     }
 
+    TEST_F(FileSystemTest, ListFilesSorted)
+    {
+        std::vector<std::string> files;
+        for (const std::string& file : PakPath::ListFiles(""))
+            files.push_back(file);
+        EXPECT_THAT(files, testing::IsSupersetOf({"TEst1.txt", "tesT2.txt"}));
+        EXPECT_THAT(files, testing::Not(testing::Contains("maps/plat23_1.13.4.bsp")));
+        EXPECT_TRUE(std::is_sorted(files.begin(), files.end(), Str::ILess()));
+    }
+
+    TEST_F(FileSystemTest, ListFilesSubdirectory)
+    {
+        std::vector<std::string> files;
+        for (const std::string& file : PakPath::ListFiles("MAPS"))
+            files.push_back(file);
+        EXPECT_THAT(files, testing::ElementsAre("plat23_1.13.4.bsp"));
+
+        files.clear();
+        for (const std::string& file : PakPath::ListFilesRecursive(""))
+            files.push_back(file);
+        EXPECT_THAT(files, testing::Contains("maps/plat23_1.13.4.bsp"));
+        EXPECT_TRUE(std::is_sorted(files.begin(), files.end(), Str::ILess()));
+    }
+
+    TEST_F(FileSystemTest, PrefetchFiles)
+    {
+        auto results = PakPath::PrefetchFiles({"Test1.txt", "TEST2.TXT", "missing.txt"});
+        ASSERT_EQ(results.size(), 3u);
+        EXPECT_EQ(results[0].get(), "test1");
+        EXPECT_EQ(results[1].get(), "test2");
+        EXPECT_THROW(results[2].get(), std::system_error);
+    }
+
+    TEST_F(FileSystemTest, PakIndexCacheWritten)
+    {
+        std::vector<std::string> files;
+        for (const std::string& file : HomePath::ListFiles("pakindex"))
+            files.push_back(file);
+        EXPECT_THAT(files, testing::Contains(testing::EndsWith(".idx")));
+        EXPECT_THAT(files, testing::Not(testing::Contains(testing::EndsWith(".tmp"))));
+    }
+
+    TEST_F(FileSystemTest, WriteFileAtomicReplaces)
+    {
+        HomePath::WriteFileAtomic("atomictest/file.txt", "first");
+        HomePath::WriteFileAtomic("atomictest/file.txt", std::string("second\0", 7));
+        EXPECT_EQ(HomePath::OpenRead("atomictest/file.txt").ReadAll(), std::string("second\0", 7));
+
+        std::vector<std::string> files;
+        for (const std::string& file : HomePath::ListFiles("atomictest"))
+            files.push_back(file);
+        EXPECT_THAT(files, testing::ElementsAre("file.txt"));
+    }
+
 } // namespace
 } // namespace FS
@@ -261,13 +261,20 @@ namespace VM {
         FS_HOMEPATH_LISTFILES,
         FS_HOMEPATH_LISTFILESRECURSIVE,
         FS_PAKPATH_TIMESTAMP,
-        FS_PAKPATH_LOADPAK
+        FS_PAKPATH_LOADPAK,
+        FS_INITIALIZE_SHARED
     };
 
     using FSInitializeMsg = IPC::SyncMessage<
         IPC::Message<IPC::Id<FILESYSTEM, FS_INITIALIZE>>,
         IPC::Reply<std::string, std::string, std::vector<FS::PakInfo>, std::vector<FS::LoadedPakInfo>, std::unordered_map<std::string, std::pair<uint32_t, FS::offset_t>, Str::IHash, Str::IEqual>>
     >;
+    // Same as FSInitializeMsg but the loaded files are sent as a sorted table
+    // in shared memory. Only sent if the engine sets fs_sharedFileTable.
+    using FSInitializeSharedMsg = IPC::SyncMessage<
+        IPC::Message<IPC::Id<FILESYSTEM, FS_INITIALIZE_SHARED>>,
+        IPC::Reply<std::string, std::string, std::vector<FS::PakInfo>, std::vector<FS::LoadedPakInfo>, IPC::SharedMemory>
+    >;
     using FSHomePathFileExistsMsg = IPC::SyncMessage<
         IPC::Message<IPC::Id<FILESYSTEM, FS_HOMEPATH_FILEEXISTS>, std::string>,
         IPC::Reply<bool>
@@ -299,7 +299,7 @@ namespace Str {
     int LongestIPrefixSize(Str::StringRef text1, Str::StringRef text2);
     bool IsIEqual(Str::StringRef text1, Str::StringRef text2);
 
-    // Case insensitive Hash and Equal functions for maps
+    // Case insensitive Hash, Equal and Less functions for maps
     struct IHash {
         size_t operator()(Str::StringRef str) const
         {
@@ -318,6 +318,14 @@ namespace Str {
             return true;
         }
     };
+    struct ILess {
+        bool operator()(Str::StringRef a, Str::StringRef b) const
+        {
+            return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+                return static_cast<unsigned char>(ctolower(x)) < static_cast<unsigned char>(ctolower(y));
+            });
+        }
+    };
 
     std::u32string UTF8To32(Str::StringRef str);
     std::string UTF32To8(Str::BasicStringRef<char32_t> str);
@@ -151,6 +151,9 @@ struct refexport_t {
 	// XreaL BEGIN
 	void ( *TakeVideoFrame )( int h, int w, byte* captureBuffer, byte* encodeBuffer, bool motionJpeg );
 
+	// encodes bottom-up RGB pixels, safe to call from any thread
+	int ( *SaveJPGToBuffer )( byte* buffer, size_t bufferSize, int quality, int width, int height, byte* pixels );
+
 	// RB: alternative skeletal animation system
 	qhandle_t( *RegisterAnimation )( const char* name );
 	int ( *CheckSkeleton )( refSkeleton_t* skel, qhandle_t model, qhandle_t anim );
@@ -215,6 +218,7 @@ struct refimport_t {
 
 	// XreaL BEGIN
 	int ( *CL_VideoRecording )( );
+	// packed RGB rows with motion JPEG, else padded BGR rows ready to be written
 	void ( *CL_WriteAVIVideoFrame )( const byte* buffer, int size );
 	// XreaL END
 
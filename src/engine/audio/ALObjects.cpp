@@ -696,6 +696,11 @@ namespace AL {
         CHECK_AL_ERROR();
     }
 
+    void Source::SetSecondOffset(float offset) {
+        alSourcef(alHandle, AL_SEC_OFFSET, offset);
+        CHECK_AL_ERROR();
+    }
+
     void Source::SetRolloff(float factor) {
         alSourcef(alHandle, AL_ROLLOFF_FACTOR, factor);
         CHECK_AL_ERROR();
@@ -199,6 +199,8 @@ namespace AL {
             void SetPosition(Vec3 position);
             void SetVelocity(Vec3 velocity);
             void SetLooping(bool loop);
+            // Moves the playback position, in seconds from the start of the buffer
+            void SetSecondOffset(float offset);
             void SetRolloff(float factor);
             void SetReferenceDistance(float distance);
             void SetRelative(bool relative);
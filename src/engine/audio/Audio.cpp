@@ -273,6 +273,7 @@ namespace Audio {
         UpdateListenerGain();
 
         // Update the rest of the system
+        UpdateSamples();
         CaptureTestUpdate();
         UpdateEmitters();
         UpdateSounds();
@@ -321,12 +322,17 @@ namespace Audio {
         EndSampleRegistration();
     }
 
+    // Samples registered during the registration can't be played until they are loaded.
+    static bool IsPlayableHandle( sfxHandle_t sfx ) {
+        return Sample::IsValidHandle( sfx ) and Sample::FromHandle( sfx )->IsLoaded();
+    }
+
     static int GetSoundPriorityForEntity( const int entityNum ) {
         return entityNum < MAX_CLIENTS ? CLIENT : ANY;
     }
 
     void StartSound(int entityNum, Vec3 origin, sfxHandle_t sfx) {
-        if (not initialized or not Sample::IsValidHandle(sfx)) {
+        if (not initialized or not IsPlayableHandle(sfx)) {
             return;
         }
 
@@ -347,7 +353,7 @@ namespace Audio {
     }
 
     void StartLocalSound(sfxHandle_t sfx) {
-        if (not initialized or not Sample::IsValidHandle(sfx)) {
+        if (not initialized or not IsPlayableHandle(sfx)) {
             return;
         }
 
@@ -355,7 +361,7 @@ namespace Audio {
     }
 
     void AddEntityLoopingSound(int entityNum, sfxHandle_t sfx, bool persistent) {
-        if (not initialized or not Sample::IsValidHandle(sfx) or not IsValidEntity(entityNum)) {
+        if (not initialized or not IsPlayableHandle(sfx) or not IsValidEntity(entityNum)) {
             return;
         }
 
@@ -402,9 +408,11 @@ namespace Audio {
         std::shared_ptr<Sample> loopingSample = nullptr;
         if (not leadingSound.empty()) {
             leadingSample = RegisterSample(leadingSound);
+            WaitForSample(leadingSample);
         }
         if (not loopSound.empty()) {
             loopingSample = RegisterSample(loopSound);
+            WaitForSample(loopingSample);
         }
 
         StopMusic();
@@ -46,8 +46,9 @@ namespace Audio {
      * - Sound that controls the raw sound shape emitted by a sound emitter (e.g. a looping sound, ...)
      *
      * In term of ownership, Samples are owned by the hashmap filename <-> Samples, OpenAL sources
-     * are allocated in an array in Sound and each source can have at most one sound. Each sound has one
-     * Emitter (they are ref counted).
+     * are allocated in an array in Sound and each source can have at most one sound. Sounds without a
+     * source are virtual: they keep playing silently until they are audible enough to get one back.
+     * Each sound has one Emitter (they are ref counted).
      */
 
     // Somewhere on the Internet we can see "quake3 is like the old wolfenstein, 64 units = 8 feet"
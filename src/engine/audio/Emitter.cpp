@@ -277,6 +277,10 @@ namespace Audio {
         UpdateSound(sound);
     }
 
+    bool Emitter::IsLocal() const {
+        return false;
+    }
+
     // Implementation of EntityEmitter
 
     EntityEmitter::EntityEmitter(int entityNum): entityNum(entityNum) {
@@ -308,6 +312,10 @@ namespace Audio {
         return entities[entityNum].position;
     }
 
+    bool EntityEmitter::IsLocal() const {
+        return entityNum == listenerEntity;
+    }
+
     // Implementation of PositionEmitter
 
     PositionEmitter::PositionEmitter(Vec3 position){
@@ -358,6 +366,10 @@ namespace Audio {
         return Vec3 {};
     }
 
+    bool LocalEmitter::IsLocal() const {
+        return true;
+    }
+
     class TestReverbCmd : public Cmd::StaticCmd {
         public:
             TestReverbCmd(): StaticCmd("testReverb", Cmd::AUDIO, "Tests a reverb preset.") {
@@ -71,6 +71,8 @@ namespace Audio {
             virtual void InternalSetupSound(Sound& sound) = 0;
 
             virtual Vec3 GetPosition() const = 0;
+            // Whether the sounds are played at the listener's position
+            virtual bool IsLocal() const;
     };
 
     // An Emitter that will follow an entity
@@ -84,6 +86,7 @@ namespace Audio {
             virtual void InternalSetupSound(Sound& sound) override;
 
             Vec3 GetPosition() const override;
+            bool IsLocal() const override;
 
         private:
             int entityNum;
@@ -116,6 +119,7 @@ namespace Audio {
             virtual void InternalSetupSound(Sound& sound) override;
 
             Vec3 GetPosition() const override;
+            bool IsLocal() const override;
     };
 
 }
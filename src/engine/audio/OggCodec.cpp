@@ -109,33 +109,139 @@ size_t OggCallbackRead(void* ptr, size_t size, size_t count, void* datasource)
 }
 
 
-const ov_callbacks Ogg_Callbacks = {&OggCallbackRead, nullptr, nullptr, nullptr};
+/*
+ *Replacement for the seek_func, needed to rewind streamed sounds
+ *Returns 0 on success and -1 if the position is out of the file.
+ */
+int OggCallbackSeek(void* datasource, ogg_int64_t offset, int whence)
+{
+	OggDataSource* data = static_cast<OggDataSource*>(datasource);
 
-AudioData LoadOggCodec(std::string filename)
+	ogg_int64_t position;
+	switch (whence) {
+		case SEEK_SET:
+			position = offset;
+			break;
+		case SEEK_CUR:
+			position = data->position + offset;
+			break;
+		case SEEK_END:
+			position = data->audioFile->size() + offset;
+			break;
+		default:
+			return -1;
+	}
+
+	if (position < 0 || position > static_cast<ogg_int64_t>(data->audioFile->size())) {
+		return -1;
+	}
+
+	data->position = position;
+	return 0;
+}
+
+/*
+ *Replacement for the tell_func
+ *Returns the current position in the file.
+ */
+long OggCallbackTell(void* datasource)
+{
+	return static_cast<OggDataSource*>(datasource)->position;
+}
+
+const ov_callbacks Ogg_Callbacks = {&OggCallbackRead, &OggCallbackSeek, nullptr, &OggCallbackTell};
+
+class OggStream : public AudioStream {
+	public:
+		// Takes ownership of a vorbis file opened on the data source.
+		OggStream(std::unique_ptr<std::string> audioFile, std::unique_ptr<OggDataSource> dataSource,
+		          std::unique_ptr<OggVorbis_File> vorbisFile, int sampleRate, int numberOfChannels)
+			: AudioStream(sampleRate, sampleWidth, numberOfChannels)
+			, audioFile(std::move(audioFile))
+			, dataSource(std::move(dataSource))
+			, vorbisFile(std::move(vorbisFile))
+		{}
+
+		~OggStream() override
+		{
+			ov_clear(vorbisFile.get());
+		}
+
+		AudioData Read(size_t maxBytes) override
+		{
+			AudioData out { sampleRate, byteDepth, numberOfChannels };
+			out.rawSamples.resize(maxBytes);
+
+			size_t bytesDecoded = 0;
+			int bitStream = 0;
+
+			while (bytesDecoded < maxBytes) {
+				long bytesRead = ov_read(vorbisFile.get(), out.rawSamples.data() + bytesDecoded,
+				                         maxBytes - bytesDecoded, 0, sampleWidth, 1, &bitStream);
+
+				if (bytesRead <= 0) {
+					break;
+				}
+
+				bytesDecoded += bytesRead;
+			}
+
+			out.rawSamples.resize(bytesDecoded);
+			return out;
+		}
+
+		bool Rewind() override
+		{
+			return ov_pcm_seek(vorbisFile.get(), 0) == 0;
+		}
+
+		bool Seek(double seconds) override
+		{
+			return ov_pcm_seek(vorbisFile.get(), static_cast<ogg_int64_t>(seconds * sampleRate)) == 0;
+		}
+
+		size_t DecodedSize() override
+		{
+			ogg_int64_t samples = ov_pcm_total(vorbisFile.get(), -1);
+
+			return samples > 0 ? samples * numberOfChannels * sampleWidth : 0;
+		}
+
+		static constexpr int sampleWidth = 2;
+
+	private:
+		std::unique_ptr<std::string> audioFile;
+		std::unique_ptr<OggDataSource> dataSource;
+		std::unique_ptr<OggVorbis_File> vorbisFile;
+};
+
+constexpr int OggStream::sampleWidth;
+
+std::unique_ptr<AudioStream> OpenOggStream(std::string filename)
 {
-	std::string audioFile;
+	std::unique_ptr<std::string> audioFile(new std::string);
 	try
 	{
-		audioFile = FS::PakPath::ReadFile(filename);
+		*audioFile = FS::PakPath::ReadFile(filename);
 	}
 	catch (std::system_error& err)
 	{
 		audioLogs.Warn("Failed to open %s: %s", filename, err.what());
-		return AudioData();
+		return nullptr;
 	}
-	OggDataSource dataSource = {&audioFile, 0};
+	std::unique_ptr<OggDataSource> dataSource(new OggDataSource{audioFile.get(), 0});
 	std::unique_ptr<OggVorbis_File> vorbisFile(new OggVorbis_File);
 
-	if (ov_open_callbacks(&dataSource, vorbisFile.get(), nullptr, 0, Ogg_Callbacks) != 0) {
+	if (ov_open_callbacks(dataSource.get(), vorbisFile.get(), nullptr, 0, Ogg_Callbacks) != 0) {
         audioLogs.Warn("Error while reading %s", filename);
 		ov_clear(vorbisFile.get());
-		return AudioData();
+		return nullptr;
 	}
 
 	if (ov_streams(vorbisFile.get()) != 1) {
 		audioLogs.Warn("Unsupported number of streams in %s.", filename);
 		ov_clear(vorbisFile.get());
-		return AudioData();
+		return nullptr;
 	}
 
 	vorbis_info* oggInfo = ov_info(vorbisFile.get(), 0);
@@ -143,50 +249,25 @@ AudioData LoadOggCodec(std::string filename)
 	if (!oggInfo) {
         audioLogs.Warn("Could not read vorbis_info in %s.", filename);
 		ov_clear(vorbisFile.get());
-		return AudioData();
+		return nullptr;
 	}
 
-	const int sampleWidth = 2;
-
 	int sampleRate = oggInfo->rate;
 	int numberOfChannels = oggInfo->channels;
 
-	/* The largest ogg file we have so far is res-soundtrack/sound/ui/heartbeat.ogg
-	It uncompress to ~47mb. Use 64mb here just in case */
-	static constexpr uint32_t MAX_USED_FILE_SIZE = 64 * 1024 * 1024;
-	static constexpr uint32_t MAX_READ_SIZE      =  1 * 1024 * 1024;
-
-	char* buffer = ( char* ) Hunk_AllocateTempMemory( MAX_USED_FILE_SIZE );
-	uint32_t bufferPointer = 0;
-	uint32_t rawSamplesPointer = 0;
-
-	int bytesRead = 0;
-	int bitStream = 0;
-
-	AudioData out { sampleRate, sampleWidth, numberOfChannels };
-
-	while ((bytesRead = ov_read(vorbisFile.get(), buffer + bufferPointer, MAX_READ_SIZE, 0, sampleWidth, 1, &bitStream)) > 0) {
-		bufferPointer += bytesRead;
-
-		if ( MAX_USED_FILE_SIZE - bufferPointer < MAX_READ_SIZE ) {
-			out.rawSamples.resize( out.rawSamples.size() + bufferPointer );
-			std::copy_n( buffer, bufferPointer, out.rawSamples.data() + rawSamplesPointer );
+	return std::unique_ptr<AudioStream>(new OggStream(std::move(audioFile), std::move(dataSource),
+	                                                  std::move(vorbisFile), sampleRate, numberOfChannels));
+}
 
-			rawSamplesPointer += bufferPointer;
-			bufferPointer = 0;
-		}
-	}
+AudioData LoadOggCodec(std::string filename)
+{
+	std::unique_ptr<AudioStream> stream = OpenOggStream(filename);
 
-	if ( bufferPointer ) {
-		out.rawSamples.resize( out.rawSamples.size() + bufferPointer );
-		std::copy_n( buffer, bufferPointer, out.rawSamples.data() + rawSamplesPointer );
+	if (!stream) {
+		return AudioData();
 	}
 
-	Hunk_FreeTempMemory( buffer );
-
-	ov_clear(vorbisFile.get());
-
-	return out;
+	return stream->ReadAll();
 }
 
 } //namespace Audio
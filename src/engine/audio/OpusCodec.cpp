@@ -97,27 +97,139 @@ int OpusCallbackRead(void* dataSource, unsigned char* ptr, int nBytes)
     return bytesToRead;
 }
 
-const OpusFileCallbacks Opus_Callbacks = {&OpusCallbackRead, nullptr, nullptr, nullptr};
+/*
+ *Replacement for the op_seek_func, needed to rewind streamed sounds
+ *Returns 0 on success and -1 if the position is out of the file.
+ */
+int OpusCallbackSeek(void* dataSource, opus_int64 offset, int whence)
+{
+	OpusDataSource* data = static_cast<OpusDataSource*>(dataSource);
 
-AudioData LoadOpusCodec(std::string filename)
+	opus_int64 position;
+	switch (whence) {
+		case SEEK_SET:
+			position = offset;
+			break;
+		case SEEK_CUR:
+			position = data->position + offset;
+			break;
+		case SEEK_END:
+			position = data->audioFile->size() + offset;
+			break;
+		default:
+			return -1;
+	}
+
+	if (position < 0 || position > static_cast<opus_int64>(data->audioFile->size())) {
+		return -1;
+	}
+
+	data->position = position;
+	return 0;
+}
+
+/*
+ *Replacement for the op_tell_func
+ *Returns the current position in the file.
+ */
+opus_int64 OpusCallbackTell(void* dataSource)
 {
-	std::string audioFile;
+	return static_cast<OpusDataSource*>(dataSource)->position;
+}
+
+const OpusFileCallbacks Opus_Callbacks = {&OpusCallbackRead, &OpusCallbackSeek, &OpusCallbackTell, nullptr};
+
+class OpusStream : public AudioStream {
+	public:
+		// Takes ownership of an opus file opened on the data source.
+		OpusStream(std::unique_ptr<std::string> audioFile, std::unique_ptr<OpusDataSource> dataSource,
+		           OggOpusFile* opusFile, int numberOfChannels)
+			: AudioStream(decodedSampleRate, sampleWidth, numberOfChannels)
+			, audioFile(std::move(audioFile))
+			, dataSource(std::move(dataSource))
+			, opusFile(opusFile)
+		{}
+
+		~OpusStream() override
+		{
+			op_free(opusFile);
+		}
+
+		AudioData Read(size_t maxBytes) override
+		{
+			AudioData out { sampleRate, byteDepth, numberOfChannels };
+			size_t frameSize = numberOfChannels * sizeof(opus_int16);
+			size_t maxSamples = maxBytes / sizeof(opus_int16);
+			out.rawSamples.resize(maxSamples * sizeof(opus_int16));
+
+			size_t samplesDecoded = 0;
+
+			// op_read returns whole frames so stop when there is no room left for one
+			while (maxSamples - samplesDecoded >= frameSize / sizeof(opus_int16)) {
+				int samplesPerChannelRead = op_read(opusFile,
+					reinterpret_cast<opus_int16*>(out.rawSamples.data()) + samplesDecoded,
+					maxSamples - samplesDecoded, nullptr);
+
+				if (samplesPerChannelRead <= 0) {
+					break;
+				}
+
+				samplesDecoded += samplesPerChannelRead * numberOfChannels;
+			}
+
+			out.rawSamples.resize(samplesDecoded * sizeof(opus_int16));
+			return out;
+		}
+
+		bool Rewind() override
+		{
+			return op_pcm_seek(opusFile, 0) == 0;
+		}
+
+		bool Seek(double seconds) override
+		{
+			return op_pcm_seek(opusFile, static_cast<ogg_int64_t>(seconds * decodedSampleRate)) == 0;
+		}
+
+		size_t DecodedSize() override
+		{
+			ogg_int64_t samples = op_pcm_total(opusFile, -1);
+
+			return samples > 0 ? samples * numberOfChannels * sampleWidth : 0;
+		}
+
+		// Opus is always decoded at 48kHz
+		static constexpr int decodedSampleRate = 48000;
+		static constexpr int sampleWidth = 2;
+
+	private:
+		std::unique_ptr<std::string> audioFile;
+		std::unique_ptr<OpusDataSource> dataSource;
+		OggOpusFile* opusFile;
+};
+
+constexpr int OpusStream::decodedSampleRate;
+constexpr int OpusStream::sampleWidth;
+
+std::unique_ptr<AudioStream> OpenOpusStream(std::string filename)
+{
+	std::unique_ptr<std::string> audioFile(new std::string);
 	try
 	{
-		audioFile = FS::PakPath::ReadFile(filename);
+		*audioFile = FS::PakPath::ReadFile(filename);
 	}
 	catch (std::system_error& err)
 	{
 		audioLogs.Warn("Failed to open %s: %s", filename, err.what());
-		return AudioData();
+		return nullptr;
 	}
 
-	OpusDataSource dataSource = {&audioFile, 0};
-	OggOpusFile* opusFile = op_open_callbacks(&dataSource, &Opus_Callbacks, nullptr, 0, nullptr);
+	std::unique_ptr<OpusDataSource> dataSource(new OpusDataSource{audioFile.get(), 0});
+	OggOpusFile* opusFile = op_open_callbacks(dataSource.get(), &Opus_Callbacks, nullptr, 0, nullptr);
 
 	if (!opusFile) {
 		audioLogs.Warn("Error while reading %s", filename);
-		return AudioData();
+		return nullptr;
 	}
 
 	const OpusHead* opusInfo = op_head(opusFile, -1);
@@ -125,63 +237,36 @@ AudioData LoadOpusCodec(std::string filename)
 	if (!opusInfo) {
 		op_free(opusFile);
 		audioLogs.Warn("Could not read OpusHead in %s", filename);
-		return AudioData();
+		return nullptr;
 	}
 
 	if (opusInfo->stream_count != 1) {
 		op_free(opusFile);
 		audioLogs.Warn("Only one stream is supported in Opus files: %s", filename);
-		return AudioData();
+		return nullptr;
 	}
 
 	if (opusInfo->channel_count != 1 && opusInfo->channel_count != 2) {
 		op_free(opusFile);
 		audioLogs.Warn("Only mono and stereo Opus files are supported: %s", filename);
-		return AudioData();
+		return nullptr;
 	}
 
-	const int sampleWidth = 2;
-
-	int sampleRate = 48000;
 	int numberOfChannels = opusInfo->channel_count;
 
-	/* The largest opus file we have so far is sound/thunder/weather.opus
-	It uncompress to ~13mb. Use 64mb here just in case */
-	static constexpr uint32_t MAX_USED_FILE_SIZE = 64 * 1024 * 1024;
-	static constexpr uint32_t MAX_READ_SIZE      =  1 * 1024 * 1024;
-
-	char* buffer = ( char* ) Hunk_AllocateTempMemory( MAX_USED_FILE_SIZE );
-	uint32_t bufferPointer = 0;
-	uint32_t rawSamplesPointer = 0;
-
-	int samplesPerChannelRead = 0;
-
-	AudioData out { sampleRate, sampleWidth, numberOfChannels };
-
-	while ( ( samplesPerChannelRead =
-				op_read( opusFile, ( opus_int16* ) ( buffer + bufferPointer ), MAX_READ_SIZE, nullptr )
-			) > 0 ) {
-		bufferPointer += samplesPerChannelRead * numberOfChannels * sizeof( opus_int16 );
-
-		if ( MAX_USED_FILE_SIZE - bufferPointer < MAX_READ_SIZE ) {
-			out.rawSamples.resize( out.rawSamples.size() + bufferPointer );
-			std::copy_n( buffer, bufferPointer, out.rawSamples.data() + rawSamplesPointer );
+	return std::unique_ptr<AudioStream>(new OpusStream(std::move(audioFile), std::move(dataSource),
+	                                                   opusFile, numberOfChannels));
+}
 
-			rawSamplesPointer += bufferPointer;
-			bufferPointer = 0;
-		}
-	}
+AudioData LoadOpusCodec(std::string filename)
+{
+	std::unique_ptr<AudioStream> stream = OpenOpusStream(filename);
 
-	if ( bufferPointer ) {
-		out.rawSamples.resize( out.rawSamples.size() + bufferPointer );
-		std::copy_n( buffer, bufferPointer, out.rawSamples.data() + rawSamplesPointer );
+	if (!stream) {
+		return AudioData();
 	}
 
-	Hunk_FreeTempMemory( buffer );
-
-	op_free(opusFile);
-
-	return out;
+	return stream->ReadAll();
 }
 
 } //namespace Audio
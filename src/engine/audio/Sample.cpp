@@ -35,15 +35,25 @@ namespace Audio {
 
     Resource::Manager<Sample>* sampleManager;
 
+    static Cvar::Range<Cvar::Cvar<int>> streamMinimumSize("audio.streamMinimumSize",
+        "sounds decoding to at least this many KiB are streamed instead of decoded at once, 0 to never stream",
+        Cvar::NONE, 4096, 0, 1024 * 1024);
+
     // Implementation of Sample
 
-    Sample::Sample(std::string filename): Resource(filename) {
+    // The cvar is read here as Prepare may run on a job thread
+    Sample::Sample(std::string filename): Resource(filename), streamed(false), duration(0.0f),
+        streamMinimumBytes(static_cast<size_t>(streamMinimumSize.Get()) * 1024) {
     }
 
     Sample::~Sample() {
         audioLogs.Debug("Deleting Sample '%s'", GetName());
     }
 
+	static float GetAudioDuration(size_t size, int sampleRate, int byteDepth, int numberOfChannels) {
+		return static_cast<float>(size) / (sampleRate * byteDepth * numberOfChannels);
+	}
+
 	static AudioData GenerateNullSample() {
 		// 8KHz 16bit mono.
 		AudioData out { 8000, 2, 1 };
@@ -52,23 +62,59 @@ namespace Audio {
 		return out;
 	}
 
-    bool Sample::Load() {
-        audioLogs.Debug("Loading Sample '%s'", GetName());
+    bool Sample::Prepare() {
+        audioLogs.Debug("Decoding Sample '%s'", GetName());
 
 		if ( GetName() == "sound/null" || GetName() == "sound/null.wav" ) {
-			buffer.Feed( GenerateNullSample() );
+			audioData.reset( new AudioData( GenerateNullSample() ) );
+			duration = GetAudioDuration( audioData->rawSamples.size(), audioData->sampleRate,
+				audioData->byteDepth, audioData->numberOfChannels );
 			return true;
 		}
 
-	    AudioData audioData = LoadSoundCodec(GetName());
+		std::unique_ptr<AudioStream> stream;
+
+		if ( streamMinimumBytes && CanStreamSound(GetName()) ) {
+			stream = OpenSoundStream(GetName());
+
+			if ( !stream ) {
+				return false;
+			}
+
+			if ( stream->DecodedSize() >= streamMinimumBytes ) {
+				audioLogs.Debug("Streaming Sample '%s'", GetName());
+				streamed = true;
+				duration = GetAudioDuration( stream->DecodedSize(), stream->sampleRate,
+					stream->byteDepth, stream->numberOfChannels );
+				return true;
+			}
+		}
+
+	    // a short sound is decoded from the stream that is already open
+	    audioData.reset( new AudioData( stream ? stream->ReadAll() : LoadSoundCodec(GetName()) ) );
 
-	    if ( !audioData.rawSamples.size() ) {
+	    if ( !audioData->rawSamples.size() ) {
 		    audioLogs.Debug("Couldn't load sound %s, it's empty!", GetName());
+		    audioData = nullptr;
             return false;
         }
 
+	    duration = GetAudioDuration( audioData->rawSamples.size(), audioData->sampleRate,
+		    audioData->byteDepth, audioData->numberOfChannels );
+
+	    return true;
+    }
+
+    bool Sample::Load() {
+        audioLogs.Debug("Loading Sample '%s'", GetName());
+
+        if ( streamed ) {
+            return true;
+        }
+
         //TODO handle errors, especially out of memory errors
-        buffer.Feed(audioData);
+        buffer.Feed(*audioData);
+        audioData = nullptr;
 
 	    return true;
     }
@@ -76,12 +122,22 @@ namespace Audio {
     void Sample::Cleanup() {
         // Destroy the OpenAL buffer by moving it in the scope
         AL::Buffer toDelete = std::move(buffer);
+        audioData = nullptr;
+        streamed = false;
     }
 
     AL::Buffer& Sample::GetBuffer() {
         return buffer;
     }
 
+    bool Sample::IsStreamed() const {
+        return streamed;
+    }
+
+    float Sample::GetDuration() const {
+        return duration;
+    }
+
     // Implementation of the sample storage
 
     static const char errorSampleName[] = "sound/null";
@@ -143,4 +199,16 @@ namespace Audio {
     void EndSampleRegistration() {
         sampleManager->EndRegistration();
     }
+
+    void UpdateSamples() {
+        if (not initialized) {
+            return;
+        }
+
+        sampleManager->FinishLoading(false);
+    }
+
+    void WaitForSample(const std::shared_ptr<Sample>& sample) {
+        sampleManager->FinishLoading(sample);
+    }
 }
@@ -101,13 +101,23 @@ namespace Audio {
             explicit Sample(std::string name);
             virtual ~Sample() override final;
 
+            virtual bool Prepare() override final;
             virtual bool Load() override final;
             virtual void Cleanup() override final;
 
             AL::Buffer& GetBuffer();
+            // Long sounds are decoded while they play instead of being loaded in the buffer.
+            bool IsStreamed() const;
+            // The length of the sound in seconds.
+            float GetDuration() const;
 
         private:
             AL::Buffer buffer;
+            // Decoded by Prepare and uploaded to the buffer by Load
+            std::unique_ptr<AudioData> audioData;
+            bool streamed;
+            float duration;
+            size_t streamMinimumBytes;
     };
 
     void InitSamples();
@@ -118,6 +128,10 @@ namespace Audio {
     void BeginSampleRegistration();
     std::shared_ptr<Sample> RegisterSample(Str::StringRef filename);
     void EndSampleRegistration();
+    // Finishes loading the samples decoded in the background since the last frame.
+    void UpdateSamples();
+    // Waits for a sample registered during the registration to be loaded.
+    void WaitForSample(const std::shared_ptr<Sample>& sample);
 }
 
 #endif //AUDIO_SAMPLE_H_
@@ -29,6 +29,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "AudioPrivate.h"
+#include "SoundCodec.h"
+#include "framework/JobSystem.h"
 
 namespace Audio {
     /* When adding an entry point to the audio subsystem,
@@ -38,16 +40,34 @@ namespace Audio {
 
     static Cvar::Range<Cvar::Cvar<float>> effectsVolume("audio.volume.effects", "the volume of the effects", Cvar::NONE, 0.8f, 0.0f, 1.0f);
 
+    static Cvar::Range<Cvar::Cvar<float>> cullDistance("audio.cullDistance",
+        "sounds further than this distance (in qu) from the listener are never given a source, 0 for no limit",
+        Cvar::NONE, 8192.0f, 0.0f, 65536.0f);
+
     // We have a big, fixed number of source to avoid rendering too many sounds and slowing down the rest of the engine.
-    struct sourceRecord_t {
-        AL::Source source;
-        std::shared_ptr<Sound> usingSound;
-        bool active;
+    // Sounds are virtual voices bound to a source only while they are among the most audible ones.
+    static AL::Source* sources = nullptr;
+    static std::vector<int> freeSources;
+    static CONSTEXPR int nSources = 128; //TODO see what's the limit for OpenAL soft
+
+    struct voice_t {
+        std::shared_ptr<Sound> sound;
         int priority;
+        // -1 while the sound is virtual
+        int sourceNum;
+        float audibility;
+        bool selected;
     };
 
-    static sourceRecord_t* sources = nullptr;
-    static CONSTEXPR int nSources = 128; //TODO see what's the limit for OpenAL soft
+    static std::vector<voice_t> voices;
+    static int lastUpdateTime = 0;
+
+    // Bound voices must be that much less audible than another one to lose their source,
+    // so that sounds of similar loudness don't keep swapping their sources.
+    static CONSTEXPR float BOUND_VOICE_BIAS = 1.25f;
+
+    // The OpenAL reference distance set by the emitters
+    static CONSTEXPR float REFERENCE_DISTANCE = 120.0f;
 
     static bool initialized = false;
 
@@ -56,12 +76,14 @@ namespace Audio {
             return;
         }
 
-        sources = new sourceRecord_t[nSources];
+        sources = new AL::Source[nSources];
 
-        for (int i = 0; i < nSources; i++) {
-            sources[i].active = false;
+        for (int i = nSources - 1; i >= 0; i--) {
+            freeSources.push_back(i);
         }
 
+        lastUpdateTime = 0;
+
         initialized = true;
     }
 
@@ -70,48 +92,37 @@ namespace Audio {
             return;
         }
 
+        for (voice_t& voice : voices) {
+            if (voice.sourceNum >= 0) {
+                voice.sound->ReleaseSource();
+            }
+        }
+        voices.clear();
+        freeSources.clear();
+
         delete[] sources;
         sources = nullptr;
 
         initialized = false;
     }
 
-    void UpdateSounds() {
-        if (not initialized) {
-            return;
-        }
-
-        for (int i = 0; i < nSources; i++) {
-            if (sources[i].active) {
-                std::shared_ptr<Sound> sound = sources[i].usingSound;
+    static void BindVoice(voice_t& voice) {
+        voice.sourceNum = freeSources.back();
+        freeSources.pop_back();
 
-                // Update and Emitter::UpdateSound can call Sound::Stop
-                if ( sound->playing ) {
-                    sound->Update();
-                }
+        AL::Source& source = sources[voice.sourceNum];
 
-                if ( sound->playing ) {
-                    sound->emitter->UpdateSound(*sound);
-                }
-
-                if ( !sound->playing ) {
-                    sources[i].active = false;
-                    sources[i].usingSound = nullptr;
-                }
-            }
-        }
+        // Make the source forget if it was a "static" or a "streaming" source.
+        source.ResetBuffer();
+        voice.sound->AcquireSource(source);
+        voice.sound->FinishSetup();
+        voice.sound->Play();
     }
 
-    void StopSounds() {
-        if (not initialized) {
-            return;
-        }
-
-        for (int i = 0; i < nSources; i++) {
-            if (sources[i].active) {
-                sources[i].usingSound->Stop();
-            }
-        }
+    static void UnbindVoice(voice_t& voice) {
+        voice.sound->ReleaseSource();
+        freeSources.push_back(voice.sourceNum);
+        voice.sourceNum = -1;
     }
 
     static Cvar::Range<Cvar::Cvar<int>> a_clientSoundPriorityMaxDistance( "a_clientSoundPriorityMaxDistance",
@@ -123,60 +134,142 @@ namespace Audio {
         " will use this value as their priority multiplier",
         Cvar::NONE, 2.0f, 0.0f, 1024.0f );
 
-    static float GetAdjustedVolumeForPosition( const Vec3& origin, const Vec3& src, const bool isClient ) {
-        vec3_t v0 { origin.Data()[0], origin.Data()[1], origin.Data()[2] };
-        vec3_t v1 { src.Data()[0], src.Data()[1], src.Data()[2] };
+    // Computes how loud the voices are at the listener's position, following OpenAL's inverse distance model.
+    static void ComputeAudibility() {
+        Vec3 listener = entities[playerClientNum].position;
 
-        float totalPriority = VectorDistanceSquared( v0, v1 );
+        const float maxDistance = cullDistance.Get();
+        const float maxDistanceSquared = maxDistance * maxDistance;
+        const float clientDistance = a_clientSoundPriorityMaxDistance.Get();
+        const float clientDistanceSquared = clientDistance * clientDistance;
+        const float clientMultiplier = a_clientSoundPriorityMultiplier.Get();
 
-        const float distanceThreshold = a_clientSoundPriorityMaxDistance.Get();
-        if ( isClient && totalPriority < distanceThreshold * distanceThreshold ) {
-            totalPriority *= 1.0f / a_clientSoundPriorityMultiplier.Get();
-        }
+        for (voice_t& voice : voices) {
+            const Sound& sound = *voice.sound;
+
+            if (not sound.CanBeVirtual()) {
+                voice.audibility = std::numeric_limits<float>::infinity();
+                continue;
+            }
+
+            float distanceGain = 1.0f;
+
+            if (not sound.emitter->IsLocal()) {
+                Vec3 position = sound.emitter->GetPosition();
+                const float distanceSquared = VectorDistanceSquared(position.Data(), listener.Data());
+
+                // Distant sounds are skipped before computing their attenuation
+                if (maxDistance > 0.0f and distanceSquared > maxDistanceSquared) {
+                    voice.audibility = 0.0f;
+                    continue;
+                }
+
+                const float distance = sqrtf(distanceSquared);
+                if (distance > REFERENCE_DISTANCE) {
+                    distanceGain = REFERENCE_DISTANCE / distance;
+                }
+
+                if (voice.priority == CLIENT and distanceSquared < clientDistanceSquared) {
+                    distanceGain *= clientMultiplier;
+                }
+            }
+
+            float gain = sound.positionalGain * sound.soundGain * SliderToAmplitude(sound.volumeModifier->Get());
+
+            if (voice.sourceNum >= 0) {
+                // Let the sounds fading out finish their fade
+                gain = std::max(gain, sound.currentGain) * BOUND_VOICE_BIAS;
+            }
 
-       return 1.0f / totalPriority;
+            voice.audibility = distanceGain * gain;
+        }
     }
 
-    // Finds a inactive or low-priority source to play a new sound.
-    static sourceRecord_t* GetSource( const Vec3& position, int priority, const float currentGain ) {
-        int best = -1;
+    // Gives the sources to the most audible voices.
+    static void BindVoices() {
+        std::vector<voice_t*> audible;
+
+        for (voice_t& voice : voices) {
+            voice.selected = false;
 
-        const Vec3& playerPos = entities[playerClientNum].position;
+            if (voice.audibility > 0.0f) {
+                audible.push_back(&voice);
+            }
+        }
 
-        // Sound volume is inversely proportional to distance to the source
-        const float adjustedVolume = Q_rsqrt_fast( currentGain )
-            * GetAdjustedVolumeForPosition( playerPos, position, priority == CLIENT );
+        if (audible.size() > nSources) {
+            std::nth_element(audible.begin(), audible.begin() + nSources, audible.end(),
+                [](const voice_t* a, const voice_t* b) {
+                    return a->audibility > b->audibility;
+                });
+            audible.resize(nSources);
+        }
 
-        // Gets the minimum sound by comparing activity first, then the adjusted volume
-        for (int i = 0; i < nSources; i++) {
-            sourceRecord_t& source = sources[i];
+        for (voice_t* voice : audible) {
+            voice->selected = true;
+        }
 
-            if (not source.active) {
-                return &source;
+        // Free the sources first so that they can be given to the voices getting one
+        for (voice_t& voice : voices) {
+            if (voice.sourceNum >= 0 and not voice.selected) {
+                UnbindVoice(voice);
             }
+        }
+
+        for (voice_t* voice : audible) {
+            if (voice->sourceNum < 0) {
+                BindVoice(*voice);
+            }
+        }
+    }
 
-            const Vec3& sourcePos = source.usingSound->emitter->GetPosition();
+    void UpdateSounds() {
+        if (not initialized) {
+            return;
+        }
 
-            // Sound volume is inversely proportional to distance to the source
-            const float adjustedSourceVolume = Q_rsqrt_fast( source.usingSound->currentGain )
-                * GetAdjustedVolumeForPosition( playerPos, sourcePos, source.priority == CLIENT );
+        int time = Sys::Milliseconds();
+        double elapsed = lastUpdateTime ? (time - lastUpdateTime) * 0.001 : 0.0;
+        lastUpdateTime = time;
 
-            if ( adjustedVolume > adjustedSourceVolume ) {
-                best = i;
-                continue;
+        for (voice_t& voice : voices) {
+            Sound& sound = *voice.sound;
+
+            sound.playTime += elapsed;
+
+            // Update, VirtualUpdate and Emitter::UpdateSound can call Sound::Stop
+            if ( sound.playing ) {
+                if ( voice.sourceNum >= 0 ) {
+                    sound.Update();
+
+                    if ( sound.playing ) {
+                        sound.emitter->UpdateSound(sound);
+                    }
+                } else {
+                    sound.VirtualUpdate();
+                }
+            }
+
+            if ( !sound.playing and voice.sourceNum >= 0 ) {
+                UnbindVoice(voice);
             }
         }
 
-        if (best >= 0) {
-            sourceRecord_t& source = sources[best];
+        voices.erase(std::remove_if(voices.begin(), voices.end(), [](const voice_t& voice) {
+            return not voice.sound->playing;
+        }), voices.end());
 
-            source.source.Stop();
-            source.source.RemoveAllQueuedBuffers();
+        ComputeAudibility();
+        BindVoices();
+    }
 
-            source.usingSound = nullptr;
-            return &source;
-        } else {
-            return nullptr;
+    void StopSounds() {
+        if (not initialized) {
+            return;
+        }
+
+        for (voice_t& voice : voices) {
+            voice.sound->Stop();
         }
     }
 
@@ -185,39 +278,52 @@ namespace Audio {
             return;
         }
 
-        const Vec3& position = emitter->GetPosition();
-        const float currentGain = sound->positionalGain * sound->soundGain
-            * SliderToAmplitude( sound->volumeModifier->Get() );
-        sourceRecord_t* source = GetSource( position, priority, currentGain );
+        sound->emitter = emitter;
+        sound->playing = true;
+        voices.push_back({ sound, priority, -1, 0.0f, false });
+        voice_t& voice = voices.back();
 
-        if ( source ) {
-            // Make the source forget if it was a "static" or a "streaming" source.
-            source->source.ResetBuffer();
-            sound->emitter = emitter;
-            sound->AcquireSource( source->source );
-            source->usingSound = sound;
-            source->priority = priority;
-            source->active = true;
+        // Sounds that can't wait for the next update take the source of the least audible voice
+        if ( freeSources.empty() and not sound->CanBeVirtual() ) {
+            voice_t* quietest = nullptr;
 
-            sound->FinishSetup();
-            sound->Play();
+            for ( voice_t& other : voices ) {
+                if ( other.sourceNum >= 0 and ( not quietest or other.audibility < quietest->audibility ) ) {
+                    quietest = &other;
+                }
+            }
+
+            if ( quietest and quietest->sound->CanBeVirtual() ) {
+                UnbindVoice( *quietest );
+            }
+        }
+
+        // Start right away when possible, the sound will compete for a source at the next update otherwise
+        if ( not freeSources.empty() ) {
+            BindVoice( voice );
         }
     }
 
     // Implementation of Sound
 
     Sound::Sound() : positionalGain(1.0f), soundGain(1.0f), currentGain(1.0f),
-                     playing(false), volumeModifier(&effectsVolume), source(nullptr) {}
+                     playing(false), volumeModifier(&effectsVolume), source(nullptr), playTime(0.0) {}
 
     Sound::~Sound() = default;
 
     void Sound::Play() {
-        source->Play();
+        if (source) {
+            source->Play();
+        }
         playing = true;
     }
 
     void Sound::Stop() {
-        source->Stop();
+        if (source) {
+            source->Stop();
+            // Free the buffers of streamed samples now rather than when the source is reused
+            source->RemoveAllQueuedBuffers();
+        }
         playing = false;
     }
 
@@ -230,6 +336,20 @@ namespace Audio {
         emitter->SetupSound(*this);
     }
 
+    void Sound::ReleaseSource() {
+        source->Stop();
+        source->RemoveAllQueuedBuffers();
+        InternalReleaseSource();
+        source = nullptr;
+    }
+
+    bool Sound::CanBeVirtual() const {
+        return true;
+    }
+
+    void Sound::InternalReleaseSource() {
+    }
+
     // Set the gain before the source is started to avoid having a few milliseconds of very loud sound
     void Sound::FinishSetup() {
         currentGain = positionalGain * soundGain * SliderToAmplitude(volumeModifier->Get());
@@ -253,6 +373,87 @@ namespace Audio {
 
         InternalUpdate();
     }
+
+    // Implementation of SampleStreamer
+
+    // Each buffer holds a third of a second of 48kHz stereo sound.
+    static CONSTEXPR size_t STREAM_CHUNK_SIZE = 64 * 1024;
+    static CONSTEXPR int STREAM_QUEUED_BUFFERS = 4;
+
+    struct SampleStreamer::streamState_t {
+        std::unique_ptr<AudioStream> stream;
+        bool loop;
+        Jobs::JobHandle job;
+
+        // written by the job
+        std::unique_ptr<AudioData> chunk;
+        bool ended;
+    };
+
+    void SampleStreamer::DecodeChunk(streamState_t* state) {
+        std::unique_ptr<AudioData> chunk(new AudioData(state->stream->Read(STREAM_CHUNK_SIZE)));
+
+        if (chunk->rawSamples.empty() and state->loop and state->stream->Rewind()) {
+            chunk.reset(new AudioData(state->stream->Read(STREAM_CHUNK_SIZE)));
+        }
+
+        state->ended = chunk->rawSamples.empty();
+        state->chunk = std::move(chunk);
+    }
+
+    SampleStreamer::SampleStreamer(const Sample& sample, bool loop, double startTime): state(new streamState_t) {
+        state->stream = OpenSoundStream(sample.GetName());
+        state->loop = loop;
+        state->ended = not state->stream;
+
+        if (state->stream and startTime > 0.0 and not state->stream->Seek(startTime)) {
+            state->stream->Rewind();
+        }
+
+        // Decode the start right away so that the sound can start playing immediately
+        if (state->stream) {
+            DecodeChunk(state.get());
+        }
+    }
+
+    bool SampleStreamer::Update(AL::Source& source) {
+        while (source.GetNumProcessedBuffers() > 0) {
+            source.PopBuffer();
+        }
+
+        if (not state->job or Jobs::IsDone(state->job)) {
+            state->job = nullptr;
+
+            if (state->chunk) {
+                if (not state->chunk->rawSamples.empty()) {
+                    AL::Buffer buffer;
+                    if (buffer.Feed(*state->chunk) == 0) {
+                        source.QueueBuffer(std::move(buffer));
+                    }
+                }
+                state->chunk = nullptr;
+            }
+
+            if (not state->ended and source.GetNumQueuedBuffers() < STREAM_QUEUED_BUFFERS) {
+                std::shared_ptr<streamState_t> jobState = state;
+                state->job = Jobs::Submit([jobState] {
+                    DecodeChunk(jobState.get());
+                });
+            }
+        }
+
+        if (source.GetNumQueuedBuffers() == 0) {
+            return not state->ended or state->job or state->chunk;
+        }
+
+        // Restart the source if it ran out of buffers before the decoding caught up
+        if (source.IsStopped()) {
+            source.Play();
+        }
+
+        return true;
+    }
+
     // Implementation of OneShotSound
 
     OneShotSound::OneShotSound(std::shared_ptr<Sample> sample): sample(sample) {
@@ -261,12 +462,37 @@ namespace Audio {
     OneShotSound::~OneShotSound() = default;
 
     void OneShotSound::SetupSource(AL::Source& source) {
-        source.SetBuffer(sample->GetBuffer());
+        if (sample->IsStreamed()) {
+            streamer.reset(new SampleStreamer(*sample, false, playTime));
+            streamer->Update(source);
+        } else {
+            source.SetBuffer(sample->GetBuffer());
+            if (playTime > 0.0) {
+                source.SetSecondOffset(playTime);
+            }
+        }
+        soundGain = volumeModifier->Get();
+    }
+
+    void OneShotSound::InternalReleaseSource() {
+        streamer = nullptr;
+    }
+
+    void OneShotSound::VirtualUpdate() {
+        if (playTime >= sample->GetDuration()) {
+            Stop();
+            return;
+        }
         soundGain = volumeModifier->Get();
     }
 
     void OneShotSound::InternalUpdate() {
-        if ( source->IsStopped() ) {
+        if (streamer) {
+            if (not streamer->Update(*source)) {
+                Stop();
+                return;
+            }
+        } else if ( source->IsStopped() ) {
             Stop();
             return;
         }
@@ -278,6 +504,7 @@ namespace Audio {
     LoopingSound::LoopingSound(std::shared_ptr<Sample> loopingSample, std::shared_ptr<Sample> leadingSample)
         : loopingSample(loopingSample),
           leadingSample(leadingSample),
+          loopStartTime(0.0),
           fadingOut(false) {}
 
     LoopingSound::~LoopingSound() = default;
@@ -288,8 +515,22 @@ namespace Audio {
     }
 
     void LoopingSound::SetupSource(AL::Source& source) {
+        // The leading sample might have ended while the sound was virtual
+        if (leadingSample and playTime >= leadingSample->GetDuration()) {
+            loopStartTime = leadingSample->GetDuration();
+            leadingSample = nullptr;
+        }
+
         if (leadingSample) {
-            source.SetBuffer(leadingSample->GetBuffer());
+            if (leadingSample->IsStreamed()) {
+                streamer.reset(new SampleStreamer(*leadingSample, false, playTime));
+                streamer->Update(source);
+            } else {
+                source.SetBuffer(leadingSample->GetBuffer());
+                if (playTime > 0.0) {
+                    source.SetSecondOffset(playTime);
+                }
+            }
         } else {
             SetupLoopingSound(source);
         }
@@ -303,23 +544,77 @@ namespace Audio {
 
         if (not fadingOut) {
             if (leadingSample) {
-                if ( source->IsStopped() ) {
+                bool leadingEnded = streamer ? not UpdateStreamer() : source->IsStopped();
+
+                if ( leadingEnded ) {
+                    loopStartTime = playTime;
+                    leadingSample = nullptr;
                     SetupLoopingSound( *source );
                     source->Play();
-                    leadingSample = nullptr;
                 }
+            } else if (streamer and not UpdateStreamer()) {
+                // A looping stream only ends if the sample couldn't be decoded
+                Stop();
+                return;
             }
             soundGain = volumeModifier->Get();
         }
     }
 
     void LoopingSound::SetupLoopingSound(AL::Source& source){
-        source.SetLooping(true);
-        if (loopingSample) {
-            source.SetBuffer(loopingSample->GetBuffer());
+        // Forget the buffers of the leading sample and whether the source was streaming
+        source.RemoveAllQueuedBuffers();
+        source.ResetBuffer();
+        streamer = nullptr;
+
+        // Resume the loop where it would be if it had been playing all along
+        double loopTime = 0.0;
+        if (loopingSample and loopingSample->GetDuration() > 0.0f) {
+            loopTime = fmod(playTime - loopStartTime, loopingSample->GetDuration());
+        }
+
+        if (loopingSample and loopingSample->IsStreamed()) {
+            // The streamer rewinds the sample, looping the source would loop its queue
+            streamer.reset(new SampleStreamer(*loopingSample, true, loopTime));
+            streamer->Update(source);
+        } else {
+            source.SetLooping(true);
+            if (loopingSample) {
+                source.SetBuffer(loopingSample->GetBuffer());
+                if (loopTime > 0.0) {
+                    source.SetSecondOffset(loopTime);
+                }
+            }
         }
     }
 
+    void LoopingSound::InternalReleaseSource() {
+        streamer = nullptr;
+    }
+
+    void LoopingSound::VirtualUpdate() {
+        // Nothing to fade out while the sound can't be heard
+        if (fadingOut) {
+            Stop();
+            return;
+        }
+
+        if (leadingSample and playTime >= leadingSample->GetDuration()) {
+            loopStartTime = leadingSample->GetDuration();
+            leadingSample = nullptr;
+        }
+        soundGain = volumeModifier->Get();
+    }
+
+    bool LoopingSound::UpdateStreamer() {
+        if (streamer->Update(*source)) {
+            return true;
+        }
+
+        streamer = nullptr;
+        return false;
+    }
+
     // Implementation of StreamingSound
 
     StreamingSound::StreamingSound() = default;
@@ -329,6 +624,14 @@ namespace Audio {
     void StreamingSound::SetupSource(AL::Source&) {
     }
 
+    void StreamingSound::VirtualUpdate() {
+        Stop();
+    }
+
+    bool StreamingSound::CanBeVirtual() const {
+        return false;
+    }
+
     void StreamingSound::InternalUpdate() {
         while ( source->GetNumProcessedBuffers() > 0 ) {
             source->PopBuffer();
@@ -341,7 +644,7 @@ namespace Audio {
 
     //TODO somehow try to catch back when data is coming faster than we consume (e.g. capture data)
     void StreamingSound::AppendBuffer(AL::Buffer buffer) {
-        if ( !playing ) {
+        if ( !playing or !source ) {
             return;
         }
 
@@ -351,4 +654,25 @@ namespace Audio {
             source->Play();
         }
     }
+
+    class ListVoicesCmd : public Cmd::StaticCmd {
+        public:
+            ListVoicesCmd(): StaticCmd("listAudioVoices", Cmd::AUDIO, "Lists the playing sounds and whether they have a source") {
+            }
+
+            virtual void Run(const Cmd::Args&) const override {
+                int numBound = 0;
+
+                for (const voice_t& voice : voices) {
+                    Print("%s audibility %.4f, %.2fs", voice.sourceNum >= 0 ? "source " : "virtual",
+                          voice.audibility, voice.sound->playTime);
+
+                    if (voice.sourceNum >= 0) {
+                        numBound++;
+                    }
+                }
+                Print("%i sounds, %i with a source, %i virtual", voices.size(), numBound, voices.size() - numBound);
+            }
+    };
+    static ListVoicesCmd listVoicesRegistration;
 }
@@ -42,7 +42,7 @@ namespace Audio {
     void StopSounds();
 
     // The only way to add a sound, attaches the sound to the emitter, a higher priority means
-    // the sound will be less likely to be recycled to spawn a new sound.
+    // the sound will be less likely to be made virtual when too many sounds are playing.
     void AddSound(std::shared_ptr<Emitter> emitter, std::shared_ptr<Sound> sound, int priority);
 
     class Sample;
@@ -51,6 +51,27 @@ namespace Audio {
         class Source;
     }
 
+    // Decodes a streamed sample on the job threads and keeps a few buffers queued on a source.
+    class SampleStreamer {
+        public:
+            // Starts decoding startTime seconds into the sample.
+            SampleStreamer(const Sample& sample, bool loop, double startTime = 0.0);
+
+            // Queues the decoded data on the source, returns false once the whole sample has been played.
+            bool Update(AL::Source& source);
+
+        private:
+            struct streamState_t;
+            // Runs on the job threads.
+            static void DecodeChunk(streamState_t* state);
+            std::shared_ptr<streamState_t> state;
+    };
+
+    /*
+     * Sounds are virtual voices: any number of them can play but only the most audible
+     * ones are given one of the OpenAL sources. The others keep track of their playback
+     * time so that they resume at the right position when they get a source back.
+     */
     //TODO sound.mute
     class Sound {
         public:
@@ -61,9 +82,13 @@ namespace Audio {
             bool playing;
             const Cvar::Range<Cvar::Cvar<float>>* volumeModifier;
 
+            // nullptr while the sound is virtual
             AL::Source* source;
             std::shared_ptr<Emitter> emitter;
 
+            // Seconds since the sound started playing
+            double playTime;
+
             Sound();
             virtual ~Sound();
 
@@ -72,14 +97,26 @@ namespace Audio {
             void Stop();
 
             void AcquireSource(AL::Source& source);
+            // Stops the source and makes the sound virtual.
+            void ReleaseSource();
 
-            // Used to setup a source for a specific kind of sound and to start the sound.
+            // Used to setup a source for a specific kind of sound and to start the sound,
+            // playTime seconds into it.
             virtual void SetupSource(AL::Source& source) = 0;
             void FinishSetup();
 
             void Update();
             // Called each frame, after emitters have been updated.
             virtual void InternalUpdate() = 0;
+            // Called each frame instead of InternalUpdate while the sound is virtual.
+            virtual void VirtualUpdate() = 0;
+
+            // Sounds that need their source all the time can't be made virtual.
+            virtual bool CanBeVirtual() const;
+
+        protected:
+            // Called before the source is taken from the sound.
+            virtual void InternalReleaseSource();
     };
 
     // A sound that is played once.
@@ -90,9 +127,14 @@ namespace Audio {
 
             virtual void SetupSource(AL::Source& source) override;
             virtual void InternalUpdate() override;
+            virtual void VirtualUpdate() override;
+
+        protected:
+            virtual void InternalReleaseSource() override;
 
         private:
             std::shared_ptr<Sample> sample;
+            std::unique_ptr<SampleStreamer> streamer;
     };
 
     // A looping sound
@@ -105,11 +147,20 @@ namespace Audio {
 
             virtual void SetupSource(AL::Source& source) override;
             virtual void InternalUpdate() override;
+            virtual void VirtualUpdate() override;
+
+        protected:
+            virtual void InternalReleaseSource() override;
 
         private:
             void SetupLoopingSound(AL::Source& source);
+            // Returns false if the sample ended.
+            bool UpdateStreamer();
             std::shared_ptr<Sample> loopingSample;
             std::shared_ptr<Sample> leadingSample;
+            std::unique_ptr<SampleStreamer> streamer;
+            // The playTime at which the looping sample started
+            double loopStartTime;
             bool fadingOut;
     };
 
@@ -122,6 +173,10 @@ namespace Audio {
 
             virtual void SetupSource(AL::Source& source) override;
             virtual void InternalUpdate() override;
+            virtual void VirtualUpdate() override;
+
+            // The data can only be queued on a source.
+            virtual bool CanBeVirtual() const override;
 
             void AppendBuffer(AL::Buffer buffer);
     };
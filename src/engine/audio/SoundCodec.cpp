@@ -37,15 +37,17 @@ struct soundExtToLoaderMap_t
 {
 	const char *ext;
 	AudioData (*SoundLoader) (std::string);
+	// nullptr if the codec can't decode incrementally
+	std::unique_ptr<AudioStream> (*StreamOpener) (std::string);
 };
 
 // Note that the ordering indicates the order of preference used
 // when there are multiple sound files of different formats available
 static const soundExtToLoaderMap_t soundLoaders[] =
 {
-	{ ".wav",	LoadWavCodec },
-	{ ".opus",	LoadOpusCodec  },
-	{ ".ogg",	LoadOggCodec  },
+	{ ".wav",	LoadWavCodec, nullptr },
+	{ ".opus",	LoadOpusCodec, OpenOpusStream },
+	{ ".ogg",	LoadOggCodec, OpenOggStream },
 };
 
 static int numSoundLoaders = ARRAY_LEN(soundLoaders);
@@ -75,7 +77,9 @@ static int FindSoundLoader(std::string filename)
 	return bestLoader;
 }
 
-AudioData LoadSoundCodec(std::string filename)
+// Finds the file and the loader to use for a sound name, which may lack the extension.
+// Returns -1 and logs why if there is none.
+static int ResolveSoundFile(std::string& filename)
 {
 
 	std::string ext = FS::Path::Extension(filename);
@@ -87,7 +91,7 @@ AudioData LoadSoundCodec(std::string filename)
 			if (ext == soundLoaders[i].ext) {
 				// if file exists, load it
 				if (FS::PakPath::FileExists(filename)) {
-					return soundLoaders[i].SoundLoader(filename);
+					return i;
 				}
 			}
 		}
@@ -109,17 +113,66 @@ AudioData LoadSoundCodec(std::string filename)
 
 	if (bestLoader >= 0)
 	{
-		std::string altName = Str::Format("%s%s", filename, soundLoaders[bestLoader].ext );
-		return soundLoaders[bestLoader].SoundLoader(altName);
+		filename = Str::Format("%s%s", filename, soundLoaders[bestLoader].ext );
+		return bestLoader;
 	}
 
 	if (FS::PakPath::FileExists(filename)) {
 		audioLogs.Warn("No codec available for opening %s.", filename);
-		return AudioData();
+		return -1;
 	}
 
 	audioLogs.Notice("Sound file '%s' not found.", filename);
-	return AudioData();
+	return -1;
+
+}
+
+AudioData LoadSoundCodec(std::string filename)
+{
+	int loader = ResolveSoundFile(filename);
+
+	if (loader < 0) {
+		return AudioData();
+	}
+
+	return soundLoaders[loader].SoundLoader(filename);
+}
+
+bool CanStreamSound(std::string filename)
+{
+	int loader = ResolveSoundFile(filename);
+
+	return loader >= 0 && soundLoaders[loader].StreamOpener;
+}
+
+std::unique_ptr<AudioStream> OpenSoundStream(std::string filename)
+{
+	int loader = ResolveSoundFile(filename);
+
+	if (loader < 0 || !soundLoaders[loader].StreamOpener) {
+		return nullptr;
+	}
+
+	return soundLoaders[loader].StreamOpener(filename);
+}
+
+AudioData AudioStream::ReadAll()
+{
+	static constexpr size_t MAX_READ_SIZE = 1 * 1024 * 1024;
+
+	AudioData out { sampleRate, byteDepth, numberOfChannels };
+	out.rawSamples.reserve(DecodedSize());
+
+	while (true) {
+		AudioData chunk = Read(MAX_READ_SIZE);
+
+		if (chunk.rawSamples.empty()) {
+			break;
+		}
+
+		out.rawSamples.insert(out.rawSamples.end(), chunk.rawSamples.begin(), chunk.rawSamples.end());
+	}
 
+	return out;
 }
 } // namespace Audio
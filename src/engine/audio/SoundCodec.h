@@ -36,13 +36,47 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace Audio {
 
+    // Decodes a sound file incrementally, for sounds too long to be decoded at once.
+    class AudioStream {
+        public:
+            AudioStream(int sampleRate, int byteDepth, int numberOfChannels)
+                : sampleRate{sampleRate}
+                , byteDepth{byteDepth}
+                , numberOfChannels{numberOfChannels}
+            {}
+            virtual ~AudioStream() = default;
+
+            // Decodes at most maxBytes of samples, returns no samples at the end of the stream.
+            virtual AudioData Read(size_t maxBytes) = 0;
+            // Goes back to the start of the sound, returns false on error.
+            virtual bool Rewind() = 0;
+            // Goes to a time in seconds from the start of the sound, returns false on error.
+            virtual bool Seek(double seconds) = 0;
+            // The size of the whole decoded sound in bytes.
+            virtual size_t DecodedSize() = 0;
+
+            // Decodes the rest of the sound.
+            AudioData ReadAll();
+
+            const int sampleRate;
+            const int byteDepth;
+            const int numberOfChannels;
+    };
+
     AudioData LoadSoundCodec(std::string filename);
 
+    // Whether the sound file uses a codec that can be decoded incrementally.
+    bool CanStreamSound(std::string filename);
+    // Returns nullptr if the file can't be opened or if its codec can't stream.
+    std::unique_ptr<AudioStream> OpenSoundStream(std::string filename);
+
     AudioData LoadWavCodec(std::string filename);
 
     AudioData LoadOggCodec(std::string filename);
+    std::unique_ptr<AudioStream> OpenOggStream(std::string filename);
 
     AudioData LoadOpusCodec(std::string filename);
+    std::unique_ptr<AudioStream> OpenOpusStream(std::string filename);
 
 } // namespace Audio
 #endif
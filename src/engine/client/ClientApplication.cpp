@@ -57,6 +57,7 @@ class ClientApplication : public Application {
             #endif
             #ifdef BUILD_GRAPHICAL_CLIENT
                 traits.isClient = true;
+                traits.useJobs = true;
             #endif
             #ifdef BUILD_TTY_CLIENT
                 traits.isTTYClient = true;
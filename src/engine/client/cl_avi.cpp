@@ -21,11 +21,15 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
 #include "client.h"
+#include "engine/framework/JobSystem.h"
 
 #define INDEX_FILE_EXTENSION ".index.dat"
 
 static const int MAX_RIFF_CHUNKS = 16;
 
+static Cvar::Range<Cvar::Cvar<int>> cl_aviQueuedFrames(
+	"cl_aviQueuedFrames", "number of video frames being compressed or written at the same time", Cvar::NONE, 8, 1, 64);
+
 struct audioFormat_t
 {
 	int rate;
@@ -37,6 +41,14 @@ struct audioFormat_t
 	int totalBytes;
 };
 
+struct aviFrame_t
+{
+	std::vector<byte> pixels;
+	std::vector<byte> jpeg;
+	int size; // of the data to write
+	Jobs::JobHandle writeJob;
+};
+
 struct aviFileData_t
 {
 	bool      fileOpen;
@@ -64,6 +76,19 @@ struct aviFileData_t
 	int           chunkStackTop;
 
 	byte          *cBuffer, *eBuffer;
+
+	// Frames go through a pipeline of jobs: motion JPEG frames are compressed
+	// in parallel, then written by a chain of jobs that keeps them in order.
+	// While frames are queued the write jobs own fileSize, moviSize,
+	// numIndices, numVideoFrames and maxRecordSize, the main thread only
+	// tracks an upper bound of the file size in reservedSize. writeFailed is
+	// set by the write jobs and checked by the main thread for every frame.
+	std::deque<std::shared_ptr<aviFrame_t>> queuedFrames;
+	std::vector<std::shared_ptr<aviFrame_t>> freeFrames;
+	Jobs::JobHandle lastWriteJob;
+	int64_t       reservedSize;
+	int           numQueuedFrames;
+	std::atomic<bool> writeFailed;
 };
 
 static aviFileData_t afd;
@@ -331,7 +356,9 @@ bool CL_OpenAVIForWriting( const char *fileName )
 		return false;
 	}
 
-	afd = {};
+	// std::atomic can't be assigned
+	afd.~aviFileData_t();
+	new ( &afd ) aviFileData_t{};
 
 	// Don't start if a framerate has not been chosen
 	if ( cl_aviFrameRate.Get() <= 0 )
@@ -429,6 +456,7 @@ bool CL_OpenAVIForWriting( const char *fileName )
 	SafeFS_Write( buffer, bufIndex, afd.idxF );
 
 	afd.moviSize = 4; // For the "movi"
+	afd.reservedSize = afd.fileSize;
 	afd.fileOpen = true;
 
 	return true;
@@ -436,64 +464,150 @@ bool CL_OpenAVIForWriting( const char *fileName )
 
 /*
 ===============
-CL_CheckFileSize
+CL_RecycleAVIFrames
+
+Takes back the frames which have been written, waiting for the oldest ones
+until fewer than maxQueued frames are in flight
 ===============
 */
-static bool CL_CheckFileSize( int bytesToAdd )
+static void CL_RecycleAVIFrames( size_t maxQueued )
+{
+	while ( !afd.queuedFrames.empty() )
+	{
+		std::shared_ptr<aviFrame_t> &frame = afd.queuedFrames.front();
+
+		if ( afd.queuedFrames.size() >= maxQueued )
+		{
+			Jobs::Wait( frame->writeJob );
+		}
+		else if ( !Jobs::IsDone( frame->writeJob ) )
+		{
+			break;
+		}
+
+		frame->writeJob = nullptr;
+		afd.freeFrames.push_back( std::move( frame ) );
+		afd.queuedFrames.pop_front();
+	}
+
+	if ( afd.queuedFrames.empty() )
+	{
+		afd.lastWriteJob = nullptr;
+	}
+}
+
+/*
+===============
+CL_FlushAVIFrames
+
+Waits until all the queued frames are written
+===============
+*/
+static void CL_FlushAVIFrames()
 {
-	unsigned int newFileSize;
+	CL_RecycleAVIFrames( 0 );
+}
 
-	newFileSize = afd.fileSize + // Current file size
-	              bytesToAdd + // What we want to add
-	              ( afd.numIndices * 16 ) + // The index
-	              4; // The index size
+/*
+===============
+CL_AVISizeBound
+===============
+*/
+static int64_t CL_AVISizeBound( int bytesToAdd )
+{
+	return afd.reservedSize + // Current file size, or more
+	       bytesToAdd + // What we want to add
+	       ( afd.numQueuedFrames * 16 ) + // The index
+	       4; // The index size
+}
 
+/*
+===============
+CL_CheckFileSize
+===============
+*/
+static bool CL_CheckFileSize( int bytesToAdd )
+{
 	// I assume all the operating systems
 	// we target can handle a 2Gb file
-	if ( newFileSize > INT_MAX )
+	if ( CL_AVISizeBound( bytesToAdd ) <= INT_MAX )
 	{
-		// Close the current file...
-		CL_CloseAVI();
+		return false;
+	}
 
-		// ...And open a new one
-		CL_OpenAVIForWriting( va( "%s_", afd.fileName ) );
+	// compressed frames are usually much smaller than the space reserved
+	// for them, so get the real size before deciding
+	CL_FlushAVIFrames();
+	afd.reservedSize = afd.fileSize;
 
-		return true;
+	if ( CL_AVISizeBound( bytesToAdd ) <= INT_MAX )
+	{
+		return false;
 	}
 
-	return false;
+	// Close the current file...
+	CL_CloseAVI();
+
+	// ...And open a new one
+	CL_OpenAVIForWriting( va( "%s_", afd.fileName ) );
+
+	return true;
 }
 
 /*
 ===============
-CL_WriteAVIVideoFrame
+CL_WriteAVIData
+
+Called from the write jobs, which must not throw
 ===============
 */
-void CL_WriteAVIVideoFrame( const byte *imageBuffer, int size )
+static void CL_WriteAVIData( const void *data, int len, fileHandle_t f )
 {
+	if ( !afd.writeFailed && FS_Write( data, len, f ) < len )
+	{
+		afd.writeFailed = true;
+	}
+}
+
+static void CL_PutLittleLong( byte *out, int x )
+{
+	out[ 0 ] = ( byte )( ( x >> 0 ) & 0xFF );
+	out[ 1 ] = ( byte )( ( x >> 8 ) & 0xFF );
+	out[ 2 ] = ( byte )( ( x >> 16 ) & 0xFF );
+	out[ 3 ] = ( byte )( ( x >> 24 ) & 0xFF );
+}
+
+/*
+===============
+CL_WriteAVIFrame
+
+Writes a frame chunk and its index entry, runs in the write jobs
+===============
+*/
+static void CL_WriteAVIFrame( const aviFrame_t &frame )
+{
+	const byte *data = afd.motionJpeg ? frame.jpeg.data() : frame.pixels.data();
+	int  size = frame.size;
 	int  chunkOffset = afd.fileSize - afd.moviOffset - 8;
 	int  chunkSize = 8 + size;
 	int  paddingSize = PAD( size, 2 ) - size;
 	byte padding[ 4 ] = { 0 };
+	byte header[ 8 ];
+	byte index[ 16 ];
 
-	if ( !afd.fileOpen )
+	// the compression job failed and already printed why
+	if ( size == 0 )
 	{
+		afd.writeFailed = true;
 		return;
 	}
 
-	// Chunk header + contents + padding
-	if ( CL_CheckFileSize( 8 + size + 2 ) )
-	{
-		return;
-	}
-
-	bufIndex = 0;
-	WRITE_STRING( "00dc" );
-	WRITE_4BYTES( size );
+	memcpy( header, "00dc", 4 );
+	CL_PutLittleLong( header + 4, size );
 
-	SafeFS_Write( buffer, 8, afd.f );
-	SafeFS_Write( imageBuffer, size, afd.f );
-	SafeFS_Write( padding, paddingSize, afd.f );
+	CL_WriteAVIData( header, sizeof( header ), afd.f );
+	CL_WriteAVIData( data, size, afd.f );
+	CL_WriteAVIData( padding, paddingSize, afd.f );
 	afd.fileSize += ( chunkSize + paddingSize );
 
 	afd.numVideoFrames++;
@@ -505,16 +619,88 @@ void CL_WriteAVIVideoFrame( const byte *imageBuffer, int size )
 	}
 
 	// Index
-	bufIndex = 0;
-	WRITE_STRING( "00dc" );  //dwIdentifier
-	WRITE_4BYTES( 0x00000010 );  //dwFlags (all frames are KeyFrames)
-	WRITE_4BYTES( chunkOffset );  //dwOffset
-	WRITE_4BYTES( size );  //dwLength
-	SafeFS_Write( buffer, 16, afd.idxF );
+	memcpy( index, "00dc", 4 );  //dwIdentifier
+	CL_PutLittleLong( index + 4, 0x00000010 );  //dwFlags (all frames are KeyFrames)
+	CL_PutLittleLong( index + 8, chunkOffset );  //dwOffset
+	CL_PutLittleLong( index + 12, size );  //dwLength
+	CL_WriteAVIData( index, sizeof( index ), afd.idxF );
 
 	afd.numIndices++;
 }
 
+/*
+===============
+CL_WriteAVIVideoFrame
+
+Queues a frame captured by the renderer. Motion JPEG frames are packed RGB
+pixels which are compressed in a job, other frames are written as they are.
+===============
+*/
+void CL_WriteAVIVideoFrame( const byte *imageBuffer, int size )
+{
+	if ( !afd.fileOpen )
+	{
+		return;
+	}
+
+	// the compressed frame fits in the space of the raw one
+	// Chunk header + contents + padding
+	if ( CL_CheckFileSize( 8 + size + 2 ) )
+	{
+		return;
+	}
+
+	CL_RecycleAVIFrames( cl_aviQueuedFrames.Get() );
+
+	if ( afd.writeFailed )
+	{
+		Sys::Drop( "Failed to write avi file" );
+	}
+
+	std::shared_ptr<aviFrame_t> frame;
+
+	if ( afd.freeFrames.empty() )
+	{
+		frame = std::make_shared<aviFrame_t>();
+	}
+	else
+	{
+		frame = std::move( afd.freeFrames.back() );
+		afd.freeFrames.pop_back();
+	}
+
+	frame->pixels.assign( imageBuffer, imageBuffer + size );
+	frame->size = size;
+
+	std::vector<Jobs::JobHandle> dependencies;
+
+	if ( afd.motionJpeg )
+	{
+		int width = afd.width;
+		int height = afd.height;
+
+		dependencies.push_back( Jobs::Submit( [ frame, width, height ] {
+			frame->jpeg.resize( frame->pixels.size() );
+			frame->size = re.SaveJPGToBuffer( frame->jpeg.data(), frame->jpeg.size(), 90,
+			                                  width, height, frame->pixels.data() );
+		} ) );
+	}
+
+	if ( afd.lastWriteJob )
+	{
+		dependencies.push_back( afd.lastWriteJob );
+	}
+
+	frame->writeJob = Jobs::Submit( [ frame ] {
+		CL_WriteAVIFrame( *frame );
+	}, dependencies );
+
+	afd.lastWriteJob = frame->writeJob;
+	afd.queuedFrames.push_back( std::move( frame ) );
+	afd.reservedSize += 8 + PAD( size, 2 );
+	afd.numQueuedFrames++;
+}
+
 /*
 ===============
 CL_TakeVideoFrame
@@ -541,7 +727,7 @@ Closes the AVI file and writes an index chunk
 bool CL_CloseAVI()
 {
 	int        indexRemainder;
-	int        indexSize = afd.numIndices * 16;
+	int        indexSize;
 	const char *idxFileName = va( "%s" INDEX_FILE_EXTENSION, afd.fileName );
 
 	// AVI file isn't open
@@ -550,8 +736,17 @@ bool CL_CloseAVI()
 		return false;
 	}
 
+	CL_FlushAVIFrames();
+	afd.freeFrames.clear();
 	afd.fileOpen = false;
 
+	if ( afd.writeFailed )
+	{
+		Log::Warn( "Failed to write some frames to %s", afd.fileName );
+	}
+
+	indexSize = afd.numIndices * 16;
+
 	FS_Seek( afd.idxF, 4, fsOrigin_t::FS_SEEK_SET );
 	bufIndex = 0;
 	WRITE_4BYTES( indexSize );
@@ -890,7 +890,12 @@ void CL_SetCGameTime()
 		{
 			clc.timeDemoStart = Sys::Milliseconds();
 		}
+		else
+		{
+			clc.timeDemoFrameTimes.push_back( Sys::SteadyClock::now() - clc.timeDemoLastFrame );
+		}
 
+		clc.timeDemoLastFrame = Sys::SteadyClock::now();
 		clc.timeDemoFrames++;
 		cl.serverTime = clc.timeDemoBaseTime + clc.timeDemoFrames * 50;
 	}
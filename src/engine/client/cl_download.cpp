@@ -408,7 +408,7 @@ void CL_ParseDownload( msg_t *msg )
 				return;
 			}
 
-			if ( !DL_BeginDownload( cls.downloadTempName, cls.downloadName, basePathLen ) )
+			if ( !DL_BeginDownload( cls.downloadTempName, cls.downloadName, basePathLen, clc.downloadSize ) )
 			{
 				// setting bWWWDl to false after sending the wwwdl fail doesn't work
 				// not sure why, but I suspect we have to eat all remaining block -1 that the server has sent us
@@ -926,7 +926,8 @@ void CL_WritePacket()
 		}
 
 		// begin a client move command
-		if ( cl_nodelta.Get() || !cl.snap.valid || clc.demowaiting || clc.serverMessageSequence != cl.snap.messageNum )
+		if ( cl_nodelta.Get() || !cl.snap.valid || clc.demowaiting || clc.demoKeyframePending
+		     || clc.serverMessageSequence != cl.snap.messageNum )
 		{
 			MSG_WriteByte( &buf, clc_moveNoDelta );
 		}
@@ -89,6 +89,20 @@ Cvar::Cvar<std::string> cvar_demo_status_filename(
     ""
 );
 
+static Cvar::Range<Cvar::Cvar<int>> cvar_demo_keyframeInterval(
+    "demo.keyframeInterval",
+    "Seconds between the points of recorded demos where demo_seek can jump, 0 to disable",
+    Cvar::NONE,
+    30, 0, 3600
+);
+
+static Cvar::Cvar<bool> cvar_demo_timedemoLog(
+    "demo.timedemoLog",
+    "Whether to write the time of each frame of a timedemo to timedemo/<demoname>.csv",
+    Cvar::NONE,
+    false
+);
+
 Cvar::Cvar<int> cl_aviFrameRate("cl_aviFrameRate", "demo video framerate", Cvar::NONE, 25);
 
 Cvar::Cvar<bool> cl_freelook("cl_freelook", "vertical mouse movement always controls pitch", Cvar::NONE, true);
@@ -236,6 +250,27 @@ CLIENT SIDE DEMO RECORDING
 =======================================================================
 */
 
+/*
+Demo files are a sequence of (sequence, length, message) records, ended by a
+(-1, -1) record. The first message is the gamestate. Keyframe records, with
+DEMO_KEYFRAME_SEQUENCE as sequence, hold a copy of the gamestate right before a
+message with a non-delta snapshot: playback can start from there. The end
+record is followed by the seek index, the demoKeyframe_t and a demoIndexTrailer_t.
+*/
+static const int DEMO_KEYFRAME_SEQUENCE = -2;
+static const char DEMO_INDEX_MAGIC[ 4 ] = { 'D', 'I', 'D', 'X' };
+static const int DEMO_INDEX_VERSION = 1;
+// Protects against corrupted indexes, this is a keyframe per second during a day
+static const int MAX_DEMO_KEYFRAMES = 24 * 60 * 60;
+
+struct demoIndexTrailer_t
+{
+	int  offset;
+	int  numKeyframes;
+	int  version;
+	char magic[ 4 ];
+};
+
 /*
 ====================
 CL_WriteDemoMessage
@@ -260,6 +295,119 @@ void CL_WriteDemoMessage( msg_t *msg, int headerBytes )
 }
 
 
+/*
+====================
+CL_WriteDemoGamestate
+
+Writes a gamestate message with the current configstrings and baselines,
+the server commands after commandSequence are played after it
+====================
+*/
+static void CL_WriteDemoGamestate( int sequence, int commandSequence )
+{
+    msg_t buf;
+    byte bufData[ MAX_MSGLEN ];
+    // write out the gamestate message
+    MSG_Init( &buf, bufData, sizeof( bufData ) );
+    MSG_Bitstream( &buf );
+
+    // NOTE, MRE: all server->client messages now acknowledge
+    MSG_WriteLong( &buf, clc.reliableSequence );
+
+    MSG_WriteByte( &buf, svc_gamestate );
+    MSG_WriteLong( &buf, commandSequence );
+
+
+    // configstrings
+    for ( int i = 0; i < MAX_CONFIGSTRINGS; i++ )
+    {
+        if ( cl.gameState[i].empty() )
+        {
+            continue;
+        }
+
+        MSG_WriteByte( &buf, svc_configstring );
+        MSG_WriteShort( &buf, i );
+        MSG_WriteBigString( &buf, cl.gameState[i].c_str() );
+    }
+
+    // baselines
+    entityState_t nullstate{};
+
+    for ( int i = 0; i < MAX_GENTITIES; i++ )
+    {
+        entityState_t *ent = &cl.entityBaselines[ i ];
+
+        if ( !ent->number )
+        {
+            continue;
+        }
+
+        MSG_WriteByte( &buf, svc_baseline );
+        MSG_WriteDeltaEntity( &buf, &nullstate, ent, true );
+    }
+
+    MSG_WriteByte( &buf, svc_EOF );
+
+    // finished writing the gamestate stuff
+
+    // write the client num
+    MSG_WriteLong( &buf, clc.clientNum );
+
+    // finished writing the client packet
+    MSG_WriteByte( &buf, svc_EOF );
+
+    // write it to the demo file
+    int len = LittleLong( sequence );
+    FS_Write( &len, 4, clc.demofile );
+
+    len = LittleLong( buf.cursize );
+    FS_Write( &len, 4, clc.demofile );
+    FS_Write( buf.data, buf.cursize, clc.demofile );
+}
+
+/*
+====================
+CL_CheckDemoKeyframe
+
+Called for each recorded message. The first non-delta snapshot starts the
+first keyframe, which is the start of the demo. Then keyframes are written
+before the non-delta snapshots, requested every demo.keyframeInterval seconds.
+The message is already parsed, commandSequence is the last server command
+received before it, so that its commands are played after the keyframe.
+====================
+*/
+static void CL_CheckDemoKeyframe( int commandSequence )
+{
+	int interval = cvar_demo_keyframeInterval.Get() * 1000;
+
+	if ( clc.demoKeyframes.empty() )
+	{
+		if ( clc.demoNonDeltaSnapshot )
+		{
+			clc.demoKeyframes.push_back( { cl.snap.serverTime, 0 } );
+		}
+		return;
+	}
+
+	if ( !interval || cl.snap.serverTime - clc.demoKeyframes.back().serverTime < interval )
+	{
+		return;
+	}
+
+	if ( !clc.demoNonDeltaSnapshot )
+	{
+		// ask the server for a non-delta snapshot, see CL_WritePacket
+		clc.demoKeyframePending = true;
+		return;
+	}
+
+	int offset = FS_FTell( clc.demofile );
+	CL_WriteDemoGamestate( DEMO_KEYFRAME_SEQUENCE, commandSequence );
+	clc.demoKeyframes.push_back( { cl.snap.serverTime, offset } );
+	clc.demoKeyframePending = false;
+}
+
 /**
  * If a demo is being recorded, this stops it
  */
@@ -272,10 +420,27 @@ static void CL_StopRecord()
     int len = -1;
     FS_Write( &len, 4, clc.demofile );
     FS_Write( &len, 4, clc.demofile );
+
+    // then the seek index
+    demoIndexTrailer_t trailer;
+    trailer.offset = LittleLong( FS_FTell( clc.demofile ) );
+    trailer.numKeyframes = LittleLong( clc.demoKeyframes.size() );
+    trailer.version = LittleLong( DEMO_INDEX_VERSION );
+    memcpy( trailer.magic, DEMO_INDEX_MAGIC, sizeof( trailer.magic ) );
+
+    for ( const demoKeyframe_t& keyframe : clc.demoKeyframes )
+    {
+        demoKeyframe_t swapped = { LittleLong( keyframe.serverTime ), LittleLong( keyframe.offset ) };
+        FS_Write( &swapped, sizeof( swapped ), clc.demofile );
+    }
+
+    FS_Write( &trailer, sizeof( trailer ), clc.demofile );
     FS_FCloseFile( clc.demofile );
     clc.demofile = 0;
 
     clc.demorecording = false;
+    clc.demoKeyframePending = false;
+    clc.demoKeyframes.clear();
     Cvar::SetValueForce(cvar_demo_status_isrecording.Name(), "0");
     Cvar::SetValueForce(cvar_demo_status_filename.Name(), "");
     Log::Notice("Stopped demo." );
@@ -392,84 +557,92 @@ void CL_Record(std::string demo_name)
 
     // don't start saving messages until a non-delta compressed message is received
     clc.demowaiting = true;
+    clc.demoKeyframes.clear();
 
-    msg_t buf;
-    byte bufData[ MAX_MSGLEN ];
-    // write out the gamestate message
-    MSG_Init( &buf, bufData, sizeof( bufData ) );
-    MSG_Bitstream( &buf );
-
-    // NOTE, MRE: all server->client messages now acknowledge
-    MSG_WriteLong( &buf, clc.reliableSequence );
-
-    MSG_WriteByte( &buf, svc_gamestate );
-    MSG_WriteLong( &buf, clc.serverCommandSequence );
+    CL_WriteDemoGamestate( clc.serverMessageSequence - 1, clc.serverCommandSequence );
 
+    // the rest of the demo file will be copied from net messages
+}
 
-    // configstrings
-    for ( int i = 0; i < MAX_CONFIGSTRINGS; i++ )
-    {
-        if ( cl.gameState[i].empty() )
-        {
-            continue;
-        }
+/*
+=======================================================================
 
-        MSG_WriteByte( &buf, svc_configstring );
-        MSG_WriteShort( &buf, i );
-        MSG_WriteBigString( &buf, cl.gameState[i].c_str() );
-    }
+CLIENT SIDE DEMO PLAYBACK
 
-    // baselines
-    entityState_t nullstate{};
+=======================================================================
+*/
 
-    for ( int i = 0; i < MAX_GENTITIES; i++ )
-    {
-        entityState_t *ent = &cl.entityBaselines[ i ];
+/*
+=================
+CL_TimeDemoFrameStats
 
-        if ( !ent->number )
-        {
-            continue;
-        }
+Prints the distribution of the frame times of a timedemo and writes them
+to a file if demo.timedemoLog is set, to track performance regressions.
+=================
+*/
+static void CL_TimeDemoFrameStats()
+{
+	std::vector<Sys::SteadyClock::duration> times = clc.timeDemoFrameTimes;
 
-        MSG_WriteByte( &buf, svc_baseline );
-        MSG_WriteDeltaEntity( &buf, &nullstate, ent, true );
-    }
+	if ( times.empty() )
+	{
+		return;
+	}
 
-    MSG_WriteByte( &buf, svc_EOF );
+	std::sort( times.begin(), times.end() );
 
-    // finished writing the gamestate stuff
+	auto Milliseconds = []( Sys::SteadyClock::duration time ) {
+		return std::chrono::duration<double, std::milli>( time ).count();
+	};
+	auto Percentile = [ & ]( int percent ) {
+		return Milliseconds( times[ ( times.size() - 1 ) * percent / 100 ] );
+	};
 
-    // write the client num
-    MSG_WriteLong( &buf, clc.clientNum );
+	Log::Notice( "frame times: min %.2fms, median %.2fms, 95%% %.2fms, 99%% %.2fms, max %.2fms",
+	             Milliseconds( times.front() ), Percentile( 50 ), Percentile( 95 ), Percentile( 99 ),
+	             Milliseconds( times.back() ) );
 
-    // finished writing the client packet
-    MSG_WriteByte( &buf, svc_EOF );
+	if ( !cvar_demo_timedemoLog.Get() )
+	{
+		return;
+	}
 
-    // write it to the demo file
-    int len = LittleLong( clc.serverMessageSequence - 1 );
-    FS_Write( &len, 4, clc.demofile );
+	std::string log = "frame,milliseconds\n";
 
-    len = LittleLong( buf.cursize );
-    FS_Write( &len, 4, clc.demofile );
-    FS_Write( buf.data, buf.cursize, clc.demofile );
+	for ( size_t i = 0; i < clc.timeDemoFrameTimes.size(); i++ )
+	{
+		log += Str::Format( "%d,%.3f\n", i, Milliseconds( clc.timeDemoFrameTimes[ i ] ) );
+	}
 
-    // the rest of the demo file will be copied from net messages
-}
+	std::string path = Str::Format( "timedemo/%s.csv", FS::Path::StripExtension( FS::Path::BaseName( clc.demoName ) ) );
+	std::error_code err;
+	FS::File file = FS::HomePath::OpenWrite( path, err );
 
-/*
-=======================================================================
+	if ( !err )
+	{
+		file.Write( log.data(), log.size(), err );
+	}
 
-CLIENT SIDE DEMO PLAYBACK
+	if ( !err )
+	{
+		file.Close( err );
+	}
 
-=======================================================================
-*/
+	if ( err )
+	{
+		Log::Warn( "Couldn't write %s: %s", path, err.message() );
+	}
+	else
+	{
+		Log::Notice( "Wrote the frame times to %s", path );
+	}
+}
 
 /*
 =================
 CL_DemoCompleted
 =================
 */
-
 NORETURN static void CL_DemoCompleted()
 {
 	if ( cvar_demo_timedemo.Get() )
@@ -483,6 +656,8 @@ NORETURN static void CL_DemoCompleted()
 			Log::Notice( "%i frames, %3.1fs: %3.1f fps", clc.timeDemoFrames,
 			            time / 1000.0, clc.timeDemoFrames * 1000.0 / time );
 		}
+
+		CL_TimeDemoFrameStats();
 	}
 
 	throw Sys::DropErr(false, "Demo completed");
@@ -506,28 +681,45 @@ void CL_ReadDemoMessage()
 		CL_DemoCompleted();
 	}
 
-	// get the sequence number
-	r = FS_Read( &s, 4, clc.demofile );
+	// init the message
+	MSG_Init( &buf, bufData, sizeof( bufData ) );
 
-	if ( r != 4 )
+	while ( true )
 	{
-		CL_DemoCompleted();
-	}
+		// get the sequence number
+		r = FS_Read( &s, 4, clc.demofile );
 
-	clc.serverMessageSequence = LittleLong( s );
+		if ( r != 4 )
+		{
+			CL_DemoCompleted();
+		}
 
-	// init the message
-	MSG_Init( &buf, bufData, sizeof( bufData ) );
+		s = LittleLong( s );
 
-	// get the length
-	r = FS_Read( &buf.cursize, 4, clc.demofile );
+		// get the length
+		r = FS_Read( &buf.cursize, 4, clc.demofile );
 
-	if ( r != 4 )
-	{
-		CL_DemoCompleted();
+		if ( r != 4 )
+		{
+			CL_DemoCompleted();
+		}
+
+		buf.cursize = LittleLong( buf.cursize );
+
+		// keyframes are only needed when the playback starts from them
+		if ( s == DEMO_KEYFRAME_SEQUENCE && cls.state >= connstate_t::CA_PRIMED && buf.cursize > 0 )
+		{
+			FS_Seek( clc.demofile, buf.cursize, fsOrigin_t::FS_SEEK_CUR );
+			continue;
+		}
+
+		break;
 	}
 
-	buf.cursize = LittleLong( buf.cursize );
+	if ( s != DEMO_KEYFRAME_SEQUENCE )
+	{
+		clc.serverMessageSequence = s;
+	}
 
 	if ( buf.cursize == -1 )
 	{
@@ -553,21 +745,104 @@ void CL_ReadDemoMessage()
 }
 
 
+/*
+=================
+CL_ReadDemoIndex
+
+Reads the seek index at the end of the demo file, returns false if there is none.
+=================
+*/
+static bool CL_ReadDemoIndex()
+{
+	clc.demoKeyframes.clear();
+
+	demoIndexTrailer_t trailer;
+	FS_Seek( clc.demofile, -int( sizeof( trailer ) ), fsOrigin_t::FS_SEEK_END );
+
+	bool valid = FS_Read( &trailer, sizeof( trailer ), clc.demofile ) == sizeof( trailer )
+		&& !memcmp( trailer.magic, DEMO_INDEX_MAGIC, sizeof( trailer.magic ) )
+		&& LittleLong( trailer.version ) == DEMO_INDEX_VERSION;
+
+	int numKeyframes = valid ? LittleLong( trailer.numKeyframes ) : 0;
+
+	if ( valid && numKeyframes > 0 && numKeyframes < MAX_DEMO_KEYFRAMES )
+	{
+		clc.demoKeyframes.resize( numKeyframes );
+		FS_Seek( clc.demofile, LittleLong( trailer.offset ), fsOrigin_t::FS_SEEK_SET );
+		int size = numKeyframes * sizeof( demoKeyframe_t );
+
+		if ( FS_Read( clc.demoKeyframes.data(), size, clc.demofile ) == size )
+		{
+			for ( demoKeyframe_t& keyframe : clc.demoKeyframes )
+			{
+				keyframe.serverTime = LittleLong( keyframe.serverTime );
+				keyframe.offset = LittleLong( keyframe.offset );
+			}
+		}
+		else
+		{
+			clc.demoKeyframes.clear();
+		}
+	}
+
+	FS_Seek( clc.demofile, 0, fsOrigin_t::FS_SEEK_SET );
+
+	return !clc.demoKeyframes.empty();
+}
+
+/*
+=================
+CL_SeekDemoKeyframe
+
+Moves to the last keyframe at most the given number of seconds into the demo.
+=================
+*/
+static void CL_SeekDemoKeyframe( int seconds )
+{
+	if ( clc.demoKeyframes.empty() )
+	{
+		Log::Warn( "The demo has no seek index, playing it from the start." );
+		return;
+	}
+
+	int targetTime = clc.demoKeyframes.front().serverTime + seconds * 1000;
+	const demoKeyframe_t* keyframe = &clc.demoKeyframes.front();
+
+	for ( const demoKeyframe_t& candidate : clc.demoKeyframes )
+	{
+		if ( candidate.serverTime > targetTime )
+		{
+			break;
+		}
+
+		keyframe = &candidate;
+	}
+
+	FS_Seek( clc.demofile, keyframe->offset, fsOrigin_t::FS_SEEK_SET );
+	Log::Notice( "Starting the demo %ds in.", ( keyframe->serverTime - clc.demoKeyframes.front().serverTime ) / 1000 );
+}
+
 class DemoPlayCmd: public Cmd::StaticCmd {
     public:
         DemoPlayCmd(): Cmd::StaticCmd("demo_play", Cmd::CLIENT, "Starts playing a demo file") {
         }
 
         void Run(const Cmd::Args& args) const override {
-            if (args.Argc() != 2) {
-                PrintUsage(args, "<demoname>", "starts playing a demo file");
+            if (args.Argc() != 2 && args.Argc() != 3) {
+                PrintUsage(args, "<demoname> [seconds]", "starts playing a demo file, from the given time if it has a seek index");
+                return;
+            }
+
+            int startTime = 0;
+            if (args.Argc() == 3 && (!Str::ParseInt(startTime, args.Argv(2)) || startTime < 0)) {
+                PrintUsage(args, "<demoname> [seconds]", "starts playing a demo file, from the given time if it has a seek index");
                 return;
             }
 
             if (com_sv_running.Get()) {
                 // Use /disconnect to shut everything down cleanly.
                 // Maybe we should also do that if there is an online connection or another demo?
-                Cmd::BufferCommandTextAfter("disconnect; demo_play " + Cmd::Escape(args.Argv(1)));
+                Cmd::BufferCommandTextAfter("disconnect; demo_play " + Cmd::Escape(args.Argv(1)) + " " + std::to_string(startTime));
                 return;
             }
 
@@ -599,6 +874,12 @@ class DemoPlayCmd: public Cmd::StaticCmd {
 
             Q_strncpyz(clc.demoName, arg, sizeof(clc.demoName));
 
+            CL_ReadDemoIndex();
+
+            if (startTime > 0) {
+                CL_SeekDemoKeyframe(startTime);
+            }
+
             Con_Close();
 
             cls.state = connstate_t::CA_CONNECTED;
@@ -624,6 +905,43 @@ class DemoPlayCmd: public Cmd::StaticCmd {
 };
 static DemoPlayCmd DemoPlayCmdRegistration;
 
+class DemoSeekCmd: public Cmd::StaticCmd {
+    public:
+        DemoSeekCmd(): Cmd::StaticCmd("demo_seek", Cmd::CLIENT, "Restarts the demo being played from a given time") {
+        }
+
+        void Run(const Cmd::Args& args) const override {
+            int seconds;
+            const std::string& arg = args.Argc() == 2 ? args.Argv(1) : "";
+            bool relative = !arg.empty() && (arg[0] == '+' || arg[0] == '-');
+
+            if (args.Argc() != 2 || !Str::ParseInt(seconds, relative ? arg.substr(1) : arg)) {
+                PrintUsage(args, "[+|-]<seconds>", "jumps to the last keyframe before the given time in the demo");
+                return;
+            }
+
+            if (!clc.demoplaying) {
+                Print("Not playing a demo.");
+                return;
+            }
+
+            if (clc.demoKeyframes.empty()) {
+                Print("This demo has no seek index.");
+                return;
+            }
+
+            if (relative) {
+                int currentTime = (cl.snap.serverTime - clc.demoKeyframes.front().serverTime) / 1000;
+                seconds = arg[0] == '+' ? currentTime + seconds : currentTime - seconds;
+            }
+
+            // Reloads the map from the keyframe's gamestate
+            std::string demoName = clc.demoName;
+            Cmd::BufferCommandTextAfter("disconnect; demo_play " + Cmd::Escape(demoName) + " " + std::to_string(std::max(seconds, 0)));
+        }
+};
+static DemoSeekCmd DemoSeekCmdRegistration;
+
 // stop demo recording and playback
 static void StopDemos()
 {
@@ -1934,6 +2252,7 @@ void CL_PacketEvent( const netadr_t& from, msg_t *msg )
 	clc.serverMessageSequence = LittleLong( * ( int * ) msg->data );
 
 	clc.lastPacketTime = cls.realtime;
+	int commandSequence = clc.serverCommandSequence;
 	CL_ParseServerMessage( msg );
 
 	//
@@ -1943,8 +2262,11 @@ void CL_PacketEvent( const netadr_t& from, msg_t *msg )
 
 	if ( clc.demorecording && !clc.demowaiting )
 	{
+		CL_CheckDemoKeyframe( commandSequence );
 		CL_WriteDemoMessage( msg, headerBytes );
 	}
+
+	clc.demoNonDeltaSnapshot = false;
 }
 
 /*
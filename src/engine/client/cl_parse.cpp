@@ -60,6 +60,95 @@ static void SHOWNET( msg_t *msg, const char *s )
 /*
 =========================================================================
 
+SNAPSHOT PARSE STATISTICS
+
+cl_shownet -3 collects the time spent parsing each snapshot and its size, and
+prints them as power of two histograms every SNAPSHOT_STATS_PERIOD snapshots.
+
+=========================================================================
+*/
+
+static const int SNAPSHOT_STATS_PERIOD = 256;
+static const int SNAPSHOT_STATS_BUCKETS = 16;
+
+struct snapshotParseStats_t
+{
+	int numSnapshots;
+	int numEntities;
+	int timeBuckets[ SNAPSHOT_STATS_BUCKETS ]; // microseconds
+	int sizeBuckets[ SNAPSHOT_STATS_BUCKETS ]; // bytes
+	Sys::SteadyClock::duration maxTime;
+	int maxSize;
+};
+
+static snapshotParseStats_t snapshotParseStats;
+
+static int CL_SnapshotStatsBucket( int value )
+{
+	int bucket = 0;
+
+	while ( value > 1 && bucket < SNAPSHOT_STATS_BUCKETS - 1 )
+	{
+		value >>= 1;
+		bucket++;
+	}
+
+	return bucket;
+}
+
+static void CL_PrintSnapshotHistogram( const char *title, const char *unit, const int *buckets )
+{
+	int largest = 1;
+	int last = 0;
+
+	for ( int i = 0; i < SNAPSHOT_STATS_BUCKETS; i++ )
+	{
+		if ( buckets[ i ] )
+		{
+			largest = std::max( largest, buckets[ i ] );
+			last = i;
+		}
+	}
+
+	Log::Notice( "%s:", title );
+
+	for ( int i = 0; i <= last; i++ )
+	{
+		int bar = buckets[ i ] * 40 / largest;
+		Log::Notice( "  < %6i %s %5i %s", 2 << i, unit, buckets[ i ], std::string( bar, '#' ) );
+	}
+}
+
+static void CL_SnapshotParseStats( int size, int numEntities, Sys::SteadyClock::duration time )
+{
+	snapshotParseStats_t &stats = snapshotParseStats;
+	int micros = std::chrono::duration_cast<std::chrono::microseconds>( time ).count();
+
+	stats.numSnapshots++;
+	stats.numEntities += numEntities;
+	stats.timeBuckets[ CL_SnapshotStatsBucket( micros ) ]++;
+	stats.sizeBuckets[ CL_SnapshotStatsBucket( size ) ]++;
+	stats.maxTime = std::max( stats.maxTime, time );
+	stats.maxSize = std::max( stats.maxSize, size );
+
+	if ( stats.numSnapshots < SNAPSHOT_STATS_PERIOD )
+	{
+		return;
+	}
+
+	Log::Notice( "%i snapshots, %.1f entities on average, longest parse %ius, largest %i bytes",
+	             stats.numSnapshots, float( stats.numEntities ) / stats.numSnapshots,
+	             int( std::chrono::duration_cast<std::chrono::microseconds>( stats.maxTime ).count() ),
+	             stats.maxSize );
+	CL_PrintSnapshotHistogram( "parse time", "us", stats.timeBuckets );
+	CL_PrintSnapshotHistogram( "size", "bytes", stats.sizeBuckets );
+
+	stats = {};
+}
+
+/*
+=========================================================================
+
 MESSAGE PARSING
 
 =========================================================================
@@ -69,11 +158,14 @@ MESSAGE PARSING
 // number, then we could grab the entity number from old directly, simplifying code a bit.
 void CL_DeltaEntity( msg_t *msg, clSnapshot_t *snapshot, int entityNum, const entityState_t &oldEntity)
 {
-    entityState_t entity;
+    // decode straight into the new snapshot, and take the slot back if the
+    // entity was removed
+    snapshot->entities.emplace_back();
+    entityState_t& entity = snapshot->entities.back();
     MSG_ReadDeltaEntity(msg, &oldEntity, &entity, entityNum);
 
-    if (entity.number != MAX_GENTITIES - 1) {
-        snapshot->entities.push_back(entity);
+    if (entity.number == MAX_GENTITIES - 1) {
+        snapshot->entities.pop_back();
     }
 }
 
@@ -187,6 +279,15 @@ void CL_ParseSnapshot( msg_t *msg )
 	// we will only copy to cl.snap if it is valid
 	clSnapshot_t newSnap{};
 
+	bool collectStats = cl_shownet->integer == -3;
+	Sys::SteadyClock::time_point parseStart;
+	int startCount = msg->readcount;
+
+	if ( collectStats )
+	{
+		parseStart = Sys::SteadyClock::now();
+	}
+
 	// we will have read any new server commands in this
 	// message before we got to svc_snapshot
 	newSnap.serverCommandNum = clc.serverCommandSequence;
@@ -220,6 +321,7 @@ void CL_ParseSnapshot( msg_t *msg )
 		if ( clc.demorecording )
 		{
 			clc.demowaiting = false; // we can start recording now
+			clc.demoNonDeltaSnapshot = true; // a keyframe can be written before this message
 		}
 		else
 		{
@@ -276,6 +378,12 @@ void CL_ParseSnapshot( msg_t *msg )
 	SHOWNET( msg, "packet entities" );
 	CL_ParsePacketEntities( msg, old, &newSnap );
 
+	if ( collectStats )
+	{
+		CL_SnapshotParseStats( msg->readcount - startCount, newSnap.entities.size(),
+		                       Sys::SteadyClock::now() - parseStart );
+	}
+
 	// if not valid, dump the entire thing now that it has
 	// been properly read
 	if ( !newSnap.valid )
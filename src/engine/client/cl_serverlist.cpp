@@ -44,8 +44,6 @@ Maryland 20850 USA.
 #include "engine/framework/Crypto.h"
 #include "engine/framework/Network.h"
 
-#define MAX_PINGREQUESTS         16
-
 static Log::Logger serverInfoLog("client.serverinfo", "");
 
 static Cvar::Cvar<std::string> cl_gamename(
@@ -54,6 +52,11 @@ static Cvar::Cvar<std::string> cl_gamename(
 static Cvar::Range<Cvar::Cvar<int>> cl_maxPing(
 	"cl_maxPing", "ping timeout for server list", Cvar::NONE, 800, 100, 9999);
 
+static Cvar::Range<Cvar::Cvar<int>> cl_maxPingRequests(
+	"cl_maxPingRequests", "maximum number of outstanding server list pings", Cvar::NONE, 256, 1, MAX_GLOBAL_SERVERS);
+static Cvar::Range<Cvar::Cvar<int>> cl_pingBatchSize(
+	"cl_pingBatchSize", "number of ping packets sent together every ping spacing interval", Cvar::NONE, 16, 1, 1024);
+
 constexpr int PING_MAX_ATTEMPTS = 3;
 static Cvar::Range<Cvar::Cvar<int>> pingSpacing[ PING_MAX_ATTEMPTS ] {
 	{"cl_pingSpacing", "milliseconds between ping packets (1st attempt)", Cvar::NONE, 5, 0, 5000},
@@ -71,9 +74,58 @@ struct ping_t
 	char     info[ MAX_INFO_STRING ];
 };
 
-ping_t             cl_pinglist[ MAX_PINGREQUESTS ];
+// Outstanding and completed pings, and the server list entries, are looked up
+// by a byte string built from the address so that responses are matched
+// without scanning the lists
+using addressKey_t = std::string;
+
+static std::unordered_map<addressKey_t, ping_t> pings;
+static std::unordered_map<addressKey_t, int> globalServerIndex;
+static std::unordered_map<addressKey_t, int> localServerIndex;
+static std::unordered_map<addressKey_t, unsigned> serverLinkIndex;
 static int lastPingSendTime = -99999;
 
+/*
+===================
+CL_AddressKey
+
+Returns an empty key for addresses which can't send a response
+===================
+*/
+static addressKey_t CL_AddressKey( const netadr_t &adr )
+{
+	addressKey_t key;
+	netadrtype_t type = NET_TYPE( adr.type );
+
+	switch ( type )
+	{
+		case netadrtype_t::NA_LOOPBACK:
+			key.push_back( 'L' );
+			return key;
+
+		case netadrtype_t::NA_IP:
+			key.push_back( '4' );
+			key.append( reinterpret_cast<const char *>( adr.ip ), sizeof( adr.ip ) );
+			break;
+
+		case netadrtype_t::NA_IP6:
+			key.push_back( '6' );
+			key.append( reinterpret_cast<const char *>( adr.ip6 ), sizeof( adr.ip6 ) );
+			break;
+
+		default:
+			return key;
+	}
+
+	key.append( reinterpret_cast<const char *>( &adr.port ), sizeof( adr.port ) );
+	return key;
+}
+
+static void CL_ClearGlobalServerIndex()
+{
+	globalServerIndex.clear();
+}
+
 /*
 ===================
 CL_InitServerInfo
@@ -137,6 +189,7 @@ static int CL_GSRSequenceInformation( byte **data )
 		// between - only use the results that arrive later
 		Log::Debug( "Master changed its mind about packet count!" );
 		cls.numglobalservers = 0;
+		CL_ClearGlobalServerIndex();
 	}
 
 	cls.numMasterPackets = num;
@@ -199,6 +252,7 @@ void CL_ServerLinksResponsePacket( msg_t *msg )
 
 	// parse through server response string
 	cls.numserverLinks = 0;
+	serverLinkIndex.clear();
 	buffptr = msg->data + 31; // skip header
 	buffend = msg->data + msg->cursize;
 
@@ -221,6 +275,15 @@ void CL_ServerLinksResponsePacket( msg_t *msg )
 		cls.serverLinks[ cls.numserverLinks ].port6 = UBigShort( port );
 		buffptr += 18;
 
+		// index both halves of the pair, so that either address finds the link
+		netadr_t half = cls.serverLinks[ cls.numserverLinks ];
+		half.type = netadrtype_t::NA_IP;
+		half.port = half.port4;
+		serverLinkIndex.emplace( CL_AddressKey( half ), cls.numserverLinks );
+		half.type = netadrtype_t::NA_IP6;
+		half.port = half.port6;
+		serverLinkIndex.emplace( CL_AddressKey( half ), cls.numserverLinks );
+
 		++cls.numserverLinks;
 	}
 
@@ -250,6 +313,7 @@ void CL_ServersResponsePacket( const netadr_t *from, msg_t *msg, bool extended )
 		// state to detect lack of servers or lack of response
 		cls.numglobalservers = 0;
 		cls.numMasterPackets = 0;
+		CL_ClearGlobalServerIndex();
 	}
 
 	// parse through server response string
@@ -320,47 +384,45 @@ void CL_ServersResponsePacket( const netadr_t *from, msg_t *msg, bool extended )
 			port += *buffptr++;
 			port = UBigShort( port );;
 
-			// deduplicate server list, do not add known server
-			for ( int i = 0; i < cls.numglobalservers; i++ )
-			{
-				if ( cls.globalServers[ i ].adr.port == port && !memcmp( cls.globalServers[ i ].adr.ip, ip, sizeof( ip ) ) )
-				{
-					duplicate = true;
-					duplicate_count++;
-					break;
-				}
-			}
-
 			memcpy( addresses[ numservers ].ip, ip, sizeof( ip ) );
 
 			addresses[ numservers ].port = port;
 			addresses[ numservers ].type = netadrtype_t::NA_IP;
+			addressKey_t key = CL_AddressKey( addresses[ numservers ] );
+
+			// deduplicate server list, do not add known server
+			if ( globalServerIndex.count( key ) )
+			{
+				duplicate = true;
+				duplicate_count++;
+			}
 
 			// look up this address in the links list
-			for (unsigned j = 0; j < cls.numserverLinks && !duplicate; ++j )
+			auto link = serverLinkIndex.find( key );
+
+			if ( !duplicate && link != serverLinkIndex.end() )
 			{
-				if ( addresses[ numservers ].port == cls.serverLinks[ j ].port4 && !memcmp( addresses[ numservers ].ip, cls.serverLinks[ j ].ip, sizeof( addresses[ numservers ].ip ) ) )
-				{
-					// found it, so look up the corresponding address
+				unsigned j = link->second;
+
+				// found it, so look up the corresponding address
 
-					// hax to get the IP address & port as a string (memcmp etc. SHOULD work, but...)
-					cls.serverLinks[ j ].type = netadrtype_t::NA_IP6;
-					cls.serverLinks[ j ].port = cls.serverLinks[ j ].port6;
-					std::string s = Net::AddressToString( cls.serverLinks[ j ], true );
-					cls.serverLinks[j].type = netadrtype_t::NA_IP_DUAL;
+				// hax to get the IP address & port as a string (memcmp etc. SHOULD work, but...)
+				cls.serverLinks[ j ].type = netadrtype_t::NA_IP6;
+				cls.serverLinks[ j ].port = cls.serverLinks[ j ].port6;
+				std::string s = Net::AddressToString( cls.serverLinks[ j ], true );
+				cls.serverLinks[j].type = netadrtype_t::NA_IP_DUAL;
 
-					for ( int i = 0; i < numservers; ++i )
+				for ( int i = 0; i < numservers; ++i )
+				{
+					if ( s == Net::AddressToString( addresses[ i ], true ) )
 					{
-						if ( s == Net::AddressToString( addresses[ i ], true ) )
-						{
-							// found: replace with the preferred address, exit both loops
-							addresses[ i ] = cls.serverLinks[ j ];
-							addresses[ i ].type = NET_TYPE( cls.serverLinks[ j ].type );
-							addresses[ i ].port = ( addresses[ i ].type == netadrtype_t::NA_IP ) ? cls.serverLinks[ j ].port4 : cls.serverLinks[ j ].port6;
-							duplicate = true;
-							duplicate_count++;
-							break;
-						}
+						// found: replace with the preferred address
+						addresses[ i ] = cls.serverLinks[ j ];
+						addresses[ i ].type = NET_TYPE( cls.serverLinks[ j ].type );
+						addresses[ i ].port = ( addresses[ i ].type == netadrtype_t::NA_IP ) ? cls.serverLinks[ j ].port4 : cls.serverLinks[ j ].port6;
+						duplicate = true;
+						duplicate_count++;
+						break;
 					}
 				}
 			}
@@ -389,48 +451,46 @@ void CL_ServersResponsePacket( const netadr_t *from, msg_t *msg, bool extended )
 			port += *buffptr++;
 			port = UBigShort( port );;
 
-			// deduplicate server list, do not add known server
-			for ( int i = 0; i < cls.numglobalservers; i++ )
-			{
-				if ( cls.globalServers[ i ].adr.port == port && !memcmp( cls.globalServers[ i ].adr.ip6, ip6, sizeof( ip6 ) ) )
-				{
-					duplicate = true;
-					duplicate_count++;
-					break;
-				}
-			}
-
 			memcpy( addresses[ numservers ].ip6, ip6, sizeof( ip6 ) );
 
 			addresses[ numservers ].port = port;
 			addresses[ numservers ].type = netadrtype_t::NA_IP6;
 			addresses[ numservers ].scope_id = from->scope_id;
+			addressKey_t key = CL_AddressKey( addresses[ numservers ] );
+
+			// deduplicate server list, do not add known server
+			if ( globalServerIndex.count( key ) )
+			{
+				duplicate = true;
+				duplicate_count++;
+			}
 
 			// look up this address in the links list
-			for ( unsigned j = 0; j < cls.numserverLinks && !duplicate; ++j )
+			auto link = serverLinkIndex.find( key );
+
+			if ( !duplicate && link != serverLinkIndex.end() )
 			{
-				if ( addresses[ numservers ].port == cls.serverLinks[ j ].port6 && !memcmp( addresses[ numservers ].ip6, cls.serverLinks[ j ].ip6, sizeof( addresses[ numservers ].ip6 ) ) )
-				{
-					// found it, so look up the corresponding address
+				unsigned j = link->second;
+
+				// found it, so look up the corresponding address
 
-					// hax to get the IP address & port as a string (memcmp etc. SHOULD work, but...)
-					cls.serverLinks[ j ].type = netadrtype_t::NA_IP;
-					cls.serverLinks[ j ].port = cls.serverLinks[ j ].port4;
-					std::string s = Net::AddressToString( cls.serverLinks[ j ], true );
-					cls.serverLinks[j].type = netadrtype_t::NA_IP_DUAL;
+				// hax to get the IP address & port as a string (memcmp etc. SHOULD work, but...)
+				cls.serverLinks[ j ].type = netadrtype_t::NA_IP;
+				cls.serverLinks[ j ].port = cls.serverLinks[ j ].port4;
+				std::string s = Net::AddressToString( cls.serverLinks[ j ], true );
+				cls.serverLinks[j].type = netadrtype_t::NA_IP_DUAL;
 
-					for ( int i = 0; i < numservers; ++i )
+				for ( int i = 0; i < numservers; ++i )
+				{
+					if ( s == Net::AddressToString( addresses[ i ], true ) )
 					{
-						if ( s == Net::AddressToString( addresses[ i ], true ) )
-						{
-							// found: replace with the preferred address, exit both loops
-							addresses[ i ] = cls.serverLinks[ j ];
-							addresses[ i ].type = NET_TYPE( cls.serverLinks[ j ].type );
-							addresses[ i ].port = ( addresses[ i ].type == netadrtype_t::NA_IP ) ? cls.serverLinks[ j ].port4 : cls.serverLinks[ j ].port6;
-							duplicate = true;
-							duplicate_count++;
-							break;
-						}
+						// found: replace with the preferred address
+						addresses[ i ] = cls.serverLinks[ j ];
+						addresses[ i ].type = NET_TYPE( cls.serverLinks[ j ].type );
+						addresses[ i ].port = ( addresses[ i ].type == netadrtype_t::NA_IP ) ? cls.serverLinks[ j ].port4 : cls.serverLinks[ j ].port6;
+						duplicate = true;
+						duplicate_count++;
+						break;
 					}
 				}
 			}
@@ -468,6 +528,24 @@ void CL_ServersResponsePacket( const netadr_t *from, msg_t *msg, bool extended )
 
 		CL_InitServerInfo( server, &addresses[ i ] );
 		Q_strncpyz( server->label, label, sizeof( server->label ) );
+
+		addressKey_t key = CL_AddressKey( addresses[ i ] );
+		globalServerIndex.emplace( key, count );
+
+		// a linked server is also known by its other address
+		auto link = serverLinkIndex.find( key );
+
+		if ( link != serverLinkIndex.end() )
+		{
+			netadr_t half = cls.serverLinks[ link->second ];
+			half.type = netadrtype_t::NA_IP;
+			half.port = half.port4;
+			globalServerIndex.emplace( CL_AddressKey( half ), count );
+			half.type = netadrtype_t::NA_IP6;
+			half.port = half.port6;
+			globalServerIndex.emplace( CL_AddressKey( half ), count );
+		}
+
 		// advance to next slot
 		count++;
 	}
@@ -497,22 +575,19 @@ static void CL_SetServerInfoByAddress(
 	const netadr_t& from, const char *info,
 	serverResponseProtocol_t proto, pingStatus_t pingStatus, int ping )
 {
-	int i;
+	addressKey_t key = CL_AddressKey( from );
+	auto local = localServerIndex.find( key );
 
-	for ( i = 0; i < MAX_OTHER_SERVERS; i++ )
+	if ( local != localServerIndex.end() && local->second < cls.numlocalservers )
 	{
-		if ( NET_CompareAdr( from, cls.localServers[ i ].adr ) )
-		{
-			CL_SetServerInfo( &cls.localServers[ i ], info, proto, pingStatus, ping );
-		}
+		CL_SetServerInfo( &cls.localServers[ local->second ], info, proto, pingStatus, ping );
 	}
 
-	for ( i = 0; i < MAX_GLOBAL_SERVERS; i++ )
+	auto global = globalServerIndex.find( key );
+
+	if ( global != globalServerIndex.end() && global->second < cls.numglobalservers )
 	{
-		if ( NET_CompareAdr( from, cls.globalServers[ i ].adr ) )
-		{
-			CL_SetServerInfo( &cls.globalServers[ i ], info, proto, pingStatus, ping );
-		}
+		CL_SetServerInfo( &cls.globalServers[ global->second ], info, proto, pingStatus, ping );
 	}
 }
 
@@ -550,47 +625,50 @@ void CL_ServerInfoPacket( const netadr_t& from, msg_t *msg )
 		return;
 	}
 
-	// iterate servers waiting for ping response
-	for ( i = 0; i < MAX_PINGREQUESTS; i++ )
+	// find the ping waiting for this response
+	auto it = pings.find( CL_AddressKey( from ) );
+
+	if ( it != pings.end() && it->second.time == -1 )
 	{
-		if ( cl_pinglist[ i ].adr.port && cl_pinglist[ i ].time == -1 && NET_CompareAdr( from, cl_pinglist[i].adr ) )
+		ping_t &ping = it->second;
+
+		if ( strcmp( ping.challenge, Info_ValueForKey( infoString, "challenge" ) ) )
 		{
-			if ( strcmp( cl_pinglist[ i ].challenge, Info_ValueForKey( infoString, "challenge" ) ) )
-			{
-				serverInfoLog.Verbose( "wrong challenge for ping response from %s", NET_AdrToString( from ) );
-				return;
-			}
+			serverInfoLog.Verbose( "wrong challenge for ping response from %s", NET_AdrToString( from ) );
+			return;
+		}
 
-			// calc ping time
-			cl_pinglist[ i ].time = Sys::Milliseconds() - cl_pinglist[ i ].start;
+		// calc ping time
+		ping.time = Sys::Milliseconds() - ping.start;
 
-			serverInfoLog.Debug( "ping time %dms from %s", cl_pinglist[ i ].time, NET_AdrToString( from ) );
+		serverInfoLog.Debug( "ping time %dms from %s", ping.time, NET_AdrToString( from ) );
 
-			// save of info
-			Q_strncpyz( cl_pinglist[ i ].info, infoString, sizeof( cl_pinglist[ i ].info ) );
+		// save of info
+		Q_strncpyz( ping.info, infoString, sizeof( ping.info ) );
 
-			// tack on the net type
-			switch ( from.type )
-			{
-				case netadrtype_t::NA_BROADCAST:
-				case netadrtype_t::NA_IP:
-					cl_pinglist[ i ].responseProto = serverResponseProtocol_t::IP4;
-					break;
-
-				case netadrtype_t::NA_IP6:
-					cl_pinglist[ i ].responseProto = serverResponseProtocol_t::IP6;
-					break;
-
-				default:
-					cl_pinglist[ i ].responseProto = serverResponseProtocol_t::UNKNOWN;
-					break;
-			}
+		// tack on the net type
+		switch ( from.type )
+		{
+			case netadrtype_t::NA_BROADCAST:
+			case netadrtype_t::NA_IP:
+				ping.responseProto = serverResponseProtocol_t::IP4;
+				break;
 
-			CL_SetServerInfoByAddress( from, infoString, cl_pinglist[ i ].responseProto,
-			                           pingStatus_t::COMPLETE, cl_pinglist[ i ].time );
+			case netadrtype_t::NA_IP6:
+				ping.responseProto = serverResponseProtocol_t::IP6;
+				break;
 
-			return;
+			default:
+				ping.responseProto = serverResponseProtocol_t::UNKNOWN;
+				break;
 		}
+
+		// the result is visible to the UI right away, the ping record is
+		// dropped on the next update
+		CL_SetServerInfoByAddress( from, infoString, ping.responseProto,
+		                           pingStatus_t::COMPLETE, ping.time );
+
+		return;
 	}
 
 	// if not just sent a local broadcast or pinging local servers
@@ -599,21 +677,16 @@ void CL_ServerInfoPacket( const netadr_t& from, msg_t *msg )
 		return;
 	}
 
-	for ( i = 0; i < MAX_OTHER_SERVERS; i++ )
-	{
-		// empty slot
-		if ( cls.localServers[ i ].adr.port == 0 )
-		{
-			break;
-		}
+	addressKey_t key = CL_AddressKey( from );
 
-		// avoid duplicate
-		if ( NET_CompareAdr( from, cls.localServers[ i ].adr ) )
-		{
-			return;
-		}
+	// avoid duplicate
+	if ( localServerIndex.count( key ) )
+	{
+		return;
 	}
 
+	i = cls.numlocalservers;
+
 	if ( i == MAX_OTHER_SERVERS )
 	{
 		serverInfoLog.Notice("MAX_OTHER_SERVERS hit, dropping infoResponse" );
@@ -628,6 +701,7 @@ void CL_ServerInfoPacket( const netadr_t& from, msg_t *msg )
 	cls.localServers[ i ].pingAttempts = 0;
 	cls.localServers[ i ].responseProto = serverResponseProtocol_t::UNKNOWN;
 	cls.localServers[ i ].infoString.clear();
+	localServerIndex.emplace( key, i );
 
 	Q_strncpyz( info, MSG_ReadString( msg ), MAX_INFO_STRING );
 
@@ -659,6 +733,7 @@ void CL_LocalServers_f()
 	// reset the list, waiting for response
 	cls.numlocalservers = 0;
 	cls.pingUpdateSource = AS_LOCAL;
+	localServerIndex.clear();
 
 	for ( i = 0; i < MAX_OTHER_SERVERS; i++ )
 	{
@@ -771,6 +846,7 @@ void CL_GlobalServers_f()
 
 		cls.numglobalservers = -1;
 		cls.numserverLinks = 0;
+		serverLinkIndex.clear();
 		cls.pingUpdateSource = AS_GLOBAL;
 
 		Com_sprintf( command, sizeof( command ), "getserversExt %s %d dual",
@@ -793,136 +869,80 @@ void CL_GlobalServers_f()
 
 /*
 ==================
-CL_GetPing
+CL_GetPingStatus
 ==================
 */
-static pingStatus_t CL_GetPing( int n )
+static pingStatus_t CL_GetPingStatus( const ping_t &ping )
 {
-	ASSERT( n >= 0 && n < MAX_PINGREQUESTS );
-	ASSERT( cl_pinglist[ n ].adr.port );
-
-	pingStatus_t status;
-	// FIXME: don't use 0 for timed out or waiting in cgame ABI
-	int time;
-
-	if ( cl_pinglist[ n ].time >= 0 )
+	if ( ping.time >= 0 )
 	{
-		time = cl_pinglist[ n ].time;
-		status = pingStatus_t::COMPLETE;
+		return pingStatus_t::COMPLETE;
 	}
-	else
-	{
-		// check for timeout
-		int elapsed = Sys::Milliseconds() - cl_pinglist[ n ].start;
 
-		if ( elapsed >= cl_maxPing.Get() )
-		{
-			time = 0;
-			status = pingStatus_t::TIMEOUT;
-		}
-		else
-		{
-			time = 0;
-			status = pingStatus_t::WAITING;
-		}
-	}
+	// check for timeout
+	int elapsed = Sys::Milliseconds() - ping.start;
 
-	// FIXME: do we really need to call this again? CL_ServerInfoPacket already calls it
-	// at the moment the ping response arrives
-	CL_SetServerInfoByAddress( cl_pinglist[ n ].adr, cl_pinglist[ n ].info,
-	                           cl_pinglist[ n ].responseProto, status, time );
+	if ( elapsed >= cl_maxPing.Get() )
+	{
+		return pingStatus_t::TIMEOUT;
+	}
 
-	return status;
+	return pingStatus_t::WAITING;
 }
 
-/*
-==================
-CL_ClearPing
-==================
-*/
-static void CL_ClearPing( int n )
+static void GeneratePingChallenge( ping_t &ping )
 {
-	if ( n < 0 || n >= MAX_PINGREQUESTS )
-	{
-		return;
-	}
-
-	cl_pinglist[ n ].adr.port = 0;
-	cl_pinglist[ n ].info[ 0 ] = '\0';
+	Crypto::Data bytes( 6 );
+	Sys::GenRandomBytes( bytes.data(), bytes.size() );
+	Crypto::Data base64 = Crypto::Encoding::Base64Encode( bytes );
+	Q_strncpyz( ping.challenge, Crypto::ToString( base64 ).c_str(), sizeof(ping.challenge) );
 }
 
 /*
 ==================
-CL_GetPingQueueCount
+CL_NewPing
+
+Starts a ping record for the address, evicting the oldest one if there are
+already cl_maxPingRequests of them
 ==================
 */
-static int CL_GetPingQueueCount()
+static ping_t &CL_NewPing( const netadr_t &adr )
 {
-	int    i;
-	int    count;
-	ping_t *pingptr;
+	addressKey_t key = CL_AddressKey( adr );
 
-	count = 0;
-	pingptr = cl_pinglist;
-
-	for ( i = 0; i < MAX_PINGREQUESTS; i++, pingptr++ )
+	if ( !pings.count( key ) && pings.size() >= static_cast<size_t>( cl_maxPingRequests.Get() ) )
 	{
-		if ( pingptr->adr.port )
+		auto best = pings.begin();
+
+		for ( auto it = pings.begin(); it != pings.end(); ++it )
 		{
-			count++;
+			if ( it->second.start < best->second.start )
+			{
+				best = it;
+			}
 		}
-	}
 
-	return ( count );
-}
-
-/*
-==================
-CL_GetFreePing
-==================
-*/
-static ping_t &CL_GetFreePing()
-{
-	// Look for a free slot
-	for ( ping_t &ping : cl_pinglist )
-	{
-		if ( !ping.adr.port )
+		if ( best->second.time >= 0 )
 		{
-			return ping;
+			serverInfoLog.Verbose( "CL_NewPing: evicting completed ping record" );
 		}
-	}
-
-	// Look for an existing ping to cancel
-	ping_t *best = nullptr;
-	int oldestStart = std::numeric_limits<int>::max();
-
-	for ( ping_t &ping : cl_pinglist )
-	{
-		if ( ping.start <= oldestStart )
+		else
 		{
-			best = &ping;
-			oldestStart = ping.start;
+			serverInfoLog.Verbose( "CL_NewPing: evicting outstanding ping request" );
 		}
-	}
 
-	if ( best->time >= 0 )
-	{
-		serverInfoLog.Verbose( "CL_GetFreePing: evicting completed ping record" );
-	}
-	else
-	{
-		serverInfoLog.Verbose( "CL_GetFreePing: evicting outstanding ping request" );
+		pings.erase( best );
 	}
 
-	return *best;
-}
+	ping_t &ping = pings[ key ];
+	ping.adr = adr;
+	ping.start = Sys::Milliseconds();
+	ping.time = -1;
+	ping.responseProto = serverResponseProtocol_t::UNKNOWN;
+	ping.info[ 0 ] = '\0';
+	GeneratePingChallenge( ping );
 
-static void GeneratePingChallenge( ping_t &ping )
-{
-	Crypto::Data bytes( 6 );
-	Sys::GenRandomBytes( bytes.data(), bytes.size() );
-	Crypto::Data base64 = Crypto::Encoding::Base64Encode( bytes );
-	Q_strncpyz( ping.challenge, Crypto::ToString( base64 ).c_str(), sizeof(ping.challenge) );
+	return ping;
 }
 
 /*
@@ -932,7 +952,6 @@ CL_Ping_f
 */
 void CL_Ping_f()
 {
-	ping_t        *pingptr;
 	const char   *server;
 	int          argc;
 	netadrtype_t family = netadrtype_t::NA_UNSPEC;
@@ -974,17 +993,12 @@ void CL_Ping_f()
 		return;
 	}
 
-	pingptr = &CL_GetFreePing();
+	ping_t &ping = CL_NewPing( to );
 
-	pingptr->adr = to;
-	pingptr->start = Sys::Milliseconds();
-	pingptr->time = -1;
-	GeneratePingChallenge( *pingptr );
-
-	CL_SetServerInfoByAddress( pingptr->adr, nullptr, serverResponseProtocol_t::UNKNOWN,
+	CL_SetServerInfoByAddress( ping.adr, nullptr, serverResponseProtocol_t::UNKNOWN,
 	                           pingStatus_t::WAITING, 0 );
 
-	Net::OutOfBandPrint( netsrc_t::NS_CLIENT, to, "getinfo %s", pingptr->challenge );
+	Net::OutOfBandPrint( netsrc_t::NS_CLIENT, to, "getinfo %s", ping.challenge );
 }
 
 // complete all of the 1st tries before starting 2nd tries, etc.
@@ -1007,19 +1021,34 @@ static int PingAttemptNum( const serverInfo_t *servers, int count )
 	return result;
 }
 
+/*
+==================
+HarvestCompletedPings
+
+Completed pings were already reported when their response arrived, so only
+the timeouts need to be passed on
+==================
+*/
 static void HarvestCompletedPings()
 {
-	for ( int i = 0; i < MAX_PINGREQUESTS; i++ )
+	for ( auto it = pings.begin(); it != pings.end(); )
 	{
-		if ( !cl_pinglist[ i ].adr.port )
+		pingStatus_t status = CL_GetPingStatus( it->second );
+
+		if ( status == pingStatus_t::WAITING )
 		{
+			++it;
 			continue;
 		}
 
-		if ( CL_GetPing( i ) != pingStatus_t::WAITING )
+		if ( status == pingStatus_t::TIMEOUT )
 		{
-			CL_ClearPing( i );
+			// FIXME: don't use 0 for timed out or waiting in cgame ABI
+			CL_SetServerInfoByAddress( it->second.adr, it->second.info,
+			                           it->second.responseProto, status, 0 );
 		}
+
+		it = pings.erase( it );
 	}
 }
 
@@ -1027,6 +1056,11 @@ static void HarvestCompletedPings()
 ==================
 CL_UpdateVisiblePings_f
 
+Sends the getinfo queries for the visible servers in batches of
+cl_pingBatchSize every ping spacing interval, keeping at most
+cl_maxPingRequests of them outstanding. The responses update the server list
+as they arrive.
+
 Returns true if there are any newly completed pings or any outstanding pings
 ==================
 */
@@ -1038,11 +1072,12 @@ bool CL_UpdateVisiblePings_f( int source )
 	}
 
 	cls.pingUpdateSource = source;
-	int usedSlots = CL_GetPingQueueCount();
-	bool status = usedSlots > 0;
+	bool status = !pings.empty();
 	HarvestCompletedPings();
+	int maxRequests = cl_maxPingRequests.Get();
+	int usedSlots = pings.size();
 
-	if ( usedSlots < MAX_PINGREQUESTS )
+	if ( usedSlots < maxRequests )
 	{
 		serverInfo_t *server;
 		int max;
@@ -1075,6 +1110,9 @@ bool CL_UpdateVisiblePings_f( int source )
 			return true; // rate limited
 		}
 
+		int batchSize = cl_pingBatchSize.Get();
+		int sent = 0;
+
 		for ( int i = 0; i < max; i++ )
 		{
 			if ( !server[ i ].visible )
@@ -1092,45 +1130,27 @@ bool CL_UpdateVisiblePings_f( int source )
 				continue;
 			}
 
-			int j;
-
-			for ( j = 0; j < MAX_PINGREQUESTS; j++ )
+			if ( pings.count( CL_AddressKey( server[ i ].adr ) ) )
 			{
-				if ( !cl_pinglist[ j ].adr.port )
-				{
-					continue;
-				}
-
-				if ( NET_CompareAdr( cl_pinglist[ j ].adr, server[ i ].adr ) )
-				{
-					// already on the list
-					break;
-				}
+				// already on the list
+				continue;
 			}
 
-			// Not in the list, so find and use a free slot.
-			if ( j >= MAX_PINGREQUESTS )
+			status = true;
+
+			ping_t &ping = CL_NewPing( server[ i ].adr );
+			Net::OutOfBandPrint( netsrc_t::NS_CLIENT, ping.adr, "getinfo %s", ping.challenge );
+			lastPingSendTime = ping.start;
+			server[ i ].pingAttempts = attempt + 1;
+
+			if ( ++usedSlots >= maxRequests )
 			{
-				status = true;
-
-				ping_t &ping = CL_GetFreePing();
-				ping.adr = server[ i ].adr;
-				ping.start = Sys::Milliseconds();
-				ping.time = -1;
-				GeneratePingChallenge( ping );
-				Net::OutOfBandPrint( netsrc_t::NS_CLIENT, ping.adr, "getinfo %s", ping.challenge );
-				lastPingSendTime = ping.start;
-				server[ i ].pingAttempts = attempt + 1;
-
-				if ( ++usedSlots >= MAX_PINGREQUESTS )
-				{
-					break;
-				}
+				break;
+			}
 
-				if ( pingSpacing[ attempt ].Get() > 0 )
-				{
-					break;
-				}
+			if ( pingSpacing[ attempt ].Get() > 0 && ++sent >= batchSize )
+			{
+				break;
 			}
 		}
 	}
@@ -0,0 +1,284 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+
+// Queries a fake master server and fake game servers on loopback through the
+// globalservers command and CL_UpdateVisiblePings_f.
+
+#include <gtest/gtest.h>
+
+#include "common/Common.h"
+#include "client.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+using socklen_t = int;
+
+#define poll WSAPoll
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using SOCKET = int;
+constexpr SOCKET INVALID_SOCKET{-1};
+
+#define closesocket close
+#endif
+
+namespace {
+
+const std::string OOB_HEADER = "\xff\xff\xff\xff";
+
+// UDP socket on 127.0.0.1 with a system chosen port
+class LoopbackSocket
+{
+public:
+	LoopbackSocket()
+	{
+		socket_ = socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+		EXPECT_NE( socket_, INVALID_SOCKET );
+
+		struct sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+		socklen_t addrLen = sizeof( addr );
+
+		EXPECT_EQ( bind( socket_, reinterpret_cast<struct sockaddr*>( &addr ), addrLen ), 0 );
+		EXPECT_EQ( getsockname( socket_, reinterpret_cast<struct sockaddr*>( &addr ), &addrLen ), 0 );
+		port_ = ntohs( addr.sin_port );
+	}
+
+	~LoopbackSocket()
+	{
+		closesocket( socket_ );
+	}
+
+	uint16_t Port() const
+	{
+		return port_;
+	}
+
+	// Returns false if no packet is waiting
+	bool Receive( std::string& data, struct sockaddr_in& from )
+	{
+		struct pollfd pfd{};
+		pfd.fd = socket_;
+		pfd.events = POLLIN;
+
+		if ( poll( &pfd, 1, 0 ) <= 0 )
+		{
+			return false;
+		}
+
+		char buffer[ 2048 ];
+		socklen_t fromLen = sizeof( from );
+		int len = recvfrom( socket_, buffer, sizeof( buffer ), 0, reinterpret_cast<struct sockaddr*>( &from ), &fromLen );
+
+		if ( len < 0 )
+		{
+			return false;
+		}
+
+		data.assign( buffer, len );
+		return true;
+	}
+
+	void Send( Str::StringRef data, const struct sockaddr_in& to )
+	{
+		sendto( socket_, data.data(), data.size(), 0, reinterpret_cast<const struct sockaddr*>( &to ), sizeof( to ) );
+	}
+
+private:
+	SOCKET socket_;
+	uint16_t port_ = 0;
+};
+
+constexpr int NUM_SERVERS = 6;
+
+// The last server never answers
+constexpr int DEAD_SERVER = NUM_SERVERS - 1;
+
+class ServerListTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		oldMaster_ = Cvar::GetValue( "sv_master1" );
+		oldMaxPing_ = Cvar::GetValue( "cl_maxPing" );
+		Cvar::SetValue( "sv_master1", Str::Format( "127.0.0.1:%d", master_.Port() ) );
+		Cvar::SetValue( "cl_maxPing", "100" );
+	}
+
+	void TearDown() override
+	{
+		Cvar::SetValue( "sv_master1", oldMaster_ );
+		Cvar::SetValue( "cl_maxPing", oldMaxPing_ );
+
+		for ( int i = 0; i < cls.numglobalservers; i++ )
+		{
+			cls.globalServers[ i ].visible = false;
+		}
+	}
+
+	// Master response listing the servers from first to last, as a
+	// packet of a multi-packet response
+	std::string MasterResponse( int first, int last, int packet, int numPackets )
+	{
+		std::string response = OOB_HEADER + "getserversExtResponse";
+		response += '\0' + std::to_string( packet ) + '\0' + std::to_string( numPackets ) + '\0';
+
+		for ( int i = first; i <= last; i++ )
+		{
+			uint16_t port = servers_[ i ].Port();
+			response += "\\";
+			response += std::string( "\x7f\x00\x00\x01", 4 );
+			response += char( port >> 8 );
+			response += char( port & 0xff );
+		}
+
+		response += std::string( "\\EOT\0\0\0", 7 );
+		return response;
+	}
+
+	// Answers the pending queries of the client and lets it read the answers
+	void Pump()
+	{
+		std::string data;
+		struct sockaddr_in from;
+
+		while ( master_.Receive( data, from ) )
+		{
+			masterQueries_.push_back( data );
+
+			// The second packet lists a server of the first again
+			master_.Send( MasterResponse( 0, 3, 1, 2 ), from );
+			master_.Send( MasterResponse( 3, NUM_SERVERS - 1, 2, 2 ), from );
+		}
+
+		for ( int i = 0; i < NUM_SERVERS; i++ )
+		{
+			while ( servers_[ i ].Receive( data, from ) )
+			{
+				queries_[ i ]++;
+
+				if ( i == DEAD_SERVER || !Str::IsPrefix( OOB_HEADER + "getinfo ", data ) )
+				{
+					continue;
+				}
+
+				std::string challenge = data.substr( OOB_HEADER.size() + strlen( "getinfo " ) );
+				servers_[ i ].Send( Str::Format( "%sinfoResponse\n\\protocol\\%d\\gamename\\%s\\challenge\\%s\\hostname\\fake%d",
+					OOB_HEADER, PROTOCOL_VERSION, GAMENAME_STRING, challenge, i ), from );
+			}
+		}
+
+		NET_Sleep( 1 );
+		Com_EventLoop();
+	}
+
+	// Index of the server in the global list, -1 if it isn't listed
+	int FindServer( int server )
+	{
+		for ( int i = 0; i < cls.numglobalservers; i++ )
+		{
+			if ( NET_TYPE( cls.globalServers[ i ].adr.type ) == netadrtype_t::NA_IP
+			     && ntohs( cls.globalServers[ i ].adr.port ) == servers_[ server ].Port() )
+			{
+				return i;
+			}
+		}
+
+		return -1;
+	}
+
+	LoopbackSocket master_;
+	LoopbackSocket servers_[ NUM_SERVERS ];
+	std::vector<std::string> masterQueries_;
+	int queries_[ NUM_SERVERS ] = {};
+	std::string oldMaster_;
+	std::string oldMaxPing_;
+};
+
+TEST_F(ServerListTest, QueryServers)
+{
+	Cmd::ExecuteCommand( Str::Format( "globalservers 0 %d", PROTOCOL_VERSION ) );
+
+	auto deadline = Sys::SteadyClock::now() + std::chrono::seconds( 10 );
+
+	while ( cls.numglobalservers < NUM_SERVERS && Sys::SteadyClock::now() < deadline )
+	{
+		Pump();
+	}
+
+	ASSERT_EQ( masterQueries_.size(), 1u );
+	EXPECT_TRUE( Str::IsPrefix( OOB_HEADER + "getserversExt ", masterQueries_[ 0 ] ) );
+
+	// The duplicate server is listed once
+	Pump();
+	ASSERT_EQ( cls.numglobalservers, NUM_SERVERS );
+
+	int index[ NUM_SERVERS ];
+
+	for ( int i = 0; i < NUM_SERVERS; i++ )
+	{
+		index[ i ] = FindServer( i );
+		ASSERT_NE( index[ i ], -1 );
+		cls.globalServers[ index[ i ] ].visible = true;
+	}
+
+	while ( CL_UpdateVisiblePings_f( AS_GLOBAL ) && Sys::SteadyClock::now() < deadline )
+	{
+		Pump();
+	}
+
+	for ( int i = 0; i < NUM_SERVERS; i++ )
+	{
+		const serverInfo_t& server = cls.globalServers[ index[ i ] ];
+
+		if ( i == DEAD_SERVER )
+		{
+			EXPECT_EQ( server.pingStatus, pingStatus_t::TIMEOUT );
+			EXPECT_EQ( queries_[ i ], 3 );
+		}
+		else
+		{
+			EXPECT_EQ( server.pingStatus, pingStatus_t::COMPLETE );
+			EXPECT_EQ( Info_ValueForKey( server.infoString.c_str(), "hostname" ), Str::Format( "fake%d", i ) );
+			EXPECT_EQ( server.responseProto, serverResponseProtocol_t::IP4 );
+			EXPECT_EQ( queries_[ i ], 1 );
+		}
+	}
+}
+
+} // namespace
@@ -173,6 +173,13 @@ demo through a file.
 =============================================================================
 */
 
+// A point of a demo where the playback can start, a gamestate followed by a non-delta snapshot
+struct demoKeyframe_t
+{
+	int serverTime;
+	int offset; // in the demo file
+};
+
 struct clientConnection_t
 {
 	int      clientNum;
@@ -225,12 +232,17 @@ struct clientConnection_t
 	bool     demorecording;
 	bool     demoplaying;
 	bool     demowaiting; // don't record until a non-delta message is received
+	bool     demoKeyframePending; // ask for a non-delta message to write a keyframe
+	bool     demoNonDeltaSnapshot; // the message being parsed has a non-delta snapshot
 	bool     firstDemoFrameSkipped;
 	fileHandle_t demofile;
+	std::vector<demoKeyframe_t> demoKeyframes; // seek index of the demo being recorded or played
 
 	int          timeDemoFrames; // counter of rendered frames
 	int          timeDemoStart; // cls.realtime before first frame
 	int          timeDemoBaseTime; // each frame will be at this time + frameNum * 50
+	Sys::SteadyClock::time_point timeDemoLastFrame;
+	std::vector<Sys::SteadyClock::duration> timeDemoFrameTimes;
 
 	// big stuff at end of structure so most offsets are 15 bits or less
 	netchan_t netchan;
@@ -48,8 +48,40 @@ Maryland 20850 USA.
 extern Log::Logger downloadLogger; // cl_download.cpp
 extern Cvar::Cvar<int> cl_downloadCount; // cl_download.cpp
 
+static Cvar::Range<Cvar::Cvar<int>> cl_downloadConnections(
+	"cl_downloadConnections", "number of connections used to download a large pak", Cvar::NONE, 4, 1, 16);
+
 namespace {
 
+// Paks smaller than this are not split between connections
+constexpr FS::offset_t MIN_DOWNLOAD_SEGMENT_SIZE = 1024 * 1024;
+
+// Number of times an interrupted transfer is resumed before giving up
+constexpr int MAX_DOWNLOAD_RETRIES = 3;
+
+bool SetRequestOptions(CURL* request, Str::StringRef url, curl_write_callback callback, void* data) {
+	CURLcode err;
+#define SETOPT(option, value) \
+if ((err = curl_easy_setopt(request, option, value)) != CURLE_OK) { \
+	downloadLogger.Warn("Setting " #option " failed: %s", curl_easy_strerror(err)); \
+	return false; \
+}
+
+	SETOPT( CURLOPT_USERAGENT, Str::Format( "%s %s", PRODUCT_NAME "/" PRODUCT_VERSION, curl_version() ).c_str() )
+	SETOPT( CURLOPT_REFERER, Str::Format("%s%s", URI_SCHEME, Cvar::GetValue("cl_currentServerIP")).c_str() )
+	SETOPT( CURLOPT_URL, url.c_str() )
+#if CURL_AT_LEAST_VERSION(7, 85, 0)
+	SETOPT( CURLOPT_PROTOCOLS_STR, "http" )
+#else
+	SETOPT( CURLOPT_PROTOCOLS, long(CURLPROTO_HTTP) )
+#endif
+	SETOPT( CURLOPT_WRITEFUNCTION, callback )
+	SETOPT( CURLOPT_WRITEDATA, data )
+	SETOPT( CURLOPT_FAILONERROR, 1L )
+#undef SETOPT
+	return true;
+}
+
 class CurlDownload {
 	CURLM* multi_ = nullptr;
 	CURL* request_ = nullptr;
@@ -67,7 +99,7 @@ public:
 			downloadLogger.Warn( "curl_easy_init returned null" );
 			return;
 		}
-		if (!SetOptions(url)) {
+		if (!SetRequestOptions(request_, url, curl_write_callback(LibcurlWriteCallback), static_cast<void*>(this))) {
 			return;
 		}
 		CURLMcode err = curl_multi_add_handle(multi_, request_);
@@ -158,46 +190,284 @@ private:
 		download->status_ = download->WriteCallback(data, len);
 		return download->status_ == dlStatus_t::DL_CONTINUE ? len : ~size_t(0);
 	}
+};
 
-	bool SetOptions(Str::StringRef url) {
-		CURLcode err;
-#define SETOPT(option, value) \
-if ((err = curl_easy_setopt(request_, option, value)) != CURLE_OK) { \
-	downloadLogger.Warn("Setting " #option " failed: %s", curl_easy_strerror(err)); \
-	return false; \
-}
+// Downloads a file over several connections at once, each fetching a range of
+// the file with an HTTP range request. A connection which is interrupted
+// resumes from where it stopped. If the server doesn't support ranges, the
+// file is downloaded in full over a single connection instead.
+class SegmentedDownload {
+	struct Segment {
+		SegmentedDownload* owner;
+		CURL* request = nullptr;
+		FS::offset_t start;
+		FS::offset_t end; // exclusive, -1 if the size is unknown
+		FS::offset_t written = 0;
+		int retries = 0;
+		bool ranged = false;
+		bool checkedResponse = false;
+		bool done = false;
+	};
 
-		SETOPT( CURLOPT_USERAGENT, Str::Format( "%s %s", PRODUCT_NAME "/" PRODUCT_VERSION, curl_version() ).c_str() )
-		SETOPT( CURLOPT_REFERER, Str::Format("%s%s", URI_SCHEME, Cvar::GetValue("cl_currentServerIP")).c_str() )
-		SETOPT( CURLOPT_URL, url.c_str() )
-#if CURL_AT_LEAST_VERSION(7, 85, 0)
-		SETOPT( CURLOPT_PROTOCOLS_STR, "http" )
-#else
-		SETOPT( CURLOPT_PROTOCOLS, long(CURLPROTO_HTTP) )
-#endif
-		SETOPT( CURLOPT_WRITEFUNCTION, curl_write_callback(LibcurlWriteCallback) )
-		SETOPT( CURLOPT_WRITEDATA, static_cast<void*>(this) )
-		SETOPT( CURLOPT_FAILONERROR, 1L )
+	CURLM* multi_ = nullptr;
+	FS::File file_;
+	std::string url_;
+	FS::offset_t size_;
+	std::vector<std::unique_ptr<Segment>> segments_;
+	bool rangesUnsupported_ = false;
+	bool restartWithoutRanges_ = false;
+	dlStatus_t status_ = dlStatus_t::DL_FAILED;
+
+public:
+	SegmentedDownload(Str::StringRef url, FS::File file, FS::offset_t size)
+		: file_(std::move(file)), url_(url), size_(size) {
+		multi_ = curl_multi_init();
+		if (!multi_) {
+			downloadLogger.Warn("curl_multi_init returned null");
+			return;
+		}
+
+		int numSegments = 1;
+		if (size_ > 0) {
+			numSegments = std::max<FS::offset_t>(1, std::min<FS::offset_t>(cl_downloadConnections.Get(), size_ / MIN_DOWNLOAD_SEGMENT_SIZE));
+		}
+		FS::offset_t segmentSize = size_ > 0 ? (size_ + numSegments - 1) / numSegments : -1;
+		for (int i = 0; i < numSegments; i++) {
+			FS::offset_t start = i * std::max<FS::offset_t>(segmentSize, 0);
+			FS::offset_t end = size_ > 0 ? std::min(start + segmentSize, size_) : -1;
+			AddSegment(start, end);
+		}
+		downloadLogger.Debug("Downloading %s over %d connections", url_, numSegments);
+
+		status_ = dlStatus_t::DL_CONTINUE;
+		for (auto& segment : segments_) {
+			if (!StartSegment(*segment)) {
+				status_ = dlStatus_t::DL_FAILED;
+				return;
+			}
+		}
+	}
+
+	SegmentedDownload(SegmentedDownload&&) = delete; // Disallow copy construction and assignment
+
+	~SegmentedDownload() {
+		for (auto& segment : segments_) {
+			StopSegment(*segment);
+		}
+		if (multi_) {
+			CURLMcode err = curl_multi_cleanup(multi_);
+			if (err != CURLM_OK) {
+				downloadLogger.Warn("curl_multi_cleanup error: %s", curl_multi_strerror(err));
+			}
+		}
+	}
+
+	void Advance() {
+		if (status_ != dlStatus_t::DL_CONTINUE) {
+			return;
+		}
+		int numRunningTransfers;
+		CURLMcode err = curl_multi_perform(multi_, &numRunningTransfers);
+		if (err != CURLM_OK) {
+			downloadLogger.Warn("curl_multi_perform error: %s", curl_multi_strerror(err));
+			status_ = dlStatus_t::DL_FAILED;
+			return;
+		}
+
+		CURLMsg* msg;
+		int ignored;
+		while (status_ == dlStatus_t::DL_CONTINUE && (msg = curl_multi_info_read(multi_, &ignored))) {
+			if (msg->msg != CURLMSG_DONE) {
+				continue;
+			}
+			for (auto& segment : segments_) {
+				if (segment->request == msg->easy_handle) {
+					FinishSegment(*segment, msg->data.result);
+					break;
+				}
+			}
+		}
+
+		if (status_ != dlStatus_t::DL_CONTINUE) {
+			return;
+		}
+
+		if (restartWithoutRanges_) {
+			RestartWithoutRanges();
+			return;
+		}
+
+		for (auto& segment : segments_) {
+			if (!segment->done) {
+				return;
+			}
+		}
+		status_ = dlStatus_t::DL_DONE;
+	}
+
+	dlStatus_t Status() {
+		return status_;
+	}
+
+private:
+	void AddSegment(FS::offset_t start, FS::offset_t end) {
+		segments_.emplace_back(new Segment);
+		segments_.back()->owner = this;
+		segments_.back()->start = start;
+		segments_.back()->end = end;
+	}
+
+	// Starts or resumes the transfer of a segment from its current position
+	bool StartSegment(Segment& segment) {
+		segment.request = curl_easy_init();
+		if (!segment.request) {
+			downloadLogger.Warn("curl_easy_init returned null");
+			return false;
+		}
+		if (!SetRequestOptions(segment.request, url_, curl_write_callback(LibcurlWriteCallback), static_cast<void*>(&segment))) {
+			return false;
+		}
+
+		FS::offset_t from = segment.start + segment.written;
+		segment.ranged = !rangesUnsupported_ && (segments_.size() > 1 || from > 0);
+		segment.checkedResponse = false;
+		if (segment.ranged) {
+			std::string range = segment.end < 0 ? Str::Format("%d-", from) : Str::Format("%d-%d", from, segment.end - 1);
+			CURLcode err = curl_easy_setopt(segment.request, CURLOPT_RANGE, range.c_str());
+			if (err != CURLE_OK) {
+				downloadLogger.Warn("Setting CURLOPT_RANGE failed: %s", curl_easy_strerror(err));
+				return false;
+			}
+		}
+
+		CURLMcode err = curl_multi_add_handle(multi_, segment.request);
+		if (err != CURLM_OK) {
+			downloadLogger.Warn("curl_multi_add_handle error: %s", curl_multi_strerror(err));
+			curl_easy_cleanup(segment.request);
+			segment.request = nullptr;
+			return false;
+		}
 		return true;
 	}
-};
 
-class FileDownload : public CurlDownload {
-	FS::File file_;
+	void StopSegment(Segment& segment) {
+		if (!segment.request) {
+			return;
+		}
+		CURLMcode err = curl_multi_remove_handle(multi_, segment.request);
+		if (err != CURLM_OK) {
+			downloadLogger.Warn("curl_multi_remove_handle error: %s", curl_multi_strerror(err));
+		}
+		curl_easy_cleanup(segment.request);
+		segment.request = nullptr;
+	}
+
+	void FinishSegment(Segment& segment, CURLcode result) {
+		long httpStatus = -1;
+		curl_easy_getinfo(segment.request, CURLINFO_RESPONSE_CODE, &httpStatus);
+		StopSegment(segment);
+
+		if (restartWithoutRanges_) {
+			return;
+		}
+
+		FS::offset_t position = segment.start + segment.written;
+		if (result == CURLE_OK) {
+			long expectedStatus = segment.ranged ? 206 : 200;
+			if (httpStatus != expectedStatus) {
+				// We don't follow redirects, so report a failure if we get one
+				// (they're not considered an error for CURLOPT_FAILONERROR purposes).
+				downloadLogger.Notice("Download failed: returned HTTP %d", httpStatus);
+				status_ = dlStatus_t::DL_FAILED;
+				return;
+			}
+			if (segment.end < 0 || position == segment.end) {
+				segment.done = true;
+				return;
+			}
+			downloadLogger.Notice("Download connection closed after %d of %d bytes", position - segment.start, segment.end - segment.start);
+		} else {
+			downloadLogger.Notice("Download request terminated with error: %s", curl_easy_strerror(result));
+			if (result == CURLE_HTTP_RETURNED_ERROR || result == CURLE_WRITE_ERROR) {
+				status_ = dlStatus_t::DL_FAILED;
+				return;
+			}
+		}
+
+		if (segment.retries >= MAX_DOWNLOAD_RETRIES) {
+			status_ = dlStatus_t::DL_FAILED;
+			return;
+		}
+		segment.retries++;
+
+		// Without ranges, a transfer can only start over
+		if (rangesUnsupported_) {
+			cl_downloadCount.Set(cl_downloadCount.Get() - segment.written);
+			segment.written = 0;
+		}
+		downloadLogger.Notice("Resuming download at byte %d", segment.start + segment.written);
+		if (!StartSegment(segment)) {
+			status_ = dlStatus_t::DL_FAILED;
+		}
+	}
+
+	void RestartWithoutRanges() {
+		downloadLogger.Notice("Download server doesn't support range requests, using a single connection");
+		for (auto& segment : segments_) {
+			StopSegment(*segment);
+		}
+		segments_.clear();
+		restartWithoutRanges_ = false;
+		rangesUnsupported_ = true;
+		cl_downloadCount.Set(0);
+
+		AddSegment(0, size_ > 0 ? size_ : -1);
+		if (!StartSegment(*segments_.back())) {
+			status_ = dlStatus_t::DL_FAILED;
+		}
+	}
+
+	static size_t LibcurlWriteCallback(char* data, size_t, size_t len, void* object) {
+		auto* segment = static_cast<Segment*>(object);
+		return segment->owner->Write(*segment, data, len) ? len : ~size_t(0);
+	}
+
+	bool Write(Segment& segment, const char* data, size_t len) {
+		if (restartWithoutRanges_) {
+			return false;
+		}
+
+		// A server which ignores the range sends the whole file, detect it
+		// before writing anything at the wrong place
+		if (!segment.checkedResponse) {
+			segment.checkedResponse = true;
+			long httpStatus = -1;
+			curl_easy_getinfo(segment.request, CURLINFO_RESPONSE_CODE, &httpStatus);
+			if (segment.ranged && httpStatus == 200) {
+				restartWithoutRanges_ = true;
+				return false;
+			}
+		}
+
+		FS::offset_t position = segment.start + segment.written;
+		if (segment.end >= 0 && position + FS::offset_t(len) > segment.end) {
+			downloadLogger.Notice("Download server sent more data than requested");
+			status_ = dlStatus_t::DL_FAILED;
+			return false;
+		}
 
-	dlStatus_t WriteCallback(const char* data, size_t len) override {
 		try {
+			file_.SeekSet(position);
 			file_.Write(data, len);
 		} catch (std::system_error& e) {
 			downloadLogger.Notice("Error writing to download file: %s", e.what());
-			return dlStatus_t::DL_FAILED;
+			status_ = dlStatus_t::DL_FAILED;
+			return false;
 		}
+		segment.written += len;
 		cl_downloadCount.Set(cl_downloadCount.Get() + len);
-		return dlStatus_t::DL_CONTINUE;
+		return true;
 	}
-
-public:
-	FileDownload(Str::StringRef url, FS::File file) : CurlDownload(url), file_(std::move(file)) {}
 };
 
 // If servers could ask the client to download any URL, there would be a security issue: the URL
@@ -230,9 +500,10 @@ public:
 
 struct DownloadState {
 	Util::optional<PakserverCheck> pakserverCheck;
-	Util::optional<FileDownload> actualDownload;
+	Util::optional<SegmentedDownload> actualDownload;
 	std::string url;
 	std::string homepathPath; // should begin with pkg/
+	int size = 0; // announced by the game server, 0 if unknown
 };
 
 } // namespace
@@ -301,7 +572,7 @@ inspired from http://www.w3.org/Library/Examples/LoadToFile.c
 setup the download, return once we have a connection
 ===============
 */
-int DL_BeginDownload( const char *localName, const char *remoteName, int basePathLen )
+int DL_BeginDownload( const char *localName, const char *remoteName, int basePathLen, int size )
 {
 	DL_StopDownload();
 
@@ -325,6 +596,7 @@ int DL_BeginDownload( const char *localName, const char *remoteName, int basePat
 	download.pakserverCheck.emplace(urlDir + PAKSERVER_FILE_NAME);
 	download.url = remoteName;
 	download.homepathPath = localName;
+	download.size = std::max( size, 0 );
 	Cvar_Set( "cl_downloadName", remoteName );
 	return 1;
 }
@@ -338,7 +610,7 @@ static void StartRealDownload() {
 		return;
 	}
 	downloadLogger.Debug("Starting HTTP download of %s", download.url);
-	download.actualDownload.emplace(download.url, std::move(file));
+	download.actualDownload.emplace(download.url, std::move(file), download.size);
 }
 
 // (maybe this should be CL_DL_DownloadLoop)
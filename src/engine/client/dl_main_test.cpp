@@ -0,0 +1,349 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+
+// Tests SegmentedDownload through DL_BeginDownload and DL_DownloadLoop, using
+// a small HTTP server on loopback as the download mirror.
+
+#include <gtest/gtest.h>
+
+#include "common/Common.h"
+#include "common/FileSystem.h"
+#include "qcommon/qcommon.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+using socklen_t = int;
+
+#define poll WSAPoll
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using SOCKET = int;
+constexpr SOCKET INVALID_SOCKET{-1};
+
+#define closesocket close
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+const std::string PAK_NAME = "test_0.dpk";
+const std::string DOWNLOAD_PATH = "dltest/test_0.dpk";
+
+struct mirrorOptions_t
+{
+	// Answer range requests with the whole file
+	bool ignoreRanges = false;
+	// Close the first pak transfer after half of the announced data
+	bool dropFirst = false;
+	// Send more data than was requested
+	bool oversized = false;
+};
+
+// HTTP server handing out one pak and the PAKSERVER file, one thread per
+// connection so that a download can use several connections at once
+class TestMirror
+{
+public:
+	TestMirror( std::string data, mirrorOptions_t options )
+		: data_( std::move( data ) ), options_( options )
+	{
+		listenSocket_ = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP );
+		EXPECT_NE( listenSocket_, INVALID_SOCKET );
+
+		struct sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+		socklen_t addrLen = sizeof( addr );
+
+		EXPECT_EQ( bind( listenSocket_, reinterpret_cast<struct sockaddr*>( &addr ), addrLen ), 0 );
+		EXPECT_EQ( listen( listenSocket_, SOMAXCONN ), 0 );
+		EXPECT_EQ( getsockname( listenSocket_, reinterpret_cast<struct sockaddr*>( &addr ), &addrLen ), 0 );
+		port_ = ntohs( addr.sin_port );
+
+		acceptThread_ = std::thread( &TestMirror::Accept, this );
+	}
+
+	~TestMirror()
+	{
+		stop_ = true;
+		acceptThread_.join();
+		closesocket( listenSocket_ );
+
+		for ( std::thread& thread : connectionThreads_ )
+		{
+			thread.join();
+		}
+	}
+
+	std::string BaseURL() const
+	{
+		return Str::Format( "http://127.0.0.1:%d/", port_ );
+	}
+
+	// Range header of every request for the pak, empty if there was none
+	std::vector<std::string> Ranges()
+	{
+		std::lock_guard<std::mutex> lock( mutex_ );
+		return ranges_;
+	}
+
+private:
+	void Accept()
+	{
+		while ( !stop_ )
+		{
+			struct pollfd pfd{};
+			pfd.fd = listenSocket_;
+			pfd.events = POLLIN;
+
+			if ( poll( &pfd, 1, 10 ) <= 0 )
+			{
+				continue;
+			}
+
+			SOCKET conn = accept( listenSocket_, nullptr, nullptr );
+
+			if ( conn != INVALID_SOCKET )
+			{
+				connectionThreads_.emplace_back( &TestMirror::Serve, this, conn );
+			}
+		}
+	}
+
+	void Serve( SOCKET conn )
+	{
+		std::string request;
+		char buffer[ 1024 ];
+
+		while ( request.find( "\r\n\r\n" ) == std::string::npos )
+		{
+			int len = recv( conn, buffer, sizeof( buffer ), 0 );
+
+			if ( len <= 0 )
+			{
+				closesocket( conn );
+				return;
+			}
+
+			request.append( buffer, len );
+		}
+
+		std::string path = request.substr( 4, request.find( ' ', 4 ) - 4 );
+		std::string range;
+		size_t rangePos = request.find( "\r\nRange: " );
+
+		if ( rangePos != std::string::npos )
+		{
+			rangePos += strlen( "\r\nRange: " );
+			range = request.substr( rangePos, request.find( "\r\n", rangePos ) - rangePos );
+		}
+
+		if ( path == "/PAKSERVER" )
+		{
+			Send( conn, "200 OK", "", "ALLOW_UNRESTRICTED_DOWNLOAD\n", 0 );
+		}
+		else if ( path == "/" + PAK_NAME )
+		{
+			bool drop;
+			{
+				std::lock_guard<std::mutex> lock( mutex_ );
+				ranges_.push_back( range );
+				drop = options_.dropFirst && ranges_.size() == 1;
+			}
+
+			size_t first = 0, last = data_.size() - 1;
+			bool ranged = !range.empty() && !options_.ignoreRanges
+				&& sscanf( range.c_str(), "bytes=%zu-%zu", &first, &last ) >= 1;
+			last = std::min( last, data_.size() - 1 );
+
+			std::string body = data_.substr( first, last + 1 - first );
+
+			if ( options_.oversized )
+			{
+				body.append( 1000, 'x' );
+			}
+
+			std::string headers = ranged ? Str::Format( "Content-Range: bytes %d-%d/%d\r\n", first, last, data_.size() ) : "";
+			Send( conn, ranged ? "206 Partial Content" : "200 OK", headers, body, drop ? body.size() / 2 : 0 );
+		}
+		else
+		{
+			Send( conn, "404 Not Found", "", "", 0 );
+		}
+
+		closesocket( conn );
+	}
+
+	// Sends a response announcing the whole body, but only the first dropAfter
+	// bytes of it if that is not 0
+	void Send( SOCKET conn, Str::StringRef status, Str::StringRef headers, Str::StringRef body, size_t dropAfter )
+	{
+		std::string response = Str::Format( "HTTP/1.1 %s\r\nContent-Length: %d\r\n%sConnection: close\r\n\r\n", status, body.size(), headers );
+		response.append( body.data(), dropAfter ? dropAfter : body.size() );
+
+		for ( size_t sent = 0; sent < response.size(); )
+		{
+			int len = send( conn, response.data() + sent, response.size() - sent, MSG_NOSIGNAL );
+
+			if ( len <= 0 )
+			{
+				return;
+			}
+
+			sent += len;
+		}
+	}
+
+	std::string data_;
+	mirrorOptions_t options_;
+	SOCKET listenSocket_;
+	int port_ = 0;
+	std::atomic<bool> stop_{ false };
+	std::thread acceptThread_;
+	std::vector<std::thread> connectionThreads_;
+	std::mutex mutex_;
+	std::vector<std::string> ranges_;
+};
+
+std::string PakData( size_t size )
+{
+	std::string data( size, '\0' );
+
+	for ( size_t i = 0; i < size; i++ )
+	{
+		data[ i ] = char( i * 7 + i / 251 );
+	}
+
+	return data;
+}
+
+// Downloads the pak from the mirror, size is 0 if unknown
+dlStatus_t Download( const TestMirror& mirror, int size, std::string& result )
+{
+	std::string baseURL = mirror.BaseURL();
+
+	if ( !DL_BeginDownload( DOWNLOAD_PATH.c_str(), ( baseURL + PAK_NAME ).c_str(), baseURL.size(), size ) )
+	{
+		return dlStatus_t::DL_FAILED;
+	}
+
+	auto deadline = Sys::SteadyClock::now() + std::chrono::seconds( 30 );
+	dlStatus_t status;
+
+	while ( ( status = DL_DownloadLoop() ) == dlStatus_t::DL_CONTINUE && Sys::SteadyClock::now() < deadline )
+	{
+		std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+	}
+
+	std::error_code err;
+	result = FS::HomePath::OpenRead( DOWNLOAD_PATH, err ).ReadAll( err );
+	return status;
+}
+
+TEST(SegmentedDownloadTest, SplitBetweenConnections)
+{
+	std::string data = PakData( 4 * 1024 * 1024 + 123 );
+	TestMirror mirror( data, {} );
+	std::string result;
+
+	ASSERT_EQ( Download( mirror, data.size(), result ), dlStatus_t::DL_DONE );
+	EXPECT_TRUE( result == data );
+
+	std::vector<std::string> ranges = mirror.Ranges();
+	std::sort( ranges.begin(), ranges.end() );
+	EXPECT_EQ( ranges, std::vector<std::string>( {
+		"bytes=0-1048606", "bytes=1048607-2097213", "bytes=2097214-3145820", "bytes=3145821-4194426" } ) );
+}
+
+TEST(SegmentedDownloadTest, ResumeDroppedConnection)
+{
+	std::string data = PakData( 100000 );
+	mirrorOptions_t options;
+	options.dropFirst = true;
+	TestMirror mirror( data, options );
+	std::string result;
+
+	ASSERT_EQ( Download( mirror, data.size(), result ), dlStatus_t::DL_DONE );
+	EXPECT_TRUE( result == data );
+	EXPECT_EQ( mirror.Ranges(), std::vector<std::string>( { "", "bytes=50000-99999" } ) );
+}
+
+TEST(SegmentedDownloadTest, RangesIgnored)
+{
+	std::string data = PakData( 4 * 1024 * 1024 );
+	mirrorOptions_t options;
+	options.ignoreRanges = true;
+	std::string result;
+
+	{
+		TestMirror mirror( data, options );
+
+		ASSERT_EQ( Download( mirror, data.size(), result ), dlStatus_t::DL_DONE );
+		EXPECT_TRUE( result == data );
+		std::vector<std::string> ranges = mirror.Ranges();
+		EXPECT_EQ( std::count( ranges.begin(), ranges.end(), "" ), 1 );
+	}
+
+	// Resuming a download of unknown size starts it over
+	options.dropFirst = true;
+	TestMirror mirror( data, options );
+
+	ASSERT_EQ( Download( mirror, 0, result ), dlStatus_t::DL_DONE );
+	EXPECT_TRUE( result == data );
+	EXPECT_EQ( mirror.Ranges(), std::vector<std::string>( { "", "bytes=2097152-", "" } ) );
+}
+
+TEST(SegmentedDownloadTest, OversizedResponse)
+{
+	std::string data = PakData( 100000 );
+	mirrorOptions_t options;
+	options.oversized = true;
+	TestMirror mirror( data, options );
+	std::string result;
+
+	EXPECT_EQ( Download( mirror, data.size(), result ), dlStatus_t::DL_FAILED );
+
+	std::string splitData = PakData( 4 * 1024 * 1024 );
+	TestMirror splitMirror( splitData, options );
+
+	EXPECT_EQ( Download( splitMirror, splitData.size(), result ), dlStatus_t::DL_FAILED );
+}
+
+} // namespace
@@ -36,7 +36,7 @@ namespace Application {
 
     Traits::Traits()
     : isClient(false), isTTYClient(false), isServer(false),
-      defaultHomepath(FS::DefaultHomePath()), useCurses(false), supportsUri(false) {
+      defaultHomepath(FS::DefaultHomePath()), useCurses(false), supportsUri(false), useJobs(false) {
     }
 
     // Forward declaration of the function declared by INSTANTIATE_APPLICATION
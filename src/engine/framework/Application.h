@@ -49,6 +49,7 @@ struct Traits {
     std::string uniqueHomepathSuffix;
     bool useCurses;
     bool supportsUri;
+    bool useJobs; // start the job threads, for the programs submitting jobs
 };
 
 class Application {
@@ -53,10 +53,11 @@ class TestApplication : public ApplicationT
     static void RecursiveDelete(const std::string& dir)
     {
         std::vector<std::string> files;
-        // TODO: does this recurse in the right order?
         for (const std::string& s : FS::RawPath::ListFilesRecursive(dir)) {
             files.push_back(FS::Path::Build(dir, s));
         }
+        // Directories are listed before their contents, delete them after
+        std::reverse(files.begin(), files.end());
         files.push_back(dir + '/');
         for (const std::string& s : files) {
             if (s.back() == '/') {
@@ -78,6 +79,7 @@ public:
     {
         this->traits.supportsUri = false;
         this->traits.useCurses = false;
+        this->traits.useJobs = true;
 
 #ifdef _WIN32
         char* name = tempnam(nullptr, nullptr);
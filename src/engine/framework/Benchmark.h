@@ -1,7 +1,7 @@
 /*
 ===========================================================================
 Daemon BSD Source Code
-Copyright (c) 2025, Daemon Developers
+Copyright (c) 2026, Daemon Developers
 All rights reserved.
 
 Redistribution and use in source and binary forms, with or without
@@ -28,14 +28,23 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ===========================================================================
 */
 
-#ifndef COMMON_OMP_SYSTEM_H_
-#define COMMON_OMP_SYSTEM_H_
+#ifndef FRAMEWORK_BENCHMARK_H_
+#define FRAMEWORK_BENCHMARK_H_
 
-namespace Omp {
-void EnlistThreads();
-void SetupThreads();
-void Init();
-int GetThreads();
-};
+namespace Benchmark {
 
-#endif // COMMON_OMP_SYSTEM_H_
+// Average time of a call to func over the given number of calls, in microseconds
+template<typename Func> float Measure( int iterations, Func func )
+{
+	auto start = Sys::SteadyClock::now();
+	for ( int i = 0; i < iterations; i++ )
+	{
+		func();
+	}
+	auto duration = Sys::SteadyClock::now() - start;
+	return std::chrono::duration_cast<std::chrono::duration<float, std::micro>>( duration ).count() / iterations;
+}
+
+} // namespace Benchmark
+
+#endif // FRAMEWORK_BENCHMARK_H_
@@ -0,0 +1,124 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+
+// Compares BoxOnPlaneSide called for every box and plane with
+// BoxesOnPlanesSide, on boxes laid out like BSP leaves against a frustum.
+// These are disabled tests, run them with --gtest_also_run_disabled_tests.
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "common/Common.h"
+
+#include "Benchmark.h"
+
+namespace {
+
+// The renderer culls world leaves against FRUSTUM_PLANES
+constexpr int NUM_PLANES = 5;
+
+void FrustumPlanes( cplane_t *planes )
+{
+	vec3_t normals[ NUM_PLANES ] = {
+		{ 0.707f, 0.707f, 0.0f }, { 0.707f, -0.707f, 0.0f },
+		{ 0.707f, 0.0f, 0.707f }, { 0.707f, 0.0f, -0.707f },
+		{ 1.0f, 0.0f, 0.0f },
+	};
+
+	for ( int p = 0; p < NUM_PLANES; p++ )
+	{
+		VectorCopy( normals[ p ], planes[ p ].normal );
+		planes[ p ].dist = p == NUM_PLANES - 1 ? 4.0f : 0.0f;
+		planes[ p ].type = PlaneTypeForNormal( planes[ p ].normal );
+		SetPlaneSignbits( &planes[ p ] );
+	}
+}
+
+void RandomBoxes( int size, std::vector<float> *mins, std::vector<float> *maxs )
+{
+	std::mt19937 generator( size );
+	std::uniform_real_distribution<float> position( -4096.0f, 4096.0f );
+	std::uniform_real_distribution<float> extent( 16.0f, 512.0f );
+
+	for ( int j = 0; j < 3; j++ )
+	{
+		mins[ j ].resize( size );
+		maxs[ j ].resize( size );
+	}
+
+	for ( int i = 0; i < size; i++ )
+	{
+		for ( int j = 0; j < 3; j++ )
+		{
+			mins[ j ][ i ] = position( generator );
+			maxs[ j ][ i ] = mins[ j ][ i ] + extent( generator );
+		}
+	}
+}
+
+TEST(CullBenchmark, DISABLED_BoxesOnPlanesSide)
+{
+	cplane_t planes[ NUM_PLANES ];
+	FrustumPlanes( planes );
+
+	for ( int size : { 256, 1024, 4096, 16384 } )
+	{
+		std::vector<float> mins[ 3 ], maxs[ 3 ];
+		RandomBoxes( size, mins, maxs );
+		std::vector<uint32_t> sides( size );
+		int iterations = std::max( 16, ( 1 << 20 ) / size );
+
+		float scalarTime = Benchmark::Measure( iterations, [&] {
+			for ( int i = 0; i < size; i++ )
+			{
+				vec3_t boxMins = { mins[ 0 ][ i ], mins[ 1 ][ i ], mins[ 2 ][ i ] };
+				vec3_t boxMaxs = { maxs[ 0 ][ i ], maxs[ 1 ][ i ], maxs[ 2 ][ i ] };
+				uint32_t result = 0;
+
+				for ( int p = 0; p < NUM_PLANES; p++ )
+				{
+					result |= uint32_t( BoxOnPlaneSide( boxMins, boxMaxs, &planes[ p ] ) ) << ( 2 * p );
+				}
+
+				sides[ i ] = result;
+			}
+		} );
+
+		float batchTime = Benchmark::Measure( iterations, [&] {
+			BoxesOnPlanesSide( size, mins[ 0 ].data(), mins[ 1 ].data(), mins[ 2 ].data(),
+				maxs[ 0 ].data(), maxs[ 1 ].data(), maxs[ 2 ].data(), planes, NUM_PLANES, sides.data() );
+		} );
+
+		Log::Notice( "%6d boxes: BoxOnPlaneSide %9.2f us, BoxesOnPlanesSide %9.2f us", size, scalarTime, batchTime );
+	}
+}
+
+} // namespace
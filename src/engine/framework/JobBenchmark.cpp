@@ -0,0 +1,95 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+
+// Measures the overhead of Jobs::ParallelFor, compared with running the loop
+// on a single thread and with OpenMP when the engine is built with it. These
+// are disabled tests, run them with --gtest_also_run_disabled_tests.
+
+#include <gtest/gtest.h>
+
+#include "common/Common.h"
+
+#include "Benchmark.h"
+#include "JobSystem.h"
+
+#if defined(_OPENMP)
+#include "omp.h"
+#endif
+
+namespace {
+
+// A few operations per element, as in vertex skinning
+void Work( std::vector<float>& data, int first, int last )
+{
+	for ( int i = first; i < last; i++ )
+	{
+		data[ i ] = data[ i ] * 0.5f + sqrtf( data[ i ] + 1.0f );
+	}
+}
+
+TEST(JobBenchmark, DISABLED_ParallelFor)
+{
+	Log::Notice( "Running parallel loops with %d job threads", Jobs::GetThreads() );
+#if defined(_OPENMP)
+	Log::Notice( "OpenMP uses %d threads", omp_get_max_threads() );
+#endif
+
+	for ( int size : { 16, 256, 4096, 65536, 1048576 } )
+	{
+		std::vector<float> data( size, 1.0f );
+		int iterations = std::max( 16, ( 1 << 24 ) / size );
+
+		float serialTime = Benchmark::Measure( iterations, [&] {
+			Work( data, 0, size );
+		} );
+
+		float jobTime = Benchmark::Measure( iterations, [&] {
+			Jobs::ParallelFor( 0, size, 64, [&]( int first, int last ) {
+				Work( data, first, last );
+			} );
+		} );
+
+#if defined(_OPENMP)
+		float ompTime = Benchmark::Measure( iterations, [&] {
+			#pragma omp parallel for
+			for ( int i = 0; i < size; i++ )
+			{
+				Work( data, i, i + 1 );
+			}
+		} );
+
+		Log::Notice( "%7d elements: serial %9.2f us, jobs %9.2f us, OpenMP %9.2f us", size, serialTime, jobTime, ompTime );
+#else
+		Log::Notice( "%7d elements: serial %9.2f us, jobs %9.2f us", size, serialTime, jobTime );
+#endif
+	}
+}
+
+} // namespace
@@ -0,0 +1,367 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+
+#include "common/Common.h"
+
+#include "CvarSystem.h"
+#include "JobSystem.h"
+
+static Cvar::Range<Cvar::Cvar<int>> common_jobThreads(
+	"common.jobThreads", "threads running jobs including the main thread, 0 to pick a number from the CPU count", Cvar::NONE, 0, 0, 64 );
+static Cvar::Range<Cvar::Cvar<int>> common_jobSpinCount(
+	"common.jobSpinCount", "times an idle job thread looks for work before sleeping", Cvar::NONE, 64, 0, 100000 );
+
+namespace Jobs {
+
+class Job {
+public:
+	std::function<void()> func;
+
+	// Number of dependencies which are not done yet, plus one until the job
+	// is fully submitted
+	std::atomic<int> pendingDependencies{1};
+
+	std::atomic<bool> done{false};
+
+	// Jobs to release once this one is done, protected by lock
+	std::mutex lock;
+	std::vector<JobHandle> dependents;
+};
+
+// Worker 0 is any thread which isn't a job thread, it uses the shared deque
+static const int MAX_WORKERS = 65;
+static thread_local int workerIndex = 0;
+
+class Scheduler {
+public:
+	~Scheduler()
+	{
+		Stop();
+	}
+
+	void Start(int numThreads)
+	{
+		quit = false;
+		numWorkers = numThreads;
+		usedWorkers = std::max(usedWorkers.load(), numThreads + 1);
+		for (int i = 1; i <= numThreads; i++) {
+			threads.emplace_back(&Scheduler::WorkerMain, this, i);
+		}
+	}
+
+	void Stop()
+	{
+		{
+			std::lock_guard<std::mutex> guard(sleepLock);
+			quit = true;
+		}
+		wakeup.notify_all();
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+		threads.clear();
+		numWorkers = 0;
+
+		// Hand the jobs left by the stopped workers to the other threads
+		for (int i = 1; i < usedWorkers; i++) {
+			std::lock_guard<std::mutex> guard(queues[i].lock);
+			for (JobHandle& job : queues[i].jobs) {
+				std::lock_guard<std::mutex> sharedGuard(queues[0].lock);
+				queues[0].jobs.push_back(std::move(job));
+			}
+			queues[i].jobs.clear();
+		}
+	}
+
+	int NumWorkers() const
+	{
+		return numWorkers;
+	}
+
+	// Queue a job which is ready to run
+	void Push(JobHandle job)
+	{
+		// Without job threads, run it right away rather than waiting for
+		// someone to wait for it
+		if (numWorkers == 0 && workerIndex == 0) {
+			Run(job);
+			return;
+		}
+
+		{
+			WorkQueue& queue = queues[workerIndex];
+			std::lock_guard<std::mutex> guard(queue.lock);
+			queue.jobs.push_back(std::move(job));
+		}
+		queuedJobs++;
+
+		if (sleepingWorkers > 0) {
+			std::lock_guard<std::mutex> guard(sleepLock);
+			wakeup.notify_one();
+		}
+	}
+
+	// Run a job from our deque or stolen from another one, returns false if
+	// none were found
+	bool RunOne()
+	{
+		JobHandle job = PopOwn();
+		if (!job) {
+			job = Steal();
+		}
+		if (!job) {
+			return false;
+		}
+
+		queuedJobs--;
+		Run(job);
+		return true;
+	}
+
+	// Mark one of the dependencies of a job as done, queuing the job if it
+	// was the last one
+	void Release(JobHandle job)
+	{
+		if (--job->pendingDependencies == 0) {
+			Push(std::move(job));
+		}
+	}
+
+	// Times an idle worker looks for jobs before sleeping
+	std::atomic<int> spinCount{64};
+
+private:
+	struct WorkQueue {
+		std::mutex lock;
+		std::deque<JobHandle> jobs;
+	};
+
+	JobHandle PopOwn()
+	{
+		WorkQueue& queue = queues[workerIndex];
+		std::lock_guard<std::mutex> guard(queue.lock);
+		if (queue.jobs.empty()) {
+			return nullptr;
+		}
+		JobHandle job = std::move(queue.jobs.back());
+		queue.jobs.pop_back();
+		return job;
+	}
+
+	JobHandle Steal()
+	{
+		int count = usedWorkers;
+		for (int i = 1; i <= count; i++) {
+			WorkQueue& queue = queues[(workerIndex + i) % count];
+			std::lock_guard<std::mutex> guard(queue.lock);
+			if (!queue.jobs.empty()) {
+				JobHandle job = std::move(queue.jobs.front());
+				queue.jobs.pop_front();
+				return job;
+			}
+		}
+		return nullptr;
+	}
+
+	void Run(const JobHandle& job)
+	{
+		job->func();
+		job->func = nullptr;
+
+		std::vector<JobHandle> dependents;
+		{
+			std::lock_guard<std::mutex> guard(job->lock);
+			job->done.store(true, std::memory_order_release);
+			std::swap(dependents, job->dependents);
+		}
+		for (JobHandle& dependent : dependents) {
+			Release(dependent);
+		}
+	}
+
+	void WorkerMain(int index)
+	{
+		workerIndex = index;
+		int idleCount = 0;
+		while (true) {
+			if (RunOne()) {
+				idleCount = 0;
+				continue;
+			}
+
+			if (++idleCount < spinCount) {
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> guard(sleepLock);
+			if (quit) {
+				return;
+			}
+			sleepingWorkers++;
+			wakeup.wait(guard, [this] { return quit || queuedJobs > 0; });
+			sleepingWorkers--;
+			idleCount = 0;
+		}
+	}
+
+	WorkQueue queues[MAX_WORKERS];
+	std::vector<std::thread> threads;
+	std::atomic<int> numWorkers{0};
+
+	// Number of deques which may contain jobs
+	std::atomic<int> usedWorkers{1};
+
+	std::atomic<int> queuedJobs{0};
+	std::atomic<int> sleepingWorkers{0};
+
+	std::mutex sleepLock;
+	std::condition_variable wakeup;
+	bool quit = false;
+};
+
+static Scheduler scheduler;
+
+JobHandle Submit(std::function<void()> func, const std::vector<JobHandle>& dependencies)
+{
+	JobHandle job = std::make_shared<Job>();
+	job->func = std::move(func);
+
+	for (const JobHandle& dependency : dependencies) {
+		std::lock_guard<std::mutex> guard(dependency->lock);
+		if (!dependency->done) {
+			job->pendingDependencies++;
+			dependency->dependents.push_back(job);
+		}
+	}
+
+	scheduler.Release(job);
+	return job;
+}
+
+bool IsDone(const JobHandle& job)
+{
+	return job->done.load(std::memory_order_acquire);
+}
+
+void Wait(const JobHandle& job)
+{
+	while (!IsDone(job)) {
+		if (!scheduler.RunOne()) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void ParallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>& func)
+{
+	int count = end - begin;
+	int numWorkers = scheduler.NumWorkers();
+	grainSize = std::max(grainSize, 1);
+	if (count <= grainSize || numWorkers == 0) {
+		if (count > 0) {
+			func(begin, end);
+		}
+		return;
+	}
+
+	// Use a few chunks per thread so that threads which finish early can help
+	// the others, and let every thread take chunks from a shared counter so
+	// that only one job per helper thread is needed
+	int numChunks = std::min((count + grainSize - 1) / grainSize, (numWorkers + 1) * 4);
+	int chunkSize = (count + numChunks - 1) / numChunks;
+	std::atomic<int> nextChunk{0};
+	auto runChunks = [&] {
+		int chunk;
+		while ((chunk = nextChunk++) < numChunks) {
+			int first = begin + chunk * chunkSize;
+			func(first, std::min(first + chunkSize, end));
+		}
+	};
+
+	int numHelpers = std::min(numWorkers, numChunks - 1);
+	std::vector<JobHandle> helpers;
+	helpers.reserve(numHelpers);
+	for (int i = 0; i < numHelpers; i++) {
+		helpers.push_back(Submit(runChunks));
+	}
+
+	runChunks();
+
+	for (const JobHandle& helper : helpers) {
+		Wait(helper);
+	}
+}
+
+static bool initialized = false;
+static int threadsSetting = -1;
+
+void SetupThreads()
+{
+	if (!initialized) {
+		return;
+	}
+
+	scheduler.spinCount = common_jobSpinCount.Get();
+
+	int setting = common_jobThreads.Get();
+	if (setting == threadsSetting) {
+		return;
+	}
+	threadsSetting = setting;
+
+	int numThreads = setting;
+	if (numThreads == 0) {
+		// Leave a core for the render thread and the rest of the system
+		int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+		numThreads = Math::Clamp(hardwareThreads - 1, 1, 16);
+	}
+
+	scheduler.Stop();
+	try {
+		scheduler.Start(std::min(numThreads - 1, MAX_WORKERS - 1));
+	} catch (std::system_error& err) {
+		Log::Warn("Could not create the job threads, jobs will run on the calling thread: %s", err.what());
+		scheduler.Stop();
+	}
+}
+
+void Init()
+{
+	initialized = true;
+	SetupThreads();
+}
+
+int GetThreads()
+{
+	return scheduler.NumWorkers() + 1;
+}
+
+} // namespace Jobs
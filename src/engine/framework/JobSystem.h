@@ -0,0 +1,76 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+
+#ifndef FRAMEWORK_JOB_SYSTEM_H_
+#define FRAMEWORK_JOB_SYSTEM_H_
+
+/*
+ * The job system runs small tasks on a persistent pool of worker threads.
+ * Each worker has its own deque of jobs: it pushes and pops the jobs it
+ * creates at the back, and idle workers steal jobs from the front of the other
+ * deques. Jobs submitted by other threads go to a shared deque. Threads which
+ * wait for a job run other jobs in the meantime, so waiting from within a job
+ * doesn't deadlock.
+ *
+ * Jobs must not throw exceptions.
+ */
+
+namespace Jobs {
+
+class Job;
+using JobHandle = std::shared_ptr<Job>;
+
+// Run a function on the job threads once all the given jobs are done
+JobHandle Submit(std::function<void()> func, const std::vector<JobHandle>& dependencies = {});
+
+// Check if a job has been run
+bool IsDone(const JobHandle& job);
+
+// Wait for a job to be done, running other jobs on this thread meanwhile
+void Wait(const JobHandle& job);
+
+// Split [begin, end) into ranges of at least grainSize elements and call
+// func(first, last) on each of them, in parallel, returning once all the calls
+// are done. Small ranges are run directly on the calling thread.
+void ParallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>& func);
+
+// Start the worker threads. Programs which don't call it run jobs on the
+// threads waiting for them.
+void Init();
+
+// Apply changes to the common.jobThreads cvar, once Init was called
+void SetupThreads();
+
+// Number of threads running jobs, including the calling thread
+int GetThreads();
+
+} // namespace Jobs
+
+#endif // FRAMEWORK_JOB_SYSTEM_H_
@@ -0,0 +1,96 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+
+#include <gtest/gtest.h>
+
+#include "common/Common.h"
+#include "JobSystem.h"
+
+namespace Jobs {
+namespace {
+
+TEST(JobSystemTest, ParallelForCoversRange)
+{
+    for (int size : {0, 1, 100, 10000}) {
+        std::vector<std::atomic<int>> counts(size);
+        // Assertions only work on the test thread
+        std::atomic<bool> emptyRange{false};
+        ParallelFor(0, size, 16, [&](int first, int last) {
+            if (first >= last) {
+                emptyRange = true;
+            }
+            for (int i = first; i < last; i++) {
+                counts[i]++;
+            }
+        });
+        ASSERT_FALSE(emptyRange) << "size " << size;
+        for (int i = 0; i < size; i++) {
+            ASSERT_EQ(counts[i], 1) << "index " << i << " of " << size;
+        }
+    }
+}
+
+TEST(JobSystemTest, DependenciesRunFirst)
+{
+    std::atomic<int> doneCount{0};
+    std::vector<JobHandle> dependencies;
+    for (int i = 0; i < 8; i++) {
+        dependencies.push_back(Submit([&] { doneCount++; }));
+    }
+
+    int seenCount = -1;
+    JobHandle job = Submit([&] { seenCount = doneCount; }, dependencies);
+    Wait(job);
+
+    EXPECT_EQ(seenCount, 8);
+    for (const JobHandle& dependency : dependencies) {
+        EXPECT_TRUE(IsDone(dependency));
+    }
+}
+
+TEST(JobSystemTest, WaitInsideJob)
+{
+    int result = 0;
+    JobHandle outer = Submit([&] {
+        int sum = 0;
+        ParallelFor(0, 1000, 10, [&](int first, int last) {
+            (void)first;
+            (void)last;
+        });
+        JobHandle inner = Submit([&] { sum = 42; });
+        Wait(inner);
+        result = sum;
+    });
+    Wait(outer);
+    EXPECT_EQ(result, 42);
+}
+
+} // namespace
+} // namespace Jobs
@@ -36,32 +36,226 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace Log {
     static Target* targets[MAX_TARGET_ID];
 
+    static Cvar::Cvar<bool> asyncDispatch("logs.async", "send the logs to their targets from a background thread, disable to print them immediately when debugging crashes", Cvar::INIT | Cvar::TEMPORARY, true);
+
+    // Bounded multi-producer single-consumer queue of the events waiting for
+    // the dispatch thread. Each slot has a sequence number telling whether it
+    // is free for the producer of a given position or filled for the consumer,
+    // so producers only need an atomic increment to claim a slot.
+    class EventQueue {
+        public:
+            static const size_t SIZE = 4096;
+
+            EventQueue() {
+                for (size_t i = 0; i < SIZE; i++) {
+                    slots[i].sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            // Can be called by any thread, returns false if the queue is full
+            bool Push(Log::Event& event, int targetControl) {
+                size_t pos = pushPos.load(std::memory_order_relaxed);
+                while (true) {
+                    Slot& slot = slots[pos % SIZE];
+                    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                    intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+                    if (diff == 0) {
+                        if (pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            slot.text = std::move(event.text);
+                            slot.targetControl = targetControl;
+                            slot.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    } else if (diff < 0) {
+                        return false;
+                    } else {
+                        pos = pushPos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            // Must only be called by the consumer
+            bool Empty() const {
+                return slots[popPos % SIZE].sequence.load(std::memory_order_acquire) != popPos + 1;
+            }
+
+            // Must only be called by the consumer, returns false if the queue is empty
+            bool Pop(std::string& text, int& targetControl) {
+                Slot& slot = slots[popPos % SIZE];
+                if (slot.sequence.load(std::memory_order_acquire) != popPos + 1) {
+                    return false;
+                }
+                text = std::move(slot.text);
+                targetControl = slot.targetControl;
+                slot.sequence.store(popPos + SIZE, std::memory_order_release);
+                popPos++;
+                return true;
+            }
+
+        private:
+            struct Slot {
+                std::atomic<size_t> sequence;
+                std::string text;
+                int targetControl;
+            };
+
+            Slot slots[SIZE];
+            std::atomic<size_t> pushPos{0};
+            size_t popPos = 0;
+    };
+
+    // The dispatch state is created on first use since events can be
+    // dispatched during static initialization.
+    struct DispatchState {
+        std::vector<Log::Event> buffers[MAX_TARGET_ID];
+        std::recursive_mutex bufferLocks[MAX_TARGET_ID];
+
+        EventQueue queue;
+        std::atomic<bool> threadRunning{false};
+        std::atomic<bool> threadSleeping{false};
+        std::atomic<size_t> droppedEvents{0};
+        bool quit = false;
+        std::mutex threadLock;
+        std::condition_variable threadWakeup;
+        std::thread thread;
+    };
+
+    static DispatchState& GetDispatchState() {
+        static DispatchState state;
+        return state;
+    }
+
+    // Give the buffered events of a target to it, the lock of the target
+    // must be held.
+    static void ProcessBuffer(DispatchState& state, int targetId) {
+        auto& buffer = state.buffers[targetId];
+
+        bool processed = false;
+        if (targets[targetId]) {
+            processed = targets[targetId]->Process(buffer);
+        }
+
+        if (processed || buffer.size() > 512) {
+            buffer.clear();
+        }
+    }
+
+    // Send all the queued events to their targets, in batches
+    static void ProcessQueue(DispatchState& state) {
+        std::vector<std::pair<std::string, int>> events;
+        std::string text;
+        int targetControl;
+        while (true) {
+            events.clear();
+            while (events.size() < 256 && state.queue.Pop(text, targetControl)) {
+                events.emplace_back(std::move(text), targetControl);
+            }
+            if (events.empty()) {
+                return;
+            }
+
+            for (int i = 0; i < MAX_TARGET_ID; i++) {
+                std::lock_guard<std::recursive_mutex> guard(state.bufferLocks[i]);
+                bool added = false;
+                for (auto& event : events) {
+                    if ((event.second >> i) & 1) {
+                        state.buffers[i].emplace_back(event.first);
+                        added = true;
+                    }
+                }
+                if (added) {
+                    ProcessBuffer(state, i);
+                }
+            }
+        }
+    }
+
+    static void DispatchThread() {
+        DispatchState& state = GetDispatchState();
+        std::unique_lock<std::mutex> lock(state.threadLock);
+        while (true) {
+            lock.unlock();
+            ProcessQueue(state);
+            size_t dropped = state.droppedEvents.exchange(0);
+            if (dropped) {
+                Log::Warn("%d log messages were dropped because too many were sent at once", dropped);
+            }
+            lock.lock();
+
+            if (state.quit) {
+                break;
+            }
+
+            // Producers only take the lock to wake us up if they see that we
+            // are sleeping, so check the queue again after setting the flag.
+            state.threadSleeping = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (state.queue.Empty()) {
+                state.threadWakeup.wait_for(lock, std::chrono::milliseconds(100));
+            }
+            state.threadSleeping = false;
+        }
+    }
+
+    void StartDispatchThread() {
+        DispatchState& state = GetDispatchState();
+        if (!asyncDispatch.Get() || state.threadRunning) {
+            return;
+        }
+
+        try {
+            state.quit = false;
+            state.thread = std::thread(DispatchThread);
+            state.threadRunning = true;
+        } catch (std::system_error& err) {
+            Log::Warn("Could not create the log dispatch thread, logs will be dispatched synchronously: %s", err.what());
+        }
+    }
+
+    void StopDispatchThread() {
+        DispatchState& state = GetDispatchState();
+        if (!state.threadRunning || std::this_thread::get_id() == state.thread.get_id()) {
+            return;
+        }
+
+        state.threadRunning = false;
+        {
+            std::lock_guard<std::mutex> guard(state.threadLock);
+            state.quit = true;
+        }
+        state.threadWakeup.notify_one();
+        state.thread.join();
+
+        // Catch the events sent while the thread was exiting
+        ProcessQueue(state);
+    }
 
-    //TODO make me reentrant // or check it is actually reentrant when using for (Event e : events) do stuff
     //TODO think way more about thread safety
     void Dispatch(Log::Event event, int targetControl) {
-        static std::vector<Log::Event> buffers[MAX_TARGET_ID];
-        static std::recursive_mutex bufferLocks[MAX_TARGET_ID];
-
         if (Sys::IsProcessTerminating()) {
             return;
         }
 
-        for (int i = 0; i < MAX_TARGET_ID; i++) {
-            if ((targetControl >> i) & 1) {
-                std::lock_guard<std::recursive_mutex> guard(bufferLocks[i]);
-                auto& buffer = buffers[i];
-
-                buffer.push_back(event);
+        DispatchState& state = GetDispatchState();
 
-                bool processed = false;
-                if (targets[i]) {
-                    processed = targets[i]->Process(buffer);
-                }
+        if (state.threadRunning) {
+            if (!state.queue.Push(event, targetControl)) {
+                state.droppedEvents++;
+                return;
+            }
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (state.threadSleeping) {
+                std::lock_guard<std::mutex> guard(state.threadLock);
+                state.threadWakeup.notify_one();
+            }
+            return;
+        }
 
-                if (processed || buffer.size() > 512) {
-                    buffer.clear();
-                }
+        for (int i = 0; i < MAX_TARGET_ID; i++) {
+            if ((targetControl >> i) & 1) {
+                std::lock_guard<std::recursive_mutex> guard(state.bufferLocks[i]);
+                state.buffers[i].push_back(event);
+                ProcessBuffer(state, i);
             }
         }
     }
@@ -78,7 +272,6 @@ namespace Log {
 
     //Log Targets
     //TODO: move them in their respective modules
-    //TODO this one isn't multithreaded at all, need a rewrite of the consoles
     class TTYTarget : public Target {
         public:
             TTYTarget() {
@@ -86,6 +279,8 @@ namespace Log {
             }
 
             virtual bool Process(const std::vector<Log::Event>& events) override {
+                // Called from the dispatch thread while the main thread reads console input
+                std::lock_guard<std::recursive_mutex> guard(CON_Mutex());
                 for (auto& event : events)  {
                     CON_Print(event.text.c_str());
                     CON_Print("\n");
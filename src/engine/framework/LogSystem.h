@@ -44,9 +44,19 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace Log {
 
     // Dispatches the event to all the targets specified by targetControl (flags)
-    // Can be called by any thread.
+    // Can be called by any thread. While the dispatch thread is running the
+    // event is queued for it, otherwise the targets are called immediately.
     void Dispatch(Log::Event event, int targetControl);
 
+    // Start the thread which sends the events to the targets, unless
+    // logs.async is disabled. Threads must not be created before Breakpad is
+    // initialized, so the events are dispatched synchronously until then.
+    void StartDispatchThread();
+
+    // Send the remaining events and stop the dispatch thread, going back to
+    // synchronous dispatch
+    void StopDispatchThread();
+
     // Open the log file and start writing to it
     void OpenLogFile();
 
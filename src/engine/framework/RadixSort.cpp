@@ -0,0 +1,117 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+
+#include "common/Common.h"
+
+#include "JobSystem.h"
+#include "RadixSort.h"
+
+namespace RadixSort {
+
+static constexpr int DIGIT_BITS = 11;
+static constexpr uint32_t NUM_BUCKETS = 1 << DIGIT_BITS;
+
+// Below this the histograms cost more than a comparison sort
+static constexpr size_t SMALL_SORT_SIZE = 2048;
+
+// Minimum number of items handled by each job thread
+static constexpr int CHUNK_SIZE = 16384;
+
+using Histogram = std::array<uint32_t, NUM_BUCKETS>;
+
+void Sort(std::vector<Item>& items, std::vector<Item>& scratch, int keyBits)
+{
+	if (items.size() <= SMALL_SORT_SIZE) {
+		std::stable_sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+			return a.key < b.key;
+		});
+		return;
+	}
+
+	int count = items.size();
+	int numChunks = Math::Clamp(count / CHUNK_SIZE, 1, Jobs::GetThreads());
+	int numPasses = (keyBits + DIGIT_BITS - 1) / DIGIT_BITS;
+	std::vector<Histogram> histograms(numChunks);
+
+	scratch.resize(count);
+
+	auto chunkBegin = [&](int chunk) {
+		return static_cast<int>(static_cast<int64_t>(count) * chunk / numChunks);
+	};
+
+	for (int pass = 0; pass < numPasses; pass++) {
+		int shift = pass * DIGIT_BITS;
+		const Item* source = items.data();
+		Item* destination = scratch.data();
+
+		Jobs::ParallelFor(0, numChunks, 1, [&](int first, int last) {
+			for (int chunk = first; chunk < last; chunk++) {
+				Histogram& histogram = histograms[chunk];
+				histogram.fill(0);
+
+				for (int i = chunkBegin(chunk), end = chunkBegin(chunk + 1); i < end; i++) {
+					histogram[(source[i].key >> shift) & (NUM_BUCKETS - 1)]++;
+				}
+			}
+		});
+
+		// Turn the counts into the offsets where each chunk writes each
+		// digit, skipping the pass if all the keys have the same digit
+		uint32_t offset = 0;
+		bool sameDigit = false;
+		for (uint32_t bucket = 0; bucket < NUM_BUCKETS && !sameDigit; bucket++) {
+			for (Histogram& histogram : histograms) {
+				uint32_t bucketCount = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucketCount;
+			}
+
+			sameDigit = histograms[0][bucket] == 0 && offset == static_cast<uint32_t>(count);
+		}
+
+		if (sameDigit) {
+			continue;
+		}
+
+		Jobs::ParallelFor(0, numChunks, 1, [&](int first, int last) {
+			for (int chunk = first; chunk < last; chunk++) {
+				Histogram& offsets = histograms[chunk];
+
+				for (int i = chunkBegin(chunk), end = chunkBegin(chunk + 1); i < end; i++) {
+					destination[offsets[(source[i].key >> shift) & (NUM_BUCKETS - 1)]++] = source[i];
+				}
+			}
+		});
+
+		items.swap(scratch);
+	}
+}
+
+} // namespace RadixSort
@@ -0,0 +1,55 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+
+#ifndef FRAMEWORK_RADIX_SORT_H_
+#define FRAMEWORK_RADIX_SORT_H_
+
+/*
+ * LSD radix sort on integer keys, for the arrays which are sorted every frame
+ * such as the draw surfaces. The keys are sorted 11 bits at a time, skipping
+ * the digits which are the same in all the keys, and large arrays are split
+ * between the job threads.
+ */
+
+namespace RadixSort {
+
+struct Item {
+	uint64_t key;
+	uint32_t value;
+};
+
+// Sort the items by key, keeping the order of items with equal keys. Only the
+// lowest keyBits bits of the keys are looked at and the other bits must be 0.
+// The content of scratch is overwritten.
+void Sort(std::vector<Item>& items, std::vector<Item>& scratch, int keyBits = 64);
+
+} // namespace RadixSort
+
+#endif // FRAMEWORK_RADIX_SORT_H_
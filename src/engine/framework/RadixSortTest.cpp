@@ -0,0 +1,98 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "common/Common.h"
+#include "RadixSort.h"
+
+namespace RadixSort {
+namespace {
+
+std::vector<Item> RandomItems(int count, int keyBits, std::mt19937_64& generator)
+{
+    uint64_t mask = keyBits == 64 ? ~uint64_t(0) : (uint64_t(1) << keyBits) - 1;
+    std::vector<Item> items(count);
+    for (int i = 0; i < count; i++) {
+        items[i] = {generator() & mask, static_cast<uint32_t>(i)};
+    }
+    return items;
+}
+
+void ExpectSortedLikeStableSort(std::vector<Item> items, int keyBits)
+{
+    std::vector<Item> expected = items;
+    std::stable_sort(expected.begin(), expected.end(), [](const Item& a, const Item& b) {
+        return a.key < b.key;
+    });
+
+    std::vector<Item> scratch;
+    Sort(items, scratch, keyBits);
+
+    ASSERT_EQ(items.size(), expected.size());
+    for (size_t i = 0; i < items.size(); i++) {
+        ASSERT_EQ(items[i].key, expected[i].key) << "index " << i;
+        ASSERT_EQ(items[i].value, expected[i].value) << "index " << i;
+    }
+}
+
+TEST(RadixSortTest, SortsRandomKeys)
+{
+    std::mt19937_64 generator(1);
+    for (int count : {0, 1, 100, 5000, 70000}) {
+        for (int keyBits : {8, 33, 61, 64}) {
+            ExpectSortedLikeStableSort(RandomItems(count, keyBits, generator), keyBits);
+        }
+    }
+}
+
+TEST(RadixSortTest, KeepsOrderOfEqualKeys)
+{
+    std::mt19937_64 generator(2);
+    std::vector<Item> items = RandomItems(50000, 4, generator);
+    for (Item& item : items) {
+        item.key <<= 30;
+    }
+    ExpectSortedLikeStableSort(items, 34);
+}
+
+TEST(RadixSortTest, SortsIdenticalKeys)
+{
+    std::vector<Item> items(5000, {12345, 0});
+    for (size_t i = 0; i < items.size(); i++) {
+        items[i].value = i;
+    }
+    ExpectSortedLikeStableSort(items, 64);
+}
+
+} // namespace
+} // namespace RadixSort
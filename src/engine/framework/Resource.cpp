@@ -33,7 +33,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace Resource {
 
     Resource::Resource(std::string name) : name(std::move(name)),
-    loaded(false), failed(false), keep(true) {
+    loaded(false), failed(false), prepared(false), keep(true) {
     }
 
     Resource::~Resource() = default;
@@ -42,6 +42,10 @@ namespace Resource {
         return true;
     }
 
+    bool Resource::Prepare() {
+        return true;
+    }
+
     bool Resource::IsStillValid() {
         return true;
     }
@@ -50,8 +54,23 @@ namespace Resource {
         return name;
     }
 
+    bool Resource::IsLoaded() const {
+        return loaded;
+    }
+
+    bool Resource::IsPrepared() const {
+        return not prepareJob or Jobs::IsDone(prepareJob);
+    }
+
     bool Resource::TryLoad() {
-        loaded = Load();
+        if (prepareJob) {
+            Jobs::Wait(prepareJob);
+            prepareJob = nullptr;
+        } else {
+            prepared = Prepare();
+        }
+
+        loaded = prepared and Load();
         if (not loaded) {
             failed = true;
         }
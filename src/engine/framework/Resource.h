@@ -32,6 +32,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define FRAMEWORK_RESOURCE_H_
 
 #include "common/Common.h"
+#include "JobSystem.h"
 
 /*
  * Resource registration logic.
@@ -41,7 +42,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *  1 - resources to be loaded from the disk only if they aren't already loaded
  *  2 - to prevent duplicates of resources
  *  3 - resources to have dependencies on other resources (e.g. for shaders)
- *  4 - (TODO) allow asynchronous loading
+ *  4 - resources registered during the registration to be loaded asynchronously
  */
 
 namespace Resource {
@@ -84,12 +85,14 @@ namespace Resource {
     /*
      * The interface that resources must implement to be used by the resource system.
      *
-     * The resource loading is in three phases, first the Resource is instanciated
+     * The resource loading is in four phases, first the Resource is instanciated
      * but it does mostly nothing, then TagDependencies is called that should load
      * from the disk only what is needed to know the dependencies of that resource
-     * (for example shaders might depend on textures). Finally Load is called, that
-     * does the actual loading of the resource from the disk. (there will be async
-     * IO at some point).
+     * (for example shaders might depend on textures). Then Prepare is called, that
+     * does the heavy loading from the disk, on the job threads for resources
+     * registered during the registration. Finally Load is called on the main
+     * thread to hand the data over to the subsystem (for example upload it to
+     * OpenAL).
      *
      * The data should be loaded from the end of Load and until Cleanup is called,
      * the Resource::Manager is the one in charge of deleting the Resource object.
@@ -107,8 +110,15 @@ namespace Resource {
             // Defaults to []{return true;}
             virtual bool TagDependencies();
 
-            // Loads the resource, doing potentially big IO, should return true on
-            // success and false on error (in which case the resource will be deleted)
+            // Reads and decodes the resource, should return true on success and false on
+            // error (in which case the resource will be deleted). It may run on a job
+            // thread so it must only touch the resource itself and thread-safe systems.
+            // Defaults to []{return true;}
+            virtual bool Prepare();
+
+            // Loads the resource on the main thread, after Prepare succeeded, should
+            // return true on success and false on error (in which case the resource
+            // will be deleted)
             // TODO provide a facility to know if resources we depend on have been loaded?
             virtual bool Load() = 0;
 
@@ -124,14 +134,22 @@ namespace Resource {
             // Returns the name of the resource.
             const std::string& GetName() const;
 
+            // Whether the resource can be used, false while it is being loaded asynchronously.
+            bool IsLoaded() const;
+
         private:
             bool TryLoad();
+            bool IsPrepared() const;
 
             std::string name;
 
             bool loaded;
             bool failed;
 
+            // The job running Prepare, it sets prepared
+            Jobs::JobHandle prepareJob;
+            bool prepared;
+
             //TODO remove .keep once we have VM handles
             // It is needed for now because the VM cannot ask for a shared_ptr so it
             // doesn't add a refcount. .keep is a hack to avoid deleting resources
@@ -144,9 +162,10 @@ namespace Resource {
 
     /*
      * Manages resources so as to avoid redundant loads as well as defer the loading
-     * to prepare for async loading. The manager can be in two states, either in the
-     * registration during which the loading of resources will be deferred, either not
-     * in the registration in which case resources will be loaded immediately.
+     * to load them asynchronously. The manager can be in two states, either in the
+     * registration during which the resources are prepared on the job threads and
+     * loaded later by FinishLoading, either not in the registration in which case
+     * resources will be loaded immediately.
      *
      * The manager gives Handle to resources, a resource will be candidate for
      * deletion when no more handles referring to that resource exist (so that we are
@@ -167,9 +186,17 @@ namespace Resource {
             // registration.
             void BeginRegistration(bool loadImmediately = false);
 
-            // Ends the registration.
+            // Ends the registration. The resources still being prepared keep loading
+            // in the background, call FinishLoading to wait for them.
             void EndRegistration();
 
+            // Loads the resources which are done being prepared, called each frame.
+            // If wait is true, waits for all the resources to be loaded.
+            void FinishLoading(bool wait);
+
+            // Waits for a single resource to be loaded.
+            void FinishLoading(const std::shared_ptr<T>& resource);
+
             // Registers the resource. Returns a handle to
             // a resource (might not be the same as provided: if an error occurs, it returns
             // the default value).
@@ -195,9 +222,14 @@ namespace Resource {
             // Like Register() but returns null instead of the default value
             std::shared_ptr<T> RegisterInternal(Str::StringRef name);
 
+            // Loads a prepared resource, deleting it on error
+            void FinishPending(const std::shared_ptr<T>& resource);
+
             bool inRegistration;
             bool immediate;
             std::shared_ptr<T> defaultValue;
+            // The resources being prepared on the job threads
+            std::vector<std::shared_ptr<T>> pending;
             // We store a StringRef to the resource's name as we know that the lifetime
             // of the resource will be longer than the one of the hashmap entry.
             std::unordered_map<Str::StringRef, std::shared_ptr<T>> resources;
@@ -215,6 +247,11 @@ namespace Resource {
 
     template<typename T>
     Manager<T>::~Manager() {
+        // Prepare may still be running for resources that will never be loaded
+        for (auto& resource : pending) {
+            Jobs::Wait(resource->prepareJob);
+        }
+
         //TODO assert that we have the ownership of all the resources?
     }
 
@@ -233,17 +270,40 @@ namespace Resource {
         // Delete unused resources
         Prune();
 
-        // And then load the new ones, so as to reduce peak memory usage.
-        for (auto it = resources.begin(); it != resources.end(); ) {
-            if (!it->second->loaded && !it->second->TryLoad()) {
-                it->second->Cleanup();
-                it = resources.erase(it);
+        // And then load the new ones that are ready, the others are loaded as they come
+        FinishLoading(false);
+
+        inRegistration = false;
+    }
+
+    template<typename T>
+    void Manager<T>::FinishLoading(bool wait) {
+        for (auto it = pending.begin(); it != pending.end(); ) {
+            if (wait or (*it)->IsPrepared()) {
+                FinishPending(*it);
+                it = pending.erase(it);
             } else {
                 ++it;
             }
         }
+    }
 
-        inRegistration = false;
+    template<typename T>
+    void Manager<T>::FinishLoading(const std::shared_ptr<T>& resource) {
+        auto it = std::find(pending.begin(), pending.end(), resource);
+
+        if (it != pending.end()) {
+            FinishPending(resource);
+            pending.erase(it);
+        }
+    }
+
+    template<typename T>
+    void Manager<T>::FinishPending(const std::shared_ptr<T>& resource) {
+        if (not resource->TryLoad()) {
+            resource->Cleanup();
+            resources.erase(resource->GetName());
+        }
     }
 
     template<typename T>
@@ -262,6 +322,16 @@ namespace Resource {
 
         if (inRegistration and not immediate) {
             resources[resource->GetName()] = resource;
+
+            resource->prepareJob = Jobs::Submit([resource] {
+                try {
+                    resource->prepared = resource->Prepare();
+                } catch (...) {
+                    // Jobs must not throw
+                    resource->prepared = false;
+                }
+            });
+            pending.push_back(resource);
         } else {
             if (resource->TryLoad()) {
                 resources[resource->GetName()] = resource;
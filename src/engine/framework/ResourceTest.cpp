@@ -0,0 +1,124 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+
+#include <gtest/gtest.h>
+
+#include "common/Common.h"
+#include "Resource.h"
+
+namespace Resource {
+namespace {
+
+// Fails to load when the name starts with "bad", counts the threads it is loaded on
+class TestResource : public Resource {
+    public:
+        explicit TestResource(std::string name): Resource(name) {}
+
+        bool Prepare() override {
+            prepareThread = std::this_thread::get_id();
+            return not Str::IsPrefix("bad", GetName());
+        }
+
+        bool Load() override {
+            loadThread = std::this_thread::get_id();
+            return true;
+        }
+
+        void Cleanup() override {}
+
+        std::thread::id prepareThread;
+        std::thread::id loadThread;
+};
+
+TEST(ResourceTest, ImmediateLoadOutsideRegistration)
+{
+    Manager<TestResource> manager("default");
+
+    Handle<TestResource> handle = manager.Register("foo");
+    EXPECT_TRUE(handle.Get()->IsLoaded());
+    EXPECT_EQ(handle.Get()->prepareThread, std::this_thread::get_id());
+
+    EXPECT_TRUE(manager.Register("bad").IsDefault());
+}
+
+TEST(ResourceTest, AsyncLoadDuringRegistration)
+{
+    Manager<TestResource> manager("default");
+
+    manager.BeginRegistration();
+    std::vector<Handle<TestResource>> handles;
+    for (int i = 0; i < 32; i++) {
+        handles.push_back(manager.Register(Str::Format("foo%d", i)));
+    }
+    Handle<TestResource> bad = manager.Register("bad");
+    manager.EndRegistration();
+
+    manager.FinishLoading(true);
+
+    for (Handle<TestResource>& handle : handles) {
+        EXPECT_TRUE(handle.Get()->IsLoaded());
+        EXPECT_EQ(handle.Get()->loadThread, std::this_thread::get_id());
+    }
+    EXPECT_TRUE(bad.Get() == manager.GetDefaultResource());
+    EXPECT_EQ(manager.Size(), 33);
+}
+
+TEST(ResourceTest, WaitForSingleResource)
+{
+    Manager<TestResource> manager("default");
+
+    manager.BeginRegistration();
+    Handle<TestResource> handle = manager.Register("foo");
+    manager.FinishLoading(handle.Get());
+    EXPECT_TRUE(handle.Get()->IsLoaded());
+    manager.EndRegistration();
+}
+
+TEST(ResourceTest, DestroyWhilePreparing)
+{
+    std::vector<Handle<TestResource>> handles;
+
+    {
+        Manager<TestResource> manager("default");
+
+        manager.BeginRegistration();
+        for (int i = 0; i < 32; i++) {
+            handles.push_back(manager.Register(Str::Format("foo%d", i)));
+        }
+    }
+
+    for (Handle<TestResource>& handle : handles) {
+        EXPECT_NE(handle.Get()->prepareThread, std::thread::id());
+        EXPECT_FALSE(handle.Get()->IsLoaded());
+    }
+}
+
+} // namespace
+} // namespace Resource
@@ -0,0 +1,94 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+
+// Compares RadixSort::Sort with std::sort on keys laid out like the renderer's
+// draw surface sort keys, for typical and worst case surface counts. These
+// are disabled tests, run them with --gtest_also_run_disabled_tests.
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "common/Common.h"
+
+#include "Benchmark.h"
+#include "RadixSort.h"
+
+namespace {
+
+// Same layout as drawSurf_t::setSort: index, entity, lightmap and shader
+constexpr int KEY_BITS = 61;
+
+std::vector<RadixSort::Item> DrawSurfaceKeys( int size )
+{
+	std::mt19937 generator( size );
+	std::uniform_int_distribution<uint64_t> shader( 0, 500 );
+	std::uniform_int_distribution<uint64_t> lightmap( 0, 16 );
+	std::uniform_int_distribution<uint64_t> entity( 0, 63 );
+
+	std::vector<RadixSort::Item> items( size );
+	for ( int i = 0; i < size; i++ )
+	{
+		// Most surfaces belong to the world
+		uint64_t entityNum = i % 4 ? 0 : entity( generator );
+		items[ i ].key = uint64_t( i ) | ( entityNum << 20 ) | ( lightmap( generator ) << 36 ) | ( shader( generator ) << 45 );
+		items[ i ].value = i;
+	}
+
+	std::shuffle( items.begin(), items.end(), generator );
+	return items;
+}
+
+TEST(SortBenchmark, DISABLED_DrawSurfaceKeys)
+{
+	// The last size is the renderer's MAX_DRAWSURFS
+	for ( int size : { 1024, 4096, 16384, 65536 } )
+	{
+		std::vector<RadixSort::Item> items = DrawSurfaceKeys( size );
+		std::vector<RadixSort::Item> sorted, scratch;
+		int iterations = std::max( 16, ( 1 << 22 ) / size );
+
+		float stdTime = Benchmark::Measure( iterations, [&] {
+			sorted = items;
+			std::sort( sorted.begin(), sorted.end(), []( const RadixSort::Item& a, const RadixSort::Item& b ) {
+				return a.key < b.key;
+			} );
+		} );
+
+		float radixTime = Benchmark::Measure( iterations, [&] {
+			sorted = items;
+			RadixSort::Sort( sorted, scratch, KEY_BITS );
+		} );
+
+		Log::Notice( "%6d surfaces: std::sort %9.2f us, radix sort %9.2f us", size, stdTime, radixTime );
+	}
+}
+
+} // namespace
@@ -34,7 +34,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ConsoleHistory.h"
 #include "CommandSystem.h"
 #include "LogSystem.h"
-#include "OmpSystem.h"
+#include "JobSystem.h"
 #include "System.h"
 #include "CrashDump.h"
 #include "CvarSystem.h"
@@ -521,8 +521,14 @@ static void Shutdown(bool error, Str::StringRef message)
 		Cvar::Shutdown();
 	}
 
+	// Print the pending logs before the terminal is restored
+	Log::StopDispatchThread();
+
 	// Always run CON_Shutdown, because it restores the terminal to a usable state.
-	CON_Shutdown();
+	{
+		std::lock_guard<std::recursive_mutex> guard(CON_Mutex());
+		CON_Shutdown();
+	}
 
 	// Flush the logs one last time. Logs are turned off when OSExit is called.
 	Log::FlushLogFile();
@@ -892,10 +898,13 @@ static void Init(int argc, char** argv)
 #endif
 
 	// Initialize the console
-	if (cmdlineArgs.use_curses)
-		CON_Init();
-	else
-		CON_Init_TTY();
+	{
+		std::lock_guard<std::recursive_mutex> guard(CON_Mutex());
+		if (cmdlineArgs.use_curses)
+			CON_Init();
+		else
+			CON_Init_TTY();
+	}
 
 	// Set cvars set from the command line having the Cvar::INIT flag
 	SetCvarsWithInitFlag(cmdlineArgs);
@@ -969,7 +978,11 @@ static void Init(int argc, char** argv)
 	for (auto& cvar: cmdlineArgs.cvars)
 		Cvar::SetValue(cvar.first, cvar.second);
 
-	Omp::Init();
+	EarlyCvar("logs.async", cmdlineArgs);
+	Log::StartDispatchThread();
+
+	if (Application::GetTraits().useJobs)
+		Jobs::Init();
 
 	// Load the console history
 	Console::History::Load();
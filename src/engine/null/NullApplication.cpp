@@ -49,16 +49,19 @@ class NullApplication : public Application {
         }
 
         void Frame() override {
-            while (true) {
-                const char* command = CON_Input();
-                if (command == nullptr) {
-                    break;
-                }
+            {
+                std::lock_guard<std::recursive_mutex> guard(CON_Mutex());
+                while (true) {
+                    const char* command = CON_Input();
+                    if (command == nullptr) {
+                        break;
+                    }
 
-                if (command[0] == '/' || command[0] == '\\') {
-                    Cmd::BufferCommandTextAfter(command + 1, true);
-                } else {
-                    Cmd::BufferCommandTextAfter(command, true);
+                    if (command[0] == '/' || command[0] == '\\') {
+                        Cmd::BufferCommandTextAfter(command + 1, true);
+                    } else {
+                        Cmd::BufferCommandTextAfter(command, true);
+                    }
                 }
             }
 
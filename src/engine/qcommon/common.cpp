@@ -47,7 +47,7 @@ Maryland 20850 USA.
 #include "framework/CommandSystem.h"
 #include "framework/CvarSystem.h"
 #include "framework/LogSystem.h"
-#include "framework/OmpSystem.h"
+#include "framework/JobSystem.h"
 #include "framework/System.h"
 #include "sys/sys_events.h"
 #include <common/FileSystem.h>
@@ -280,9 +280,13 @@ std::unique_ptr<Sys::EventBase> Com_GetEvent()
 	}
 
 	// check for tty/curses console commands
-	if ( char* s = CON_Input() )
 	{
-		Com_QueueEvent( Util::make_unique<Sys::ConsoleInputEvent>( s ) );
+		std::lock_guard<std::recursive_mutex> guard( CON_Mutex() );
+
+		if ( char* s = CON_Input() )
+		{
+			Com_QueueEvent( Util::make_unique<Sys::ConsoleInputEvent>( s ) );
+		}
 	}
 
 	// check for network packets
@@ -784,7 +788,7 @@ static Cvar::Cvar<bool> showTraceStats("common.showTraceStats", "are physics tra
 
 void Com_Frame()
 {
-	Omp::SetupThreads();
+	Jobs::SetupThreads();
 
 	int             msec, minMsec;
 	static int      lastTime = 0;
@@ -765,6 +765,48 @@ static netField_t entityStateFields[] =
 	{ NETF( weaponAnim ),        ANIM_BITS      , 0 },
 };
 
+// Compact form of entityStateFields for MSG_ReadDeltaEntity, which only needs
+// the offsets and sizes and shouldn't drag the field names through the cache
+struct entityFieldCode_t
+{
+	uint16_t offset;
+	uint8_t  bits; // 0 for floats
+};
+
+static std::array<entityFieldCode_t, ARRAY_LEN( entityStateFields )> MakeEntityFieldCodes()
+{
+	std::array<entityFieldCode_t, ARRAY_LEN( entityStateFields )> codes;
+
+	for ( size_t i = 0; i < codes.size(); i++ )
+	{
+		codes[ i ].offset = entityStateFields[ i ].offset;
+		codes[ i ].bits = entityStateFields[ i ].bits;
+	}
+
+	return codes;
+}
+
+static const std::array<entityFieldCode_t, ARRAY_LEN( entityStateFields )> entityFieldCodes = MakeEntityFieldCodes();
+
+/*
+============
+MSG_ReadFlag
+
+Single bit read, the common case while decoding a delta
+============
+*/
+static inline int MSG_ReadFlag( msg_t *msg )
+{
+	if ( msg->oob )
+	{
+		return MSG_ReadBits( msg, 1 );
+	}
+
+	int value = Huff_getBit( msg->data, &msg->bit );
+	msg->readcount = ( msg->bit >> 3 ) + 1;
+	return value;
+}
+
 static int qsort_entitystatefields( const void *a, const void *b )
 {
 	int aa, bb;
@@ -976,8 +1018,7 @@ void MSG_ReadDeltaEntity( msg_t *msg, const entityState_t *from, entityState_t *
 {
 	int        i, lc;
 	int        numFields;
-	netField_t *field;
-	int        *fromF, *toF;
+	int        *toF;
 	int        print;
 	int        trunc;
 	int        startBit, endBit;
@@ -1038,80 +1079,77 @@ void MSG_ReadDeltaEntity( msg_t *msg, const entityState_t *from, entityState_t *
 		print = 0;
 	}
 
+	// usually only a few fields change, so start from a copy of the old
+	// state and only decode the fields that have their change bit set
+	if ( to != from )
+	{
+		*to = *from;
+	}
+
 	to->number = number;
 
-	for ( i = 0, field = entityStateFields; i < lc; i++, field++ )
+	for ( i = 0; i < lc; i++ )
 	{
-		fromF = ( int * )( ( byte * ) from + field->offset );
-		toF = ( int * )( ( byte * ) to + field->offset );
-
-		if ( !MSG_ReadBits( msg, 1 ) )
+		if ( !MSG_ReadFlag( msg ) )
 		{
 			// no change
-			*toF = *fromF;
+			continue;
 		}
-		else
+
+		const entityFieldCode_t &code = entityFieldCodes[ i ];
+		toF = ( int * )( ( byte * ) to + code.offset );
+
+		if ( code.bits == 0 )
 		{
-			if ( field->bits == 0 )
+			// float
+			if ( MSG_ReadFlag( msg ) == 0 )
 			{
-				// float
-				if ( MSG_ReadBits( msg, 1 ) == 0 )
-				{
-					* ( float * ) toF = 0.0f;
-				}
-				else
-				{
-					if ( MSG_ReadBits( msg, 1 ) == 0 )
-					{
-						// integral float
-						trunc = MSG_ReadBits( msg, FLOAT_INT_BITS );
-						// bias to allow equal parts positive and negative
-						trunc -= FLOAT_INT_BIAS;
-						* ( float * ) toF = trunc;
-
-						if ( print )
-						{
-							Log::Notice( "%s:%i ", field->name, trunc );
-						}
-					}
-					else
-					{
-						// full floating point value
-						*toF = MSG_ReadBits( msg, 32 );
-
-						if ( print )
-						{
-							Log::Notice( "%s:%f ", field->name, * ( float * ) toF );
-						}
-					}
-				}
+				* ( float * ) toF = 0.0f;
 			}
 			else
 			{
-				if ( MSG_ReadBits( msg, 1 ) == 0 )
+				if ( MSG_ReadFlag( msg ) == 0 )
 				{
-					*toF = 0;
+					// integral float
+					trunc = MSG_ReadBits( msg, FLOAT_INT_BITS );
+					// bias to allow equal parts positive and negative
+					trunc -= FLOAT_INT_BIAS;
+					* ( float * ) toF = trunc;
+
+					if ( print )
+					{
+						Log::Notice( "%s:%i ", entityStateFields[ i ].name, trunc );
+					}
 				}
 				else
 				{
-					// integer
-					*toF = MSG_ReadBits( msg, field->bits );
+					// full floating point value
+					*toF = MSG_ReadBits( msg, 32 );
 
 					if ( print )
 					{
-						Log::Notice( "%s:%i ", field->name, *toF );
+						Log::Notice( "%s:%f ", entityStateFields[ i ].name, * ( float * ) toF );
 					}
 				}
 			}
 		}
-	}
+		else
+		{
+			if ( MSG_ReadFlag( msg ) == 0 )
+			{
+				*toF = 0;
+			}
+			else
+			{
+				// integer
+				*toF = MSG_ReadBits( msg, code.bits );
 
-	for ( i = lc, field = &entityStateFields[ lc ]; i < numFields; i++, field++ )
-	{
-		fromF = ( int * )( ( byte * ) from + field->offset );
-		toF = ( int * )( ( byte * ) to + field->offset );
-		// no change
-		*toF = *fromF;
+				if ( print )
+				{
+					Log::Notice( "%s:%i ", entityStateFields[ i ].name, *toF );
+				}
+			}
+		}
 	}
 
 	if ( print )
@@ -810,6 +810,68 @@ int BoxOnPlaneSide( const vec3_t emins, const vec3_t emaxs, const cplane_t *p )
 	return bit0 + ( bit1 * 2 );
 }
 
+/*
+ * ==================
+ * BoxesOnPlanesSide
+ *
+ * The SSE version does the same operations as BoxOnPlaneSide on four boxes
+ * at once so the results are the same
+ * ==================
+ */
+void BoxesOnPlanesSide( int numBoxes, const float *minsX, const float *minsY, const float *minsZ,
+	const float *maxsX, const float *maxsY, const float *maxsZ,
+	const cplane_t *planes, int numPlanes, uint32_t *sides )
+{
+	ASSERT_LE( numPlanes, 16 );
+
+	int i = 0;
+
+#if defined(DAEMON_USE_ARCH_INTRINSICS_I686_SSE2)
+	for ( ; i + 4 <= numBoxes; i += 4 )
+	{
+		__m128 mins[ 3 ] = { _mm_loadu_ps( minsX + i ), _mm_loadu_ps( minsY + i ), _mm_loadu_ps( minsZ + i ) };
+		__m128 maxs[ 3 ] = { _mm_loadu_ps( maxsX + i ), _mm_loadu_ps( maxsY + i ), _mm_loadu_ps( maxsZ + i ) };
+		__m128i result = _mm_setzero_si128();
+
+		for ( int p = 0; p < numPlanes; p++ )
+		{
+			__m128 distMax, distMin;
+
+			for ( int j = 0; j < 3; j++ )
+			{
+				__m128 normal = _mm_set1_ps( planes[ p ].normal[ j ] );
+				__m128 prod0 = _mm_mul_ps( maxs[ j ], normal );
+				__m128 prod1 = _mm_mul_ps( mins[ j ], normal );
+
+				distMax = j ? _mm_add_ps( distMax, _mm_max_ps( prod0, prod1 ) ) : _mm_max_ps( prod0, prod1 );
+				distMin = j ? _mm_add_ps( distMin, _mm_min_ps( prod0, prod1 ) ) : _mm_min_ps( prod0, prod1 );
+			}
+
+			__m128 dist = _mm_set1_ps( planes[ p ].dist );
+			__m128i front = _mm_and_si128( _mm_castps_si128( _mm_cmpgt_ps( distMax, dist ) ), _mm_set1_epi32( int( 1u << ( 2 * p ) ) ) );
+			__m128i back = _mm_and_si128( _mm_castps_si128( _mm_cmplt_ps( distMin, dist ) ), _mm_set1_epi32( int( 2u << ( 2 * p ) ) ) );
+
+			result = _mm_or_si128( result, _mm_or_si128( front, back ) );
+		}
+
+		_mm_storeu_si128( reinterpret_cast<__m128i *>( sides + i ), result );
+	}
+#endif
+
+	for ( ; i < numBoxes; i++ )
+	{
+		vec3_t mins = { minsX[ i ], minsY[ i ], minsZ[ i ] };
+		vec3_t maxs = { maxsX[ i ], maxsY[ i ], maxsZ[ i ] };
+
+		sides[ i ] = 0;
+
+		for ( int p = 0; p < numPlanes; p++ )
+		{
+			sides[ i ] |= uint32_t( BoxOnPlaneSide( mins, maxs, &planes[ p ] ) ) << ( 2 * p );
+		}
+	}
+}
+
 /*
  * =================
  * RadiusFromBounds
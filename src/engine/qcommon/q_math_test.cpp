@@ -28,6 +28,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ===========================================================================
 */
 
+#include <random>
+
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
@@ -233,4 +235,58 @@ TEST(QSharedMathTest, FastInverseSquareRoot)
     EXPECT_THAT(Q_rsqrt_fast(1e6), RsqrtEq(1e-3));
 }
 
+std::vector<cplane_t> RandomPlanes(std::mt19937& generator, int numPlanes)
+{
+    std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+    std::vector<cplane_t> planes(numPlanes);
+    for (int i = 0; i < numPlanes; i++) {
+        cplane_t& plane = planes[i];
+        if (i < 3) {
+            // axial planes
+            VectorClear(plane.normal);
+            plane.normal[i] = 1.0f;
+        } else {
+            VectorSet(plane.normal, coordinate(generator), coordinate(generator), coordinate(generator));
+            VectorNormalize(plane.normal);
+        }
+        plane.dist = 100.0f * coordinate(generator);
+        plane.type = PlaneTypeForNormal(plane.normal);
+        SetPlaneSignbits(&plane);
+    }
+    return planes;
+}
+
+TEST(QMathCullTest, BoxesOnPlanesSide)
+{
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> coordinate(-200.0f, 200.0f);
+    std::uniform_real_distribution<float> size(0.0f, 100.0f);
+
+    // not a multiple of 4 to also test the scalar code
+    const int numBoxes = 1003;
+    std::vector<float> mins[3], maxs[3];
+    for (int j = 0; j < 3; j++) {
+        for (int i = 0; i < numBoxes; i++) {
+            mins[j].push_back(coordinate(generator));
+            maxs[j].push_back(mins[j].back() + size(generator));
+        }
+    }
+
+    for (int numPlanes : {1, 5, 16}) {
+        std::vector<cplane_t> planes = RandomPlanes(generator, numPlanes);
+        std::vector<uint32_t> sides(numBoxes);
+        BoxesOnPlanesSide(numBoxes, mins[0].data(), mins[1].data(), mins[2].data(),
+            maxs[0].data(), maxs[1].data(), maxs[2].data(), planes.data(), numPlanes, sides.data());
+
+        for (int i = 0; i < numBoxes; i++) {
+            vec3_t boxMins = { mins[0][i], mins[1][i], mins[2][i] };
+            vec3_t boxMaxs = { maxs[0][i], maxs[1][i], maxs[2][i] };
+            for (int p = 0; p < numPlanes; p++) {
+                EXPECT_EQ((sides[i] >> (2 * p)) & 3u, uint32_t(BoxOnPlaneSide(boxMins, boxMaxs, &planes[p])))
+                    << "box " << i << " plane " << p;
+            }
+        }
+    }
+}
+
 } // namespace
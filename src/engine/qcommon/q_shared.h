@@ -759,6 +759,14 @@ inline vec_t VectorNormalize2( const vec3_t v, vec3_t out )
 	void  SetPlaneSignbits( struct cplane_t *out );
 	WARN_UNUSED_RESULT int BoxOnPlaneSide( const vec3_t emins, const vec3_t emaxs, const struct cplane_t *plane );
 
+	/* Classify batches of boxes against up to 16 planes, with the
+	coordinates given as separate arrays. Bits 2p and 2p + 1 of sides[ i ]
+	are the BoxOnPlaneSide result of the box i for the plane p: 1 if it
+	is in front, 2 if it is behind and 3 if it crosses the plane. */
+	void BoxesOnPlanesSide( int numBoxes, const float *minsX, const float *minsY, const float *minsZ,
+		const float *maxsX, const float *maxsY, const float *maxsZ,
+		const struct cplane_t *planes, int numPlanes, uint32_t *sides );
+
 	WARN_UNUSED_RESULT DEPRECATED float AngleMod( float a );
 	WARN_UNUSED_RESULT float LerpAngle( float from, float to, float frac );
 	WARN_UNUSED_RESULT float AngleSubtract( float a1, float a2 );
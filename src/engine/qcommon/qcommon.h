@@ -463,7 +463,7 @@ enum class dlStatus_t
   DL_FAILED
 };
 
-int        DL_BeginDownload( const char *localName, const char *remoteName, int basePathLen );
+int        DL_BeginDownload( const char *localName, const char *remoteName, int basePathLen, int size );
 dlStatus_t DL_DownloadLoop();
 
 void       DL_Shutdown();
@@ -702,6 +702,10 @@ void         CON_Init_TTY();
 char         *CON_Input();
 void         CON_Print( const char *message );
 
+// Must be held around calls to the console functions, the log dispatch
+// thread prints to the console concurrently with the main thread's input
+std::recursive_mutex &CON_Mutex();
+
 /* This is based on the Adaptive Huffman algorithm described in Sayood's Data
  * Compression book.  The ranks are not actually stored, but implicitly defined
  * by the location of a node within a doubly-linked list */
@@ -36,6 +36,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "tr_local.h"
 
 #include "EntityCache.h"
+#include "framework/JobSystem.h"
 
 trRefEntity_t entities[MAX_REF_ENTITIES] {};
 
@@ -43,6 +44,9 @@ static constexpr uint32_t blockCount = PAD( MAX_REF_ENTITIES / 64, 64 );
 static uint16_t highestActiveID = 0;
 static uint64_t blocks[blockCount];
 
+// Minimum number of entities transformed by each job
+static constexpr int TRANSFORM_GRAIN_SIZE = 8;
+
 static void PositionEntityOnTag( trRefEntity_t* entity, const refEntity_t* parent, orientation_t* orientation ) {
 	// FIXME: allow origin offsets along tag?
 	VectorCopy( parent->origin, entity->e.origin );
@@ -225,25 +229,37 @@ void TransformEntity( trRefEntity_t* ent ) {
 	ent->transformFrame = tr.frameCount;
 }
 
+// Entities which can be transformed on the job threads: they don't depend on
+// another entity and building their skeleton doesn't touch any global state
+static bool CanTransformInParallel( const trRefEntity_t* ent ) {
+	return ent->transformFrame <= tr.frameCount
+		&& ent->e.positionOnTag == EntityTag::NONE
+		&& ent->e.reType == refEntityType_t::RT_MODEL;
+}
+
+static void TransformEntityInParallel( trRefEntity_t* ent ) {
+	const model_t* model = R_GetModelByHandle( ent->e.hModel );
+
+	if ( model->type == modtype_t::MOD_MD5 || model->type == modtype_t::MOD_IQM ) {
+		BuildSkeleton( ent );
+	}
+
+	ent->transformFrame = tr.frameCount;
+}
+
 void AddRefEntities() {
+	static std::vector<trRefEntity_t*> activeEntities;
 	uint16_t highestFound = 0;
 
+	activeEntities.clear();
+
 	for ( uint16_t i = 0; i < highestActiveID / 64 + 1; i++ ) {
 		uint64_t block = blocks[i];
 
 		while ( block ) {
 			uint32_t offset = CountTrailingZeroes( block );
 
-			trRefEntity_t* ent = &entities[offset + i * 64];
-
-			TransformEntity( ent );
-			RE_AddEntityToScene( ent );
-
-			const vec4_t& dynamicLight = ent->e.dynamicLight;
-
-			if ( dynamicLight[3] ) {
-				RE_AddDynamicLightToScene( ent->e.origin, dynamicLight[3], dynamicLight[0], dynamicLight[1], dynamicLight[2], 0 );
-			}
+			activeEntities.push_back( &entities[offset + i * 64] );
 
 			block &= offset == 63 ? 0 : ( UINT64_MAX << ( offset + 1 ) );
 
@@ -252,6 +268,31 @@ void AddRefEntities() {
 	}
 
 	highestActiveID = highestFound;
+
+	// Build the skeletons of independent entities in parallel, the entities on
+	// a tag are transformed afterwards since they need their parent first
+	Jobs::ParallelFor( 0, static_cast<int>( activeEntities.size() ), TRANSFORM_GRAIN_SIZE, []( int first, int last ) {
+		for ( int i = first; i < last; i++ ) {
+			if ( CanTransformInParallel( activeEntities[i] ) ) {
+				TransformEntityInParallel( activeEntities[i] );
+			}
+		}
+	} );
+
+	// Add the entities to the scene in the same order as before
+	for ( trRefEntity_t* ent : activeEntities ) {
+		if ( !CanTransformInParallel( ent ) ) {
+			TransformEntity( ent );
+		}
+
+		RE_AddEntityToScene( ent );
+
+		const vec4_t& dynamicLight = ent->e.dynamicLight;
+
+		if ( dynamicLight[3] ) {
+			RE_AddDynamicLightToScene( ent->e.origin, dynamicLight[3], dynamicLight[0], dynamicLight[1], dynamicLight[2], 0 );
+		}
+	}
 }
 
 void ClearEntityCache() {
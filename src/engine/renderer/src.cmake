@@ -9,6 +9,7 @@ set(RENDERERLIST
     ${ENGINE_DIR}/renderer/ShadeCommon.h
     ${ENGINE_DIR}/renderer/tr_animation.cpp
     ${ENGINE_DIR}/renderer/tr_backend.cpp
+    ${ENGINE_DIR}/renderer/tr_benchmark.cpp
     ${ENGINE_DIR}/renderer/tr_bsp.cpp
     ${ENGINE_DIR}/renderer/tr_cmds.cpp
     ${ENGINE_DIR}/renderer/tr_curve.cpp
@@ -31,6 +32,7 @@ set(RENDERERLIST
     ${ENGINE_DIR}/renderer/TextureManager.h
     ${ENGINE_DIR}/renderer/tr_image.cpp
     ${ENGINE_DIR}/renderer/tr_image.h
+    ${ENGINE_DIR}/renderer/tr_image_cache.cpp
     ${ENGINE_DIR}/renderer/tr_image_crn.cpp
     ${ENGINE_DIR}/renderer/tr_image_dds.cpp
     ${ENGINE_DIR}/renderer/tr_image_jpg.cpp
@@ -56,6 +58,7 @@ set(RENDERERLIST
     ${ENGINE_DIR}/renderer/tr_shader.cpp
     ${ENGINE_DIR}/renderer/tr_shade_calc.cpp
     ${ENGINE_DIR}/renderer/tr_skin.cpp
+    ${ENGINE_DIR}/renderer/tr_skinning.cpp
     ${ENGINE_DIR}/renderer/tr_sky.cpp
     ${ENGINE_DIR}/renderer/tr_surface.cpp
     ${ENGINE_DIR}/renderer/tr_types.h
@@ -70,4 +73,6 @@ set(RENDERERLIST
 
 set(RENDERERTESTLIST
     ${ENGINE_DIR}/renderer/gl_shader_test.cpp
+    ${ENGINE_DIR}/renderer/tr_image_ktx_test.cpp
+    ${ENGINE_DIR}/renderer/tr_skinning_test.cpp
 )
@@ -0,0 +1,524 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+// tr_benchmark.cpp -- records scenes and replays them through the front end
+
+#include "tr_local.h"
+
+/*
+====================
+Front end benchmark
+
+frontEndBenchmarkRecord stores the world scenes rendered by the client, with
+the view and the transformed entities, in the home path. frontEndBenchmark
+runs them again through the front end on the same map and reports the CPU
+time of its phases. The render commands of the replayed scenes are thrown
+away, so the back end and the GPU are not involved.
+=====================
+*/
+
+static const uint32_t BENCHMARK_MAGIC = 0x4d424546; // "FEBM"
+static const uint32_t BENCHMARK_VERSION = 1;
+
+struct benchmarkRecording_t
+{
+	bool active;
+	std::string path;
+	std::string data;
+	int numScenes;
+};
+
+static benchmarkRecording_t recording;
+static bool replaying;
+
+Sys::SteadyClock::time_point R_StartFrontEndTimer()
+{
+	if ( !tr.frontEndTimes.enabled )
+	{
+		return {};
+	}
+
+	return Sys::SteadyClock::now();
+}
+
+void R_StopFrontEndTimer( Sys::SteadyClock::duration &time, Sys::SteadyClock::time_point start )
+{
+	if ( tr.frontEndTimes.enabled )
+	{
+		time += Sys::SteadyClock::now() - start;
+	}
+}
+
+bool R_ReplayingBenchmark()
+{
+	return replaying;
+}
+
+static std::string BenchmarkPath( Str::StringRef name )
+{
+	return Str::Format( "benchmarks/%s.frontend", name );
+}
+
+template<typename T> static void Write( std::string &data, const T &value )
+{
+	static_assert( std::is_trivially_copyable<T>::value, "only plain data can be written" );
+	data.append( reinterpret_cast<const char *>( &value ), sizeof( value ) );
+}
+
+static void WriteString( std::string &data, const char *value )
+{
+	uint32_t length = strlen( value );
+	Write( data, length );
+	data.append( value, length );
+}
+
+class BenchmarkReader
+{
+public:
+	explicit BenchmarkReader( const std::string &data ) : data( data ), pos( 0 ), valid( true ) {}
+
+	template<typename T> void Read( T &value )
+	{
+		static_assert( std::is_trivially_copyable<T>::value, "only plain data can be read" );
+		ReadBytes( &value, sizeof( value ) );
+	}
+
+	void ReadBytes( void *value, size_t size )
+	{
+		if ( data.size() - pos < size )
+		{
+			valid = false;
+			memset( value, 0, size );
+			return;
+		}
+
+		memcpy( value, data.data() + pos, size );
+		pos += size;
+	}
+
+	std::string ReadString()
+	{
+		uint32_t length = 0;
+		Read( length );
+
+		if ( data.size() - pos < length )
+		{
+			valid = false;
+			return "";
+		}
+
+		pos += length;
+		return data.substr( pos - length, length );
+	}
+
+	bool AtEnd() const
+	{
+		return pos == data.size();
+	}
+
+	bool Valid() const
+	{
+		return valid;
+	}
+
+private:
+	const std::string &data;
+	size_t pos;
+	bool valid;
+};
+
+// Only the fields used by the front end are stored
+static void WriteEntity( std::string &data, const trRefEntity_t &ent )
+{
+	WriteString( data, ent.e.hModel ? R_GetModelByHandle( ent.e.hModel )->name : "" );
+	WriteString( data, ent.e.customShader ? R_GetShaderByHandle( ent.e.customShader )->name : "" );
+	WriteString( data, ent.e.customSkin ? R_GetSkinByHandle( ent.e.customSkin )->name : "" );
+
+	Write( data, ent.e.reType );
+	Write( data, ent.e.frame );
+	Write( data, ent.e.oldframe );
+	Write( data, ent.e.backlerp );
+	Write( data, ent.e.skinNum );
+	Write( data, ent.e.shaderTexCoord );
+	Write( data, ent.e.shaderTime );
+	Write( data, ent.e.radius );
+	Write( data, ent.e.rotation );
+	Write( data, ent.e.altShaderIndex );
+	Write( data, ent.e.scale );
+	Write( data, ent.e.renderfx );
+	Write( data, ent.e.boundsAdd );
+	Write( data, ent.e.nonNormalizedAxes );
+	Write( data, ent.e.shaderRGBA );
+	Write( data, ent.e.dynamicLight );
+	Write( data, ent.e.axis );
+	Write( data, ent.e.origin );
+	Write( data, ent.e.oldorigin );
+	Write( data, ent.e.boundsRotation );
+
+	Write( data, ent.skeleton.type );
+	Write( data, ent.skeleton.numBones );
+	Write( data, ent.skeleton.bounds );
+	Write( data, ent.skeleton.scale );
+	data.append( reinterpret_cast<const char *>( ent.skeleton.bones ), ent.skeleton.numBones * sizeof( refBone_t ) );
+}
+
+static bool ReadEntity( BenchmarkReader &reader, trRefEntity_t &ent )
+{
+	std::string model = reader.ReadString();
+	std::string customShader = reader.ReadString();
+	std::string customSkin = reader.ReadString();
+
+	ent.e.hModel = model.empty() ? 0 : RE_RegisterModel( model.c_str() );
+	ent.e.customShader = customShader.empty() ? 0 : RE_RegisterShader( customShader.c_str(), RSF_DEFAULT );
+	ent.e.customSkin = customSkin.empty() ? 0 : RE_RegisterSkin( customSkin.c_str() );
+
+	reader.Read( ent.e.reType );
+	reader.Read( ent.e.frame );
+	reader.Read( ent.e.oldframe );
+	reader.Read( ent.e.backlerp );
+	reader.Read( ent.e.skinNum );
+	reader.Read( ent.e.shaderTexCoord );
+	reader.Read( ent.e.shaderTime );
+	reader.Read( ent.e.radius );
+	reader.Read( ent.e.rotation );
+	reader.Read( ent.e.altShaderIndex );
+	reader.Read( ent.e.scale );
+	reader.Read( ent.e.renderfx );
+	reader.Read( ent.e.boundsAdd );
+	reader.Read( ent.e.nonNormalizedAxes );
+	reader.Read( ent.e.shaderRGBA );
+	reader.Read( ent.e.dynamicLight );
+	reader.Read( ent.e.axis );
+	reader.Read( ent.e.origin );
+	reader.Read( ent.e.oldorigin );
+	reader.Read( ent.e.boundsRotation );
+
+	reader.Read( ent.skeleton.type );
+	reader.Read( ent.skeleton.numBones );
+	reader.Read( ent.skeleton.bounds );
+	reader.Read( ent.skeleton.scale );
+
+	if ( ent.skeleton.numBones > MAX_BONES || ent.e.reType >= refEntityType_t::RT_MAX_REF_ENTITY_TYPE )
+	{
+		return false;
+	}
+
+	reader.ReadBytes( ent.skeleton.bones, ent.skeleton.numBones * sizeof( refBone_t ) );
+
+	return reader.Valid();
+}
+
+void R_RecordBenchmarkScene( const refdef_t *fd )
+{
+	if ( !recording.active || replaying || ( fd->rdflags & RDF_NOWORLDMODEL ) )
+	{
+		return;
+	}
+
+	Write( recording.data, *fd );
+	Write( recording.data, uint32_t( tr.refdef.numEntities ) );
+
+	for ( int i = 0; i < tr.refdef.numEntities; i++ )
+	{
+		WriteEntity( recording.data, tr.refdef.entities[ i ] );
+	}
+
+	recording.numScenes++;
+}
+
+void R_StopBenchmarkRecording()
+{
+	if ( !recording.active )
+	{
+		return;
+	}
+
+	std::error_code err;
+	FS::File file = FS::HomePath::OpenWrite( recording.path, err );
+
+	if ( !err )
+	{
+		file.Write( recording.data.data(), recording.data.size(), err );
+	}
+
+	if ( !err )
+	{
+		file.Close( err );
+	}
+
+	if ( err )
+	{
+		Log::Warn( "Couldn't write benchmark %s: %s", recording.path, err.message() );
+	}
+	else
+	{
+		Log::Notice( "Recorded %d scenes to %s", recording.numScenes, recording.path );
+	}
+
+	recording = {};
+}
+
+class FrontEndBenchmarkRecordCmd : public Cmd::StaticCmd
+{
+public:
+	FrontEndBenchmarkRecordCmd() : StaticCmd(
+		"frontEndBenchmarkRecord", Cmd::RENDERER, "records the rendered scenes for frontEndBenchmark, stops without argument" ) {}
+
+	void Run( const Cmd::Args& args ) const override
+	{
+		if ( args.Argc() != 2 )
+		{
+			if ( !recording.active )
+			{
+				PrintUsage( args, "<name>", "start recording the scenes, run without argument to stop" );
+			}
+
+			R_StopBenchmarkRecording();
+			return;
+		}
+
+		if ( !tr.world )
+		{
+			Print( "A map must be loaded to record a benchmark" );
+			return;
+		}
+
+		R_StopBenchmarkRecording();
+
+		recording.active = true;
+		recording.path = BenchmarkPath( args.Argv( 1 ) );
+		Write( recording.data, BENCHMARK_MAGIC );
+		Write( recording.data, BENCHMARK_VERSION );
+		WriteString( recording.data, tr.world->name );
+
+		Print( "Recording scenes to %s", recording.path );
+	}
+};
+static FrontEndBenchmarkRecordCmd frontEndBenchmarkRecordCmdRegistration;
+
+struct benchmarkScene_t
+{
+	refdef_t refdef;
+	std::vector<trRefEntity_t> entities;
+};
+
+class FrontEndBenchmarkCmd : public Cmd::StaticCmd
+{
+public:
+	FrontEndBenchmarkCmd() : StaticCmd(
+		"frontEndBenchmark", Cmd::RENDERER, "replays recorded scenes through the renderer front end and reports its CPU times" ) {}
+
+	void Run( const Cmd::Args& args ) const override
+	{
+		if ( args.Argc() < 2 || args.Argc() > 3 )
+		{
+			PrintUsage( args, "<name> [passes]", "replay the scenes recorded with frontEndBenchmarkRecord" );
+			return;
+		}
+
+		int passes = 1;
+
+		if ( args.Argc() == 3 && ( !Str::ParseInt( passes, args.Argv( 2 ) ) || passes < 1 ) )
+		{
+			Print( "Invalid number of passes: %s", args.Argv( 2 ) );
+			return;
+		}
+
+		if ( !tr.world )
+		{
+			Print( "The map of the benchmark must be loaded" );
+			return;
+		}
+
+		// The material system culls on the GPU
+		if ( glConfig.usingMaterialSystem )
+		{
+			Print( "The front end benchmark doesn't support the material system" );
+			return;
+		}
+
+		if ( recording.active )
+		{
+			Print( "Can't replay a benchmark while recording" );
+			return;
+		}
+
+		std::vector<benchmarkScene_t> scenes;
+
+		if ( !LoadBenchmark( BenchmarkPath( args.Argv( 1 ) ), scenes ) )
+		{
+			return;
+		}
+
+		if ( scenes.empty() )
+		{
+			Print( "The benchmark has no scenes" );
+			return;
+		}
+
+		Sys::SteadyClock::duration total{}, worstScene{};
+		uint64_t numDrawSurfs = 0, numLeafs = 0, numEntities = 0;
+
+		// the render thread may still be drawing from the buffers toggled
+		// below, nothing is issued to it until the replay is over
+		R_SyncRenderThread();
+
+		tr.frontEndTimes = {};
+		tr.frontEndTimes.enabled = true;
+		replaying = true;
+
+		for ( int pass = 0; pass < passes; pass++ )
+		{
+			for ( benchmarkScene_t &scene : scenes )
+			{
+				// reuse the command buffer and scene lists, the commands are never
+				// executed
+				R_ToggleSmpFrame();
+				tr.frameCount++;
+				tr.frameSceneNum = 0;
+				tr.pc = {};
+
+				for ( trRefEntity_t &ent : scene.entities )
+				{
+					ent.transformFrame = tr.frameCount;
+					RE_AddEntityToScene( &ent );
+				}
+
+				auto start = Sys::SteadyClock::now();
+				RE_RenderScene( &scene.refdef );
+				auto duration = Sys::SteadyClock::now() - start;
+
+				total += duration;
+				worstScene = std::max( worstScene, duration );
+				numDrawSurfs += tr.refdef.numDrawSurfs;
+				numLeafs += tr.pc.c_leafs;
+				numEntities += scene.entities.size();
+			}
+		}
+
+		replaying = false;
+		tr.frontEndTimes.enabled = false;
+		R_ToggleSmpFrame();
+		tr.pc = {};
+
+		const frontEndTimes_t &times = tr.frontEndTimes;
+		int numRuns = scenes.size() * passes;
+		Sys::SteadyClock::duration other = total - times.worldSurfaces - times.entitySurfaces - times.sortDrawSurfs;
+
+		Print( "%d scenes, %d passes: %.1f us per scene, worst %.1f us",
+			int( scenes.size() ), passes, Microseconds( total, numRuns ), Microseconds( worstScene, 1 ) );
+		Print( "  mark leaves     %9.1f us", Microseconds( times.markLeaves, numRuns ) );
+		Print( "  world surfaces  %9.1f us (with mark leaves)", Microseconds( times.worldSurfaces, numRuns ) );
+		Print( "  entity surfaces %9.1f us", Microseconds( times.entitySurfaces, numRuns ) );
+		Print( "  sort draw surfs %9.1f us", Microseconds( times.sortDrawSurfs, numRuns ) );
+		Print( "  other           %9.1f us", Microseconds( other, numRuns ) );
+		Print( "per scene: %.1f draw surfaces, %.1f leaves, %.1f entities",
+			double( numDrawSurfs ) / numRuns, double( numLeafs ) / numRuns, double( numEntities ) / numRuns );
+	}
+
+private:
+	// Average time in microseconds
+	static float Microseconds( Sys::SteadyClock::duration duration, int count )
+	{
+		return std::chrono::duration_cast<std::chrono::duration<float, std::micro>>( duration ).count() / count;
+	}
+
+	bool LoadBenchmark( const std::string &path, std::vector<benchmarkScene_t> &scenes ) const
+	{
+		std::error_code err;
+		FS::File file = FS::HomePath::OpenRead( path, err );
+		std::string data;
+
+		if ( !err )
+		{
+			data = file.ReadAll( err );
+		}
+
+		if ( err )
+		{
+			Print( "Couldn't read %s: %s", path, err.message() );
+			return false;
+		}
+
+		BenchmarkReader reader( data );
+		uint32_t magic = 0, version = 0;
+		reader.Read( magic );
+		reader.Read( version );
+
+		if ( magic != BENCHMARK_MAGIC || version != BENCHMARK_VERSION )
+		{
+			Print( "%s is not a front end benchmark of this version", path );
+			return false;
+		}
+
+		std::string mapName = reader.ReadString();
+
+		if ( Q_stricmp( mapName.c_str(), tr.world->name ) )
+		{
+			Print( "The benchmark was recorded on %s, but %s is loaded", mapName, tr.world->name );
+			return false;
+		}
+
+		while ( reader.Valid() && !reader.AtEnd() )
+		{
+			benchmarkScene_t scene;
+			uint32_t numEntities = 0;
+
+			reader.Read( scene.refdef );
+			reader.Read( numEntities );
+
+			if ( numEntities > MAX_REF_ENTITIES )
+			{
+				break;
+			}
+
+			scene.entities.resize( numEntities );
+
+			for ( trRefEntity_t &ent : scene.entities )
+			{
+				if ( !ReadEntity( reader, ent ) )
+				{
+					Print( "%s is corrupted", path );
+					return false;
+				}
+			}
+
+			scenes.push_back( std::move( scene ) );
+		}
+
+		if ( !reader.Valid() || !reader.AtEnd() )
+		{
+			Print( "%s is corrupted", path );
+			return false;
+		}
+
+		return true;
+	}
+};
+static FrontEndBenchmarkCmd frontEndBenchmarkCmdRegistration;
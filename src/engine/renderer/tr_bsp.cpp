@@ -24,9 +24,11 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 // tr_bsp.c
 #include "tr_local.h"
 #include "framework/CommandSystem.h"
+#include "framework/JobSystem.h"
 #include "GeometryCache.h"
 #include "GeometryOptimiser.h"
 #include "ShadeCommon.h"
+#include <zlib.h>
 
 /*
 ========================================================
@@ -556,6 +558,10 @@ static void R_LoadLightmaps( lump_t *l, const char *bspName )
 
 				Log::Debug("...loading %i deluxemaps", lightmapFiles.size());
 
+				for (const std::string& filename : lightmapFiles) {
+					R_PrefetchImageFile(va("%s/%s", mapName, filename.c_str()));
+				}
+
 				for (const std::string& filename : lightmapFiles) {
 					Log::Debug("...loading external lightmap '%s/%s'", mapName, filename);
 
@@ -584,6 +590,10 @@ static void R_LoadLightmaps( lump_t *l, const char *bspName )
 			// we are about to upload textures
 			R_SyncRenderThread();
 
+			for (const std::string& filename : lightmapFiles) {
+				R_PrefetchImageFile(va("%s/%s", mapName, filename.c_str()));
+			}
+
 			for (size_t i = 0; i < lightmapFiles.size(); i++) {
 				Log::Debug("...loading external lightmap '%s/%s'", mapName, lightmapFiles[i]);
 
@@ -1156,14 +1166,23 @@ static void ParseTriSurf( dsurface_t* ds, drawVert_t* verts, bspSurface_t* surf,
 	surface->plane.dist = plane.dist;
 }
 
-static void ParseMesh( dsurface_t *ds, drawVert_t *verts, bspSurface_t *surf )
+// A patch whose control points are loaded, subdivided later by R_CreatePatchGrids
+struct pendingPatch_t
+{
+	int surfaceNum;
+	int width, height;
+	std::vector<srfVert_t> points;
+
+	// bounds of the group of curves that must subdivide the same
+	vec3_t lodBounds[ 2 ];
+};
+
+// Returns false if the patch is not drawn
+static bool ParseMesh( dsurface_t *ds, drawVert_t *verts, bspSurface_t *surf, pendingPatch_t &patch )
 {
-	srfGridMesh_t        *grid;
 	int                  width, height, numPoints;
-	static srfVert_t     points[ MAX_PATCH_SIZE * MAX_PATCH_SIZE ];
-	vec3_t               bounds[ 2 ];
+	srfVert_t            *points;
 	vec2_t               stBounds[ 2 ], tcOffset;
-	vec3_t               tmpVec;
 	static surfaceType_t skipData = surfaceType_t::SF_SKIP;
 	int                  realLightmapNum;
 
@@ -1197,7 +1216,7 @@ static void ParseMesh( dsurface_t *ds, drawVert_t *verts, bspSurface_t *surf )
 	if ( s_worldData.shaders[ LittleLong( ds->shaderNum ) ].surfaceFlags & SURF_NODRAW )
 	{
 		surf->data = &skipData;
-		return;
+		return false;
 	}
 
 	width = LittleLong( ds->patchWidth );
@@ -1212,6 +1231,9 @@ static void ParseMesh( dsurface_t *ds, drawVert_t *verts, bspSurface_t *surf )
 	verts += LittleLong( ds->firstVert );
 	numPoints = width * height;
 
+	patch.points.resize( numPoints );
+	points = patch.points.data();
+
 	// compute min/max texture coords on the fly
 	stBounds[ 0 ][ 0 ] =  99999.0f;
 	stBounds[ 0 ][ 1 ] =  99999.0f;
@@ -1263,25 +1285,47 @@ static void ParseMesh( dsurface_t *ds, drawVert_t *verts, bspSurface_t *surf )
 		}
 	}
 
-	// pre-tesselate
-	grid = R_SubdividePatchToGrid( width, height, points );
-	surf->data = ( surfaceType_t * ) grid;
+	patch.surfaceNum = surf - s_worldData.surfaces;
+	patch.width = width;
+	patch.height = height;
 
-	// copy the level of detail origin, which is the center
-	// of the group of all curves that must subdivide the same
-	// to avoid cracking
 	for ( int i = 0; i < 3; i++ )
 	{
-		bounds[ 0 ][ i ] = LittleFloat( ds->lightmapVecs[ 0 ][ i ] );
-		bounds[ 1 ][ i ] = LittleFloat( ds->lightmapVecs[ 1 ][ i ] );
+		patch.lodBounds[ 0 ][ i ] = LittleFloat( ds->lightmapVecs[ 0 ][ i ] );
+		patch.lodBounds[ 1 ][ i ] = LittleFloat( ds->lightmapVecs[ 1 ][ i ] );
 	}
 
-	VectorAdd( bounds[ 0 ], bounds[ 1 ], bounds[ 1 ] );
+	// subdivided later
+	surf->data = nullptr;
+	return true;
+}
+
+/*
+=================
+R_SubdividePatch
+=================
+*/
+static srfGridMesh_t *R_SubdividePatch( pendingPatch_t &patch, gridScratch_t &scratch )
+{
+	vec3_t        bounds[ 2 ];
+	vec3_t        tmpVec;
+	srfGridMesh_t *grid;
+
+	// pre-tesselate
+	grid = R_SubdividePatchToGrid( patch.width, patch.height, patch.points.data(), scratch );
+
+	// copy the level of detail origin, which is the center
+	// of the group of all curves that must subdivide the same
+	// to avoid cracking
+	VectorCopy( patch.lodBounds[ 0 ], bounds[ 0 ] );
+	VectorAdd( patch.lodBounds[ 0 ], patch.lodBounds[ 1 ], bounds[ 1 ] );
 	VectorScale( bounds[ 1 ], 0.5f, grid->lodOrigin );
 	VectorSubtract( bounds[ 0 ], grid->lodOrigin, tmpVec );
 	grid->lodRadius = VectorLength( tmpVec );
 
 	SphereFromBounds( grid->bounds[0], grid->bounds[1], grid->origin, &grid->radius );
+
+	return grid;
 }
 
 /*
@@ -1673,7 +1717,7 @@ void R_FixSharedVertexLodError()
 R_StitchPatches
 ===============
 */
-int R_StitchPatches( int grid1num, int grid2num )
+int R_StitchPatches( int grid1num, int grid2num, gridScratch_t &scratch )
 {
 	float         *v1, *v2;
 	srfGridMesh_t *grid1, *grid2;
@@ -1776,7 +1820,7 @@ int R_StitchPatches( int grid1num, int grid2num )
 						row = 0;
 					}
 
-					grid2 = R_GridInsertColumn( grid2, l + 1, row, grid1->verts[ k + 1 + offset1 ].xyz, grid1->widthLodError[ k + 1 ] );
+					grid2 = R_GridInsertColumn( grid2, l + 1, row, grid1->verts[ k + 1 + offset1 ].xyz, grid1->widthLodError[ k + 1 ], scratch );
 					grid2->lodStitched = false;
 					s_worldData.surfaces[ grid2num ].data = ( surfaceType_t * ) grid2;
 					return true;
@@ -1858,7 +1902,7 @@ int R_StitchPatches( int grid1num, int grid2num )
 						column = 0;
 					}
 
-					grid2 = R_GridInsertRow( grid2, l + 1, column, grid1->verts[ k + 1 + offset1 ].xyz, grid1->widthLodError[ k + 1 ] );
+					grid2 = R_GridInsertRow( grid2, l + 1, column, grid1->verts[ k + 1 + offset1 ].xyz, grid1->widthLodError[ k + 1 ], scratch );
 					grid2->lodStitched = false;
 					s_worldData.surfaces[ grid2num ].data = ( surfaceType_t * ) grid2;
 					return true;
@@ -1962,7 +2006,7 @@ int R_StitchPatches( int grid1num, int grid2num )
 					}
 
 					grid2 = R_GridInsertColumn( grid2, l + 1, row,
-					                            grid1->verts[ grid1->width * ( k + 1 ) + offset1 ].xyz, grid1->heightLodError[ k + 1 ] );
+					                            grid1->verts[ grid1->width * ( k + 1 ) + offset1 ].xyz, grid1->heightLodError[ k + 1 ], scratch );
 					grid2->lodStitched = false;
 					s_worldData.surfaces[ grid2num ].data = ( surfaceType_t * ) grid2;
 					return true;
@@ -2045,7 +2089,7 @@ int R_StitchPatches( int grid1num, int grid2num )
 					}
 
 					grid2 = R_GridInsertRow( grid2, l + 1, column,
-					                         grid1->verts[ grid1->width * ( k + 1 ) + offset1 ].xyz, grid1->heightLodError[ k + 1 ] );
+					                         grid1->verts[ grid1->width * ( k + 1 ) + offset1 ].xyz, grid1->heightLodError[ k + 1 ], scratch );
 					grid2->lodStitched = false;
 					s_worldData.surfaces[ grid2num ].data = ( surfaceType_t * ) grid2;
 					return true;
@@ -2148,7 +2192,7 @@ int R_StitchPatches( int grid1num, int grid2num )
 						row = 0;
 					}
 
-					grid2 = R_GridInsertColumn( grid2, l + 1, row, grid1->verts[ k - 1 + offset1 ].xyz, grid1->widthLodError[ k - 1 ] );
+					grid2 = R_GridInsertColumn( grid2, l + 1, row, grid1->verts[ k - 1 + offset1 ].xyz, grid1->widthLodError[ k - 1 ], scratch );
 					grid2->lodStitched = false;
 					s_worldData.surfaces[ grid2num ].data = ( surfaceType_t * ) grid2;
 					return true;
@@ -2230,7 +2274,7 @@ int R_StitchPatches( int grid1num, int grid2num )
 						column = 0;
 					}
 
-					grid2 = R_GridInsertRow( grid2, l + 1, column, grid1->verts[ k - 1 + offset1 ].xyz, grid1->widthLodError[ k - 1 ] );
+					grid2 = R_GridInsertRow( grid2, l + 1, column, grid1->verts[ k - 1 + offset1 ].xyz, grid1->widthLodError[ k - 1 ], scratch );
 
 					if ( !grid2 )
 					{
@@ -2340,7 +2384,7 @@ int R_StitchPatches( int grid1num, int grid2num )
 					}
 
 					grid2 = R_GridInsertColumn( grid2, l + 1, row,
-					                            grid1->verts[ grid1->width * ( k - 1 ) + offset1 ].xyz, grid1->heightLodError[ k - 1 ] );
+					                            grid1->verts[ grid1->width * ( k - 1 ) + offset1 ].xyz, grid1->heightLodError[ k - 1 ], scratch );
 					grid2->lodStitched = false;
 					s_worldData.surfaces[ grid2num ].data = ( surfaceType_t * ) grid2;
 					return true;
@@ -2423,7 +2467,7 @@ int R_StitchPatches( int grid1num, int grid2num )
 					}
 
 					grid2 = R_GridInsertRow( grid2, l + 1, column,
-					                         grid1->verts[ grid1->width * ( k - 1 ) + offset1 ].xyz, grid1->heightLodError[ k - 1 ] );
+					                         grid1->verts[ grid1->width * ( k - 1 ) + offset1 ].xyz, grid1->heightLodError[ k - 1 ], scratch );
 					grid2->lodStitched = false;
 					s_worldData.surfaces[ grid2num ].data = ( surfaceType_t * ) grid2;
 					return true;
@@ -2448,7 +2492,7 @@ of the patch (on the same row or column) the vertices will not be joined and cra
 might still appear at that side.
 ===============
 */
-int R_TryStitchingPatch( int grid1num )
+int R_TryStitchingPatch( int grid1num, gridScratch_t &scratch )
 {
 	int           j, numstitches;
 
@@ -2489,7 +2533,7 @@ int R_TryStitchingPatch( int grid1num )
 		}
 
 		//
-		while ( R_StitchPatches( grid1num, j ) )
+		while ( R_StitchPatches( grid1num, j, scratch ) )
 		{
 			numstitches++;
 		}
@@ -2507,6 +2551,7 @@ void R_StitchAllPatches()
 {
 	int           i, stitched, numstitches;
 	srfGridMesh_t *grid1;
+	std::unique_ptr<gridScratch_t> scratch( new gridScratch_t );
 
 	Log::Debug("...stitching LoD cracks" );
 
@@ -2537,7 +2582,7 @@ void R_StitchAllPatches()
 			grid1->lodStitched = true;
 			stitched = true;
 			//
-			numstitches += R_TryStitchingPatch( i );
+			numstitches += R_TryStitchingPatch( i, *scratch );
 		}
 	}
 	while ( stitched );
@@ -2590,6 +2635,381 @@ void R_MovePatchSurfacesToHunk()
 	}
 }
 
+/*
+===============
+World cache
+
+The subdivided and stitched patches and the merged vertices of the world
+VBO are cached in the home path. Each cache file is keyed by a checksum of
+the data the pass was computed from, so a changed map or different
+settings just compute it again.
+===============
+*/
+
+static Cvar::Cvar<bool> r_worldCache(
+	"r_worldCache", "cache the preprocessed world geometry in the home path", Cvar::NONE, true );
+
+static const uint32_t WORLD_CACHE_MAGIC = 0x48434357; // "WCCH"
+static const uint32_t WORLD_CACHE_VERSION = 1;
+
+class worldCacheReader_t
+{
+public:
+	explicit worldCacheReader_t( std::string data, size_t pos ) : data( std::move( data ) ), pos( pos ) {}
+
+	template<typename T> bool Read( T *values, size_t count )
+	{
+		if ( ( data.size() - pos ) / sizeof( T ) < count )
+		{
+			return false;
+		}
+
+		memcpy( static_cast<void *>( values ), data.data() + pos, count * sizeof( T ) );
+		pos += count * sizeof( T );
+		return true;
+	}
+
+	bool AtEnd() const
+	{
+		return pos == data.size();
+	}
+
+private:
+	std::string data;
+	size_t pos;
+};
+
+template<typename T> static void R_WriteWorldCacheData( std::string &data, const T *values, size_t count )
+{
+	data.append( reinterpret_cast<const char *>( values ), count * sizeof( T ) );
+}
+
+static uint32_t R_WorldCacheChecksum( uint32_t crc, const void *data, size_t size )
+{
+	return crc32( crc, static_cast<const Bytef *>( data ), size );
+}
+
+static std::string R_WorldCachePath( const char *extension )
+{
+	return Str::Format( "worldcache/%s.%s", s_worldData.baseName, extension );
+}
+
+// Returns a reader positioned after the header if the cache file matches the key
+static Util::optional<worldCacheReader_t> R_OpenWorldCache( const char *extension, uint32_t key )
+{
+	std::error_code err;
+	FS::File file = FS::HomePath::OpenRead( R_WorldCachePath( extension ), err );
+
+	if ( err )
+	{
+		return {};
+	}
+
+	std::string data = file.ReadAll( err );
+	const size_t headerSize = 4 * sizeof( uint32_t );
+
+	if ( err || data.size() < headerSize )
+	{
+		return {};
+	}
+
+	uint32_t header[ 4 ];
+	memcpy( header, data.data(), headerSize );
+
+	if ( header[ 0 ] != WORLD_CACHE_MAGIC || header[ 1 ] != WORLD_CACHE_VERSION || header[ 2 ] != key
+		|| header[ 3 ] != R_WorldCacheChecksum( 0, data.data() + headerSize, data.size() - headerSize ) )
+	{
+		return {};
+	}
+
+	return worldCacheReader_t( std::move( data ), headerSize );
+}
+
+// Errors are ignored since the cache is only an optimization
+static void R_SaveWorldCache( const char *extension, uint32_t key, const std::string &payload )
+{
+	uint32_t header[ 4 ] = {
+		WORLD_CACHE_MAGIC, WORLD_CACHE_VERSION, key, R_WorldCacheChecksum( 0, payload.data(), payload.size() ) };
+
+	std::string data( reinterpret_cast<const char *>( header ), sizeof( header ) );
+	data += payload;
+
+	std::string path = R_WorldCachePath( extension );
+	std::error_code err;
+	FS::HomePath::WriteFileAtomic( path, data, err );
+
+	if ( err )
+	{
+		Log::Warn( "Failed to write world cache %s: %s", path, err.message() );
+	}
+}
+
+static uint32_t R_PatchCacheKey( const std::vector<pendingPatch_t> &patches )
+{
+	uint32_t crc = R_WorldCacheChecksum( 0, &r_subdivisions->value, sizeof( r_subdivisions->value ) );
+	crc = R_WorldCacheChecksum( crc, &r_stitchCurves->integer, sizeof( r_stitchCurves->integer ) );
+	crc = R_WorldCacheChecksum( crc, &s_worldData.numSurfaces, sizeof( s_worldData.numSurfaces ) );
+
+	for ( const pendingPatch_t &patch : patches )
+	{
+		crc = R_WorldCacheChecksum( crc, &patch.surfaceNum, sizeof( patch.surfaceNum ) );
+		crc = R_WorldCacheChecksum( crc, &patch.width, sizeof( patch.width ) );
+		crc = R_WorldCacheChecksum( crc, &patch.height, sizeof( patch.height ) );
+		crc = R_WorldCacheChecksum( crc, patch.lodBounds, sizeof( patch.lodBounds ) );
+		crc = R_WorldCacheChecksum( crc, patch.points.data(), patch.points.size() * sizeof( srfVert_t ) );
+	}
+
+	return crc;
+}
+
+static bool R_LoadPatchCache( const std::vector<pendingPatch_t> &patches, uint32_t key )
+{
+	Util::optional<worldCacheReader_t> reader = R_OpenWorldCache( "patches", key );
+
+	if ( !reader )
+	{
+		return false;
+	}
+
+	// nothing goes to the hunk before the whole file is validated, since
+	// hunk memory can't be given back
+	struct cachedGrid_t
+	{
+		srfGridMesh_t grid;
+		std::vector<float> widthLodError, heightLodError;
+		std::vector<srfTriangle_t> triangles;
+		std::vector<srfVert_t> verts;
+	};
+
+	std::vector<cachedGrid_t> cachedGrids( patches.size() );
+
+	for ( size_t p = 0; p < patches.size(); p++ )
+	{
+		const pendingPatch_t &patch = patches[ p ];
+		cachedGrid_t &cached = cachedGrids[ p ];
+		srfGridMesh_t &grid = cached.grid;
+		int surfaceNum;
+
+		grid = {};
+
+		if ( !reader->Read( &surfaceNum, 1 ) || surfaceNum != patch.surfaceNum
+			|| !reader->Read( grid.bounds, 2 ) || !reader->Read( &grid.origin, 1 ) || !reader->Read( &grid.radius, 1 )
+			|| !reader->Read( &grid.lodOrigin, 1 ) || !reader->Read( &grid.lodRadius, 1 )
+			|| !reader->Read( &grid.lodFixed, 1 ) || !reader->Read( &grid.lodStitched, 1 )
+			|| !reader->Read( &grid.width, 1 ) || !reader->Read( &grid.height, 1 )
+			|| !reader->Read( &grid.numTriangles, 1 )
+			|| grid.width <= 0 || grid.width > MAX_GRID_SIZE || grid.height <= 0 || grid.height > MAX_GRID_SIZE
+			|| grid.numTriangles < 0 || grid.numTriangles > SHADER_MAX_TRIANGLES )
+		{
+			return false;
+		}
+
+		grid.surfaceType = surfaceType_t::SF_GRID;
+		grid.numVerts = grid.width * grid.height;
+		cached.widthLodError.resize( grid.width );
+		cached.heightLodError.resize( grid.height );
+		cached.triangles.resize( grid.numTriangles );
+		cached.verts.resize( grid.numVerts );
+
+		if ( !reader->Read( cached.widthLodError.data(), grid.width ) || !reader->Read( cached.heightLodError.data(), grid.height )
+			|| !reader->Read( cached.triangles.data(), grid.numTriangles ) || !reader->Read( cached.verts.data(), grid.numVerts ) )
+		{
+			return false;
+		}
+
+		for ( const srfTriangle_t &triangle : cached.triangles )
+		{
+			for ( int index : triangle.indexes )
+			{
+				if ( index < 0 || index >= grid.numVerts )
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	if ( !reader->AtEnd() )
+	{
+		return false;
+	}
+
+	for ( size_t p = 0; p < patches.size(); p++ )
+	{
+		cachedGrid_t &cached = cachedGrids[ p ];
+		srfGridMesh_t *grid = (srfGridMesh_t*) ri.Hunk_Alloc( sizeof( srfGridMesh_t ), ha_pref::h_low );
+
+		*grid = cached.grid;
+		grid->widthLodError = (float*) ri.Hunk_Alloc( grid->width * sizeof( float ), ha_pref::h_low );
+		std::copy( cached.widthLodError.begin(), cached.widthLodError.end(), grid->widthLodError );
+		grid->heightLodError = (float*) ri.Hunk_Alloc( grid->height * sizeof( float ), ha_pref::h_low );
+		std::copy( cached.heightLodError.begin(), cached.heightLodError.end(), grid->heightLodError );
+		grid->triangles = (srfTriangle_t*) ri.Hunk_Alloc( grid->numTriangles * sizeof( srfTriangle_t ), ha_pref::h_low );
+		std::copy( cached.triangles.begin(), cached.triangles.end(), grid->triangles );
+		grid->verts = (srfVert_t*) ri.Hunk_Alloc( grid->numVerts * sizeof( srfVert_t ), ha_pref::h_low );
+		std::copy( cached.verts.begin(), cached.verts.end(), grid->verts );
+
+		s_worldData.surfaces[ patches[ p ].surfaceNum ].data = ( surfaceType_t * ) grid;
+	}
+
+	return true;
+}
+
+static void R_SavePatchCache( const std::vector<pendingPatch_t> &patches, uint32_t key )
+{
+	std::string payload;
+
+	for ( const pendingPatch_t &patch : patches )
+	{
+		const srfGridMesh_t *grid = ( const srfGridMesh_t * ) s_worldData.surfaces[ patch.surfaceNum ].data;
+
+		R_WriteWorldCacheData( payload, &patch.surfaceNum, 1 );
+		R_WriteWorldCacheData( payload, grid->bounds, 2 );
+		R_WriteWorldCacheData( payload, &grid->origin, 1 );
+		R_WriteWorldCacheData( payload, &grid->radius, 1 );
+		R_WriteWorldCacheData( payload, &grid->lodOrigin, 1 );
+		R_WriteWorldCacheData( payload, &grid->lodRadius, 1 );
+		R_WriteWorldCacheData( payload, &grid->lodFixed, 1 );
+		R_WriteWorldCacheData( payload, &grid->lodStitched, 1 );
+		R_WriteWorldCacheData( payload, &grid->width, 1 );
+		R_WriteWorldCacheData( payload, &grid->height, 1 );
+		R_WriteWorldCacheData( payload, &grid->numTriangles, 1 );
+		R_WriteWorldCacheData( payload, grid->widthLodError, grid->width );
+		R_WriteWorldCacheData( payload, grid->heightLodError, grid->height );
+		R_WriteWorldCacheData( payload, grid->triangles, grid->numTriangles );
+		R_WriteWorldCacheData( payload, grid->verts, grid->numVerts );
+	}
+
+	R_SaveWorldCache( "patches", key, payload );
+}
+
+/*
+===============
+R_CreatePatchGrids
+
+Subdivides the patches into grids and stitches them, or loads the result
+from the world cache
+===============
+*/
+static void R_CreatePatchGrids( std::vector<pendingPatch_t> &patches )
+{
+	uint32_t key = 0;
+
+	if ( r_worldCache.Get() )
+	{
+		key = R_PatchCacheKey( patches );
+
+		if ( R_LoadPatchCache( patches, key ) )
+		{
+			Log::Debug( "...loaded %i patches from the world cache", patches.size() );
+			return;
+		}
+	}
+
+	// the patches are independent until they are stitched
+	std::vector<srfGridMesh_t *> grids( patches.size() );
+	Jobs::ParallelFor( 0, patches.size(), 16, [&]( int first, int last ) {
+		std::unique_ptr<gridScratch_t> scratch( new gridScratch_t );
+
+		for ( int i = first; i < last; i++ )
+		{
+			grids[ i ] = R_SubdividePatch( patches[ i ], *scratch );
+		}
+	} );
+
+	for ( size_t i = 0; i < patches.size(); i++ )
+	{
+		s_worldData.surfaces[ patches[ i ].surfaceNum ].data = ( surfaceType_t * ) grids[ i ];
+	}
+
+	if ( r_stitchCurves->integer )
+	{
+		R_StitchAllPatches();
+	}
+
+	R_FixSharedVertexLodError();
+
+	R_MovePatchSurfacesToHunk();
+
+	if ( r_worldCache.Get() )
+	{
+		R_SavePatchCache( patches, key );
+	}
+}
+
+static uint32_t R_MergedVerticesCacheKey( bspSurface_t **rendererSurfaces, int numSurfaces )
+{
+	uint32_t crc = R_WorldCacheChecksum( 0, &numSurfaces, sizeof( numSurfaces ) );
+
+	for ( int i = 0; i < numSurfaces; i++ )
+	{
+		const srfGeneric_t *srf = ( const srfGeneric_t * ) rendererSurfaces[ i ]->data;
+
+		crc = R_WorldCacheChecksum( crc, &srf->numVerts, sizeof( srf->numVerts ) );
+		crc = R_WorldCacheChecksum( crc, &srf->numTriangles, sizeof( srf->numTriangles ) );
+		crc = R_WorldCacheChecksum( crc, srf->verts, srf->numVerts * sizeof( srfVert_t ) );
+		crc = R_WorldCacheChecksum( crc, srf->triangles, srf->numTriangles * sizeof( srfTriangle_t ) );
+	}
+
+	return crc;
+}
+
+// Same output as MergeDuplicateVertices
+static bool R_LoadMergedVerticesCache( uint32_t key, bspSurface_t **rendererSurfaces, int numSurfaces,
+	srfVert_t *vertices, int numVerticesIn, glIndex_t *indices, int numIndicesIn, int &numVerticesOut, int &numIndicesOut )
+{
+	Util::optional<worldCacheReader_t> reader = R_OpenWorldCache( "vertices", key );
+
+	if ( !reader )
+	{
+		return false;
+	}
+
+	std::vector<int> firstIndexes( numSurfaces );
+
+	if ( !reader->Read( &numVerticesOut, 1 ) || !reader->Read( &numIndicesOut, 1 )
+		|| numVerticesOut < 0 || numVerticesOut > numVerticesIn || numIndicesOut < 0 || numIndicesOut > numIndicesIn
+		|| !reader->Read( firstIndexes.data(), numSurfaces )
+		|| !reader->Read( vertices, numVerticesOut ) || !reader->Read( indices, numIndicesOut ) || !reader->AtEnd() )
+	{
+		return false;
+	}
+
+	for ( int i = 0; i < numIndicesOut; i++ )
+	{
+		if ( indices[ i ] >= ( glIndex_t ) numVerticesOut )
+		{
+			return false;
+		}
+	}
+
+	for ( int i = 0; i < numSurfaces; i++ )
+	{
+		( ( srfGeneric_t * ) rendererSurfaces[ i ]->data )->firstIndex = firstIndexes[ i ];
+	}
+
+	return true;
+}
+
+static void R_SaveMergedVerticesCache( uint32_t key, bspSurface_t **rendererSurfaces, int numSurfaces,
+	const srfVert_t *vertices, int numVertices, const glIndex_t *indices, int numIndices )
+{
+	std::string payload;
+
+	R_WriteWorldCacheData( payload, &numVertices, 1 );
+	R_WriteWorldCacheData( payload, &numIndices, 1 );
+
+	for ( int i = 0; i < numSurfaces; i++ )
+	{
+		R_WriteWorldCacheData( payload, &( ( srfGeneric_t * ) rendererSurfaces[ i ]->data )->firstIndex, 1 );
+	}
+
+	R_WriteWorldCacheData( payload, vertices, numVertices );
+	R_WriteWorldCacheData( payload, indices, numIndices );
+
+	R_SaveWorldCache( "vertices", key, payload );
+}
+
 /*
 =================
 R_CreateClusters
@@ -2754,7 +3174,18 @@ static void R_CreateWorldVBO() {
 
 	int numVerts;
 	int numIndices;
-	MergeDuplicateVertices( rendererSurfaces, numSurfaces, vboVerts, numVertsInitial, vboIdxs, 3 * numTriangles, numVerts, numIndices );
+	uint32_t mergeKey = r_worldCache.Get() ? R_MergedVerticesCacheKey( rendererSurfaces, numSurfaces ) : 0;
+
+	if ( !r_worldCache.Get() || !R_LoadMergedVerticesCache( mergeKey, rendererSurfaces, numSurfaces,
+		vboVerts, numVertsInitial, vboIdxs, 3 * numTriangles, numVerts, numIndices ) )
+	{
+		MergeDuplicateVertices( rendererSurfaces, numSurfaces, vboVerts, numVertsInitial, vboIdxs, 3 * numTriangles, numVerts, numIndices );
+
+		if ( r_worldCache.Get() )
+		{
+			R_SaveMergedVerticesCache( mergeKey, rendererSurfaces, numSurfaces, vboVerts, numVerts, vboIdxs, numIndices );
+		}
+	}
 
 	if ( glConfig.usingMaterialSystem ) {
 		OptimiseMapGeometryMaterial( &s_worldData, rendererSurfaces, numSurfaces, vboVerts, numVerts, vboIdxs, numIndices );
@@ -2850,12 +3281,20 @@ static void R_LoadSurfaces( lump_t *surfs, lump_t *verts, lump_t *indexLump )
 	s_worldData.surfaces = out;
 	s_worldData.numSurfaces = count;
 
+	std::vector<pendingPatch_t> patches;
+
 	for ( i = 0; i < count; i++, in++, out++ )
 	{
 		switch ( LittleLong( in->surfaceType ) )
 		{
 			case mapSurfaceType_t::MST_PATCH:
-				ParseMesh( in, dv, out );
+				patches.emplace_back();
+
+				if ( !ParseMesh( in, dv, out, patches.back() ) )
+				{
+					patches.pop_back();
+				}
+
 				numMeshes++;
 				break;
 
@@ -2898,17 +3337,7 @@ static void R_LoadSurfaces( lump_t *surfs, lump_t *verts, lump_t *indexLump )
 	Log::Debug( "...loaded %d faces, %i meshes, %i trisurfs, %i flares (skipped) %i foliages", numFaces, numMeshes, numTriSurfs,
 	           numFlares, numFoliages );
 
-	if ( r_stitchCurves->integer )
-	{
-		R_StitchAllPatches();
-	}
-
-	R_FixSharedVertexLodError();
-
-	if ( r_stitchCurves->integer )
-	{
-		R_MovePatchSurfacesToHunk();
-	}
+	R_CreatePatchGrids( patches );
 }
 
 /*
@@ -4859,6 +5288,13 @@ void RE_LoadWorldMap( const char *name )
 
 	R_LoadLightmaps( &header->lumps[ LUMP_LIGHTMAPS ], name );
 
+	// start decoding the textures while the rest of the map is loaded,
+	// the shaders are only parsed along with the surfaces
+	for ( i = 0; i < s_worldData.numShaders; i++ )
+	{
+		R_PrefetchShaderImages( s_worldData.shaders[ i ].shader );
+	}
+
 	R_LoadPlanes( &header->lumps[ LUMP_PLANES ] );
 
 	R_LoadSurfaces( &header->lumps[ LUMP_SURFACES ], &header->lumps[ LUMP_DRAWVERTS ], &header->lumps[ LUMP_DRAWINDEXES ] );
@@ -277,14 +277,11 @@ static void MakeMeshNormals( int width, int height, srfVert_t ctrl[ MAX_GRID_SIZ
 	}
 }
 
-static int MakeMeshTriangles( int width, int height, srfVert_t ctrl[ MAX_GRID_SIZE ][ MAX_GRID_SIZE ],
-                              srfTriangle_t triangles[ SHADER_MAX_TRIANGLES ] )
+static int MakeMeshTriangles( int width, int height, srfTriangle_t triangles[ SHADER_MAX_TRIANGLES ] )
 {
 	int              i, j;
 	int              numTriangles;
 	int              w, h;
-	srfVert_t        *dv;
-	static srfVert_t ctrl2[ MAX_GRID_SIZE * MAX_GRID_SIZE ];
 
 	h = height - 1;
 	w = width - 1;
@@ -314,16 +311,6 @@ static int MakeMeshTriangles( int width, int height, srfVert_t ctrl[ MAX_GRID_SI
 		}
 	}
 
-	// FIXME: use more elegant way
-	for ( i = 0; i < width; i++ )
-	{
-		for ( j = 0; j < height; j++ )
-		{
-			dv = &ctrl2[ j * width + i ];
-			*dv = ctrl[ j ][ i ];
-		}
-	}
-
 	return numTriangles;
 }
 
@@ -417,44 +404,24 @@ static srfGridMesh_t *R_CreateSurfaceGridMesh( int width, int height,
 	vec3_t        tmpVec;
 	srfGridMesh_t *grid;
 
-	// copy the results out to a grid
+	// copy the results out to a grid, the grids are moved to the hunk by
+	// R_MovePatchSurfacesToHunk once all of them are stitched
 	size = sizeof( *grid );
 
-	if ( r_stitchCurves->integer )
-	{
-		grid = (srfGridMesh_t*)/*ri.Hunk_Alloc */ Z_Calloc( size );
-
-		grid->widthLodError = (float*)/*ri.Hunk_Alloc */ Z_AllocUninit( width * sizeof( float ) );
-		std::copy_n( errorTable[ 0 ], width, grid->widthLodError );
-
-		grid->heightLodError = (float*)/*ri.Hunk_Alloc */ Z_AllocUninit( height * sizeof( float ) );
-		std::copy_n( errorTable[ 1 ], height, grid->heightLodError );
-
-		grid->numTriangles = numTriangles;
-		grid->triangles = (srfTriangle_t*) Z_AllocUninit( grid->numTriangles * sizeof( srfTriangle_t ) );
-		std::copy_n( triangles, numTriangles, grid->triangles );
-
-		grid->numVerts = ( width * height );
-		grid->verts = (srfVert_t*) Z_AllocUninit( grid->numVerts * sizeof( srfVert_t ) );
-	}
-	else
-	{
-		grid = (srfGridMesh_t*) ri.Hunk_Alloc( size, ha_pref::h_low );
-		*grid = {};
+	grid = (srfGridMesh_t*) Z_Calloc( size );
 
-		grid->widthLodError = (float*) ri.Hunk_Alloc( width * 4, ha_pref::h_low );
-		std::copy_n( errorTable[ 0 ], width, grid->widthLodError );
+	grid->widthLodError = (float*) Z_AllocUninit( width * sizeof( float ) );
+	std::copy_n( errorTable[ 0 ], width, grid->widthLodError );
 
-		grid->heightLodError = (float*) ri.Hunk_Alloc( height * 4, ha_pref::h_low );
-		std::copy_n( errorTable[ 1 ], height, grid->heightLodError );
+	grid->heightLodError = (float*) Z_AllocUninit( height * sizeof( float ) );
+	std::copy_n( errorTable[ 1 ], height, grid->heightLodError );
 
-		grid->numTriangles = numTriangles;
-		grid->triangles = (srfTriangle_t*) ri.Hunk_Alloc( grid->numTriangles * sizeof( srfTriangle_t ), ha_pref::h_low );
-		std::copy_n( triangles, numTriangles, grid->triangles );
+	grid->numTriangles = numTriangles;
+	grid->triangles = (srfTriangle_t*) Z_AllocUninit( grid->numTriangles * sizeof( srfTriangle_t ) );
+	std::copy_n( triangles, numTriangles, grid->triangles );
 
-		grid->numVerts = ( width * height );
-		grid->verts = (srfVert_t*) ri.Hunk_Alloc( grid->numVerts * sizeof( srfVert_t ), ha_pref::h_low );
-	}
+	grid->numVerts = ( width * height );
+	grid->verts = (srfVert_t*) Z_AllocUninit( grid->numVerts * sizeof( srfVert_t ) );
 
 	grid->width = width;
 	grid->height = height;
@@ -497,14 +464,12 @@ void R_FreeSurfaceGridMesh( srfGridMesh_t *grid )
 	Z_Free( grid );
 }
 
-static srfTriangle_t gridtriangles[ SHADER_MAX_TRIANGLES ];
-static srfVert_t     gridctrl[ MAX_GRID_SIZE ][ MAX_GRID_SIZE ];
 /*
 =================
 R_SubdividePatchToGrid
 =================
 */
-srfGridMesh_t  *R_SubdividePatchToGrid( int width, int height, srfVert_t points[ MAX_PATCH_SIZE * MAX_PATCH_SIZE ] )
+srfGridMesh_t  *R_SubdividePatchToGrid( int width, int height, srfVert_t points[ MAX_PATCH_SIZE * MAX_PATCH_SIZE ], gridScratch_t &scratch )
 {
 	int                  i, j, k, l;
 	srfVert_t            prev, next, mid;
@@ -518,7 +483,7 @@ srfGridMesh_t  *R_SubdividePatchToGrid( int width, int height, srfVert_t points[
 	{
 		for ( j = 0; j < height; j++ )
 		{
-			gridctrl[ j ][ i ] = points[ j * width + i ];
+			scratch.ctrl[ j ][ i ] = points[ j * width + i ];
 		}
 	}
 
@@ -550,15 +515,15 @@ srfGridMesh_t  *R_SubdividePatchToGrid( int width, int height, srfVert_t points[
 				// calculate the point on the curve
 				for ( l = 0; l < 3; l++ )
 				{
-					midxyz[ l ] = ( gridctrl[ i ][ j ].xyz[ l ] + gridctrl[ i ][ j + 1 ].xyz[ l ] * 2 + gridctrl[ i ][ j + 2 ].xyz[ l ] ) * 0.25f;
+					midxyz[ l ] = ( scratch.ctrl[ i ][ j ].xyz[ l ] + scratch.ctrl[ i ][ j + 1 ].xyz[ l ] * 2 + scratch.ctrl[ i ][ j + 2 ].xyz[ l ] ) * 0.25f;
 				}
 
 				// see how far off the line it is
 				// using dist-from-line will not account for internal
 				// texture warping, but it gives a lot less polygons than
 				// dist-from-midpoint
-				VectorSubtract( midxyz, gridctrl[ i ][ j ].xyz, midxyz );
-				VectorSubtract( gridctrl[ i ][ j + 2 ].xyz, gridctrl[ i ][ j ].xyz, direction );
+				VectorSubtract( midxyz, scratch.ctrl[ i ][ j ].xyz, midxyz );
+				VectorSubtract( scratch.ctrl[ i ][ j + 2 ].xyz, scratch.ctrl[ i ][ j ].xyz, direction );
 				VectorNormalize( direction );
 
 				d = DotProduct( midxyz, direction );
@@ -601,32 +566,32 @@ srfGridMesh_t  *R_SubdividePatchToGrid( int width, int height, srfVert_t points[
 
 			for ( i = 0; i < height; i++ )
 			{
-				LerpSurfaceVert( &gridctrl[ i ][ j ], &gridctrl[ i ][ j + 1 ], &prev );
-				LerpSurfaceVert( &gridctrl[ i ][ j + 1 ], &gridctrl[ i ][ j + 2 ], &next );
+				LerpSurfaceVert( &scratch.ctrl[ i ][ j ], &scratch.ctrl[ i ][ j + 1 ], &prev );
+				LerpSurfaceVert( &scratch.ctrl[ i ][ j + 1 ], &scratch.ctrl[ i ][ j + 2 ], &next );
 				LerpSurfaceVert( &prev, &next, &mid );
 
 				for ( k = width - 1; k > j + 3; k-- )
 				{
-					gridctrl[ i ][ k ] = gridctrl[ i ][ k - 2 ];
+					scratch.ctrl[ i ][ k ] = scratch.ctrl[ i ][ k - 2 ];
 				}
 
-				gridctrl[ i ][ j + 1 ] = prev;
-				gridctrl[ i ][ j + 2 ] = mid;
-				gridctrl[ i ][ j + 3 ] = next;
+				scratch.ctrl[ i ][ j + 1 ] = prev;
+				scratch.ctrl[ i ][ j + 2 ] = mid;
+				scratch.ctrl[ i ][ j + 3 ] = next;
 			}
 
 			// back up and recheck this set again, it may need more subdivision
 			j -= 2;
 		}
 
-		Transpose( width, height, gridctrl );
+		Transpose( width, height, scratch.ctrl );
 		t = width;
 		width = height;
 		height = t;
 	}
 
 	// put all the approximating points on the curve
-	PutPointsOnCurve( gridctrl, width, height );
+	PutPointsOnCurve( scratch.ctrl, width, height );
 
 	// cull out any rows or columns that are colinear
 	for ( i = 1; i < width - 1; i++ )
@@ -640,7 +605,7 @@ srfGridMesh_t  *R_SubdividePatchToGrid( int width, int height, srfVert_t points[
 		{
 			for ( k = 0; k < height; k++ )
 			{
-				gridctrl[ k ][ j - 1 ] = gridctrl[ k ][ j ];
+				scratch.ctrl[ k ][ j - 1 ] = scratch.ctrl[ k ][ j ];
 			}
 
 			errorTable[ 0 ][ j - 1 ] = errorTable[ 0 ][ j ];
@@ -660,7 +625,7 @@ srfGridMesh_t  *R_SubdividePatchToGrid( int width, int height, srfVert_t points[
 		{
 			for ( k = 0; k < width; k++ )
 			{
-				gridctrl[ j - 1 ][ k ] = gridctrl[ j ][ k ];
+				scratch.ctrl[ j - 1 ][ k ] = scratch.ctrl[ j ][ k ];
 			}
 
 			errorTable[ 1 ][ j - 1 ] = errorTable[ 1 ][ j ];
@@ -674,21 +639,21 @@ srfGridMesh_t  *R_SubdividePatchToGrid( int width, int height, srfVert_t points[
 	// without this step
 	if ( height > width )
 	{
-		Transpose( width, height, gridctrl );
+		Transpose( width, height, scratch.ctrl );
 		InvertErrorTable( errorTable, width, height );
 		t = width;
 		width = height;
 		height = t;
-		InvertCtrl( width, height, gridctrl );
+		InvertCtrl( width, height, scratch.ctrl );
 	}
 
 	// calculate triangles
-	numTriangles = MakeMeshTriangles( width, height, gridctrl, gridtriangles );
+	numTriangles = MakeMeshTriangles( width, height, scratch.triangles );
 
 	// calculate normals
-	MakeMeshNormals( width, height, gridctrl );
+	MakeMeshNormals( width, height, scratch.ctrl );
 
-	return R_CreateSurfaceGridMesh( width, height, gridctrl, errorTable, numTriangles, gridtriangles );
+	return R_CreateSurfaceGridMesh( width, height, scratch.ctrl, errorTable, numTriangles, scratch.triangles );
 }
 
 /*
@@ -696,7 +661,7 @@ srfGridMesh_t  *R_SubdividePatchToGrid( int width, int height, srfVert_t points[
 R_GridInsertColumn
 ===============
 */
-srfGridMesh_t  *R_GridInsertColumn( srfGridMesh_t *grid, int column, int row, vec3_t point, float loderror )
+srfGridMesh_t  *R_GridInsertColumn( srfGridMesh_t *grid, int column, int row, vec3_t point, float loderror, gridScratch_t &scratch )
 {
 	int                  i, j;
 	int                  width, height, oldwidth;
@@ -722,11 +687,11 @@ srfGridMesh_t  *R_GridInsertColumn( srfGridMesh_t *grid, int column, int row, ve
 			//insert new column
 			for ( j = 0; j < grid->height; j++ )
 			{
-				LerpSurfaceVert( &grid->verts[ j * grid->width + i - 1 ], &grid->verts[ j * grid->width + i ], &gridctrl[ j ][ i ] );
+				LerpSurfaceVert( &grid->verts[ j * grid->width + i - 1 ], &grid->verts[ j * grid->width + i ], &scratch.ctrl[ j ][ i ] );
 
 				if ( j == row )
 				{
-					VectorCopy( point, gridctrl[ j ][ i ].xyz );
+					VectorCopy( point, scratch.ctrl[ j ][ i ].xyz );
 				}
 			}
 
@@ -738,7 +703,7 @@ srfGridMesh_t  *R_GridInsertColumn( srfGridMesh_t *grid, int column, int row, ve
 
 		for ( j = 0; j < grid->height; j++ )
 		{
-			gridctrl[ j ][ i ] = grid->verts[ j * grid->width + oldwidth ];
+			scratch.ctrl[ j ][ i ] = grid->verts[ j * grid->width + oldwidth ];
 		}
 
 		oldwidth++;
@@ -750,17 +715,17 @@ srfGridMesh_t  *R_GridInsertColumn( srfGridMesh_t *grid, int column, int row, ve
 	}
 
 	// calculate triangles
-	numTriangles = MakeMeshTriangles( width, height, gridctrl, gridtriangles );
+	numTriangles = MakeMeshTriangles( width, height, scratch.triangles );
 
 	// calculate normals
-	MakeMeshNormals( width, height, gridctrl );
+	MakeMeshNormals( width, height, scratch.ctrl );
 
 	VectorCopy( grid->lodOrigin, lodOrigin );
 	lodRadius = grid->lodRadius;
 	// free the old grid
 	R_FreeSurfaceGridMesh( grid );
 	// create a new grid
-	grid = R_CreateSurfaceGridMesh( width, height, gridctrl, errorTable, numTriangles, gridtriangles );
+	grid = R_CreateSurfaceGridMesh( width, height, scratch.ctrl, errorTable, numTriangles, scratch.triangles );
 	grid->lodRadius = lodRadius;
 	VectorCopy( lodOrigin, grid->lodOrigin );
 	return grid;
@@ -771,7 +736,7 @@ srfGridMesh_t  *R_GridInsertColumn( srfGridMesh_t *grid, int column, int row, ve
 R_GridInsertRow
 ===============
 */
-srfGridMesh_t  *R_GridInsertRow( srfGridMesh_t *grid, int row, int column, vec3_t point, float loderror )
+srfGridMesh_t  *R_GridInsertRow( srfGridMesh_t *grid, int row, int column, vec3_t point, float loderror, gridScratch_t &scratch )
 {
 	int                  i, j;
 	int                  width, height, oldheight;
@@ -796,11 +761,11 @@ srfGridMesh_t  *R_GridInsertRow( srfGridMesh_t *grid, int row, int column, vec3_
 			//insert new row
 			for ( j = 0; j < grid->width; j++ )
 			{
-				LerpSurfaceVert( &grid->verts[( i - 1 ) * grid->width + j ], &grid->verts[ i * grid->width + j ], &gridctrl[ i ][ j ] );
+				LerpSurfaceVert( &grid->verts[( i - 1 ) * grid->width + j ], &grid->verts[ i * grid->width + j ], &scratch.ctrl[ i ][ j ] );
 
 				if ( j == column )
 				{
-					VectorCopy( point, gridctrl[ i ][ j ].xyz );
+					VectorCopy( point, scratch.ctrl[ i ][ j ].xyz );
 				}
 			}
 
@@ -812,7 +777,7 @@ srfGridMesh_t  *R_GridInsertRow( srfGridMesh_t *grid, int row, int column, vec3_
 
 		for ( j = 0; j < grid->width; j++ )
 		{
-			gridctrl[ i ][ j ] = grid->verts[ oldheight * grid->width + j ];
+			scratch.ctrl[ i ][ j ] = grid->verts[ oldheight * grid->width + j ];
 		}
 
 		oldheight++;
@@ -824,17 +789,17 @@ srfGridMesh_t  *R_GridInsertRow( srfGridMesh_t *grid, int row, int column, vec3_
 	}
 
 	// calculate triangles
-	numTriangles = MakeMeshTriangles( width, height, gridctrl, gridtriangles );
+	numTriangles = MakeMeshTriangles( width, height, scratch.triangles );
 
 	// calculate normals
-	MakeMeshNormals( width, height, gridctrl );
+	MakeMeshNormals( width, height, scratch.ctrl );
 
 	VectorCopy( grid->lodOrigin, lodOrigin );
 	lodRadius = grid->lodRadius;
 	// free the old grid
 	R_FreeSurfaceGridMesh( grid );
 	// create a new grid
-	grid = R_CreateSurfaceGridMesh( width, height, gridctrl, errorTable, numTriangles, gridtriangles );
+	grid = R_CreateSurfaceGridMesh( width, height, scratch.ctrl, errorTable, numTriangles, scratch.triangles );
 	grid->lodRadius = lodRadius;
 	VectorCopy( lodOrigin, grid->lodOrigin );
 	return grid;
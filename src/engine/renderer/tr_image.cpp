@@ -26,6 +26,11 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "tr_local.h"
 #include <iomanip>
 #include "Material.h"
+#include "framework/JobSystem.h"
+
+static Cvar::Range<Cvar::Cvar<int>> r_imageDecodeAhead(
+	"r_imageDecodeAhead", "how many requested images may be decoded ahead on the job threads while loading, 0 to decode them when they are used",
+	Cvar::NONE, 32, 0, 1024 );
 
 static Cvar::Cvar<bool> r_allowImageParamMismatch(
 	"r_allowImageParamMismatch", "reuse images when requested with different parameters",
@@ -1642,20 +1647,22 @@ struct imageExtLoader_t
 	const char *name;
 	imageLoader_t imageLoader;
 	bool cubemap;
+	// decoding is slow enough for the result to be kept in the texture cache
+	bool cache;
 };
 
 /* The ordering indicates the order of preference used when
 there are multiple images of different formats available. */
 static const imageExtLoader_t imageLoaders[] =
 {
-	{ "webp", "WebP", LoadWEBP, false },
-	{ "png",  "PNG",  LoadPNG,  false },
-	{ "tga",  "TGA",  LoadTGA,  false },
-	{ "jpg",  "JPEG", LoadJPG,  false },
-	{ "jpeg", "JPEG", LoadJPG,  false },
-	{ "dds",  "DDS",  LoadDDS,  false },
-	{ "crn",  "CRN",  LoadCRN,  true  },
-	{ "ktx",  "KTX",  LoadKTX,  true  },
+	{ "webp", "WebP", LoadWEBP, false, true  },
+	{ "png",  "PNG",  LoadPNG,  false, true  },
+	{ "tga",  "TGA",  LoadTGA,  false, true  },
+	{ "jpg",  "JPEG", LoadJPG,  false, true  },
+	{ "jpeg", "JPEG", LoadJPG,  false, true  },
+	{ "dds",  "DDS",  LoadDDS,  false, false },
+	{ "crn",  "CRN",  LoadCRN,  true,  true  },
+	{ "ktx",  "KTX",  LoadKTX,  true,  false },
 };
 
 /*
@@ -1717,11 +1724,28 @@ bool R_HasImageLoader( const char *baseName ) {
 static void R_LoadImageWithLoader( const char* fileName, const char* altName, const imageExtLoader_t *loader, byte **pic, int *width, int *height, int *numLayers, int *numMips, int *bits, byte alphaByte )
 {
 	Log::Debug( "Found %s image candidate '%s': %s", loader->name, fileName, altName );
+
+	if ( loader->cache && !( *bits & IF_HOMEPATH )
+		&& R_LoadCachedImage( altName, pic, width, height, numMips, bits ) )
+	{
+		*numLayers = 0;
+		return;
+	}
+
+	int requestedBits = *bits;
+
 	loader->imageLoader( altName, pic, width, height, numLayers, numMips, bits, alphaByte );
 
 	if ( *pic )
 	{
 		Log::Debug("Found %d×%d %s image '%s': %s", *width, *height, loader->name, fileName, altName );
+
+		// the requested bits like IF_NORMALMAP say how to upload the image,
+		// only the format set by the loader describes the decoded data
+		if ( loader->cache && !( *bits & IF_HOMEPATH ) )
+		{
+			R_CacheImage( altName, pic, *width, *height, *numLayers, *numMips, *bits & ~requestedBits );
+		}
 	}
 }
 
@@ -1810,6 +1834,198 @@ static void R_LoadImage( const char *name, byte **pic, int *width, int *height,
 	}
 }
 
+/*
+=================
+Image prefetching
+
+Shaders and maps request the images they are about to use with
+R_PrefetchImageFile, they are then read and decoded on the job threads
+while the render thread goes on parsing, and R_FindImageFile takes the
+decoded pixels when the image is really needed. Only the GL upload stays on
+the render thread. At most r_imageDecodeAhead images are decoded and not yet
+used at the same time, to bound the memory they take.
+=================
+*/
+
+struct prefetchedImage_t
+{
+	std::string name;
+	Jobs::JobHandle job;
+	bool taken = false;
+
+	// written by the job
+	byte *pic[ MAX_TEXTURE_MIPS * MAX_TEXTURE_LAYERS ];
+	int width = 0, height = 0, numLayers = 0, numMips = 0, bits = 0;
+	std::exception_ptr error;
+};
+
+static std::unordered_map<std::string, std::shared_ptr<prefetchedImage_t>> prefetchedImages;
+static std::deque<std::shared_ptr<prefetchedImage_t>> prefetchQueue;
+static int numPrefetchesStarted = 0;
+
+static void R_DecodePrefetchedImage( prefetchedImage_t *prefetch )
+{
+	prefetch->pic[ 0 ] = nullptr;
+
+	try
+	{
+		R_LoadImage( prefetch->name.c_str(), prefetch->pic, &prefetch->width, &prefetch->height,
+			&prefetch->numLayers, &prefetch->numMips, &prefetch->bits );
+	}
+	catch ( ... )
+	{
+		// rethrown by R_FindImageFile, jobs must not throw
+		prefetch->error = std::current_exception();
+	}
+}
+
+// Start decoding the queued images as long as there is room for them
+static void R_StartImagePrefetches()
+{
+	while ( !prefetchQueue.empty() && numPrefetchesStarted < r_imageDecodeAhead.Get() )
+	{
+		std::shared_ptr<prefetchedImage_t> prefetch = std::move( prefetchQueue.front() );
+		prefetchQueue.pop_front();
+
+		if ( prefetch->taken )
+		{
+			continue;
+		}
+
+		prefetch->job = Jobs::Submit( [prefetch] {
+			R_DecodePrefetchedImage( prefetch.get() );
+		} );
+		numPrefetchesStarted++;
+	}
+}
+
+/*
+=================
+R_PrefetchImageFile
+
+Starts loading an image that is about to be requested with R_FindImageFile.
+=================
+*/
+void R_PrefetchImageFile( const char *imageName0 )
+{
+	if ( !imageName0 || !r_imageDecodeAhead.Get() )
+	{
+		return;
+	}
+
+	// built-in images are never loaded from files
+	if ( imageName0[ 0 ] == '$' || imageName0[ 0 ] == '*' || imageName0[ 0 ] == '_' )
+	{
+		return;
+	}
+
+	std::string imageName = FS::Path::NormalizeSlashes( imageName0 );
+	std::string key = Str::ToLower( imageName );
+
+	if ( prefetchedImages.count( key ) )
+	{
+		return;
+	}
+
+	unsigned hash = GenerateImageHashValue( imageName.c_str() );
+
+	for ( image_t *image = r_imageHashTable[ hash ]; image; image = image->next )
+	{
+		if ( Str::IsIEqual( imageName, image->name ) )
+		{
+			return;
+		}
+	}
+
+	auto prefetch = std::make_shared<prefetchedImage_t>();
+	prefetch->name = std::move( imageName );
+	prefetchedImages.emplace( std::move( key ), prefetch );
+	prefetchQueue.push_back( std::move( prefetch ) );
+
+	R_StartImagePrefetches();
+}
+
+/*
+=================
+R_TakePrefetchedImage
+
+Loads an image like R_LoadImage, using the prefetched pixels if there are any.
+=================
+*/
+static void R_TakePrefetchedImage( const std::string &imageName, byte **pic, int *width, int *height,
+	int *numLayers, int *numMips, int *bits )
+{
+	auto it = prefetchedImages.find( Str::ToLower( imageName ) );
+
+	// the KTX loader reads images from the home path when asked to
+	if ( it == prefetchedImages.end() || ( *bits & IF_HOMEPATH ) )
+	{
+		R_LoadImage( imageName.c_str(), pic, width, height, numLayers, numMips, bits );
+		return;
+	}
+
+	std::shared_ptr<prefetchedImage_t> prefetch = std::move( it->second );
+	prefetchedImages.erase( it );
+	prefetch->taken = true;
+
+	if ( prefetch->job )
+	{
+		Jobs::Wait( prefetch->job );
+		numPrefetchesStarted--;
+		R_StartImagePrefetches();
+	}
+	else
+	{
+		// not started yet, it's quicker to decode it here
+		R_DecodePrefetchedImage( prefetch.get() );
+	}
+
+	if ( prefetch->error )
+	{
+		std::rethrow_exception( prefetch->error );
+	}
+
+	memcpy( pic, prefetch->pic, sizeof( prefetch->pic ) );
+	*width = prefetch->width;
+	*height = prefetch->height;
+	*numLayers = prefetch->numLayers;
+	*numMips = prefetch->numMips;
+	*bits |= prefetch->bits;
+}
+
+/*
+=================
+R_FlushImagePrefetches
+
+Frees the prefetched images that were never used, once loading is done.
+=================
+*/
+void R_FlushImagePrefetches()
+{
+	prefetchQueue.clear();
+
+	for ( auto &entry : prefetchedImages )
+	{
+		prefetchedImage_t *prefetch = entry.second.get();
+
+		if ( !prefetch->job )
+		{
+			continue;
+		}
+
+		Jobs::Wait( prefetch->job );
+
+		if ( prefetch->pic[ 0 ] )
+		{
+			Log::Debug( "Prefetched image '%s' was not used", prefetch->name );
+			Z_Free( prefetch->pic[ 0 ] );
+		}
+	}
+
+	prefetchedImages.clear();
+	numPrefetchesStarted = 0;
+}
+
 /*
 ===============
 R_FindImageFile
@@ -1891,7 +2107,7 @@ image_t *R_FindImageFile( const char *imageName0, imageParams_t &imageParams )
 	byte *pic[ MAX_TEXTURE_MIPS * MAX_TEXTURE_LAYERS ];
 	pic[ 0 ] = nullptr;
 
-	R_LoadImage( imageName.c_str(), pic, &width, &height, &numLayers, &numMips, &imageParams.bits);
+	R_TakePrefetchedImage( imageName, pic, &width, &height, &numLayers, &numMips, &imageParams.bits );
 
 	if ( *pic )
 	{
@@ -2812,6 +3028,9 @@ void R_ShutdownImages()
 {
 	Log::Debug("------- R_ShutdownImages -------" );
 
+	R_FlushImagePrefetches();
+	R_SaveImageCacheIndex();
+
 	for ( image_t *image : tr.images )
 	{
 		if ( image->texture->IsResident() ) {
@@ -0,0 +1,344 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+// tr_image_cache.cpp -- on-disk cache of decoded images
+
+#include "common/FileSystem.h"
+#include "tr_local.h"
+
+/*
+Decoding PNG, JPEG or WebP images and transcoding CRN images takes most of the
+time spent loading textures, and gives the same result every time. When the
+cache is enabled, the decoded pixels and their mipmaps are saved as KTX files
+in the home path, keyed by the pak and the path of the source file, and later
+loads read them instead. The least recently used files are removed when the
+cache grows over its size limit.
+
+The images can be decoded on the job threads, so the cache state is guarded
+by a mutex.
+*/
+
+static Cvar::Cvar<bool> r_textureCache(
+	"r_textureCache", "keep decoded textures in the home path to load them faster", Cvar::NONE, false );
+static Cvar::Range<Cvar::Cvar<int>> r_textureCacheSize(
+	"r_textureCacheSize", "size limit of the texture cache in MiB", Cvar::NONE, 1024, 16, 65536 );
+
+static const char CACHE_DIR[] = "texcache";
+static const char CACHE_INDEX[] = "texcache/index.txt";
+
+namespace {
+struct cachedImage_t
+{
+	// identifies the source file, to detect hash collisions and modified paks
+	std::string key;
+	uint64_t size = 0;
+	uint64_t lastUse = 0;
+};
+
+struct imageCache_t
+{
+	std::mutex mutex;
+	bool loaded = false;
+	bool modified = false;
+
+	// by cache file name
+	std::unordered_map<std::string, cachedImage_t> images;
+	uint64_t totalSize = 0;
+	uint64_t useCount = 0;
+};
+} // namespace
+
+static imageCache_t imageCache;
+
+/*
+================
+R_PakFileCacheKey
+
+Identifies the content of a file in the paks for the caches of data derived
+from it: the name and checksum of its pak for zip paks, the modification time
+of the file for directory paks.
+================
+*/
+bool R_PakFileCacheKey( const char *fileName, std::string &key )
+{
+	const FS::LoadedPakInfo *pak = FS::PakPath::LocateFile( fileName );
+
+	if ( !pak )
+	{
+		return false;
+	}
+
+	if ( pak->type == FS::pakType_t::PAK_ZIP )
+	{
+		Util::optional<uint32_t> checksum = pak->realChecksum ? pak->realChecksum : pak->checksum;
+
+		if ( !checksum )
+		{
+			return false;
+		}
+
+		key = Str::Format( "%s_%s_%08x:%s", pak->name, pak->version, *checksum, fileName );
+		return true;
+	}
+
+	std::error_code err;
+	auto timestamp = FS::PakPath::FileTimestamp( fileName, err );
+
+	if ( err )
+	{
+		return false;
+	}
+
+	key = Str::Format( "%s_%s@%d:%s", pak->name, pak->version,
+		std::chrono::duration_cast<std::chrono::seconds>( timestamp.time_since_epoch() ).count(), fileName );
+	return true;
+}
+
+static std::string R_ImageCachePath( const std::string &key )
+{
+	return Str::Format( "%s/%016x.ktx", CACHE_DIR, uint64_t( std::hash<std::string>()( key ) ) );
+}
+
+// The index lists a cache file per line: name, size, last use and key
+static void R_LoadImageCacheIndex()
+{
+	if ( imageCache.loaded )
+	{
+		return;
+	}
+
+	imageCache.loaded = true;
+
+	std::error_code err;
+	FS::File file = FS::HomePath::OpenRead( CACHE_INDEX, err );
+
+	if ( err )
+	{
+		return;
+	}
+
+	std::string index = file.ReadAll( err );
+
+	if ( err )
+	{
+		return;
+	}
+
+	size_t start = 0;
+
+	while ( start < index.size() )
+	{
+		size_t end = index.find( '\n', start );
+
+		if ( end == std::string::npos )
+		{
+			end = index.size();
+		}
+
+		std::string line = index.substr( start, end - start );
+		start = end + 1;
+
+		char fileName[ MAX_QPATH ];
+		unsigned long long size, lastUse;
+		int keyOffset;
+
+		if ( sscanf( line.c_str(), "%63s %llu %llu %n", fileName, &size, &lastUse, &keyOffset ) != 3 )
+		{
+			continue;
+		}
+
+		cachedImage_t &image = imageCache.images[ fileName ];
+		image.key = line.substr( keyOffset );
+		image.size = size;
+		image.lastUse = lastUse;
+
+		imageCache.totalSize += size;
+		imageCache.useCount = std::max( imageCache.useCount, image.lastUse );
+	}
+}
+
+// Remove the least recently used images until the cache fits in its limit
+static void R_TrimImageCache()
+{
+	uint64_t limit = uint64_t( r_textureCacheSize.Get() ) << 20;
+
+	while ( imageCache.totalSize > limit && !imageCache.images.empty() )
+	{
+		auto oldest = imageCache.images.begin();
+
+		for ( auto it = imageCache.images.begin(); it != imageCache.images.end(); ++it )
+		{
+			if ( it->second.lastUse < oldest->second.lastUse )
+			{
+				oldest = it;
+			}
+		}
+
+		std::error_code err;
+		FS::HomePath::DeleteFile( oldest->first, err );
+
+		imageCache.totalSize -= oldest->second.size;
+		imageCache.images.erase( oldest );
+		imageCache.modified = true;
+	}
+}
+
+/*
+================
+R_LoadCachedImage
+
+Loads the decoded version of a file from the cache, returns false if it isn't
+cached.
+================
+*/
+bool R_LoadCachedImage( const char *fileName, byte **pic, int *width, int *height, int *numMips, int *bits )
+{
+	if ( !r_textureCache.Get() )
+	{
+		return false;
+	}
+
+	std::string key;
+
+	if ( !R_PakFileCacheKey( fileName, key ) )
+	{
+		return false;
+	}
+
+	std::string path = R_ImageCachePath( key );
+
+	{
+		std::lock_guard<std::mutex> lock( imageCache.mutex );
+		R_LoadImageCacheIndex();
+
+		auto it = imageCache.images.find( path );
+
+		if ( it == imageCache.images.end() || it->second.key != key )
+		{
+			return false;
+		}
+
+		it->second.lastUse = ++imageCache.useCount;
+		imageCache.modified = true;
+	}
+
+	int numLayers;
+	int cachedBits = IF_HOMEPATH;
+	LoadKTX( path.c_str(), pic, width, height, &numLayers, numMips, &cachedBits, 0xFF );
+
+	if ( !*pic )
+	{
+		return false;
+	}
+
+	Log::Debug( "Loaded image '%s' from the texture cache: %s", fileName, path );
+	*bits |= cachedBits & ~IF_HOMEPATH;
+	return true;
+}
+
+/*
+================
+R_CacheImage
+
+Saves a decoded image, bits are only the format bits set by its loader.
+================
+*/
+void R_CacheImage( const char *fileName, byte **pic, int width, int height, int numLayers, int numMips, int bits )
+{
+	if ( !r_textureCache.Get() || numLayers > 0 )
+	{
+		return;
+	}
+
+	// only the formats SaveImageDataKTX knows about
+	if ( bits & ~( IF_BC1 | IF_BC2 | IF_BC3 | IF_BC4 | IF_BC5 ) )
+	{
+		return;
+	}
+
+	std::string key;
+
+	if ( !R_PakFileCacheKey( fileName, key ) )
+	{
+		return;
+	}
+
+	std::string path = R_ImageCachePath( key );
+	size_t size = SaveImageDataKTX( path.c_str(), pic, width, height, numMips, bits );
+
+	if ( !size )
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock( imageCache.mutex );
+	R_LoadImageCacheIndex();
+
+	cachedImage_t &image = imageCache.images[ path ];
+	imageCache.totalSize += size - image.size;
+	image.key = std::move( key );
+	image.size = size;
+	image.lastUse = ++imageCache.useCount;
+	imageCache.modified = true;
+
+	R_TrimImageCache();
+}
+
+/*
+================
+R_SaveImageCacheIndex
+================
+*/
+void R_SaveImageCacheIndex()
+{
+	std::lock_guard<std::mutex> lock( imageCache.mutex );
+
+	if ( !imageCache.modified )
+	{
+		return;
+	}
+
+	std::string index;
+
+	for ( const auto &entry : imageCache.images )
+	{
+		index += Str::Format( "%s %d %d %s\n", entry.first, entry.second.size, entry.second.lastUse, entry.second.key );
+	}
+
+	std::error_code err;
+	FS::HomePath::WriteFileAtomic( CACHE_INDEX, index, err );
+
+	if ( err )
+	{
+		Log::Warn( "Could not write the texture cache index: %s", err.message() );
+		return;
+	}
+
+	imageCache.modified = false;
+}
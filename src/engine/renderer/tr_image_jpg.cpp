@@ -31,8 +31,12 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  * You may also wish to include "jerror.h".
  */
 
+#include <csetjmp>
 #include <jpeglib.h>
+#include <jerror.h>
 
+// Warning is broken. https://stackoverflow.com/questions/45384718/msvc-warning-4611-regarding-setjmp-w-pod-struct
+#pragma warning(disable : 4611)
 
 /*
 =========================================================
@@ -42,16 +46,23 @@ JPEG LOADING
 =========================================================
 */
 
-static void NORETURN R_JPGErrorExit( j_common_ptr cinfo )
+/* Images are also encoded and decoded on the job threads, so libjpeg errors
+ * jump back to the caller like the PNG loader does instead of quitting.
+ */
+struct jpegErrorManager_t
 {
-	char buffer[ JMSG_LENGTH_MAX ];
+	struct jpeg_error_mgr pub;
+	jmp_buf setjmpBuffer;
+	char message[ JMSG_LENGTH_MAX ];
+};
 
-	( *cinfo->err->format_message )( cinfo, buffer );
+static void NORETURN R_JPGErrorExit( j_common_ptr cinfo )
+{
+	jpegErrorManager_t *err = reinterpret_cast<jpegErrorManager_t *>( cinfo->err );
 
-	/* Let the memory manager delete any temp files before we die */
-	jpeg_destroy( cinfo );
+	( *cinfo->err->format_message )( cinfo, err->message );
 
-	Sys::Error( "%s", buffer );
+	longjmp( err->setjmpBuffer, 1 );
 }
 
 static void R_JPGOutputMessage( j_common_ptr cinfo )
@@ -85,14 +96,14 @@ void LoadJPG( const char *filename, unsigned char **pic, int *width, int *height
 	 * Note that this struct must live as long as the main JPEG parameter
 	 * struct, to avoid dangling-pointer problems.
 	 */
-	struct jpeg_error_mgr jerr;
+	jpegErrorManager_t jerr;
 
 	/* More stuff */
 	JSAMPARRAY            buffer; /* Output row buffer */
 	unsigned int          row_stride; /* physical row width in output buffer */
 	unsigned int          pixelcount, memcount;
 	unsigned int          sindex, dindex;
-	byte                  *out;
+	byte                  *volatile out = nullptr; /* freed after an error */
 	byte *buf;
 
 	std::error_code err;
@@ -109,10 +120,25 @@ void LoadJPG( const char *filename, unsigned char **pic, int *width, int *height
 	 * This routine fills in the contents of struct jerr, and returns jerr's
 	 * address which we place into the link field in cinfo.
 	 */
-	cinfo.err = jpeg_std_error( &jerr );
+	cinfo.err = jpeg_std_error( &jerr.pub );
 	cinfo.err->error_exit = R_JPGErrorExit;
 	cinfo.err->output_message = R_JPGOutputMessage;
 
+	if ( setjmp( jerr.setjmpBuffer ) )
+	{
+		/* Let the memory manager delete any temp files */
+		jpeg_destroy_decompress( &cinfo );
+
+		if ( out )
+		{
+			Z_Free( out );
+			*pic = nullptr;
+		}
+
+		Log::Warn( "JPG image '%s' could not be decoded: %s", filename, jerr.message );
+		return;
+	}
+
 	/* Now we can initialize the JPEG decompression object. */
 	jpeg_create_decompress( &cinfo );
 
@@ -287,12 +313,9 @@ static void init_destination( j_compress_ptr cinfo )
 
 static          boolean empty_output_buffer( j_compress_ptr cinfo )
 {
-	my_dest_ptr dest = ( my_dest_ptr ) cinfo->dest;
-
-	jpeg_destroy_compress( cinfo );
-
-	// Make crash fatal or we would probably leak memory.
-	Sys::Error( "Output buffer for encoded JPEG image has insufficient size of %d bytes", dest->size );
+	// Goes to R_JPGErrorExit, the caller gets a size of 0
+	ERREXIT( cinfo, JERR_BUFFER_SIZE );
+	return FALSE;
 }
 
 /*
@@ -344,14 +367,14 @@ static void jpegDest( j_compress_ptr cinfo, byte *outfile, int size )
 SaveJPGToBuffer
 
 Encodes JPEG from image in image_buffer and writes to buffer.
-Expects RGB input data
+Expects RGB input data, returns 0 if the image could not be encoded
 =================
 */
 int SaveJPGToBuffer( byte *buffer, size_t bufSize, int quality, int image_width, int image_height, byte *image_buffer )
 {
 	struct jpeg_compress_struct cinfo;
 
-	struct jpeg_error_mgr       jerr;
+	jpegErrorManager_t          jerr;
 
 	JSAMPROW                    row_pointer[ 1 ]; /* pointer to JSAMPLE row[s] */
 	my_dest_ptr                 dest;
@@ -359,10 +382,18 @@ int SaveJPGToBuffer( byte *buffer, size_t bufSize, int quality, int image_width,
 	size_t                      outcount;
 
 	/* Step 1: allocate and initialize JPEG compression object */
-	cinfo.err = jpeg_std_error( &jerr );
+	cinfo.err = jpeg_std_error( &jerr.pub );
 	cinfo.err->error_exit = R_JPGErrorExit;
 	cinfo.err->output_message = R_JPGOutputMessage;
 
+	if ( setjmp( jerr.setjmpBuffer ) )
+	{
+		jpeg_destroy_compress( &cinfo );
+
+		Log::Warn( "Failed to encode JPEG image: %s", jerr.message );
+		return 0;
+	}
+
 	/* Now we can initialize the JPEG compression object. */
 	jpeg_create_compress( &cinfo );
 
@@ -425,7 +456,11 @@ void SaveJPG( const char *filename, int quality, int image_width, int image_heig
 	out = (byte*) ri.Hunk_AllocateTempMemory( bufSize );
 
 	bufSize = SaveJPGToBuffer( out, bufSize, quality, image_width, image_height, image_buffer );
-	ri.FS_WriteFile( filename, out, bufSize );
+
+	if ( bufSize )
+	{
+		ri.FS_WriteFile( filename, out, bufSize );
+	}
 
 	ri.Hunk_FreeTempMemory( out );
 }
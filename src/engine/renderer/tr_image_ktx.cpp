@@ -257,13 +257,15 @@ bool LoadInMemoryKTX( const char *name, void *ktxData, size_t ktxSize,
 	}
 
 	for(uint32_t i{ 1 }; i < hdr->numberOfMipmapLevels; i++) {
+		// the previous image has the size of the previous level
+		uint32_t previousImageSize{ imageSize };
 		imageSize = GetImageSize( ptr, needReverseBytes );
 		ptr += sizeof(uint32_t);
 
 		for (uint32_t j{ 0 }; j < hdr->numberOfFaces; j++) {
 			const uint32_t idx{ i * hdr->numberOfFaces + j };
 
-			data[ idx ] = data[ idx - 1 ] + imageSize;
+			data[ idx ] = data[ idx - 1 ] + ( j == 0 ? previousImageSize : imageSize );
 			memcpy( data[ idx ], ptr, imageSize );
 
 			ptr += imageSize;
@@ -773,6 +775,73 @@ void LoadKTX( const char *name, byte **pic, int *width, int *height,
 	}
 }
 
+size_t SaveImageDataKTX( const char *path, byte **pic, int width, int height, int numMips, int bits )
+{
+	KTX_header_t hdr{};
+	memcpy( &hdr.identifier, KTX_identifier, sizeof( KTX_identifier ) );
+	hdr.endianness = KTX_endianness;
+
+	uint32_t glInternalFormat = GL_RGBA8;
+	uint32_t blockSize = 0;
+
+	if ( bits & IF_BC1 ) {
+		glInternalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		blockSize = 8;
+	} else if ( bits & IF_BC2 ) {
+		glInternalFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+		blockSize = 16;
+	} else if ( bits & IF_BC3 ) {
+		glInternalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		blockSize = 16;
+	} else if ( bits & IF_BC4 ) {
+		glInternalFormat = GL_COMPRESSED_RED_RGTC1;
+		blockSize = 8;
+	} else if ( bits & IF_BC5 ) {
+		glInternalFormat = GL_COMPRESSED_RG_RGTC2;
+		blockSize = 16;
+	}
+
+	uint32_t components;
+	if( !ApplyKTXHeaderGlProperties( glInternalFormat, hdr, components ) ) {
+		return 0;
+	}
+
+	hdr.pixelWidth = width;
+	hdr.pixelHeight = height;
+	hdr.numberOfFaces = 1;
+	hdr.numberOfMipmapLevels = std::max( numMips, 1 );
+
+	std::string data( reinterpret_cast<const char *>( &hdr ), sizeof( hdr ) );
+
+	uint32_t mipWidth = width;
+	uint32_t mipHeight = height;
+	for( uint32_t i = 0; i < hdr.numberOfMipmapLevels; i++ ) {
+		uint32_t mipSize;
+		if( blockSize ) {
+			mipSize = ( ( mipWidth + 3 ) >> 2 ) * ( ( mipHeight + 3 ) >> 2 ) * blockSize;
+		} else {
+			mipSize = mipWidth * mipHeight * 4;
+		}
+
+		uint32_t paddedSize = PAD( mipSize, 4U );
+		data.append( reinterpret_cast<const char *>( &paddedSize ), sizeof( paddedSize ) );
+		data.append( reinterpret_cast<const char *>( pic[ i ] ), mipSize );
+		data.append( paddedSize - mipSize, '\0' );
+
+		if( mipWidth  > 1 ) mipWidth  >>= 1U;
+		if( mipHeight > 1 ) mipHeight >>= 1U;
+	}
+
+	std::error_code err;
+	FS::HomePath::WriteFileAtomic( path, data, err );
+	if ( err ) {
+		Log::Warn( "Could not write KTX image '%s': %s", path, err.message() );
+		return 0;
+	}
+
+	return data.size();
+}
+
 void SaveImageKTX( const char *path, image_t *img )
 {
 	KTX_header_t hdr{};
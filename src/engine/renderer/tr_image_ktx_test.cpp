@@ -0,0 +1,110 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+
+#include <gtest/gtest.h>
+
+#include "common/Common.h"
+
+#include "engine/renderer/tr_local.h"
+
+namespace {
+
+// Size of a mipmap level of width x height pixels
+int LevelSize( int width, int height, int blockSize )
+{
+    if ( blockSize )
+    {
+        return ( ( width + 3 ) / 4 ) * ( ( height + 3 ) / 4 ) * blockSize;
+    }
+
+    return width * height * 4;
+}
+
+void TestRoundTrip( int bits, int blockSize )
+{
+    const int width = 37, height = 20, numMips = 3;
+
+    std::vector<byte> data;
+    byte *pic[ numMips ];
+    int sizes[ numMips ];
+    int offsets[ numMips ];
+
+    for ( int i = 0; i < numMips; i++ )
+    {
+        offsets[ i ] = data.size();
+        sizes[ i ] = LevelSize( std::max( width >> i, 1 ), std::max( height >> i, 1 ), blockSize );
+        // levels which are not a multiple of 4 bytes are padded in the file
+        data.resize( data.size() + ( ( sizes[ i ] + 3 ) & ~3 ) );
+    }
+
+    for ( size_t i = 0; i < data.size(); i++ )
+    {
+        data[ i ] = byte( i * 7 + bits );
+    }
+
+    for ( int i = 0; i < numMips; i++ )
+    {
+        pic[ i ] = data.data() + offsets[ i ];
+    }
+
+    ASSERT_GT( SaveImageDataKTX( "texcache/test.ktx", pic, width, height, numMips, bits ), 0u );
+
+    byte *loaded[ MAX_TEXTURE_MIPS ];
+    int loadedWidth, loadedHeight, loadedLayers, loadedMips;
+    int loadedBits = IF_HOMEPATH;
+    LoadKTX( "texcache/test.ktx", loaded, &loadedWidth, &loadedHeight, &loadedLayers, &loadedMips, &loadedBits, 0xFF );
+
+    ASSERT_NE( loaded[ 0 ], nullptr );
+    EXPECT_EQ( width, loadedWidth );
+    EXPECT_EQ( height, loadedHeight );
+    EXPECT_EQ( 0, loadedLayers );
+    EXPECT_EQ( numMips, loadedMips );
+    EXPECT_EQ( bits | IF_HOMEPATH, loadedBits );
+
+    for ( int i = 0; i < numMips; i++ )
+    {
+        EXPECT_EQ( 0, memcmp( pic[ i ], loaded[ i ], sizes[ i ] ) ) << "level " << i;
+    }
+
+    Z_Free( loaded[ 0 ] );
+}
+
+TEST(KTXImageTest, UncompressedRoundTrip)
+{
+    TestRoundTrip( 0, 0 );
+}
+
+TEST(KTXImageTest, CompressedRoundTrip)
+{
+    TestRoundTrip( IF_BC1, 8 );
+    TestRoundTrip( IF_BC3, 16 );
+}
+
+} // namespace
@@ -23,7 +23,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 // tr_init.c -- functions that are not called every frame
 #include "tr_local.h"
 #include "framework/CvarSystem.h"
-#include "framework/OmpSystem.h"
+#include "framework/JobSystem.h"
 #include "DetectGLVendors.h"
 #include "Material.h"
 #include "GeometryCache.h"
@@ -791,7 +791,6 @@ ScreenshotCmd screenshotPNGRegistration("screenshotPNG", ssFormat_t::SSF_PNG, "p
 		int                       lineLen, captureLineLen;
 		byte                      *pixels;
 		int                       i;
-		int                       outputSize;
 		int                       j;
 		int                       aviLineLen;
 
@@ -811,14 +810,14 @@ ScreenshotCmd screenshotPNGRegistration("screenshotPNG", ssFormat_t::SSF_PNG, "p
 
 			if ( motionJpeg )
 			{
-				// Drop alignment and line padding bytes
+				// Drop alignment and line padding bytes, the client
+				// compresses the frame off the render thread
 				for ( i = 0; i < height; ++i )
 				{
 					memmove( captureBuffer + i * lineLen, pixels + i * captureLineLen, lineLen );
 				}
 
-				outputSize = SaveJPGToBuffer( encodeBuffer, 3 * width * height, 90, width, height, captureBuffer );
-				ri.CL_WriteAVIVideoFrame( encodeBuffer, outputSize );
+				ri.CL_WriteAVIVideoFrame( captureBuffer, lineLen * height );
 			}
 			else
 			{
@@ -1076,20 +1075,16 @@ ScreenshotCmd screenshotPNGRegistration("screenshotPNG", ssFormat_t::SSF_PNG, "p
 			Log::Notice("Using dual processor acceleration." );
 		}
 
-#if defined(_OPENMP)
-		int ompThreads = Omp::GetThreads();
+		int jobThreads = Jobs::GetThreads();
 
-		if ( ompThreads == 1 )
+		if ( jobThreads == 1 )
 		{
-			Log::Notice("%sNot using OpenMP parallelism: only one thread.", Color::ToString( Color::Yellow ) );
+			Log::Notice("%sNot using parallel jobs: only one thread.", Color::ToString( Color::Yellow ) );
 		}
 		else
 		{
-			Log::Notice("%sUsing OpenMP parallelism with %d threads.", Color::ToString( Color::Green ), ompThreads );
+			Log::Notice("%sUsing parallel jobs with %d threads.", Color::ToString( Color::Green ), jobThreads );
 		}
-#else
-		Log::Notice("%sNot using OpenMP parallelism: unavailable.", Color::ToString( Color::Yellow ) );
-#endif
 
 		if ( r_finish->integer )
 		{
@@ -1529,6 +1524,7 @@ ScreenshotCmd screenshotPNGRegistration("screenshotPNG", ssFormat_t::SSF_PNG, "p
 		{
 			R_SyncRenderThread();
 
+			R_StopBenchmarkRecording();
 			CIN_CloseAllVideos();
 			R_ShutdownBackend();
 			R_ShutdownImages();
@@ -1568,6 +1564,11 @@ ScreenshotCmd screenshotPNGRegistration("screenshotPNG", ssFormat_t::SSF_PNG, "p
 	void RE_EndRegistration()
 	{
 		R_SyncRenderThread();
+
+		// images prefetched by shaders that turned out not to need them
+		R_FlushImagePrefetches();
+		R_SaveImageCacheIndex();
+
 		if ( r_lazyShaders.Get() == 1 ) {
 			if ( tr.world->numFogs > 0 )
 			{
@@ -1711,6 +1712,7 @@ ScreenshotCmd screenshotPNGRegistration("screenshotPNG", ssFormat_t::SSF_PNG, "p
 
 		// XreaL BEGIN
 		re.TakeVideoFrame = RE_TakeVideoFrame;
+		re.SaveJPGToBuffer = SaveJPGToBuffer;
 
 		re.RegisterAnimation = RE_RegisterAnimation;
 		re.CheckSkeleton = RE_CheckSkeleton;
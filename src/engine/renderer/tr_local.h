@@ -2115,6 +2115,18 @@ enum
 		int c_leafs;
 	};
 
+	// CPU time spent in the phases of the front end, only measured by the
+	// frontEndBenchmark command
+	struct frontEndTimes_t
+	{
+		bool enabled;
+
+		Sys::SteadyClock::duration markLeaves;
+		Sys::SteadyClock::duration worldSurfaces;
+		Sys::SteadyClock::duration entitySurfaces;
+		Sys::SteadyClock::duration sortDrawSurfs;
+	};
+
 #define FUNCTABLE_SIZE  1024
 #define FUNCTABLE_SIZE2 10
 #define FUNCTABLE_MASK  ( FUNCTABLE_SIZE - 1 )
@@ -2541,6 +2553,7 @@ enum
 
 		frontEndCounters_t pc;
 		int                frontEndMsec; // not in pc due to clearing issue
+		frontEndTimes_t    frontEndTimes;
 
 		bool skipSubgroupProfiler = false;
 		bool skipVBO = false;
@@ -3002,6 +3015,13 @@ void GL_CompressedTexSubImage3D( GLenum target, GLint level, GLint xOffset, GLin
 	void    R_ShutdownImages();
 
 	bool R_HasImageLoader( const char *baseName );
+	void R_PrefetchImageFile( const char *name );
+	void R_FlushImagePrefetches();
+
+	bool R_PakFileCacheKey( const char *fileName, std::string &key );
+	bool R_LoadCachedImage( const char *fileName, byte **pic, int *width, int *height, int *numMips, int *bits );
+	void R_CacheImage( const char *fileName, byte **pic, int width, int height, int numLayers, int numMips, int bits );
+	void R_SaveImageCacheIndex();
 	image_t *R_FindImageFile( const char *name, imageParams_t &imageParams );
 	image_t *R_FindCubeImage( const char *name, imageParams_t &imageParams );
 
@@ -3032,6 +3052,7 @@ void GL_CompressedTexSubImage3D( GLenum target, GLint level, GLint xOffset, GLin
 	qhandle_t RE_RegisterShader( const char *name, int flags );
 	qhandle_t RE_RegisterShaderFromImage( const char *name, image_t *image );
 
+	void      R_PrefetchShaderImages( const char *name );
 	shader_t  *R_FindShader( const char *name, int flags );
 	shader_t  *R_GetShaderByHandle( qhandle_t hShader );
 	const char *RE_GetShaderNameFromHandle( qhandle_t shader );
@@ -3228,6 +3249,22 @@ void GLimp_LogComment_( std::string comment );
 	void Tess_InstantScreenSpaceQuad();
 	void Tess_InstantQuad( u_ModelViewProjectionMatrix &shader, float x, float y, float width, float height );
 
+	/*
+	============================================================
+
+	CPU SKINNING, tr_skinning.cpp
+
+	============================================================
+	*/
+
+	// Transform the vertices by their bones, writing the position, the
+	// texture coordinates and, if computeTangents is set, the qtangents.
+	// useSIMD is only meant to compare the SIMD and scalar code.
+	void R_SkinMD5Vertexes( const md5Vertex_t *verts, int numVertexes, const transform_t *bones,
+		bool computeTangents, shaderVertex_t *out, bool useSIMD = true );
+	void R_SkinIQMVertexes( const IQModel_t *model, int firstVertex, int numVertexes, const transform_t *bones,
+		bool computeTangents, shaderVertex_t *out, bool useSIMD = true );
+
 	void Tess_MapVBOs( bool forceCPU );
 	void Tess_UpdateVBOs();
 
@@ -3287,9 +3324,16 @@ void GLimp_LogComment_( std::string comment );
 	============================================================
 	*/
 
-	srfGridMesh_t *R_SubdividePatchToGrid( int width, int height, srfVert_t points[ MAX_PATCH_SIZE *MAX_PATCH_SIZE ] );
-	srfGridMesh_t *R_GridInsertColumn( srfGridMesh_t *grid, int column, int row, vec3_t point, float loderror );
-	srfGridMesh_t *R_GridInsertRow( srfGridMesh_t *grid, int row, int column, vec3_t point, float loderror );
+	// too large for the stack, every thread building grids needs its own
+	struct gridScratch_t
+	{
+		srfTriangle_t triangles[ SHADER_MAX_TRIANGLES ];
+		srfVert_t     ctrl[ MAX_GRID_SIZE ][ MAX_GRID_SIZE ];
+	};
+
+	srfGridMesh_t *R_SubdividePatchToGrid( int width, int height, srfVert_t points[ MAX_PATCH_SIZE *MAX_PATCH_SIZE ], gridScratch_t &scratch );
+	srfGridMesh_t *R_GridInsertColumn( srfGridMesh_t *grid, int column, int row, vec3_t point, float loderror, gridScratch_t &scratch );
+	srfGridMesh_t *R_GridInsertRow( srfGridMesh_t *grid, int row, int column, vec3_t point, float loderror, gridScratch_t &scratch );
 	void          R_FreeSurfaceGridMesh( srfGridMesh_t *grid );
 
 	/*
@@ -3356,6 +3400,21 @@ void GLimp_LogComment_( std::string comment );
 	void R_UpdateVisTests();
 	void R_InitVisTests();
 	void R_ShutdownVisTests();
+
+	/*
+	============================================================
+
+	FRONT END BENCHMARK, tr_benchmark.cpp
+
+	============================================================
+	*/
+
+	Sys::SteadyClock::time_point R_StartFrontEndTimer();
+	void R_StopFrontEndTimer( Sys::SteadyClock::duration &time, Sys::SteadyClock::time_point start );
+
+	bool R_ReplayingBenchmark();
+	void R_RecordBenchmarkScene( const refdef_t *fd );
+	void R_StopBenchmarkRecording();
 	/*
 	=============================================================
 
@@ -3668,6 +3727,7 @@ void GLimp_LogComment_( std::string comment );
 	void                                LoadCRN( const char *name, byte **pic, int *width, int *height, int *numLayers, int *numMips, int *bits, byte alphaByte);
 	void                                LoadKTX( const char *name, byte **pic, int *width, int *height, int *numLayers, int *numMips, int *bits, byte alphaByte);
 	void                                SaveImageKTX( const char *name, image_t *img );
+	size_t                              SaveImageDataKTX( const char *path, byte **pic, int width, int height, int numMips, int bits );
 
 
 // video stuff
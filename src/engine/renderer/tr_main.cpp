@@ -24,6 +24,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "tr_local.h"
 #include "Material.h"
 #include "EntityCache.h"
+#include "framework/RadixSort.h"
 
 trGlobals_t tr;
 
@@ -1660,9 +1661,13 @@ R_SortDrawSurfs
 */
 static void R_SortDrawSurfs()
 {
+	static std::vector<RadixSort::Item> sortItems;
+	static std::vector<RadixSort::Item> sortScratch;
+	static std::vector<drawSurf_t> sortedDrawSurfs;
+
 	drawSurf_t   *drawSurf;
 	shader_t     *shader;
-	int          sort;
+	int          sortCounts[ Util::ordinal( shaderSort_t::SS_NUM_SORTS ) ] = {};
 
 	// it is possible for some views to not have any surfaces
 	if ( !glConfig.usingMaterialSystem && tr.viewParms.numDrawSurfs < 1 )
@@ -1680,13 +1685,10 @@ static void R_SortDrawSurfs()
 		tr.viewParms.numDrawSurfs = MAX_DRAWSURFS;
 	}
 
-	std::sort( tr.viewParms.drawSurfs, tr.viewParms.drawSurfs + tr.viewParms.numDrawSurfs,
-	           []( const drawSurf_t &a, const drawSurf_t &b ) {
-	               return a.sort < b.sort;
-	           } );
-
-	// compute the offsets of the first surface of each SS_* type
-	sort = Util::ordinal( shaderSort_t::SS_BAD ) - 1;
+	// gather the sort keys and count the surfaces of each SS_* type, the
+	// shaders are sorted by their sort value so these counts give the
+	// offsets of the first surface of each type once sorted
+	sortItems.resize( tr.viewParms.numDrawSurfs );
 	for ( int i = 0; i < tr.viewParms.numDrawSurfs; i++ )
 	{
 		drawSurf = &tr.viewParms.drawSurfs[ i ];
@@ -1698,13 +1700,30 @@ static void R_SortDrawSurfs()
 			Sys::Drop( "Shader '%s'with sort == SS_BAD", shader->name );
 		}
 
-		while ( sort < Util::ordinal( shaderSort_t::SS_NUM_SORTS ) - 1 && shader->sort > sort ) {
-			tr.viewParms.firstDrawSurf[ ++sort ] = i;
-		}
+		// fractional sorts such as 15.5 go with the next SS_* type
+		int sort = Math::Clamp( int( ceilf( shader->sort ) ), 0, Util::ordinal( shaderSort_t::SS_NUM_SORTS ) - 1 );
+		sortCounts[ sort ]++;
+
+		sortItems[ i ] = { drawSurf->sort, uint32_t( i ) };
 	}
-	while ( sort < Util::ordinal( shaderSort_t::SS_NUM_SORTS ) ) {
-		tr.viewParms.firstDrawSurf[ ++sort ] = tr.viewParms.numDrawSurfs;
+
+	// the keys are unique since they contain the surface index
+	RadixSort::Sort( sortItems, sortScratch, 64 - SORT_UNUSED_BITS );
+
+	sortedDrawSurfs.resize( tr.viewParms.numDrawSurfs );
+	for ( int i = 0; i < tr.viewParms.numDrawSurfs; i++ )
+	{
+		sortedDrawSurfs[ i ] = tr.viewParms.drawSurfs[ sortItems[ i ].value ];
+	}
+	std::copy( sortedDrawSurfs.begin(), sortedDrawSurfs.end(), tr.viewParms.drawSurfs );
+
+	int firstDrawSurf = 0;
+	for ( int sort = 0; sort < Util::ordinal( shaderSort_t::SS_NUM_SORTS ); sort++ )
+	{
+		tr.viewParms.firstDrawSurf[ sort ] = firstDrawSurf;
+		firstDrawSurf += sortCounts[ sort ];
 	}
+	tr.viewParms.firstDrawSurf[ Util::ordinal( shaderSort_t::SS_NUM_SORTS ) ] = tr.viewParms.numDrawSurfs;
 
 	// tell renderer backend to render the depth for this view
 	R_AddDrawViewCmd( true );
@@ -1975,7 +1994,9 @@ void R_RenderView( viewParms_t *parms )
 		materialSystem.QueueSurfaceCull( tr.viewCount, tr.viewParms.pvsOrigin, (frustum_t*) tr.viewParms.frustum );
 		materialSystem.AddAutospriteSurfaces();
 	} else {
+		Sys::SteadyClock::time_point start = R_StartFrontEndTimer();
 		R_AddWorldSurfaces();
+		R_StopFrontEndTimer( tr.frontEndTimes.worldSurfaces, start );
 	}
 
 	R_AddPolygonSurfaces();
@@ -1993,7 +2014,9 @@ void R_RenderView( viewParms_t *parms )
 
 	R_AddFogBrushSurfaces();
 
+	Sys::SteadyClock::time_point start = R_StartFrontEndTimer();
 	R_AddEntitySurfaces();
+	R_StopFrontEndTimer( tr.frontEndTimes.entitySurfaces, start );
 
 	// Transform the blur vector in view space, FIXME for some we need reason invert its Z component
 	MatrixTransformNormal2( tr.viewParms.world.viewMatrix, tr.refdef.blurVec );
@@ -2002,7 +2025,9 @@ void R_RenderView( viewParms_t *parms )
 	tr.viewParms.drawSurfs = tr.refdef.drawSurfs + firstDrawSurf;
 	tr.viewParms.numDrawSurfs = tr.refdef.numDrawSurfs - firstDrawSurf;
 
+	start = R_StartFrontEndTimer();
 	R_SortDrawSurfs();
+	R_StopFrontEndTimer( tr.frontEndTimes.sortDrawSurfs, start );
 
 	// draw main system development information (surface outlines, etc)
 	R_DebugGraphics();
@@ -667,7 +667,11 @@ void RE_RenderScene( const refdef_t *fd )
 		tr.refdef.floatTime = float( double( tr.refdef.time ) * 0.001 );
 	}
 
-	AddRefEntities();
+	// the entities of a replayed benchmark scene are already in the scene
+	if ( !R_ReplayingBenchmark() )
+	{
+		AddRefEntities();
+	}
 
 	tr.refdef.numDrawSurfs = r_firstSceneDrawSurf;
 	tr.refdef.drawSurfs = backEndData[ tr.smpFrame ]->drawSurfs;
@@ -684,6 +688,8 @@ void RE_RenderScene( const refdef_t *fd )
 	tr.refdef.numVisTests = r_numVisTests - r_firstSceneVisTest;
 	tr.refdef.visTests = &backEndData[ tr.smpFrame ]->visTests[ r_firstSceneVisTest ];
 
+	R_RecordBenchmarkScene( fd );
+
 	// a single frame may have multiple scenes draw inside it --
 	// a 3D game view, 3D status bar renderings, 3D menus, etc.
 	// They need to be distinguished by the light flare code, because
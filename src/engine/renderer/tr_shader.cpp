@@ -26,7 +26,9 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "framework/CvarSystem.h"
 #include "Material.h"
 #include "GeometryOptimiser.h"
+#include "framework/JobSystem.h"
 #include <iomanip>
+#include <zlib.h>
 
 static const int MAX_SHADERTABLE_HASH = 1024;
 static shaderTable_t *shaderTableHashTable[ MAX_SHADERTABLE_HASH ];
@@ -35,7 +37,15 @@ static const int FILE_HASH_SIZE       = 1024;
 static shader_t      *shaderHashTable[ FILE_HASH_SIZE ];
 
 static const int MAX_SHADERTEXT_HASH  = 2048;
-static const char          **shaderTextHashTable[ MAX_SHADERTEXT_HASH ];
+
+struct shaderTextEntry_t
+{
+	const char *name;
+	// the text of the shader, right after its name
+	const char *text;
+};
+
+static shaderTextEntry_t *shaderTextHashTable[ MAX_SHADERTEXT_HASH ];
 
 static char          *s_shaderText;
 
@@ -3380,6 +3390,28 @@ static bool ParseStage( shaderStage_t *stage, const char **text )
 		return true;
 	}
 
+	// decode all the images of the stage at once on the job threads
+	for ( const auto& delayedAnimationTexture : delayedAnimationTextures )
+	{
+		if ( loadAnimMap && delayedAnimationTexture.active )
+		{
+			R_PrefetchImageFile( delayedAnimationTexture.path );
+		}
+	}
+
+	for ( const auto& delayedStageTexture : delayedStageTextures )
+	{
+		if ( !loadAnimMap && delayedStageTexture.active )
+		{
+			R_PrefetchImageFile( delayedStageTexture.path );
+		}
+	}
+
+	if ( loadMap && !loadAnimMap )
+	{
+		R_PrefetchImageFile( buffer );
+	}
+
 	if ( loadAnimMap )
 	{
 		for ( size_t animationIndex = 0; animationIndex < MAX_IMAGE_ANIMATIONS; animationIndex++ )
@@ -6171,20 +6203,15 @@ If found, it will return a valid shader
 */
 static const char    *FindShaderInShaderText( const char *shaderName )
 {
-	const char *token, *p;
-
 	int  i, hash;
 
 	hash = generateHashValue( shaderName, MAX_SHADERTEXT_HASH );
 
-	for ( i = 0; shaderTextHashTable[ hash ][ i ]; i++ )
+	for ( i = 0; shaderTextHashTable[ hash ][ i ].name; i++ )
 	{
-		p = shaderTextHashTable[ hash ][ i ];
-		token = COM_ParseExt2( &p, true );
-
-		if ( !Q_stricmp( token, shaderName ) )
+		if ( !Q_stricmp( shaderTextHashTable[ hash ][ i ].name, shaderName ) )
 		{
-			return p;
+			return shaderTextHashTable[ hash ][ i ].text;
 		}
 	}
 
@@ -6192,6 +6219,77 @@ static const char    *FindShaderInShaderText( const char *shaderName )
 	return nullptr;
 }
 
+/*
+===============
+R_PrefetchShaderImages
+
+Starts loading the images a shader is likely to use before it is parsed,
+see R_PrefetchImageFile. This only looks for the common image keywords, the
+images it misses are loaded when the shader is parsed.
+===============
+*/
+void R_PrefetchShaderImages( const char *name )
+{
+	static const char *const imageKeywords[] = {
+		"map", "clampMap", "diffuseMap", "normalMap", "normalHeightMap", "heightMap",
+		"specularMap", "physicalMap", "glowMap", "lightMap",
+	};
+
+	char strippedName[ MAX_QPATH ];
+
+	COM_StripExtension3( FS::Path::NormalizeSlashes( name ).c_str(),
+	                     strippedName, sizeof( strippedName ) );
+
+	const char *text = FindShaderInShaderText( strippedName );
+
+	if ( !text )
+	{
+		// implicit shader made of the image of the same name
+		R_PrefetchImageFile( strippedName );
+		return;
+	}
+
+	int depth = 0;
+
+	do
+	{
+		const char *token = COM_ParseExt2( &text, true );
+
+		if ( !token[ 0 ] )
+		{
+			break;
+		}
+
+		if ( !strcmp( token, "{" ) )
+		{
+			depth++;
+		}
+		else if ( !strcmp( token, "}" ) )
+		{
+			depth--;
+		}
+		else if ( !Q_stricmp( token, "implicitMap" ) || !Q_stricmp( token, "implicitMask" )
+			|| !Q_stricmp( token, "implicitBlend" ) )
+		{
+			token = COM_ParseExt2( &text, false );
+			R_PrefetchImageFile( !token[ 0 ] || !strcmp( token, "-" ) ? strippedName : token );
+		}
+		else
+		{
+			for ( const char *keyword : imageKeywords )
+			{
+				if ( !Q_stricmp( token, keyword ) )
+				{
+					token = COM_ParseExt2( &text, false );
+					R_PrefetchImageFile( token );
+					break;
+				}
+			}
+		}
+	}
+	while ( depth > 0 );
+}
+
 static void ClearGlobalShader()
 {
 	ResetStruct( shader );
@@ -6745,243 +6843,480 @@ static ShaderExpCmd shaderExpCmdRegistration;
 
 /*
 ====================
-ScanAndLoadShaderFiles
+ParseShaderTable
 
-Finds and loads all .shader files, combining them into
-a single large text block that can be scanned for shader names
+Parses a shader table, after the "table" keyword
 =====================
 */
-static void ScanAndLoadShaderFiles()
+static void ParseShaderTable( const char **text )
 {
-	std::vector<std::string> buffers;
-	const char *p;
-	const char *oldp, *token;
-	char *textEnd;
-	const char **hashMem;
-	int  shaderTextHashTableSizes[ MAX_SHADERTEXT_HASH ], hash, size;
-	char filename[ MAX_QPATH ];
-	size_t sum = 0;
+	const char    *token;
+	int           depth;
+	float         values[ FUNCTABLE_SIZE ];
+	int           numValues;
+	shaderTable_t *tb;
+	bool      alreadyCreated;
+	int           hash;
 
-	Log::Debug("----- ScanAndLoadShaderFiles -----" );
+	// zeroes shader table, booleans can be assumed as false
+	table = {};
 
-	// load and parse shader files
-	for ( const std::string& basename : FS::PakPath::ListFiles("scripts") )
+	token = COM_ParseExt2( text, true );
+
+	Q_strncpyz( table.name, token, sizeof( table.name ) );
+
+	// check if already created
+	alreadyCreated = false;
+	hash = generateHashValue( table.name, MAX_SHADERTABLE_HASH );
+
+	for ( tb = shaderTableHashTable[ hash ]; tb; tb = tb->next )
 	{
-		if ( !Str::IsISuffix( ".shader", basename ) )
+		if ( Q_stricmp( tb->name, table.name ) == 0 )
 		{
-			continue;
+			// match found
+			alreadyCreated = true;
+			break;
 		}
+	}
 
-		Com_sprintf( filename, sizeof( filename ), "scripts/%s", basename.c_str() );
+	depth = 0;
+	numValues = 0;
 
-		Log::Debug("loading '%s' shader file", filename );
-		std::error_code err;
-		std::string buffer = FS::PakPath::ReadFile( filename, err );
+	do
+	{
+		token = COM_ParseExt2( text, true );
 
-		if ( err )
+		if ( !Q_stricmp( token, "snap" ) )
+		{
+			table.snap = true;
+		}
+		else if ( !Q_stricmp( token, "clamp" ) )
+		{
+			table.clamp = true;
+		}
+		else if ( token[ 0 ] == '{' )
+		{
+			depth++;
+		}
+		else if ( token[ 0 ] == '}' )
+		{
+			depth--;
+		}
+		else if ( token[ 0 ] == ',' )
 		{
-			Log::Warn( "Couldn't load shader file %s", filename );
 			continue;
 		}
-
-		p = buffer.c_str();
-		bool syntaxError = false;
-
-		while ( true )
+		else
 		{
-			token = COM_ParseExt2( &p, true );
-
-			if ( !*token )
+			if ( numValues == FUNCTABLE_SIZE )
 			{
+				Log::Warn("FUNCTABLE_SIZE hit" );
 				break;
 			}
 
-			// Step over the "table" and the name
-			if ( !Q_stricmp( token, "table" ) )
-			{
-				token = COM_ParseExt2( &p, true );
+			values[ numValues++ ] = atof( token );
+		}
+	}
+	while ( depth && *text );
 
-				if ( !*token )
-				{
-					break;
-				}
-			}
+	if ( !alreadyCreated )
+	{
+		Log::Debug("...generating '%s'", table.name );
+		GeneratePermanentShaderTable( values, numValues );
+	}
+}
 
+/*
+====================
+Shader file index
+
+The text of each shader file, without comments, and the positions of the
+shaders and tables it defines are cached in the home path, keyed by the pak
+the file comes from. Unchanged files are then neither read nor tokenized at
+startup, and the shader names don't have to be tokenized again on lookup.
+=====================
+*/
+
+static Cvar::Cvar<bool> r_shaderIndexCache(
+	"r_shaderIndexCache", "cache the index of the shader files in the home path", Cvar::NONE, true );
+
+static const uint32_t SHADER_INDEX_MAGIC = 0x58444953; // "SIDX"
+static const uint32_t SHADER_INDEX_VERSION = 1;
+static const char SHADER_INDEX_PATH[] = "shaderindex/scripts.idx";
+
+struct shaderFileIndex_t
+{
+	std::string key;
+
+	// text of the file with the comments removed
+	std::string text;
+
+	// names of the shaders and offsets of their text right after the name
+	std::vector<std::pair<std::string, uint32_t>> shaders;
+
+	// offsets of the table definitions, after the "table" keyword
+	std::vector<uint32_t> tables;
+};
+
+/*
+====================
+IndexShaderFile
+
+Finds the shaders and tables of a file, returns false if the file has
+incorrect syntax
+=====================
+*/
+static bool IndexShaderFile( shaderFileIndex_t &file )
+{
+	const char *start = file.text.c_str();
+	const char *p = start;
+
+	while ( true )
+	{
+		const char *token = COM_ParseExt2( &p, true );
+
+		if ( !*token )
+		{
+			break;
+		}
+
+		// Step over the "table" and the name
+		if ( !Q_stricmp( token, "table" ) )
+		{
+			const char *table = p;
 			token = COM_ParseExt2( &p, true );
 
-			if ( token[ 0 ] != '{' || token[ 1 ] != '\0' || !SkipBracedSection_Depth( &p, 1 ) )
+			if ( !*token )
 			{
-				Log::Warn("Bad shader file %s has incorrect syntax.", filename );
-				syntaxError = true;
 				break;
 			}
+
+			file.tables.push_back( table - start );
 		}
+		else
+		{
+			file.shaders.emplace_back( token, p ? p - start : file.text.size() );
+		}
+
+		token = COM_ParseExt2( &p, true );
 
-		if ( !syntaxError )
+		if ( token[ 0 ] != '{' || token[ 1 ] != '\0' || !SkipBracedSection_Depth( &p, 1 ) )
 		{
-			sum += buffer.size();
-			buffers.push_back( std::move( buffer ) );
+			return false;
 		}
 	}
 
-	// build single large buffer
-	s_shaderText = (char*) ri.Hunk_Alloc( sum + buffers.size() * 2, ha_pref::h_low );
-	s_shaderText[ 0 ] = '\0';
-	textEnd = s_shaderText;
+	return true;
+}
 
-	for ( auto i = buffers.rbegin(); i != buffers.rend(); ++i )
+static void ReadShaderIndexCache( std::unordered_map<std::string, shaderFileIndex_t> &files )
+{
+	std::error_code err;
+	FS::File cacheFile = FS::HomePath::OpenRead( SHADER_INDEX_PATH, err );
+
+	if ( err )
 	{
-		strcat( textEnd, i->c_str() );
-		strcat( textEnd, "\n" );
-		textEnd += strlen( textEnd );
+		return;
 	}
 
-	// ydnar: unixify all shaders
-	COM_FixPath( s_shaderText );
+	std::string data = cacheFile.ReadAll( err );
 
-	COM_Compress( s_shaderText );
+	if ( err || data.size() < 4 * sizeof( uint32_t ) )
+	{
+		return;
+	}
 
-	memset( shaderTextHashTableSizes, 0, sizeof( shaderTextHashTableSizes ) );
-	size = 0;
+	size_t pos = 0;
+	bool valid = true;
 
-	p = s_shaderText;
+	auto readInt = [&]() -> uint32_t {
+		uint32_t value = 0;
 
-	// look for shader names
-	while ( true )
-	{
-		token = COM_ParseExt2( &p, true );
+		if ( data.size() - pos < sizeof( value ) )
+		{
+			valid = false;
+			return 0;
+		}
 
-		if ( token[ 0 ] == 0 )
+		memcpy( &value, data.data() + pos, sizeof( value ) );
+		pos += sizeof( value );
+		return value;
+	};
+
+	auto readString = [&]() -> std::string {
+		uint32_t length = readInt();
+
+		if ( data.size() - pos < length )
 		{
-			break;
+			valid = false;
+			return "";
 		}
 
-		// skip shader tables
-		if ( !Q_stricmp( token, "table" ) )
+		pos += length;
+		return data.substr( pos - length, length );
+	};
+
+	uint32_t magic = readInt();
+	uint32_t version = readInt();
+	uint32_t checksum = readInt();
+	uint32_t numFiles = readInt();
+
+	if ( magic != SHADER_INDEX_MAGIC || version != SHADER_INDEX_VERSION
+		|| checksum != crc32( 0, reinterpret_cast<const Bytef *>( data.data() + pos ), data.size() - pos ) )
+	{
+		return;
+	}
+
+	for ( uint32_t i = 0; i < numFiles && valid; i++ )
+	{
+		shaderFileIndex_t file;
+		file.key = readString();
+		file.text = readString();
+
+		uint32_t numShaders = readInt();
+
+		for ( uint32_t j = 0; j < numShaders && valid; j++ )
 		{
-			// skip table name
-			token = COM_ParseExt2( &p, true );
+			std::string name = readString();
+			file.shaders.emplace_back( std::move( name ), readInt() );
+		}
+
+		uint32_t numTables = readInt();
 
-			SkipBracedSection( &p );
+		for ( uint32_t j = 0; j < numTables && valid; j++ )
+		{
+			file.tables.push_back( readInt() );
 		}
-		else
+
+		if ( valid )
 		{
-			hash = generateHashValue( token, MAX_SHADERTEXT_HASH );
-			shaderTextHashTableSizes[ hash ]++;
-			size++;
-			SkipBracedSection( &p );
+			std::string key = file.key;
+			files.emplace( std::move( key ), std::move( file ) );
 		}
 	}
+}
 
-	size += MAX_SHADERTEXT_HASH;
+// Errors are ignored since the cache is only an optimization
+static void WriteShaderIndexCache( const std::vector<shaderFileIndex_t> &files )
+{
+	std::string data;
 
-	hashMem = (const char**) ri.Hunk_Alloc( size * sizeof( char * ), ha_pref::h_low );
+	auto writeInt = [&]( uint32_t value ) {
+		data.append( reinterpret_cast<const char *>( &value ), sizeof( value ) );
+	};
 
-	for ( int i = 0; i < MAX_SHADERTEXT_HASH; i++ )
-	{
-		shaderTextHashTable[ i ] = hashMem;
-		hashMem += shaderTextHashTableSizes[ i ] + 1;
-	}
+	auto writeString = [&]( const std::string &value ) {
+		writeInt( value.size() );
+		data.append( value );
+	};
 
-	memset( shaderTextHashTableSizes, 0, sizeof( shaderTextHashTableSizes ) );
+	writeInt( SHADER_INDEX_MAGIC );
+	writeInt( SHADER_INDEX_VERSION );
+	writeInt( 0 );
+	writeInt( 0 );
 
-	p = s_shaderText;
+	uint32_t numFiles = 0;
 
-	// look for shader names
-	while ( true )
+	for ( const shaderFileIndex_t &file : files )
 	{
-		oldp = p;
-		token = COM_ParseExt( &p, true );
+		if ( file.key.empty() )
+		{
+			continue;
+		}
 
-		if ( token[ 0 ] == 0 )
+		writeString( file.key );
+		writeString( file.text );
+		writeInt( file.shaders.size() );
+
+		for ( const auto &shader : file.shaders )
 		{
-			break;
+			writeString( shader.first );
+			writeInt( shader.second );
 		}
 
-		// parse shader tables
-		if ( !Q_stricmp( token, "table" ) )
+		writeInt( file.tables.size() );
+
+		for ( uint32_t offset : file.tables )
 		{
-			int           depth;
-			float         values[ FUNCTABLE_SIZE ];
-			int           numValues;
-			shaderTable_t *tb;
-			bool      alreadyCreated;
+			writeInt( offset );
+		}
 
-			// zeroes shader table, booleans can be assumed as false
-			table = {};
+		numFiles++;
+	}
 
-			token = COM_ParseExt2( &p, true );
+	const size_t headerSize = 4 * sizeof( uint32_t );
+	uint32_t checksum = crc32( 0, reinterpret_cast<const Bytef *>( data.data() + headerSize ), data.size() - headerSize );
+	memcpy( &data[ 2 * sizeof( uint32_t ) ], &checksum, sizeof( checksum ) );
+	memcpy( &data[ 3 * sizeof( uint32_t ) ], &numFiles, sizeof( numFiles ) );
+
+	std::error_code err;
+	FS::HomePath::WriteFileAtomic( SHADER_INDEX_PATH, data, err );
+}
+
+/*
+====================
+ScanAndLoadShaderFiles
+
+Finds and loads all .shader files, combining them into
+a single large text block that can be scanned for shader names
+=====================
+*/
+static void ScanAndLoadShaderFiles()
+{
+	Log::Debug("----- ScanAndLoadShaderFiles -----" );
+
+	std::vector<std::string> filenames;
+	for ( const std::string& basename : FS::PakPath::ListFiles("scripts") )
+	{
+		if ( Str::IsISuffix( ".shader", basename ) )
+		{
+			filenames.push_back( "scripts/" + basename );
+		}
+	}
+
+	std::vector<shaderFileIndex_t> files( filenames.size() );
+	std::unordered_map<std::string, shaderFileIndex_t> cachedFiles;
+	bool useCache = r_shaderIndexCache.Get();
+
+	if ( useCache )
+	{
+		ReadShaderIndexCache( cachedFiles );
+	}
 
-			Q_strncpyz( table.name, token, sizeof( table.name ) );
+	// take the unchanged files from the cache, start reading the others in
+	// the background
+	std::vector<std::string> scanFilenames;
+	std::vector<size_t> scanIndexes;
+	bool cacheModified = false;
 
-			// check if already created
-			alreadyCreated = false;
-			hash = generateHashValue( table.name, MAX_SHADERTABLE_HASH );
+	for ( size_t i = 0; i < filenames.size(); i++ )
+	{
+		if ( useCache && R_PakFileCacheKey( filenames[ i ].c_str(), files[ i ].key ) )
+		{
+			auto it = cachedFiles.find( files[ i ].key );
 
-			for ( tb = shaderTableHashTable[ hash ]; tb; tb = tb->next )
+			if ( it != cachedFiles.end() )
 			{
-				if ( Q_stricmp( tb->name, table.name ) == 0 )
-				{
-					// match found
-					alreadyCreated = true;
-					break;
-				}
+				files[ i ] = std::move( it->second );
+				cachedFiles.erase( it );
+				continue;
 			}
+		}
 
-			depth = 0;
-			numValues = 0;
+		scanFilenames.push_back( filenames[ i ] );
+		scanIndexes.push_back( i );
+	}
 
-			do
-			{
-				token = COM_ParseExt2( &p, true );
+	// files that are not used anymore are removed from the cache
+	cacheModified = !scanIndexes.empty() || !cachedFiles.empty();
 
-				if ( !Q_stricmp( token, "snap" ) )
-				{
-					table.snap = true;
-				}
-				else if ( !Q_stricmp( token, "clamp" ) )
-				{
-					table.clamp = true;
-				}
-				else if ( token[ 0 ] == '{' )
-				{
-					depth++;
-				}
-				else if ( token[ 0 ] == '}' )
-				{
-					depth--;
-				}
-				else if ( token[ 0 ] == ',' )
-				{
-					continue;
-				}
-				else
-				{
-					if ( numValues == FUNCTABLE_SIZE )
-					{
-						Log::Warn("FUNCTABLE_SIZE hit" );
-						break;
-					}
+	std::vector<std::future<std::string>> pendingReads = FS::PakPath::PrefetchFiles( scanFilenames );
 
-					values[ numValues++ ] = atof( token );
-				}
-			}
-			while ( depth && p );
+	// read the files and remove their comments on the job threads
+	std::vector<char> readErrors( scanIndexes.size() );
+	Jobs::ParallelFor( 0, scanIndexes.size(), 1, [&]( int first, int last ) {
+		for ( int j = first; j < last; j++ )
+		{
+			std::string &text = files[ scanIndexes[ j ] ].text;
 
-			if ( !alreadyCreated )
+			try
 			{
-				Log::Debug("...generating '%s'", table.name );
-				GeneratePermanentShaderTable( values, numValues );
+				text = pendingReads[ j ].get();
 			}
+			catch ( const std::system_error& )
+			{
+				readErrors[ j ] = true;
+				continue;
+			}
+
+			// ydnar: unixify all shaders
+			COM_FixPath( &text[ 0 ] );
+			text.resize( COM_Compress( &text[ 0 ] ) );
 		}
-		else
+	} );
+
+	for ( size_t j = 0; j < scanIndexes.size(); j++ )
+	{
+		shaderFileIndex_t &file = files[ scanIndexes[ j ] ];
+
+		Log::Debug("loading '%s' shader file", scanFilenames[ j ] );
+
+		if ( readErrors[ j ] )
+		{
+			Log::Warn( "Couldn't load shader file %s", scanFilenames[ j ] );
+			file = {};
+		}
+		else if ( !IndexShaderFile( file ) )
+		{
+			Log::Warn("Bad shader file %s has incorrect syntax.", scanFilenames[ j ] );
+			file = {};
+		}
+	}
+
+	if ( useCache && cacheModified )
+	{
+		WriteShaderIndexCache( files );
+	}
+
+	// build single large buffer, the last files first so that their shaders
+	// are found first
+	size_t textSize = 1;
+	size_t namesSize = 0;
+	int shaderTextHashTableSizes[ MAX_SHADERTEXT_HASH ] = {};
+	int numShaders = 0;
+
+	for ( const shaderFileIndex_t &file : files )
+	{
+		textSize += file.text.size() + 1;
+
+		for ( const auto &shader : file.shaders )
+		{
+			namesSize += shader.first.size() + 1;
+			shaderTextHashTableSizes[ generateHashValue( shader.first.c_str(), MAX_SHADERTEXT_HASH ) ]++;
+			numShaders++;
+		}
+	}
+
+	s_shaderText = (char*) ri.Hunk_Alloc( textSize, ha_pref::h_low );
+	char *names = (char*) ri.Hunk_Alloc( namesSize + 1, ha_pref::h_low );
+	shaderTextEntry_t *entries = (shaderTextEntry_t*) ri.Hunk_Alloc(
+		( numShaders + MAX_SHADERTEXT_HASH ) * sizeof( shaderTextEntry_t ), ha_pref::h_low );
+
+	for ( int i = 0; i < MAX_SHADERTEXT_HASH; i++ )
+	{
+		shaderTextHashTable[ i ] = entries;
+		entries += shaderTextHashTableSizes[ i ] + 1;
+		shaderTextHashTableSizes[ i ] = 0;
+	}
+
+	char *textEnd = s_shaderText;
+
+	for ( auto file = files.rbegin(); file != files.rend(); ++file )
+	{
+		memcpy( textEnd, file->text.c_str(), file->text.size() );
+
+		for ( const auto &shader : file->shaders )
 		{
-			hash = generateHashValue( token, MAX_SHADERTEXT_HASH );
-			shaderTextHashTable[ hash ][ shaderTextHashTableSizes[ hash ]++ ] = oldp;
+			int hash = generateHashValue( shader.first.c_str(), MAX_SHADERTEXT_HASH );
+			shaderTextEntry_t &entry = shaderTextHashTable[ hash ][ shaderTextHashTableSizes[ hash ]++ ];
 
-			SkipBracedSection( &p );
+			memcpy( names, shader.first.c_str(), shader.first.size() + 1 );
+			entry.name = names;
+			entry.text = textEnd + shader.second;
+			names += shader.first.size() + 1;
 		}
+
+		for ( uint32_t offset : file->tables )
+		{
+			const char *p = textEnd + offset;
+			ParseShaderTable( &p );
+		}
+
+		textEnd += file->text.size();
+		*textEnd++ = '\n';
 	}
+
+	*textEnd = '\0';
 }
 
 /*
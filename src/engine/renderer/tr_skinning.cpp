@@ -0,0 +1,474 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+// tr_skinning.cpp -- CPU vertex skinning of MD5 and IQM surfaces
+
+#include <random>
+
+#include "tr_local.h"
+#include "framework/Benchmark.h"
+
+/*
+The SSE2 kernels skin four vertices at once: the attributes of the vertices
+and the transforms of their bones are transposed so that each register holds
+one component for the four vertices. The vertices which don't fill a group of
+four go through the scalar code, which is also used for builds without SSE2.
+*/
+
+#if defined(DAEMON_USE_ARCH_INTRINSICS_I686_SSE2)
+namespace {
+
+// One vec3_t for each of four vertices
+struct sseVec3_t
+{
+	__m128 x, y, z;
+};
+
+// Weights of four vertices, one register and one row of indexes per weight
+struct sseWeights_t
+{
+	__m128 weights[ MAX_WEIGHTS ];
+	alignas( 16 ) uint32_t indexes[ MAX_WEIGHTS ][ 4 ];
+};
+
+} // namespace
+
+static sseVec3_t sseTranspose( __m128 x, __m128 y, __m128 z, __m128 w )
+{
+	_MM_TRANSPOSE4_PS( x, y, z, w );
+
+	return { x, y, z };
+}
+
+static void sseTransposeWeights( __m128 w0, __m128 w1, __m128 w2, __m128 w3,
+	__m128i i0, __m128i i1, __m128i i2, __m128i i3, sseWeights_t &out )
+{
+	_MM_TRANSPOSE4_PS( w0, w1, w2, w3 );
+	out.weights[ 0 ] = w0;
+	out.weights[ 1 ] = w1;
+	out.weights[ 2 ] = w2;
+	out.weights[ 3 ] = w3;
+
+	__m128 f0 = _mm_castsi128_ps( i0 ), f1 = _mm_castsi128_ps( i1 ), f2 = _mm_castsi128_ps( i2 ), f3 = _mm_castsi128_ps( i3 );
+	_MM_TRANSPOSE4_PS( f0, f1, f2, f3 );
+	_mm_store_ps( reinterpret_cast<float *>( out.indexes[ 0 ] ), f0 );
+	_mm_store_ps( reinterpret_cast<float *>( out.indexes[ 1 ] ), f1 );
+	_mm_store_ps( reinterpret_cast<float *>( out.indexes[ 2 ] ), f2 );
+	_mm_store_ps( reinterpret_cast<float *>( out.indexes[ 3 ] ), f3 );
+}
+#endif
+
+namespace {
+
+struct MD5Vertexes
+{
+	const md5Vertex_t *verts;
+
+	const float *Position( int i ) const { return verts[ i ].position; }
+	const float *Normal( int i ) const { return verts[ i ].normal; }
+	const float *Tangent( int i ) const { return verts[ i ].tangent; }
+	const float *Binormal( int i ) const { return verts[ i ].binormal; }
+	const float *TexCoords( int i ) const { return verts[ i ].texCoords; }
+
+	uint32_t BoneIndex( int i, int weight ) const
+	{
+		return uint32_t( weight ) < verts[ i ].numWeights ? verts[ i ].boneIndexes[ weight ] : 0;
+	}
+
+	float BoneWeight( int i, int weight ) const
+	{
+		return uint32_t( weight ) < verts[ i ].numWeights ? verts[ i ].boneWeights[ weight ] : 0.0f;
+	}
+
+#if defined(DAEMON_USE_ARCH_INTRINSICS_I686_SSE2)
+	// The attributes are aligned vec4_t
+	sseVec3_t sseLoadAttribute( int i, const float *( MD5Vertexes::*attribute )( int ) const ) const
+	{
+		return sseTranspose( _mm_load_ps( ( this->*attribute )( i ) ), _mm_load_ps( ( this->*attribute )( i + 1 ) ),
+			_mm_load_ps( ( this->*attribute )( i + 2 ) ), _mm_load_ps( ( this->*attribute )( i + 3 ) ) );
+	}
+
+	void sseLoadWeights( int i, sseWeights_t &out ) const
+	{
+		__m128 w[ 4 ];
+		__m128i indexes[ 4 ];
+
+		for ( int j = 0; j < 4; j++ )
+		{
+			const md5Vertex_t &vertex = verts[ i + j ];
+
+			// ignore the weights after numWeights
+			__m128i mask = _mm_cmplt_epi32( _mm_setr_epi32( 0, 1, 2, 3 ), _mm_set1_epi32( vertex.numWeights ) );
+			w[ j ] = _mm_and_ps( _mm_loadu_ps( vertex.boneWeights ), _mm_castsi128_ps( mask ) );
+			indexes[ j ] = _mm_and_si128( _mm_loadu_si128( reinterpret_cast<const __m128i *>( vertex.boneIndexes ) ), mask );
+		}
+
+		sseTransposeWeights( w[ 0 ], w[ 1 ], w[ 2 ], w[ 3 ], indexes[ 0 ], indexes[ 1 ], indexes[ 2 ], indexes[ 3 ], out );
+	}
+#endif
+};
+
+struct IQMVertexes
+{
+	const IQModel_t *model;
+	int firstVertex;
+
+	const float *Position( int i ) const { return model->positions + 3 * ( firstVertex + i ); }
+	const float *Normal( int i ) const { return model->normals + 3 * ( firstVertex + i ); }
+	const float *Tangent( int i ) const { return model->tangents + 3 * ( firstVertex + i ); }
+	const float *Binormal( int i ) const { return model->bitangents + 3 * ( firstVertex + i ); }
+	const float *TexCoords( int i ) const { return model->texcoords + 2 * ( firstVertex + i ); }
+
+	uint32_t BoneIndex( int i, int weight ) const
+	{
+		return model->blendIndexes[ 4 * ( firstVertex + i ) + weight ];
+	}
+
+	float BoneWeight( int i, int weight ) const
+	{
+		return model->blendWeights[ 4 * ( firstVertex + i ) + weight ] * ( 1.0f / 255.0f );
+	}
+
+#if defined(DAEMON_USE_ARCH_INTRINSICS_I686_SSE2)
+	sseVec3_t sseLoadAttribute( int i, const float *( IQMVertexes::*attribute )( int ) const ) const
+	{
+		return sseTranspose( sseLoadVec3( ( this->*attribute )( i ) ), sseLoadVec3( ( this->*attribute )( i + 1 ) ),
+			sseLoadVec3( ( this->*attribute )( i + 2 ) ), sseLoadVec3( ( this->*attribute )( i + 3 ) ) );
+	}
+
+	// The weights and indexes of the four vertices are 16 consecutive bytes
+	void sseLoadWeights( int i, sseWeights_t &out ) const
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128 weightFactor = _mm_set1_ps( 1.0f / 255.0f );
+
+		__m128i bytes = _mm_loadu_si128( reinterpret_cast<const __m128i *>( model->blendWeights + 4 * ( firstVertex + i ) ) );
+		__m128i low = _mm_unpacklo_epi8( bytes, zero );
+		__m128i high = _mm_unpackhi_epi8( bytes, zero );
+
+		__m128 w0 = _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( low, zero ) ), weightFactor );
+		__m128 w1 = _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( low, zero ) ), weightFactor );
+		__m128 w2 = _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( high, zero ) ), weightFactor );
+		__m128 w3 = _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( high, zero ) ), weightFactor );
+
+		bytes = _mm_loadu_si128( reinterpret_cast<const __m128i *>( model->blendIndexes + 4 * ( firstVertex + i ) ) );
+		low = _mm_unpacklo_epi8( bytes, zero );
+		high = _mm_unpackhi_epi8( bytes, zero );
+
+		sseTransposeWeights( w0, w1, w2, w3,
+			_mm_unpacklo_epi16( low, zero ), _mm_unpackhi_epi16( low, zero ),
+			_mm_unpacklo_epi16( high, zero ), _mm_unpackhi_epi16( high, zero ), out );
+	}
+#endif
+};
+
+} // namespace
+
+template<typename Vertexes>
+static void SkinVertexScalar( const Vertexes &vertexes, int i, const transform_t *bones,
+	bool computeTangents, shaderVertex_t *out )
+{
+	vec3_t position = {}, normal = {}, tangent = {}, binormal = {};
+
+	for ( int k = 0; k < MAX_WEIGHTS; k++ )
+	{
+		float weight = vertexes.BoneWeight( i, k );
+
+		if ( weight == 0.0f )
+		{
+			continue;
+		}
+
+		const transform_t *bone = &bones[ vertexes.BoneIndex( i, k ) ];
+		vec3_t tmp;
+
+		TransformPoint( bone, vertexes.Position( i ), tmp );
+		VectorMA( position, weight, tmp, position );
+
+		if ( computeTangents )
+		{
+			TransformNormalVector( bone, vertexes.Normal( i ), tmp );
+			VectorMA( normal, weight, tmp, normal );
+
+			TransformNormalVector( bone, vertexes.Tangent( i ), tmp );
+			VectorMA( tangent, weight, tmp, tangent );
+
+			TransformNormalVector( bone, vertexes.Binormal( i ), tmp );
+			VectorMA( binormal, weight, tmp, binormal );
+		}
+	}
+
+	VectorCopy( position, out->xyz );
+
+	if ( computeTangents )
+	{
+		VectorNormalizeFast( normal );
+		VectorNormalizeFast( tangent );
+		VectorNormalizeFast( binormal );
+
+		R_TBNtoQtangentsFast( tangent, binormal, normal, out->qtangents );
+	}
+
+	Vector2Copy( vertexes.TexCoords( i ), out->texCoords );
+}
+
+#if defined(DAEMON_USE_ARCH_INTRINSICS_I686_SSE2)
+static void sseStoreTransposed( const sseVec3_t &v, vec4_t out[ 4 ] )
+{
+	__m128 x = v.x;
+	__m128 y = v.y;
+	__m128 z = v.z;
+	__m128 w = _mm_setzero_ps();
+
+	_MM_TRANSPOSE4_PS( x, y, z, w );
+
+	_mm_store_ps( out[ 0 ], x );
+	_mm_store_ps( out[ 1 ], y );
+	_mm_store_ps( out[ 2 ], z );
+	_mm_store_ps( out[ 3 ], w );
+}
+
+static sseVec3_t sseCrossProductSoA( __m128 ax, __m128 ay, __m128 az, const sseVec3_t &b )
+{
+	return {
+		_mm_sub_ps( _mm_mul_ps( ay, b.z ), _mm_mul_ps( az, b.y ) ),
+		_mm_sub_ps( _mm_mul_ps( az, b.x ), _mm_mul_ps( ax, b.z ) ),
+		_mm_sub_ps( _mm_mul_ps( ax, b.y ), _mm_mul_ps( ay, b.x ) ),
+	};
+}
+
+// Same operations as sseQuatTransform, on four vectors
+static sseVec3_t sseQuatTransformSoA( __m128 qx, __m128 qy, __m128 qz, __m128 qw, const sseVec3_t &v )
+{
+	sseVec3_t t = sseCrossProductSoA( qx, qy, qz, v );
+	t = { _mm_add_ps( t.x, t.x ), _mm_add_ps( t.y, t.y ), _mm_add_ps( t.z, t.z ) };
+
+	sseVec3_t t2 = sseCrossProductSoA( qx, qy, qz, t );
+
+	return {
+		_mm_add_ps( _mm_add_ps( v.x, t2.x ), _mm_mul_ps( qw, t.x ) ),
+		_mm_add_ps( _mm_add_ps( v.y, t2.y ), _mm_mul_ps( qw, t.y ) ),
+		_mm_add_ps( _mm_add_ps( v.z, t2.z ), _mm_mul_ps( qw, t.z ) ),
+	};
+}
+
+static void sseAccumulate( sseVec3_t &sum, __m128 weight, const sseVec3_t &v )
+{
+	sum.x = _mm_add_ps( sum.x, _mm_mul_ps( weight, v.x ) );
+	sum.y = _mm_add_ps( sum.y, _mm_mul_ps( weight, v.y ) );
+	sum.z = _mm_add_ps( sum.z, _mm_mul_ps( weight, v.z ) );
+}
+
+template<typename Vertexes>
+static void SkinVertexesSSE( const Vertexes &vertexes, int i, const transform_t *bones,
+	bool computeTangents, shaderVertex_t *out )
+{
+	const __m128 zero = _mm_setzero_ps();
+
+	sseVec3_t position = vertexes.sseLoadAttribute( i, &Vertexes::Position );
+	sseVec3_t normal = {}, tangent = {}, binormal = {};
+
+	if ( computeTangents )
+	{
+		normal = vertexes.sseLoadAttribute( i, &Vertexes::Normal );
+		tangent = vertexes.sseLoadAttribute( i, &Vertexes::Tangent );
+		binormal = vertexes.sseLoadAttribute( i, &Vertexes::Binormal );
+	}
+
+	sseVec3_t skinnedPosition = { zero, zero, zero };
+	sseVec3_t skinnedNormal = skinnedPosition, skinnedTangent = skinnedPosition, skinnedBinormal = skinnedPosition;
+
+	sseWeights_t weights;
+	vertexes.sseLoadWeights( i, weights );
+
+	for ( int k = 0; k < MAX_WEIGHTS; k++ )
+	{
+		__m128 weight = weights.weights[ k ];
+
+		if ( !_mm_movemask_ps( _mm_cmpneq_ps( weight, zero ) ) )
+		{
+			continue;
+		}
+
+		const transform_t &bone0 = bones[ weights.indexes[ k ][ 0 ] ];
+		const transform_t &bone1 = bones[ weights.indexes[ k ][ 1 ] ];
+		const transform_t &bone2 = bones[ weights.indexes[ k ][ 2 ] ];
+		const transform_t &bone3 = bones[ weights.indexes[ k ][ 3 ] ];
+
+		__m128 qx = bone0.sseRot, qy = bone1.sseRot, qz = bone2.sseRot, qw = bone3.sseRot;
+		_MM_TRANSPOSE4_PS( qx, qy, qz, qw );
+
+		__m128 tx = bone0.sseTransScale, ty = bone1.sseTransScale, tz = bone2.sseTransScale, scale = bone3.sseTransScale;
+		_MM_TRANSPOSE4_PS( tx, ty, tz, scale );
+
+		sseVec3_t v = sseQuatTransformSoA( qx, qy, qz, qw, position );
+		v.x = _mm_add_ps( _mm_mul_ps( v.x, scale ), tx );
+		v.y = _mm_add_ps( _mm_mul_ps( v.y, scale ), ty );
+		v.z = _mm_add_ps( _mm_mul_ps( v.z, scale ), tz );
+		sseAccumulate( skinnedPosition, weight, v );
+
+		if ( computeTangents )
+		{
+			sseAccumulate( skinnedNormal, weight, sseQuatTransformSoA( qx, qy, qz, qw, normal ) );
+			sseAccumulate( skinnedTangent, weight, sseQuatTransformSoA( qx, qy, qz, qw, tangent ) );
+			sseAccumulate( skinnedBinormal, weight, sseQuatTransformSoA( qx, qy, qz, qw, binormal ) );
+		}
+	}
+
+	alignas( 16 ) vec4_t positions[ 4 ];
+	sseStoreTransposed( skinnedPosition, positions );
+
+	for ( int j = 0; j < 4; j++ )
+	{
+		VectorCopy( positions[ j ], out[ j ].xyz );
+		Vector2Copy( vertexes.TexCoords( i + j ), out[ j ].texCoords );
+	}
+
+	if ( computeTangents )
+	{
+		alignas( 16 ) vec4_t normals[ 4 ], tangents[ 4 ], binormals[ 4 ];
+		sseStoreTransposed( skinnedNormal, normals );
+		sseStoreTransposed( skinnedTangent, tangents );
+		sseStoreTransposed( skinnedBinormal, binormals );
+
+		for ( int j = 0; j < 4; j++ )
+		{
+			VectorNormalizeFast( normals[ j ] );
+			VectorNormalizeFast( tangents[ j ] );
+			VectorNormalizeFast( binormals[ j ] );
+
+			R_TBNtoQtangentsFast( tangents[ j ], binormals[ j ], normals[ j ], out[ j ].qtangents );
+		}
+	}
+}
+#endif
+
+template<typename Vertexes>
+static void SkinVertexes( const Vertexes &vertexes, int numVertexes, const transform_t *bones,
+	bool computeTangents, shaderVertex_t *out, bool useSIMD )
+{
+	int i = 0;
+
+#if defined(DAEMON_USE_ARCH_INTRINSICS_I686_SSE2)
+	if ( useSIMD )
+	{
+		for ( ; i + 4 <= numVertexes; i += 4 )
+		{
+			SkinVertexesSSE( vertexes, i, bones, computeTangents, out + i );
+		}
+	}
+#else
+	Q_UNUSED( useSIMD );
+#endif
+
+	for ( ; i < numVertexes; i++ )
+	{
+		SkinVertexScalar( vertexes, i, bones, computeTangents, out + i );
+	}
+}
+
+void R_SkinMD5Vertexes( const md5Vertex_t *verts, int numVertexes, const transform_t *bones,
+	bool computeTangents, shaderVertex_t *out, bool useSIMD )
+{
+	SkinVertexes( MD5Vertexes{ verts }, numVertexes, bones, computeTangents, out, useSIMD );
+}
+
+void R_SkinIQMVertexes( const IQModel_t *model, int firstVertex, int numVertexes, const transform_t *bones,
+	bool computeTangents, shaderVertex_t *out, bool useSIMD )
+{
+	SkinVertexes( IQMVertexes{ model, firstVertex }, numVertexes, bones, computeTangents, out, useSIMD );
+}
+
+class SkinningBenchmarkCmd : public Cmd::StaticCmd
+{
+public:
+	SkinningBenchmarkCmd() : StaticCmd(
+		"skinningBenchmark", Cmd::RENDERER, "measures the speed of CPU vertex skinning") {}
+
+	void Run( const Cmd::Args& ) const override
+	{
+		const int numVertexes = 16384;
+		const int numBones = 64;
+
+		std::mt19937 generator( 0 );
+		std::uniform_real_distribution<float> coordinate( -1.0f, 1.0f );
+		std::uniform_int_distribution<uint32_t> boneIndex( 0, numBones - 1 );
+
+		std::vector<transform_t> benchmarkBones( numBones );
+		for ( transform_t &bone : benchmarkBones )
+		{
+			quat_t rotation = { coordinate( generator ), coordinate( generator ), coordinate( generator ), 1.0f };
+			QuatNormalize( rotation );
+			TransInitRotationQuat( rotation, &bone );
+			vec3_t translation = { coordinate( generator ), coordinate( generator ), coordinate( generator ) };
+			TransAddTranslation( translation, &bone );
+		}
+
+		std::vector<md5Vertex_t> verts( numVertexes );
+		for ( md5Vertex_t &vertex : verts )
+		{
+			Vector4Set( vertex.position, coordinate( generator ), coordinate( generator ), coordinate( generator ), 1.0f );
+			Vector4Set( vertex.normal, 0.0f, 0.0f, 1.0f, 0.0f );
+			Vector4Set( vertex.tangent, 1.0f, 0.0f, 0.0f, 0.0f );
+			Vector4Set( vertex.binormal, 0.0f, 1.0f, 0.0f, 0.0f );
+			Vector2Set( vertex.texCoords, 0.0f, 0.0f );
+
+			vertex.numWeights = 1 + boneIndex( generator ) % MAX_WEIGHTS;
+			for ( uint32_t k = 0; k < vertex.numWeights; k++ )
+			{
+				vertex.boneIndexes[ k ] = boneIndex( generator );
+				vertex.boneWeights[ k ] = 1.0f / vertex.numWeights;
+			}
+		}
+
+		std::vector<shaderVertex_t> scalarOut( numVertexes ), simdOut( numVertexes );
+
+		for ( bool computeTangents : { false, true } )
+		{
+			// millions of vertices per second
+			float scalarRate = numVertexes / Benchmark::Measure( 64, [&] {
+				R_SkinMD5Vertexes( verts.data(), numVertexes, benchmarkBones.data(), computeTangents, scalarOut.data(), false );
+			} );
+
+			float simdRate = numVertexes / Benchmark::Measure( 64, [&] {
+				R_SkinMD5Vertexes( verts.data(), numVertexes, benchmarkBones.data(), computeTangents, simdOut.data(), true );
+			} );
+
+			float maxError = 0.0f;
+			for ( int i = 0; i < numVertexes; i++ )
+			{
+				maxError = std::max( maxError, Distance( scalarOut[ i ].xyz, simdOut[ i ].xyz ) );
+			}
+
+			Print( "%s: scalar %.1f Mvertices/s, SIMD %.1f Mvertices/s, max position difference %g",
+				computeTangents ? "positions and tangents" : "positions", scalarRate, simdRate, maxError );
+		}
+	}
+};
+static SkinningBenchmarkCmd skinningBenchmarkCmdRegistration;
@@ -0,0 +1,167 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "common/Common.h"
+
+#include "engine/renderer/tr_local.h"
+
+namespace {
+
+class SkinningTest : public testing::Test
+{
+protected:
+    static const int NUM_BONES = 32;
+
+    std::mt19937 generator{ 0 };
+    std::uniform_real_distribution<float> coordinate{ -1.0f, 1.0f };
+    std::vector<transform_t> bones;
+
+    void SetUp() override
+    {
+        bones.resize(NUM_BONES);
+        for (transform_t& bone : bones) {
+            quat_t rotation = { coordinate(generator), coordinate(generator), coordinate(generator), 1.0f };
+            QuatNormalize(rotation);
+            TransInitRotationQuat(rotation, &bone);
+            vec3_t translation = { coordinate(generator), coordinate(generator), coordinate(generator) };
+            TransAddTranslation(translation, &bone);
+            TransAddScale(1.0f + 0.5f * coordinate(generator), &bone);
+        }
+    }
+
+    void RandomUnitVector(vec3_t out)
+    {
+        VectorSet(out, coordinate(generator), coordinate(generator), coordinate(generator) + 2.0f);
+        VectorNormalize(out);
+    }
+
+    static void ExpectSameVertexes(const std::vector<shaderVertex_t>& scalar, const std::vector<shaderVertex_t>& simd, bool computeTangents)
+    {
+        for (size_t i = 0; i < scalar.size(); i++) {
+            for (int j = 0; j < 3; j++) {
+                EXPECT_NEAR(scalar[i].xyz[j], simd[i].xyz[j], 1e-4f) << "vertex " << i;
+            }
+            for (int j = 0; j < 2; j++) {
+                EXPECT_EQ(scalar[i].texCoords[j], simd[i].texCoords[j]) << "vertex " << i;
+            }
+            if (computeTangents) {
+                for (int j = 0; j < 4; j++) {
+                    EXPECT_NEAR(scalar[i].qtangents[j], simd[i].qtangents[j], 2) << "vertex " << i;
+                }
+            }
+        }
+    }
+};
+
+TEST_F(SkinningTest, MD5MatchesScalar)
+{
+    // Not a multiple of 4 to also go through the scalar code for the last vertices
+    const int numVertexes = 1027;
+    std::uniform_int_distribution<uint32_t> boneIndex(0, NUM_BONES - 1);
+
+    std::vector<md5Vertex_t> verts(numVertexes);
+    for (md5Vertex_t& vertex : verts) {
+        Vector4Set(vertex.position, coordinate(generator), coordinate(generator), coordinate(generator), 1.0f);
+        RandomUnitVector(vertex.normal);
+        RandomUnitVector(vertex.tangent);
+        CrossProduct(vertex.normal, vertex.tangent, vertex.binormal);
+        VectorNormalize(vertex.binormal);
+        CrossProduct(vertex.binormal, vertex.normal, vertex.tangent);
+        Vector2Set(vertex.texCoords, coordinate(generator), coordinate(generator));
+
+        vertex.numWeights = 1 + boneIndex(generator) % MAX_WEIGHTS;
+        for (uint32_t k = 0; k < vertex.numWeights; k++) {
+            vertex.boneIndexes[k] = boneIndex(generator);
+            vertex.boneWeights[k] = 1.0f / vertex.numWeights;
+        }
+    }
+
+    for (bool computeTangents : {false, true}) {
+        std::vector<shaderVertex_t> scalar(numVertexes), simd(numVertexes);
+        R_SkinMD5Vertexes(verts.data(), numVertexes, bones.data(), computeTangents, scalar.data(), false);
+        R_SkinMD5Vertexes(verts.data(), numVertexes, bones.data(), computeTangents, simd.data(), true);
+        ExpectSameVertexes(scalar, simd, computeTangents);
+    }
+}
+
+TEST_F(SkinningTest, IQMMatchesScalar)
+{
+    const int numVertexes = 1030;
+    const int firstVertex = 3;
+    const int totalVertexes = firstVertex + numVertexes;
+    std::uniform_int_distribution<int> boneIndex(0, NUM_BONES - 1);
+
+    std::vector<float> positions(3 * totalVertexes), normals(3 * totalVertexes), tangents(3 * totalVertexes), bitangents(3 * totalVertexes);
+    std::vector<float> texcoords(2 * totalVertexes);
+    std::vector<byte> blendIndexes(4 * totalVertexes), blendWeights(4 * totalVertexes);
+
+    for (int i = 0; i < totalVertexes; i++) {
+        VectorSet(&positions[3 * i], coordinate(generator), coordinate(generator), coordinate(generator));
+        RandomUnitVector(&normals[3 * i]);
+        RandomUnitVector(&tangents[3 * i]);
+        CrossProduct(&normals[3 * i], &tangents[3 * i], &bitangents[3 * i]);
+        VectorNormalize(&bitangents[3 * i]);
+        CrossProduct(&bitangents[3 * i], &normals[3 * i], &tangents[3 * i]);
+        Vector2Set(&texcoords[2 * i], coordinate(generator), coordinate(generator));
+
+        // Some weights are zero, as when a vertex has less than four bones
+        int remaining = 255;
+        for (int k = 0; k < 4; k++) {
+            int weight = k == 3 ? remaining : std::uniform_int_distribution<int>(0, remaining)(generator);
+            blendIndexes[4 * i + k] = boneIndex(generator);
+            blendWeights[4 * i + k] = weight;
+            remaining -= weight;
+        }
+    }
+
+    IQModel_t model{};
+    model.num_vertexes = totalVertexes;
+    model.num_joints = NUM_BONES;
+    model.positions = positions.data();
+    model.normals = normals.data();
+    model.tangents = tangents.data();
+    model.bitangents = bitangents.data();
+    model.texcoords = texcoords.data();
+    model.blendIndexes = blendIndexes.data();
+    model.blendWeights = blendWeights.data();
+
+    for (bool computeTangents : {false, true}) {
+        std::vector<shaderVertex_t> scalar(numVertexes), simd(numVertexes);
+        R_SkinIQMVertexes(&model, firstVertex, numVertexes, bones.data(), computeTangents, scalar.data(), false);
+        R_SkinIQMVertexes(&model, firstVertex, numVertexes, bones.data(), computeTangents, simd.data(), true);
+        ExpectSameVertexes(scalar, simd, computeTangents);
+    }
+}
+
+} // namespace
@@ -24,6 +24,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "tr_local.h"
 #include "gl_shader.h"
 #include "Material.h"
+#include "framework/JobSystem.h"
 
 /*
 ==============================================================================
@@ -42,6 +43,9 @@ use the shader system.
 
 static transform_t bones[ MAX_BONES ];
 
+// Minimum number of vertices skinned by each job
+static const int SKINNING_GRAIN_SIZE = 256;
+
 /*
 ==============
 Tess_EndBegin
@@ -1055,81 +1059,10 @@ static void Tess_SurfaceMD5( md5Surface_t *srf )
 	shaderVertex_t *modelTessVertex = tess.verts + tess.numVertexes;
 
 	// Deform the vertices by the lerped bones.
-	if ( tess.skipTangents )
+	Jobs::ParallelFor( 0, static_cast<int>( srf->numVerts ), SKINNING_GRAIN_SIZE, [&]( int first, int last )
 	{
-		#pragma omp parallel for
-		for ( int i = 0; i < static_cast<int>( srf->numVerts ); i++ )
-		{
-			shaderVertex_t *tessVertex = modelTessVertex + i;
-			md5Vertex_t *vertex = surfaceVertex + i;
-
-			vec4_t *vertexPosition = &vertex->position;
-
-			float *boneWeight = vertex->boneWeights;
-			float *lastWeight = boneWeight + vertex->numWeights;
-			uint32_t *boneIndex = vertex->boneIndexes;
-
-			vec3_t position = {};
-
-			for ( ; boneWeight < lastWeight; boneWeight++, boneIndex++ )
-			{
-				vec3_t tmp;
-
-				TransformPoint( &bones[ *boneIndex ], *vertexPosition, tmp );
-				VectorMA( position, *boneWeight, tmp, position );
-			}
-
-			VectorCopy( position, tessVertex->xyz );
-
-			Vector2Copy( vertex->texCoords, tessVertex->texCoords );
-		}
-	}
-	else
-	{
-		#pragma omp parallel for
-		for ( int i = 0; i < static_cast<int>( srf->numVerts ); i++ )
-		{
-			shaderVertex_t *tessVertex = modelTessVertex + i;
-			md5Vertex_t *vertex = surfaceVertex + i;
-
-			vec4_t *vertexPosition = &vertex->position;
-			vec4_t *vertexNormal = &vertex->normal;
-			vec4_t *vertexTangent = &vertex->tangent;
-			vec4_t *vertexBinormal = &vertex->binormal;
-
-			float *boneWeight = vertex->boneWeights;
-			float *lastWeight = boneWeight + vertex->numWeights;
-			uint32_t *boneIndex = vertex->boneIndexes;
-
-			vec3_t tangent = {}, binormal = {}, normal = {}, position = {};
-
-			for ( ; boneWeight < lastWeight; boneWeight++, boneIndex++ )
-			{
-				vec3_t tmp;
-
-				TransformPoint( &bones[ *boneIndex ], *vertexPosition, tmp );
-				VectorMA( position, *boneWeight, tmp, position );
-
-				TransformNormalVector( &bones[ *boneIndex ], *vertexNormal, tmp );
-				VectorMA( normal, *boneWeight, tmp, normal );
-
-				TransformNormalVector( &bones[ *boneIndex ], *vertexTangent, tmp );
-				VectorMA( tangent, *boneWeight, tmp, tangent );
-
-				TransformNormalVector( &bones[ *boneIndex ], *vertexBinormal, tmp );
-				VectorMA( binormal, *boneWeight, tmp, binormal );
-			}
-
-			VectorNormalizeFast( normal );
-			VectorNormalizeFast( tangent );
-			VectorNormalizeFast( binormal );
-			VectorCopy( position, tessVertex->xyz );
-
-			R_TBNtoQtangentsFast( tangent, binormal, normal, tessVertex->qtangents );
-
-			Vector2Copy( vertex->texCoords, tessVertex->texCoords );
-		}
-	}
+		R_SkinMD5Vertexes( surfaceVertex + first, last - first, bones, !tess.skipTangents, modelTessVertex + first );
+	} );
 
 	tess.numIndexes += numIndexes;
 	tess.numVertexes += srf->numVerts;
@@ -1250,53 +1183,18 @@ void Tess_SurfaceIQM( srfIQModel_t *surf ) {
 	// Deform the vertices by the lerped bones.
 	if ( model->num_joints > 0 && model->blendWeights && model->blendIndexes )
 	{
-		const float weightFactor = 1.0f / 255.0f;
-
-		if ( tess.skipTangents )
+		Jobs::ParallelFor( 0, surf->num_vertexes, SKINNING_GRAIN_SIZE, [&]( int first, int last )
 		{
-			byte *modelBlendIndex = model->blendIndexes + 4 * firstVertex;
-			byte *modelBlendWeight = model->blendWeights + 4 * firstVertex;
-
-			#pragma omp parallel for
-			for ( int i = 0; i < surf->num_vertexes; i++ )
-			{
-				shaderVertex_t *tessVertex = modelTessVertex + i;
-
-				float *vertexPosition = modelPosition + 3 * i;
-				float *vertexTexcoord = modelTexcoord + 2 * i;
-
-				byte *blendIndex = modelBlendIndex + 4 * i;
-				byte *lastBlendIndex = blendIndex + 4;
-				byte *blendWeight = modelBlendWeight + 4 * i;
-
-				vec3_t position = {};
-
-				for ( ; blendIndex < lastBlendIndex; blendIndex++, blendWeight++ )
-				{
-					if ( *blendWeight == 0 )
-					{
-						continue;
-					}
-
-					float weight = *blendWeight * weightFactor;
-					vec3_t tmp;
-
-					TransformPoint( &bones[ *blendIndex ], vertexPosition, tmp );
-					VectorMA( position, weight, tmp, position );
-				}
-
-				VectorCopy( position, tessVertex->xyz );
+			R_SkinIQMVertexes( model, firstVertex + first, last - first, bones, !tess.skipTangents, modelTessVertex + first );
+		} );
+	}
+	else
+	{
+		float scale = model->internalScale * backEnd.currentEntity->skeleton.scale;
 
-				Vector2Copy( vertexTexcoord, tessVertex->texCoords );
-			}
-		}
-		else
+		Jobs::ParallelFor( 0, surf->num_vertexes, SKINNING_GRAIN_SIZE, [&]( int first, int last )
 		{
-			byte *modelBlendIndex = model->blendIndexes + 4 * firstVertex;
-			byte *modelBlendWeight = model->blendWeights + 4 * firstVertex;
-
-			#pragma omp parallel for
-			for ( int i = 0; i < surf->num_vertexes; i++ )
+			for ( int i = first; i < last; i++ )
 			{
 				shaderVertex_t *tessVertex = modelTessVertex + i;
 
@@ -1306,67 +1204,13 @@ void Tess_SurfaceIQM( srfIQModel_t *surf ) {
 				float *vertexBitangent = modelBitangent + 3 * i;
 				float *vertexTexcoord = modelTexcoord + 2 * i;
 
-				byte *blendIndex = modelBlendIndex + 4 * i;
-				byte *lastBlendIndex = blendIndex + 4;
-				byte *blendWeight = modelBlendWeight + 4 * i;
-
-				vec3_t position = {}, tangent = {}, binormal = {}, normal = {};
-
-				for ( ; blendIndex < lastBlendIndex; blendIndex++, blendWeight++ )
-				{
-					if ( *blendWeight == 0 )
-					{
-						continue;
-					}
+				VectorScale( vertexPosition, scale, tessVertex->xyz );
 
-					float weight = *blendWeight * weightFactor;
-					vec3_t tmp;
-
-					TransformPoint( &bones[ *blendIndex ], vertexPosition, tmp );
-					VectorMA( position, weight, tmp, position );
-
-					TransformNormalVector( &bones[ *blendIndex ], vertexNormal, tmp );
-					VectorMA( normal, weight, tmp, normal );
-
-					TransformNormalVector( &bones[ *blendIndex ], vertexTangent, tmp );
-					VectorMA( tangent, weight, tmp, tangent );
-
-					TransformNormalVector( &bones[ *blendIndex ], vertexBitangent, tmp );
-					VectorMA( binormal, weight, tmp, binormal );
-				}
-
-				VectorNormalizeFast( normal );
-				VectorNormalizeFast( tangent );
-				VectorNormalizeFast( binormal );
-				VectorCopy( position, tessVertex->xyz );
-
-				R_TBNtoQtangentsFast( tangent, binormal, normal, tessVertex->qtangents );
+				R_TBNtoQtangentsFast( vertexTangent, vertexBitangent, vertexNormal, tessVertex->qtangents );
 
 				Vector2Copy( vertexTexcoord, tessVertex->texCoords );
 			}
-		}
-	}
-	else
-	{
-		float scale = model->internalScale * backEnd.currentEntity->skeleton.scale;
-
-		#pragma omp parallel for
-		for ( int i = 0; i < surf->num_vertexes; i++ )
-		{
-			shaderVertex_t *tessVertex = modelTessVertex + i;
-
-			float *vertexPosition = modelPosition + 3 * i;
-			float *vertexNormal = modelNormal + 3 * i;
-			float *vertexTangent = modelTangent + 3 * i;
-			float *vertexBitangent = modelBitangent + 3 * i;
-			float *vertexTexcoord = modelTexcoord + 2 * i;
-
-			VectorScale( vertexPosition, scale, tessVertex->xyz );
-
-			R_TBNtoQtangentsFast( vertexTangent, vertexBitangent, vertexNormal, tessVertex->qtangents );
-
-			Vector2Copy( vertexTexcoord, tessVertex->texCoords );
-		}
+		} );
 	}
 
 	tess.numIndexes  += numIndexes;
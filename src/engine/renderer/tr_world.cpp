@@ -261,6 +261,95 @@ static void R_AddLeafSurfaces( bspNode_t *node, int planeBits )
 	}
 }
 
+/*
+=============================================================
+
+        BATCHED LEAF CULLING
+
+=============================================================
+*/
+
+/* The leaves in the PVS that have surfaces, with their bounds stored as
+separate arrays so BoxesOnPlanesSide can cull them four at a time. The list
+only changes when R_MarkLeaves marks a new set of leaves. */
+struct visibleLeaves_t
+{
+	const bspNode_t *worldNodes = nullptr;
+	int visIndex = -1;
+	int visCount = -1;
+
+	std::vector<int> leafNums;
+	std::vector<float> mins[ 3 ];
+	std::vector<float> maxs[ 3 ];
+	std::vector<uint32_t> sides;
+
+	// the culling results indexed by node number
+	std::vector<uint32_t> nodeSides;
+};
+
+static visibleLeaves_t visibleLeaves;
+
+static void R_FlattenVisibleLeaves( bool marked )
+{
+	visibleLeaves_t &leaves = visibleLeaves;
+
+	if ( !marked && leaves.worldNodes == tr.world->nodes && leaves.visIndex == tr.visIndex
+		&& leaves.visCount == tr.visCounts[ tr.visIndex ] )
+	{
+		return;
+	}
+
+	leaves.worldNodes = tr.world->nodes;
+	leaves.visIndex = tr.visIndex;
+	leaves.visCount = tr.visCounts[ tr.visIndex ];
+
+	leaves.leafNums.clear();
+
+	for ( int j = 0; j < 3; j++ )
+	{
+		leaves.mins[ j ].clear();
+		leaves.maxs[ j ].clear();
+	}
+
+	// the same leaves that R_RecursiveWorldNode can reach
+	for ( int i = 0; i < tr.world->numnodes; i++ )
+	{
+		const bspNode_t *node = &tr.world->nodes[ i ];
+
+		if ( node->contents == -1 || !node->numMarkSurfaces
+			|| node->visCounts[ tr.visIndex ] != tr.visCounts[ tr.visIndex ] )
+		{
+			continue;
+		}
+
+		leaves.leafNums.push_back( i );
+
+		for ( int j = 0; j < 3; j++ )
+		{
+			leaves.mins[ j ].push_back( node->mins[ j ] );
+			leaves.maxs[ j ].push_back( node->maxs[ j ] );
+		}
+	}
+
+	leaves.sides.resize( leaves.leafNums.size() );
+	leaves.nodeSides.resize( tr.world->numnodes );
+}
+
+static void R_CullVisibleLeaves()
+{
+	visibleLeaves_t &leaves = visibleLeaves;
+	int numLeaves = leaves.leafNums.size();
+
+	BoxesOnPlanesSide( numLeaves, leaves.mins[ 0 ].data(), leaves.mins[ 1 ].data(), leaves.mins[ 2 ].data(),
+		leaves.maxs[ 0 ].data(), leaves.maxs[ 1 ].data(), leaves.maxs[ 2 ].data(),
+		tr.viewParms.frustum, FRUSTUM_PLANES, leaves.sides.data() );
+
+	for ( int i = 0; i < numLeaves; i++ )
+	{
+		leaves.nodeSides[ leaves.leafNums[ i ] ] = leaves.sides[ i ];
+	}
+}
+
 /*
 ================
 R_RecursiveWorldNode
@@ -288,12 +377,27 @@ static void R_RecursiveWorldNode( bspNode_t *node, int planeBits )
 		{
 			int i;
 			int r;
+			bool isLeaf = node->contents != -1;
+			uint32_t leafSides = 0;
+
+			if ( isLeaf )
+			{
+				// leaves were already culled by R_CullVisibleLeaves
+				leafSides = visibleLeaves.nodeSides[ node - tr.world->nodes ];
+			}
 
 			for ( i = 0; i < FRUSTUM_PLANES; i++ )
 			{
 				if ( planeBits & ( 1 << i ) )
 				{
-					r = BoxOnPlaneSide( node->mins, node->maxs, &tr.viewParms.frustum[ i ] );
+					if ( isLeaf )
+					{
+						r = ( leafSides >> ( 2 * i ) ) & 3;
+					}
+					else
+					{
+						r = BoxOnPlaneSide( node->mins, node->maxs, &tr.viewParms.frustum[ i ] );
+					}
 
 					if ( r == 2 )
 					{
@@ -454,10 +558,10 @@ bool R_inPVVS( const vec3_t p1, const vec3_t p2 )
 R_MarkLeaves
 
 Mark the leaves and nodes that are in the PVS for the current
-cluster
+cluster, returns true if the leaves were marked again
 ===============
 */
-static void R_MarkLeaves()
+static bool R_MarkLeaves()
 {
 	const byte *vis;
 	bspNode_t  *leaf, *parent;
@@ -468,7 +572,7 @@ static void R_MarkLeaves()
 	// extent of the current pvs
 	if ( r_lockpvs->integer )
 	{
-		return;
+		return false;
 	}
 
 	// current viewcluster
@@ -497,7 +601,7 @@ static void R_MarkLeaves()
 					}
 
 					tr.visIndex = i;
-					return;
+					return false;
 				}
 			}
 		}
@@ -522,7 +626,7 @@ static void R_MarkLeaves()
 			}
 		}
 
-		return;
+		return true;
 	}
 
 	vis = R_ClusterPVS( tr.visClusters[ tr.visIndex ] );
@@ -570,6 +674,8 @@ static void R_MarkLeaves()
 		}
 		while ( parent );
 	}
+
+	return true;
 }
 
 /*
@@ -595,7 +701,15 @@ void R_AddWorldSurfaces()
 	ClearBounds( tr.viewParms.visBounds[ 0 ], tr.viewParms.visBounds[ 1 ] );
 
 	// determine which leaves are in the PVS / areamask
-	R_MarkLeaves();
+	Sys::SteadyClock::time_point start = R_StartFrontEndTimer();
+	bool marked = R_MarkLeaves();
+	R_StopFrontEndTimer( tr.frontEndTimes.markLeaves, start );
+
+	if ( !r_nocull->integer )
+	{
+		R_FlattenVisibleLeaves( marked );
+		R_CullVisibleLeaves();
+	}
 
 	// clear traversal list
 	backEndData[ tr.smpFrame ]->traversalLength = 0;
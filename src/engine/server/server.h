@@ -132,6 +132,8 @@ struct netchan_buffer_t
 	netchan_buffer_t *next;
 };
 
+struct downloadPak_t;
+
 struct client_t
 {
 	clientState_t  state;
@@ -154,15 +156,11 @@ struct client_t
 
 	// downloading
 	char          downloadName[ MAX_OSPATH ]; // if not empty string, we are downloading
-	FS::File*     download; // file being downloaded
+	downloadPak_t *download; // mapping of the pak being downloaded, shared with other clients
 	int           downloadSize; // total bytes (can't use EOF because of paks)
-	int           downloadCount; // bytes sent
 	int           downloadClientBlock; // last block we sent to the client, awaiting ack
-	int           downloadCurrentBlock; // current block number
+	int           downloadCurrentBlock; // end of the window of blocks which can be sent
 	int           downloadXmitBlock; // last block we xmited
-	unsigned char *downloadBlocks[ MAX_DOWNLOAD_WINDOW ]; // the buffers for the download blocks
-	int           downloadBlockSize[ MAX_DOWNLOAD_WINDOW ];
-	bool      downloadEOF; // We have sent the EOF block
 	int           downloadSendTime; // time we last got an ack from the client
 
 	// www downloading
@@ -366,6 +364,15 @@ void SV_ClientThink( client_t *cl, usercmd_t *cmd );
 
 void SV_WriteDownloadToClient( client_t *cl, msg_t *msg );
 
+//
+// sv_http.cpp
+//
+void        SV_HTTPStart();
+void        SV_HTTPStop();
+std::string SV_HTTPBaseURL();
+void        SV_HTTPAddPak( const std::string& name, const std::string& path );
+int         SV_HTTPParseRange( const std::string& value, FS::offset_t size, FS::offset_t& start, FS::offset_t& end );
+
 //
 // sv_snapshot.c
 //
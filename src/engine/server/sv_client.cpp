@@ -40,6 +40,15 @@ Maryland 20850 USA.
 #include "qcommon/sys.h"
 #include <common/FileSystem.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 // HTTP download params
 static Cvar::Cvar<bool> sv_wwwDownload("sv_wwwDownload", "have clients download missing paks via HTTP", Cvar::NONE, true);
 static Cvar::Cvar<std::string> sv_wwwBaseURL("sv_wwwBaseURL", "where clients download paks (must NOT be HTTPS, must contain PAKSERVER)", Cvar::NONE, WWW_BASEURL);
@@ -47,6 +56,241 @@ static Cvar::Cvar<std::string> sv_wwwFallbackURL("sv_wwwFallbackURL", "alternati
 
 static void SV_CloseDownload( client_t *cl );
 
+/*
+============================================================
+
+UDP DOWNLOAD PAKS
+
+Paks sent over the UDP download protocol are mapped into memory once and
+shared by every client downloading them, so blocks are written to the
+client message straight from the page cache instead of being read into
+per-client buffers on the frame.
+
+============================================================
+*/
+
+struct downloadPak_t
+{
+	std::string path;
+	const byte  *data;
+	size_t      size;
+	int         refCount;
+	bool        changed;
+#ifndef _WIN32
+	// to notice the file being modified or replaced while it is mapped
+	ino_t       inode;
+	time_t      mtime;
+#endif
+};
+
+static std::unordered_map<std::string, downloadPak_t*> downloadPaks;
+
+/*
+==================
+SV_AcquireDownloadPak
+
+Map a pak for downloading, or add a reference to an existing mapping
+==================
+*/
+static downloadPak_t *SV_AcquireDownloadPak( const std::string& path )
+{
+	auto it = downloadPaks.find( path );
+
+	if ( it != downloadPaks.end() )
+	{
+		it->second->refCount++;
+		return it->second;
+	}
+
+	FS::File file = FS::RawPath::OpenRead( path );
+	const FS::offset_t length = file.Length();
+
+	if ( length > std::numeric_limits<int>::max() )
+	{
+		throw std::system_error{Util::ordinal(std::errc::value_too_large), std::system_category(),
+			"Pak file '" + path + "' size '" + std::to_string(length) + "' is larger than max client download size"};
+	}
+
+	const byte *data = nullptr;
+
+	// an empty file can't be mapped, it is sent as a lone EOF block
+	if ( length > 0 )
+	{
+#ifdef _WIN32
+		HANDLE handle = reinterpret_cast<HANDLE>( _get_osfhandle( fileno( file.GetHandle() ) ) );
+		HANDLE mapping = CreateFileMappingW( handle, nullptr, PAGE_READONLY, 0, 0, nullptr );
+
+		if ( mapping )
+		{
+			data = static_cast<const byte*>( MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, length ) );
+			CloseHandle( mapping );
+		}
+
+		if ( !data )
+		{
+			throw std::system_error{Util::ordinal(std::errc::io_error), std::system_category(),
+				"Failed to map pak file '" + path + "': " + Sys::Win32StrError( GetLastError() )};
+		}
+#else
+		void *base = mmap( nullptr, length, PROT_READ, MAP_PRIVATE, fileno( file.GetHandle() ), 0 );
+
+		if ( base == MAP_FAILED )
+		{
+			throw std::system_error{errno, std::generic_category(), "Failed to map pak file '" + path + "'"};
+		}
+
+		data = static_cast<const byte*>( base );
+#endif
+	}
+
+	// the mapping outlives the file handle
+	downloadPak_t *pak = new downloadPak_t{ path, data, static_cast<size_t>( length ), 1, false };
+
+#ifndef _WIN32
+	struct stat st;
+
+	if ( fstat( fileno( file.GetHandle() ), &st ) == 0 )
+	{
+		pak->inode = st.st_ino;
+		pak->mtime = st.st_mtime;
+	}
+	else
+	{
+		pak->inode = 0;
+		pak->mtime = 0;
+	}
+#endif
+
+	downloadPaks.emplace( path, pak );
+	return pak;
+}
+
+/*
+==================
+SV_ReleaseDownloadPak
+
+Drop a reference to a mapped pak, unmapping it when no client uses it anymore
+==================
+*/
+static void SV_ReleaseDownloadPak( downloadPak_t *pak )
+{
+	if ( --pak->refCount > 0 )
+	{
+		return;
+	}
+
+	if ( pak->data )
+	{
+#ifdef _WIN32
+		UnmapViewOfFile( pak->data );
+#else
+		munmap( const_cast<byte*>( pak->data ), pak->size );
+#endif
+	}
+
+	// a changed pak may have been mapped again under the same path
+	auto it = downloadPaks.find( pak->path );
+
+	if ( it != downloadPaks.end() && it->second == pak )
+	{
+		downloadPaks.erase( it );
+	}
+
+	delete pak;
+}
+
+/*
+==================
+SV_DownloadPakChanged
+
+Whether the pak was modified or replaced since it was mapped. Reading pages
+of a mapping past the end of a truncated file raises SIGBUS, so this is
+checked before writing blocks from it. Windows doesn't allow truncating a
+mapped file.
+==================
+*/
+static bool SV_DownloadPakChanged( downloadPak_t *pak )
+{
+#ifndef _WIN32
+	struct stat st;
+
+	if ( !pak->changed && ( stat( pak->path.c_str(), &st ) != 0 || st.st_ino != pak->inode
+		|| static_cast<size_t>( st.st_size ) != pak->size || st.st_mtime != pak->mtime ) )
+	{
+		pak->changed = true;
+
+		// the next downloads map the new file
+		auto it = downloadPaks.find( pak->path );
+
+		if ( it != downloadPaks.end() && it->second == pak )
+		{
+			downloadPaks.erase( it );
+		}
+	}
+#endif
+
+	return pak->changed;
+}
+
+/*
+==================
+SV_PrefetchDownloadBlocks
+
+Ask the kernel to read ahead the blocks of the download window, so that the
+page faults taken while writing them out don't stall the frame on disk
+==================
+*/
+static void SV_PrefetchDownloadBlocks( const downloadPak_t *pak, int firstBlock, int lastBlock )
+{
+#ifdef _WIN32
+	// Windows has no cheap per-range equivalent; its own read-ahead of
+	// sequential faults on the view has to do
+	Q_UNUSED( pak );
+	Q_UNUSED( firstBlock );
+	Q_UNUSED( lastBlock );
+#else
+	static const size_t pageSize = sysconf( _SC_PAGESIZE );
+
+	size_t start = static_cast<size_t>( firstBlock ) * MAX_DOWNLOAD_BLKSIZE;
+	size_t end = std::min( static_cast<size_t>( lastBlock ) * MAX_DOWNLOAD_BLKSIZE, pak->size );
+
+	if ( !pak->data || start >= end )
+	{
+		return;
+	}
+
+	start &= ~( pageSize - 1 );
+	posix_madvise( const_cast<byte*>( pak->data ) + start, end - start, POSIX_MADV_WILLNEED );
+#endif
+}
+
+/*
+==================
+SV_DownloadBlockSize
+
+Size of a block of the download, the block after the last data block is the
+zero-length EOF block
+==================
+*/
+static int SV_DownloadBlockSize( const client_t *cl, int block )
+{
+	int offset = block * MAX_DOWNLOAD_BLKSIZE;
+
+	return Math::Clamp( cl->downloadSize - offset, 0, MAX_DOWNLOAD_BLKSIZE );
+}
+
+/*
+==================
+SV_DownloadBlockCount
+
+Number of blocks of the download, including the EOF block
+==================
+*/
+static int SV_DownloadBlockCount( const client_t *cl )
+{
+	return ( cl->downloadSize + MAX_DOWNLOAD_BLKSIZE - 1 ) / MAX_DOWNLOAD_BLKSIZE + 1;
+}
+
 void SV_GetChallenge( const netadr_t& from )
 {
 	auto challenge = ChallengeManager::GenerateChallenge( from );
@@ -453,26 +697,14 @@ clear/free any download vars
 */
 static void SV_CloseDownload( client_t *cl )
 {
-	int i;
-
 	// EOF
 	if ( cl->download )
 	{
-		delete cl->download;
+		SV_ReleaseDownloadPak( cl->download );
 		cl->download = nullptr;
 	}
 
 	*cl->downloadName = 0;
-
-	// Free the temporary buffer space
-	for ( i = 0; i < MAX_DOWNLOAD_WINDOW; i++ )
-	{
-		if ( cl->downloadBlocks[ i ] )
-		{
-			Z_Free( cl->downloadBlocks[ i ] );
-			cl->downloadBlocks[ i ] = nullptr;
-		}
-	}
 }
 
 /*
@@ -531,7 +763,7 @@ void SV_NextDownload_f( client_t *cl, const Cmd::Args& args )
 		Log::Debug( "clientDownload: %d: client acknowledge of block %d", ( int )( cl - svs.clients ), block );
 
 		// Find out if we are done.  A zero-length block indicates EOF
-		if ( cl->downloadBlockSize[ cl->downloadClientBlock % MAX_DOWNLOAD_WINDOW ] == 0 )
+		if ( SV_DownloadBlockSize( cl, cl->downloadClientBlock ) == 0 )
 		{
 			Log::Notice( "clientDownload: %d : file \"%s\" completed", ( int )( cl - svs.clients ), cl->downloadName );
 			SV_CloseDownload( cl );
@@ -694,7 +926,7 @@ Fill up msg with data
 */
 void SV_WriteDownloadToClient( client_t *cl, msg_t *msg )
 {
-	int      curindex;
+	int      blocksize;
 	int      rate;
 	int      blockspersnap;
 	char     errorMessage[ 1024 ];
@@ -781,7 +1013,19 @@ void SV_WriteDownloadToClient( client_t *cl, msg_t *msg )
 			{
 				if ( success )
 				{
-					Q_strncpyz( cl->downloadURL, va("%s/%s", sv_wwwBaseURL.Get().c_str(), pakName.c_str()),
+					// the built-in pak server takes over from sv_wwwBaseURL when it is running
+					std::string baseURL = SV_HTTPBaseURL();
+
+					if ( baseURL.empty() )
+					{
+						baseURL = sv_wwwBaseURL.Get();
+					}
+					else
+					{
+						SV_HTTPAddPak( pakName, pak->path );
+					}
+
+					Q_strncpyz( cl->downloadURL, va("%s/%s", baseURL.c_str(), pakName.c_str()),
 								sizeof( cl->downloadURL ) );
 
 					//bani - prevent multiple download notifications
@@ -799,7 +1043,7 @@ void SV_WriteDownloadToClient( client_t *cl, msg_t *msg )
 					MSG_WriteString( msg, cl->downloadURL );
 					MSG_WriteLong( msg, downloadSize );
 					// Base URL length. The base prefix is expected to end with '/'
-					MSG_WriteLong( msg, sv_wwwBaseURL.Get().size() + 1 );
+					MSG_WriteLong( msg, baseURL.size() + 1 );
 					return;
 				}
 				else
@@ -838,16 +1082,8 @@ void SV_WriteDownloadToClient( client_t *cl, msg_t *msg )
 
 			if (pak) {
 				try {
-					cl->download = new FS::File(FS::RawPath::OpenRead(pak->path));
-
-					const FS::offset_t length{cl->download->Length()};
-
-					if (length > std::numeric_limits<decltype(cl->downloadSize)>::max()) {
-						throw std::system_error{Util::ordinal(std::errc::value_too_large), std::system_category(),
-							"Pak file '" + pak->path + "' size '" + std::to_string(length) + "' is larger than max client download size"};
-					}
-
-					cl->downloadSize = length;
+					cl->download = SV_AcquireDownloadPak(pak->path);
+					cl->downloadSize = cl->download->size;
 				} catch (std::system_error& ex) {
 					Log::Notice("clientDownload: %d : \"%s\" file download failed - %s", (int)(cl - svs.clients), cl->downloadName, ex.what());
 					success = false;
@@ -869,44 +1105,28 @@ void SV_WriteDownloadToClient( client_t *cl, msg_t *msg )
 
 		// is valid source, init
 		cl->downloadCurrentBlock = cl->downloadClientBlock = cl->downloadXmitBlock = 0;
-		cl->downloadCount = 0;
-		cl->downloadEOF = false;
 
 		bTellRate = true;
 	}
-
-	// Perform any reads that we need to
-	while ( cl->downloadCurrentBlock - cl->downloadClientBlock < MAX_DOWNLOAD_WINDOW && cl->downloadSize != cl->downloadCount )
+	else if ( SV_DownloadPakChanged( cl->download ) )
 	{
-		curindex = ( cl->downloadCurrentBlock % MAX_DOWNLOAD_WINDOW );
-
-		if ( !cl->downloadBlocks[ curindex ] )
-		{
-			cl->downloadBlocks[ curindex ] = ( byte* ) Z_Malloc( MAX_DOWNLOAD_BLKSIZE );
-		}
-
-		try {
-			cl->downloadBlockSize[ curindex ] = cl->download->Read(cl->downloadBlocks[ curindex ], MAX_DOWNLOAD_BLKSIZE);
-		} catch (std::system_error&) {
-			// EOF right now
-			cl->downloadCount = cl->downloadSize;
-			break;
-		}
-
-		cl->downloadCount += cl->downloadBlockSize[ curindex ];
-
-		// Load in next block
-		cl->downloadCurrentBlock++;
+		Log::Notice( "clientDownload: %d : \"%s\" changed on the server during the download", ( int )( cl - svs.clients ), cl->downloadName );
+		Com_sprintf( errorMessage, sizeof( errorMessage ), "File \"%s\" changed on the server during the download.\n",
+		             cl->downloadName );
+		SV_ReleaseDownloadPak( cl->download );
+		cl->download = nullptr;
+		SV_BadDownload( cl, msg );
+		MSG_WriteString( msg, errorMessage );
+		return;
 	}
 
-	// Check to see if we have eof condition and add the EOF block
-	if ( cl->downloadCount == cl->downloadSize &&
-	     !cl->downloadEOF && cl->downloadCurrentBlock - cl->downloadClientBlock < MAX_DOWNLOAD_WINDOW )
-	{
-		cl->downloadBlockSize[ cl->downloadCurrentBlock % MAX_DOWNLOAD_WINDOW ] = 0;
-		cl->downloadCurrentBlock++;
+	// Slide the window over the mapped pak, blocks are written straight from it
+	int windowEnd = std::min( cl->downloadClientBlock + MAX_DOWNLOAD_WINDOW, SV_DownloadBlockCount( cl ) );
 
-		cl->downloadEOF = true; // We have added the EOF block
+	if ( windowEnd > cl->downloadCurrentBlock )
+	{
+		SV_PrefetchDownloadBlocks( cl->download, cl->downloadCurrentBlock, windowEnd );
+		cl->downloadCurrentBlock = windowEnd;
 	}
 
 	// Loop up to window size times based on how many blocks we can fit in the
@@ -973,7 +1193,7 @@ void SV_WriteDownloadToClient( client_t *cl, msg_t *msg )
 		}
 
 		// Send current block
-		curindex = ( cl->downloadXmitBlock % MAX_DOWNLOAD_WINDOW );
+		blocksize = SV_DownloadBlockSize( cl, cl->downloadXmitBlock );
 
 		MSG_WriteByte( msg, svc_download );
 		MSG_WriteShort( msg, cl->downloadXmitBlock );
@@ -984,12 +1204,12 @@ void SV_WriteDownloadToClient( client_t *cl, msg_t *msg )
 			MSG_WriteLong( msg, cl->downloadSize );
 		}
 
-		MSG_WriteShort( msg, cl->downloadBlockSize[ curindex ] );
+		MSG_WriteShort( msg, blocksize );
 
 		// Write the block
-		if ( cl->downloadBlockSize[ curindex ] )
+		if ( blocksize )
 		{
-			MSG_WriteData( msg, cl->downloadBlocks[ curindex ], cl->downloadBlockSize[ curindex ] );
+			MSG_WriteData( msg, cl->download->data + cl->downloadXmitBlock * MAX_DOWNLOAD_BLKSIZE, blocksize );
 		}
 
 		Log::Debug( "clientDownload: %d: writing block %d", ( int )( cl - svs.clients ), cl->downloadXmitBlock );
@@ -0,0 +1,726 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+
+// sv_http.cpp -- built-in HTTP server for pak downloads
+
+#include "server.h"
+#include <common/FileSystem.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+using socklen_t = int;
+
+#define poll              WSAPoll
+#define socketError       WSAGetLastError()
+#define SOCKET_WOULDBLOCK WSAEWOULDBLOCK
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+using SOCKET = int;
+constexpr SOCKET INVALID_SOCKET{-1};
+
+#define closesocket       close
+#define ioctlsocket       ioctl
+#define socketError       errno
+#define SOCKET_WOULDBLOCK EWOULDBLOCK
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+/*
+============================================================
+
+HTTP PAK SERVER
+
+A small HTTP server running on its own thread so that dedicated servers can
+hand out their own paks without a separate web server mirroring them. Only
+the paks clients have been redirected to (and the PAKSERVER file the client
+checks for) are served, files are sent with sendfile where available and
+byte ranges are supported so that clients can resume and split downloads.
+
+============================================================
+*/
+
+static Cvar::Cvar<bool> sv_httpServer("sv_httpServer", "serve paks to downloading clients over HTTP from the dedicated server", Cvar::NONE, false);
+static Cvar::Range<Cvar::Cvar<int>> sv_httpPort("sv_httpPort", "TCP port of the HTTP pak server, 0 to use net_port", Cvar::NONE, 0, 0, 65535);
+static Cvar::Cvar<std::string> sv_httpHost("sv_httpHost", "host name or address clients use to reach the HTTP pak server, empty to use net_ip", Cvar::NONE, "");
+static Cvar::Range<Cvar::Cvar<int>> sv_httpMaxConnections("sv_httpMaxConnections", "max simultaneous connections to the HTTP pak server", Cvar::NONE, 32, 1, 1024);
+static Cvar::Range<Cvar::Cvar<int>> sv_httpMaxConnectionsPerIP("sv_httpMaxConnectionsPerIP", "max simultaneous connections to the HTTP pak server from one address", Cvar::NONE, 8, 1, 1024);
+
+static Log::Logger httpLog("server.http");
+
+static const size_t HTTP_MAX_REQUEST_SIZE = 8192;
+static const size_t HTTP_SEND_CHUNK = 65536;
+static const int HTTP_POLL_MSEC = 100; // how often the thread checks whether it should stop
+static const auto HTTP_IDLE_TIMEOUT = std::chrono::seconds( 30 );
+static const auto HTTP_REQUEST_TIMEOUT = std::chrono::seconds( 10 ); // to receive the request headers
+
+struct httpConnection_t
+{
+	SOCKET       socket;
+	uint32_t     address; // IPv4 address of the client
+	std::string  request; // received bytes until the end of the request headers
+	std::string  response; // response headers, and the body when it isn't a file
+	size_t       responseSent = 0;
+	FS::File     file; // pak sent after the response headers
+	FS::offset_t offset = 0; // next byte of the file to send
+	FS::offset_t end = 0; // end of the requested range of the file
+	bool         writing = false; // the request was handled, now sending the response
+	Sys::SteadyClock::time_point accepted;
+	Sys::SteadyClock::time_point lastActivity;
+};
+
+static std::thread httpThread;
+static std::atomic<bool> httpStop;
+static SOCKET httpSocket = INVALID_SOCKET;
+static size_t httpMaxConnections;
+static int httpMaxConnectionsPerIP;
+static std::string httpBaseURL;
+
+// paks which may be served, by the name used in the URL
+static std::mutex httpPaksMutex;
+static std::unordered_map<std::string, std::string> httpPaks;
+
+static std::string SV_HTTPErrorString()
+{
+#ifdef _WIN32
+	return Sys::Win32StrError( WSAGetLastError() );
+#else
+	return strerror( errno );
+#endif
+}
+
+static void SV_HTTPSetNonBlocking( SOCKET socket )
+{
+#ifdef _WIN32
+	u_long nonBlocking = 1;
+#else
+	int nonBlocking = 1;
+#endif
+
+	ioctlsocket( socket, FIONBIO, &nonBlocking );
+}
+
+/*
+==================
+SV_HTTPParseRange
+
+Parse the value of a Range header, returning the status to answer with:
+206 with [start, end) set for a satisfiable range, 416 for an unsatisfiable
+one, or 200 to send the whole file for anything else (multiple ranges, other
+units or an invalid range, which are all allowed to be ignored)
+==================
+*/
+int SV_HTTPParseRange( const std::string& value, FS::offset_t size, FS::offset_t& start, FS::offset_t& end )
+{
+	auto parseOffset = []( const std::string& text, FS::offset_t& offset ) {
+		if ( text.empty() || text.size() > 18 || text.find_first_not_of( "0123456789" ) != std::string::npos )
+		{
+			return false;
+		}
+
+		offset = std::stoll( text );
+		return true;
+	};
+
+	if ( !Str::IsIPrefix( "bytes=", value ) || value.find( ',' ) != std::string::npos )
+	{
+		return 200;
+	}
+
+	size_t dash = value.find( '-' );
+
+	if ( dash == std::string::npos )
+	{
+		return 200;
+	}
+
+	std::string first = value.substr( 6, dash - 6 );
+	std::string last = value.substr( dash + 1 );
+	FS::offset_t firstByte, lastByte;
+
+	// suffix range, the last bytes of the file
+	if ( first.empty() )
+	{
+		if ( !parseOffset( last, lastByte ) )
+		{
+			return 200;
+		}
+
+		if ( lastByte == 0 || size == 0 )
+		{
+			return 416;
+		}
+
+		start = std::max<FS::offset_t>( size - lastByte, 0 );
+		end = size;
+		return 206;
+	}
+
+	if ( !parseOffset( first, firstByte ) )
+	{
+		return 200;
+	}
+
+	if ( last.empty() )
+	{
+		lastByte = size - 1;
+	}
+	else if ( !parseOffset( last, lastByte ) || lastByte < firstByte )
+	{
+		return 200;
+	}
+
+	if ( firstByte >= size )
+	{
+		return 416;
+	}
+
+	start = firstByte;
+	end = std::min( lastByte, size - 1 ) + 1;
+	return 206;
+}
+
+static void SV_HTTPSetResponse( httpConnection_t& conn, int status, Str::StringRef reason, Str::StringRef headers,
+                                FS::offset_t contentLength, Str::StringRef body )
+{
+	conn.response = Str::Format( "HTTP/1.1 %d %s\r\n"
+	                             "Server: %s\r\n"
+	                             "Content-Length: %d\r\n"
+	                             "Connection: close\r\n"
+	                             "%s\r\n",
+	                             status, reason, PRODUCT_NAME "/" PRODUCT_VERSION, contentLength, headers );
+	conn.response += body;
+	conn.responseSent = 0;
+	conn.writing = true;
+}
+
+static void SV_HTTPSetError( httpConnection_t& conn, int status, Str::StringRef reason, Str::StringRef headers = "" )
+{
+	std::string body = Str::Format( "%d %s\n", status, reason );
+
+	SV_HTTPSetResponse( conn, status, reason, headers, body.size(), body );
+}
+
+/*
+==================
+SV_HTTPHandleRequest
+
+Parse the complete request headers and set up the response
+==================
+*/
+static void SV_HTTPHandleRequest( httpConnection_t& conn )
+{
+	size_t lineEnd = conn.request.find( "\r\n" );
+	size_t methodEnd = conn.request.find( ' ' );
+	size_t targetEnd = methodEnd < lineEnd ? conn.request.find( ' ', methodEnd + 1 ) : std::string::npos;
+
+	if ( targetEnd == std::string::npos || targetEnd > lineEnd )
+	{
+		SV_HTTPSetError( conn, 400, "Bad Request" );
+		return;
+	}
+
+	std::string method = conn.request.substr( 0, methodEnd );
+	std::string target = conn.request.substr( methodEnd + 1, targetEnd - methodEnd - 1 );
+	bool head = method == "HEAD";
+
+	if ( !head && method != "GET" )
+	{
+		SV_HTTPSetError( conn, 405, "Method Not Allowed", "Allow: GET, HEAD\r\n" );
+		return;
+	}
+
+	target.erase( std::min( target.find( '?' ), target.size() ) );
+
+	if ( target.empty() || target[ 0 ] != '/' )
+	{
+		SV_HTTPSetError( conn, 400, "Bad Request" );
+		return;
+	}
+
+	std::string name = target.substr( 1 );
+	std::string range;
+
+	for ( size_t pos = lineEnd + 2; pos < conn.request.size(); )
+	{
+		size_t next = conn.request.find( "\r\n", pos );
+		std::string line = conn.request.substr( pos, next - pos );
+		size_t colon = line.find( ':' );
+
+		if ( colon != std::string::npos && Str::IsIEqual( line.substr( 0, colon ), "Range" ) )
+		{
+			range = line.substr( std::min( line.find_first_not_of( " \t", colon + 1 ), line.size() ) );
+		}
+
+		pos = next == std::string::npos ? next : next + 2;
+	}
+
+	if ( name == "PAKSERVER" )
+	{
+		Str::StringRef body = "ALLOW_UNRESTRICTED_DOWNLOAD\n";
+
+		SV_HTTPSetResponse( conn, 200, "OK", "Content-Type: text/plain\r\n", body.size(), head ? "" : body );
+		return;
+	}
+
+	std::string path;
+	{
+		std::lock_guard<std::mutex> lock( httpPaksMutex );
+		auto it = httpPaks.find( name );
+
+		if ( it != httpPaks.end() )
+		{
+			path = it->second;
+		}
+	}
+
+	if ( path.empty() )
+	{
+		SV_HTTPSetError( conn, 404, "Not Found" );
+		return;
+	}
+
+	FS::offset_t size;
+
+	try
+	{
+		conn.file = FS::RawPath::OpenRead( path );
+		size = conn.file.Length();
+	}
+	catch ( std::system_error& err )
+	{
+		httpLog.Warn( "Failed to open pak '%s': %s", path, err.what() );
+		SV_HTTPSetError( conn, 500, "Internal Server Error" );
+		return;
+	}
+
+	FS::offset_t start = 0;
+	FS::offset_t end = size;
+	int status = range.empty() ? 200 : SV_HTTPParseRange( range, size, start, end );
+
+	if ( status == 416 )
+	{
+		SV_HTTPSetError( conn, 416, "Range Not Satisfiable", Str::Format( "Content-Range: bytes */%d\r\n", size ) );
+		return;
+	}
+
+	std::string headers = "Content-Type: application/zip\r\nAccept-Ranges: bytes\r\n";
+
+	if ( status == 206 )
+	{
+		headers += Str::Format( "Content-Range: bytes %d-%d/%d\r\n", start, end - 1, size );
+	}
+
+	SV_HTTPSetResponse( conn, status, status == 206 ? "Partial Content" : "OK", headers, end - start, "" );
+
+	conn.offset = start;
+	conn.end = head ? start : end;
+
+	httpLog.Debug( "Sending '%s' bytes %d-%d", name, start, end );
+}
+
+/*
+==================
+SV_HTTPWrite
+
+Send as much of the response as the socket takes, returns false when the
+connection should be closed
+==================
+*/
+static bool SV_HTTPWrite( httpConnection_t& conn )
+{
+	while ( conn.responseSent < conn.response.size() )
+	{
+		int len = send( conn.socket, conn.response.data() + conn.responseSent, conn.response.size() - conn.responseSent, MSG_NOSIGNAL );
+
+		if ( len < 0 )
+		{
+			return socketError == SOCKET_WOULDBLOCK;
+		}
+
+		conn.responseSent += len;
+	}
+
+	while ( conn.offset < conn.end )
+	{
+		size_t count = std::min<FS::offset_t>( conn.end - conn.offset, HTTP_SEND_CHUNK );
+
+#ifdef __linux__
+		off_t offset = conn.offset;
+		ssize_t len = sendfile( conn.socket, fileno( conn.file.GetHandle() ), &offset, count );
+
+		if ( len < 0 )
+		{
+			return errno == EAGAIN;
+		}
+
+		if ( len == 0 )
+		{
+			return false; // the file was truncated under us
+		}
+
+		conn.offset = offset;
+#else
+		static char buffer[ HTTP_SEND_CHUNK ];
+		size_t read;
+
+		try
+		{
+			conn.file.SeekSet( conn.offset );
+			read = conn.file.Read( buffer, count );
+		}
+		catch ( std::system_error& )
+		{
+			return false;
+		}
+
+		if ( read == 0 )
+		{
+			return false;
+		}
+
+		int len = send( conn.socket, buffer, read, MSG_NOSIGNAL );
+
+		if ( len < 0 )
+		{
+			return socketError == SOCKET_WOULDBLOCK;
+		}
+
+		conn.offset += len;
+#endif
+	}
+
+	// the whole response was sent
+	return false;
+}
+
+/*
+==================
+SV_HTTPRead
+
+Receive the request, returns false when the connection should be closed
+==================
+*/
+static bool SV_HTTPRead( httpConnection_t& conn )
+{
+	char buffer[ 1024 ];
+
+	while ( true )
+	{
+		int len = recv( conn.socket, buffer, sizeof( buffer ), 0 );
+
+		if ( len == 0 )
+		{
+			return false;
+		}
+
+		if ( len < 0 )
+		{
+			return socketError == SOCKET_WOULDBLOCK;
+		}
+
+		conn.request.append( buffer, len );
+
+		if ( conn.request.find( "\r\n\r\n" ) != std::string::npos )
+		{
+			SV_HTTPHandleRequest( conn );
+			return SV_HTTPWrite( conn );
+		}
+
+		if ( conn.request.size() > HTTP_MAX_REQUEST_SIZE )
+		{
+			SV_HTTPSetError( conn, 431, "Request Header Fields Too Large" );
+			return SV_HTTPWrite( conn );
+		}
+	}
+}
+
+static void SV_HTTPThread()
+{
+	std::vector<std::unique_ptr<httpConnection_t>> connections;
+	std::unordered_map<uint32_t, int> connectionsPerAddress;
+	std::vector<pollfd> fds;
+
+	while ( !httpStop )
+	{
+		// stop accepting while at the connection limit, pending ones wait in the backlog
+		bool accepting = connections.size() < httpMaxConnections;
+
+		fds.clear();
+		fds.push_back( { httpSocket, static_cast<short>( accepting ? POLLIN : 0 ), 0 } );
+
+		for ( const auto& conn : connections )
+		{
+			fds.push_back( { conn->socket, static_cast<short>( conn->writing ? POLLOUT : POLLIN ), 0 } );
+		}
+
+		if ( poll( fds.data(), fds.size(), HTTP_POLL_MSEC ) < 0 )
+		{
+			continue;
+		}
+
+		auto now = Sys::SteadyClock::now();
+
+		for ( size_t i = 0; i < connections.size(); i++ )
+		{
+			httpConnection_t& conn = *connections[ i ];
+			short revents = fds[ i + 1 ].revents;
+			bool keep = true;
+
+			if ( revents & ( POLLIN | POLLOUT ) )
+			{
+				conn.lastActivity = now;
+				keep = conn.writing ? SV_HTTPWrite( conn ) : SV_HTTPRead( conn );
+			}
+			else if ( revents & ( POLLERR | POLLHUP | POLLNVAL ) )
+			{
+				keep = false;
+			}
+			else if ( now - conn.lastActivity > HTTP_IDLE_TIMEOUT )
+			{
+				keep = false;
+			}
+
+			// a client trickling its headers would otherwise hold the connection forever
+			if ( keep && !conn.writing && now - conn.accepted > HTTP_REQUEST_TIMEOUT )
+			{
+				keep = false;
+			}
+
+			if ( !keep )
+			{
+				if ( --connectionsPerAddress[ conn.address ] == 0 )
+				{
+					connectionsPerAddress.erase( conn.address );
+				}
+
+				closesocket( conn.socket );
+				connections[ i ] = nullptr;
+			}
+		}
+
+		connections.erase( std::remove( connections.begin(), connections.end(), nullptr ), connections.end() );
+
+		if ( accepting && ( fds[ 0 ].revents & POLLIN ) )
+		{
+			while ( connections.size() < httpMaxConnections )
+			{
+				struct sockaddr_in clientAddr;
+				socklen_t clientAddrLen = sizeof( clientAddr );
+				SOCKET clientSocket = accept( httpSocket, reinterpret_cast<struct sockaddr*>( &clientAddr ), &clientAddrLen );
+
+				if ( clientSocket == INVALID_SOCKET )
+				{
+					break;
+				}
+
+				uint32_t address = clientAddr.sin_addr.s_addr;
+				int& numConnections = connectionsPerAddress[ address ];
+
+				if ( numConnections >= httpMaxConnectionsPerIP )
+				{
+					char addressString[ INET_ADDRSTRLEN ] = "";
+					inet_ntop( AF_INET, &clientAddr.sin_addr, addressString, sizeof( addressString ) );
+					httpLog.Debug( "Refusing connection from %s, it has too many already", addressString );
+					closesocket( clientSocket );
+					continue;
+				}
+
+				numConnections++;
+				SV_HTTPSetNonBlocking( clientSocket );
+
+				connections.emplace_back( new httpConnection_t );
+				connections.back()->socket = clientSocket;
+				connections.back()->address = address;
+				connections.back()->accepted = now;
+				connections.back()->lastActivity = now;
+			}
+		}
+	}
+
+	for ( const auto& conn : connections )
+	{
+		closesocket( conn->socket );
+	}
+}
+
+/*
+==================
+SV_HTTPStart
+
+Start the HTTP pak server if it is enabled and not already running
+==================
+*/
+void SV_HTTPStart()
+{
+	if ( !sv_httpServer.Get() || !Com_IsDedicatedServer() || httpThread.joinable() )
+	{
+		return;
+	}
+
+	int port = sv_httpPort.Get();
+
+	if ( !port && !Str::ParseInt( port, Cvar::GetValue( "net_port" ) ) )
+	{
+		port = PORT_SERVER;
+	}
+
+	// a host name in net_ip is not resolved, the server listens on all interfaces then
+	std::string address = Cvar::GetValue( "net_ip" );
+	struct sockaddr_in bindAddr{};
+
+	bindAddr.sin_family = AF_INET;
+	bindAddr.sin_port = htons( port );
+
+	if ( inet_pton( AF_INET, address.c_str(), &bindAddr.sin_addr ) != 1 )
+	{
+		bindAddr.sin_addr.s_addr = htonl( INADDR_ANY );
+	}
+
+	httpSocket = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP );
+
+	if ( httpSocket == INVALID_SOCKET )
+	{
+		Log::Warn( "HTTP pak server: couldn't create socket: %s", SV_HTTPErrorString() );
+		return;
+	}
+
+#ifndef _WIN32
+	int reuse = 1;
+	setsockopt( httpSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof( reuse ) );
+#endif
+
+	if ( bind( httpSocket, reinterpret_cast<struct sockaddr*>( &bindAddr ), sizeof( bindAddr ) ) != 0
+	     || listen( httpSocket, SOMAXCONN ) != 0 )
+	{
+		Log::Warn( "HTTP pak server: couldn't listen on port %d: %s", port, SV_HTTPErrorString() );
+		closesocket( httpSocket );
+		httpSocket = INVALID_SOCKET;
+		return;
+	}
+
+	SV_HTTPSetNonBlocking( httpSocket );
+
+	httpMaxConnections = sv_httpMaxConnections.Get();
+	httpMaxConnectionsPerIP = sv_httpMaxConnectionsPerIP.Get();
+	httpStop = false;
+
+	try
+	{
+		httpThread = std::thread( SV_HTTPThread );
+	}
+	catch ( std::system_error& err )
+	{
+		Log::Warn( "HTTP pak server: couldn't create thread: %s", err.what() );
+		closesocket( httpSocket );
+		httpSocket = INVALID_SOCKET;
+		return;
+	}
+
+	std::string host = sv_httpHost.Get();
+
+	if ( host.empty() && bindAddr.sin_addr.s_addr != htonl( INADDR_ANY ) )
+	{
+		host = address;
+	}
+
+	if ( host.empty() )
+	{
+		Log::Warn( "HTTP pak server: neither sv_httpHost nor net_ip is set, clients won't be redirected to it" );
+	}
+	else
+	{
+		httpBaseURL = Str::Format( "%s:%d", host, port );
+	}
+
+	Log::Notice( "HTTP pak server listening on port %d", port );
+}
+
+/*
+==================
+SV_HTTPStop
+==================
+*/
+void SV_HTTPStop()
+{
+	if ( !httpThread.joinable() )
+	{
+		return;
+	}
+
+	httpStop = true;
+	httpThread.join();
+
+	closesocket( httpSocket );
+	httpSocket = INVALID_SOCKET;
+	httpBaseURL.clear();
+
+	std::lock_guard<std::mutex> lock( httpPaksMutex );
+	httpPaks.clear();
+}
+
+/*
+==================
+SV_HTTPBaseURL
+
+URL clients can download paks from, empty if the HTTP pak server isn't
+running or its address is unknown
+==================
+*/
+std::string SV_HTTPBaseURL()
+{
+	return httpBaseURL;
+}
+
+/*
+==================
+SV_HTTPAddPak
+
+Allow the pak at path to be downloaded under the given name
+==================
+*/
+void SV_HTTPAddPak( const std::string& name, const std::string& path )
+{
+	std::lock_guard<std::mutex> lock( httpPaksMutex );
+	httpPaks[ name ] = path;
+}
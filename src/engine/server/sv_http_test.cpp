@@ -0,0 +1,110 @@
+/*
+===========================================================================
+Daemon BSD Source Code
+Copyright (c) 2026, Daemon Developers
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the Daemon developers nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL DAEMON DEVELOPERS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+===========================================================================
+*/
+
+#include <gtest/gtest.h>
+
+#include "server.h"
+
+namespace {
+
+const FS::offset_t SIZE = 1000;
+
+struct rangeCase_t
+{
+	const char   *value;
+	int          status;
+	FS::offset_t start, end;
+};
+
+void ExpectRange( const rangeCase_t& test, FS::offset_t size = SIZE )
+{
+	FS::offset_t start = -1, end = -1;
+
+	EXPECT_EQ( SV_HTTPParseRange( test.value, size, start, end ), test.status ) << test.value;
+
+	if ( test.status == 206 )
+	{
+		EXPECT_EQ( start, test.start ) << test.value;
+		EXPECT_EQ( end, test.end ) << test.value;
+	}
+}
+
+TEST(HTTPParseRangeTest, SatisfiableRanges)
+{
+	for ( const rangeCase_t& test : std::initializer_list<rangeCase_t>{
+		{ "bytes=0-99", 206, 0, 100 },
+		{ "bytes=0-0", 206, 0, 1 },
+		{ "Bytes=10-19", 206, 10, 20 },
+		{ "bytes=100-", 206, 100, SIZE },
+		{ "bytes=999-999", 206, 999, SIZE },
+		{ "bytes=500-5000", 206, 500, SIZE },
+		{ "bytes=-100", 206, 900, SIZE },
+		{ "bytes=-5000", 206, 0, SIZE },
+	} )
+	{
+		ExpectRange( test );
+	}
+}
+
+TEST(HTTPParseRangeTest, UnsatisfiableRanges)
+{
+	for ( const rangeCase_t& test : std::initializer_list<rangeCase_t>{
+		{ "bytes=1000-", 416, 0, 0 },
+		{ "bytes=5000-6000", 416, 0, 0 },
+		{ "bytes=-0", 416, 0, 0 },
+	} )
+	{
+		ExpectRange( test );
+	}
+
+	ExpectRange( { "bytes=-10", 416, 0, 0 }, 0 );
+	ExpectRange( { "bytes=0-", 416, 0, 0 }, 0 );
+}
+
+// Invalid or unsupported ranges may be ignored, the whole file is sent then
+TEST(HTTPParseRangeTest, IgnoredRanges)
+{
+	for ( const rangeCase_t& test : std::initializer_list<rangeCase_t>{
+		{ "bytes=0-1,5-6", 200, 0, 0 },
+		{ "items=0-1", 200, 0, 0 },
+		{ "bytes=", 200, 0, 0 },
+		{ "bytes=0", 200, 0, 0 },
+		{ "bytes=-", 200, 0, 0 },
+		{ "bytes=5-1", 200, 0, 0 },
+		{ "bytes=a-b", 200, 0, 0 },
+		{ "bytes=+1-2", 200, 0, 0 },
+		{ "bytes=1234567890123456789-", 200, 0, 0 },
+	} )
+	{
+		ExpectRange( test );
+	}
+}
+
+} // namespace
@@ -586,6 +586,8 @@ void SV_SpawnServer(std::string pakname, std::string mapname)
 	// send a heartbeat now so the master will get up to date info
 	SV_Heartbeat_f();
 
+	SV_HTTPStart();
+
 	SV_UpdateConfigStrings();
 
 	SV_AddOperatorCommands();
@@ -677,6 +679,7 @@ void SV_QuickShutdown( const char *finalmsg )
 
 	SV_ShutdownGameProgs();
 	SV_MasterShutdown();
+	SV_HTTPStop();
 }
 
 /*
@@ -39,6 +39,12 @@ Cvar::Cvar<bool> com_ansiColor(
 Cvar::Cvar<std::string> com_consoleCommand(
     "com_consoleCommand", "command prepended to inputs from tty/curses console", Cvar::NONE, "");
 
+std::recursive_mutex &CON_Mutex()
+{
+    static std::recursive_mutex mutex;
+    return mutex;
+}
+
 namespace Color {
 
 /*